@@ -0,0 +1 @@
+\#define libfirm_VERSION_REVISION "3c85de21167da955a24ed80c5f0ad3dc96ade3cb"
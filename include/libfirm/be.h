@@ -154,6 +154,10 @@ typedef struct backend_params {
 
 	/** Alignment of stack parameters */
 	unsigned stack_param_align;
+
+	/** Preferred factor for unrolling loops with runtime trip counts,
+	 * 0 lets the loop optimization choose. */
+	unsigned loop_unroll_factor;
 } backend_params;
 
 /**
@@ -52,6 +52,21 @@ FIRM_API int ir_import(const char *filename);
  */
 FIRM_API int ir_import_file(FILE *input, const char *inputname);
 
+/**
+ * Imports several files into the current program and links them like a
+ * linker would (link-time optimization).
+ * Externally visible entities with the same linker name are resolved to the
+ * strongest definition, a non-weak definition wins over a weak one and both
+ * win over declarations. Local entities with clashing linker names are
+ * renamed. Structurally equal primitive, pointer and method types of the
+ * modules are merged.
+ * @param n_files    the number of files
+ * @param filenames  the names of the files
+ * @returns 0 if no errors occured, other values in case of errors or
+ *          conflicting definitions
+ */
+FIRM_API int ir_import_lto(size_t n_files, const char *const *filenames);
+
 /** @} */
 
 #include "end.h"
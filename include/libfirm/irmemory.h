@@ -239,6 +239,30 @@ FIRM_API void mark_private_methods(void);
  */
 FIRM_API ir_prog_pass_t *mark_private_methods_pass(const char *name);
 
+/**
+ * Computes interprocedural points-to information for all graphs of the
+ * program. While it is available get_alias_relation() uses it to
+ * disambiguate addresses. Needs the callee information of cgana to resolve
+ * indirect calls, without it their arguments are considered to escape.
+ * Nodes created after the analysis are not covered.
+ */
+FIRM_API void compute_irp_points_to(void);
+
+/**
+ * Frees the points-to information and reports how many alias queries it
+ * answered with ir_no_alias.
+ */
+FIRM_API void free_irp_points_to(void);
+
+/**
+ * Creates an ir_prog pass for compute_irp_points_to().
+ *
+ * @param name     the name of this pass or NULL
+ *
+ * @return  the newly created ir_prog pass
+ */
+FIRM_API ir_prog_pass_t *compute_irp_points_to_pass(const char *name);
+
 /** @} */
 
 #include "end.h"
@@ -296,6 +296,45 @@ FIRM_API void opt_ldst(ir_graph *irg);
  */
 FIRM_API ir_graph_pass_t *opt_ldst_pass(const char *name);
 
+/**
+ * Moves Loads from loop invariant addresses out of loops and promotes memory
+ * locations read and written in loops to values, which are stored once on
+ * the loop exits. Uses get_alias_relation() to prove that no other memory
+ * operation in the loop accesses the location.
+ *
+ * Works best after do_loop_inversion() as Stores in the body of a head
+ * controlled loop are not executed on every path leaving the loop.
+ */
+FIRM_API void opt_licm(ir_graph *irg);
+
+/**
+ * Creates an ir_graph pass for opt_licm().
+ *
+ * @param name     the name of this pass or NULL
+ *
+ * @return  the newly created ir_graph pass
+ */
+FIRM_API ir_graph_pass_t *opt_licm_pass(const char *name);
+
+/**
+ * Replaces loops which set memory to a constant byte by a call to memset()
+ * and loops which copy memory by a call to memcpy() or memmove(). The
+ * number of iterations must be computable before the loop from an induction
+ * variable. Copies of a small constant size become a CopyB node instead.
+ * Uses get_alias_relation() to decide whether source and destination of a
+ * copy may overlap.
+ */
+FIRM_API void opt_loop_idiom(ir_graph *irg);
+
+/**
+ * Creates an ir_graph pass for opt_loop_idiom().
+ *
+ * @param name     the name of this pass or NULL
+ *
+ * @return  the newly created ir_graph pass
+ */
+FIRM_API ir_graph_pass_t *opt_loop_idiom_pass(const char *name);
+
 /**
  * Optimize loops by peeling or unrolling them if beneficial.
  *
@@ -459,6 +498,28 @@ FIRM_API void proc_cloning(float threshold);
  */
 FIRM_API ir_prog_pass_t *proc_cloning_pass(const char *name, float threshold);
 
+/**
+ * Interprocedural sparse conditional constant propagation.
+ *
+ * Computes which parameters and results of all graphs are constant over all
+ * call sites, using the callee information of cgana for indirect calls.
+ * Constant parameters of graphs whose callers are all known are placed in
+ * the graph, constant results are placed at the call sites and results no
+ * caller uses are replaced by a constant, so the code computing them becomes
+ * dead. Run combo() or optimize_graph_df() afterwards to fold the changed
+ * graphs.
+ */
+FIRM_API void opt_ipsccp(void);
+
+/**
+ * Creates an ir_prog pass for opt_ipsccp().
+ *
+ * @param name     the name of this pass or NULL
+ *
+ * @return  the newly created ir_prog pass
+ */
+FIRM_API ir_prog_pass_t *opt_ipsccp_pass(const char *name);
+
 /**
  * Reassociation.
  *
@@ -666,6 +727,43 @@ FIRM_API void inline_functions(unsigned maxsize, int inline_threshold,
 FIRM_API ir_prog_pass_t *inline_functions_pass(const char *name,
 		unsigned maxsize, int inline_threshold, opt_ptr after_inline_opt);
 
+/**
+ * Whole-program inliner. Keeps a single priority queue of all calls in the
+ * program ordered by their benefice weighted with the execution frequency of
+ * the call site (profile data if available, estimated frequencies otherwise)
+ * and divided by the size of the callee. Callee sizes are updated after each
+ * inlining step. Decisions are reported as statistic events.
+ *
+ * @param maxsize             Do not inline any calls if a method has more than
+ *                            maxsize firm nodes.  It may reach this limit by
+ *                            inlining.
+ * @param max_growth          maximum growth of the whole program in percent
+ * @param inline_threshold    inlining threshold
+ * @param after_inline_opt    optimizations performed immediately after inlining
+ *                            some calls
+ */
+FIRM_API void inline_functions_global(unsigned maxsize, unsigned max_growth,
+                                      int inline_threshold,
+                                      opt_ptr after_inline_opt);
+
+/**
+ * Creates an ir_prog pass for inline_functions_global().
+ *
+ * @param name               the name of this pass or NULL
+ * @param maxsize            Do not inline any calls if a method has more than
+ *                           maxsize firm nodes.  It may reach this limit by
+ *                           inlineing.
+ * @param max_growth         maximum growth of the whole program in percent
+ * @param inline_threshold   inlining threshold
+ * @param after_inline_opt   a function that is called after inlining a
+ *                           procedure.
+ *
+ * @return  the newly created ir_prog pass
+ */
+FIRM_API ir_prog_pass_t *inline_functions_global_pass(const char *name,
+		unsigned maxsize, unsigned max_growth, int inline_threshold,
+		opt_ptr after_inline_opt);
+
 /**
  * Combines congruent blocks into one.
  *
@@ -750,6 +848,17 @@ FIRM_API void garbage_collect_entities(void);
 /** Pass for garbage_collect_entities */
 FIRM_API ir_prog_pass_t *garbage_collect_entities_pass(const char *name);
 
+/**
+ * Runs the whole-program optimizations which become effective once all
+ * modules of a program are linked into the current program by
+ * ir_import_lto(): devirtualization of calls with cgana, inlining, marking
+ * const/pure functions and removing unused entities.
+ *
+ * @param inline_maxsize     the maxsize parameter of inline_functions()
+ * @param inline_threshold   the inlining threshold of inline_functions()
+ */
+FIRM_API void opt_lto(unsigned inline_maxsize, int inline_threshold);
+
 /**
  * Performs dead node elimination by copying the ir graph to a new obstack.
  *
@@ -108,6 +108,17 @@ FIRM_API int ir_prog_pass_mgr_run(ir_prog_pass_manager_t *mgr);
  */
 FIRM_API void term_prog_pass_mgr(ir_prog_pass_manager_t *mgr);
 
+/**
+ * Sets the irg_verify() flags used when verify_all is set for an irgraph
+ * pass manager. Use VERIFY_INCREMENTAL or VERIFY_FAST to make verification
+ * after every pass cheap enough to leave it enabled.
+ *
+ * @param mgr    the manager
+ * @param flags  a combination of irg_verify_flags_t, default is VERIFY_NORMAL
+ */
+FIRM_API void ir_graph_pass_mgr_set_verify_flags(
+	ir_graph_pass_manager_t *mgr, unsigned flags);
+
 /**
  * Sets the run index for an irgraph pass manager.
  *
@@ -209,6 +220,16 @@ FIRM_API ir_prog_pass_t *def_prog_pass_constructor(
 FIRM_API ir_prog_pass_t *call_function_pass(
 	const char *name, void (*function)(void *context), void *context);
 
+/**
+ * Sets the irg_verify() flags used when verify_all is set for an irprog
+ * pass manager. They are inherited by added irgraph pass managers.
+ *
+ * @param mgr    the manager
+ * @param flags  a combination of irg_verify_flags_t, default is VERIFY_NORMAL
+ */
+FIRM_API void ir_prog_pass_mgr_set_verify_flags(
+	ir_prog_pass_manager_t *mgr, unsigned flags);
+
 /**
  * Sets the run index for an irprog pass manager.
  *
@@ -47,15 +47,24 @@ FIRM_API int irn_verify_irg_dump(const ir_node *checknode, ir_graph *irg,
  */
 typedef enum irg_verify_flags_t {
 	VERIFY_NORMAL      = 0,      /**< check SSA property only if dominance information is available */
-	VERIFY_ENFORCE_SSA = 1       /**< check SSA property by enforcing the dominance information recalculation */
+	VERIFY_ENFORCE_SSA = 1,      /**< check SSA property by enforcing the dominance information recalculation */
+	VERIFY_FAST        = 2,      /**< only check cheap structural invariants in a
+	                                  linear sweep over the node index map */
+	VERIFY_INCREMENTAL = 4       /**< only check nodes created or changed since
+	                                  the last incremental verification of the
+	                                  graph; the first call checks the whole
+	                                  graph and starts tracking changes */
 } irg_verify_flags_t;
 
 /**
  * Calls irn_verify() for each node in irg.
  * Graph must be in state "op_pin_state_pinned".
  *
+ * VERIFY_FAST and VERIFY_INCREMENTAL are also available in release builds,
+ * the full verification only in debug builds.
+ *
  * @param irg    the IR-graph t check
- * @param flags  one of irg_verify_flags_t
+ * @param flags  a combination of irg_verify_flags_t
  *
  * @return NON-zero on success.
  */
@@ -48,6 +48,55 @@
 FIRM_API void lower_CopyB(ir_graph *irg, unsigned max_small_size,
                           unsigned min_large_size, int allow_misalignments);
 
+/**
+ * The ways to lower a CopyB node, see lower_CopyB_rules().
+ */
+typedef enum ir_copyb_strategy {
+	ir_copyb_keep,  /**< keep the CopyB, the backend handles it */
+	ir_copyb_moves, /**< replace it by a series of Load/Store nodes */
+	ir_copyb_loop,  /**< replace it by a loop of Load/Store nodes */
+	ir_copyb_call,  /**< replace it by a call to memcpy */
+} ir_copyb_strategy;
+
+/**
+ * A line of the table choosing the strategy for a CopyB node.
+ */
+typedef struct ir_copyb_rule {
+	unsigned          max_size;  /**< the rule applies up to this size */
+	unsigned          min_align; /**< the rule needs at least this alignment */
+	ir_copyb_strategy strategy;  /**< the strategy used */
+} ir_copyb_rule;
+
+/**
+ * Target description for lower_CopyB_rules().
+ */
+typedef struct ir_copyb_params {
+	const ir_copyb_rule *rules;     /**< rules ordered by size, the first
+	                                     matching one is used */
+	size_t               n_rules;   /**< number of rules */
+	ir_mode             *wide_mode; /**< a mode wider than the machine size
+	                                     which moves bytes unmodified, or NULL */
+	int                  allow_misalignments; /**< backend can handle
+	                                               misaligned loads and stores */
+} ir_copyb_params;
+
+/**
+ * Lowers CopyB nodes with the strategy chosen by a table of rules.
+ *
+ * The first rule whose max_size is not exceeded by the size of the copied
+ * type and whose min_align is met by its alignment decides how a CopyB is
+ * lowered. CopyB nodes matching no rule are turned into memcpy calls.
+ *
+ * Load/Store series use the wide mode if possible. If misalignments are
+ * allowed, the last move overlaps the previous one instead of falling back
+ * to narrower moves. Copy loops move words and copy the remaining bytes like
+ * a Load/Store series.
+ *
+ * @param irg     The graph to be lowered.
+ * @param params  The target description.
+ */
+FIRM_API void lower_CopyB_rules(ir_graph *irg, const ir_copyb_params *params);
+
 /**
  * Lowers all Switches (Cond nodes with non-boolean mode) depending on spare_size.
  * They will either remain the same or be converted into if-cascades.
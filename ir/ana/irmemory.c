@@ -697,6 +697,8 @@ leave_type_based_alias:;
 	}
 
 	/* access points-to information here */
+	if (points_to_computed())
+		return get_points_to_relation(orig_adr1, orig_adr2);
 	return ir_may_alias;
 }
 
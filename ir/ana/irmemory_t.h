@@ -12,9 +12,30 @@
 #ifndef FIRM_ANA_IRMEMORY_T_H
 #define FIRM_ANA_IRMEMORY_T_H
 
+#include <stdbool.h>
+#include "irmemory.h"
+
 /**
  * One-time inititialization of the memory< disambiguator.
  */
 void firm_init_memory_disambiguator(void);
 
+/**
+ * Returns true if the interprocedural points-to information is available.
+ */
+bool points_to_computed(void);
+
+/**
+ * Determine the alias relation of two addresses using the interprocedural
+ * points-to information.
+ */
+ir_alias_relation get_points_to_relation(const ir_node *adr1,
+                                         const ir_node *adr2);
+
+/**
+ * Forgets the classes of the nodes of a graph. Must be called when the node
+ * indices of the graph are reset or the graph is freed.
+ */
+void invalidate_points_to(ir_graph *irg);
+
 #endif
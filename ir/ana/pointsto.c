@@ -0,0 +1,831 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief    Interprocedural points-to analysis
+ *
+ * A unification based (Steensgaard style) analysis over all graphs of the
+ * program. Every pointer value is mapped to a class of abstract objects it
+ * may point to. Objects are global and frame entities, Allocs and the results
+ * of malloc-like calls. A class records the class its stored pointers point
+ * to (content) and, to be field sensitive, a class for every compound member
+ * selected from it. Fields are merged into their object when it is accessed
+ * in a way which does not respect the members: pointer arithmetic, CopyB or
+ * Loads and Stores directly through the object pointer.
+ *
+ * Everything the analysis cannot follow is unified with a single unknown
+ * class: externally visible globals, arguments of externally visible or
+ * address taken functions, arguments of unknown callees and pointers
+ * converted to integers. Two addresses whose classes differ and are not
+ * contained in each other cannot alias.
+ *
+ * Nodes created after the analysis have no class, queries for them are
+ * answered with ir_may_alias. This holds for all nodes of a graph whose
+ * node indices were reset, e.g. by dead node elimination.
+ */
+#include <stdbool.h>
+
+#include "irmemory_t.h"
+#include "irmemory.h"
+#include "irnode_t.h"
+#include "irgraph_t.h"
+#include "irprog_t.h"
+#include "irgwalk.h"
+#include "irpass.h"
+#include "irprintf.h"
+#include "typerep.h"
+#include "array_t.h"
+#include "obst.h"
+#include "pmap.h"
+#include "pset_new.h"
+#include "debug.h"
+#include "error.h"
+#include "statev.h"
+
+DEBUG_ONLY(static firm_dbg_module_t *dbg = NULL;)
+
+/** Give up looking for containing objects after this many steps. */
+#define MAX_OUTER_DEPTH 64
+
+typedef struct pt_class_t pt_class_t;
+typedef struct pt_field_t pt_field_t;
+
+/** A class of abstract objects. */
+struct pt_class_t {
+	pt_class_t *link;      /**< union-find link, NULL for representatives */
+	pt_class_t *content;   /**< objects the stored pointers point to */
+	pt_class_t *outer;     /**< the object containing this field */
+	pt_field_t *fields;    /**< the members selected from this object */
+	unsigned    rank;      /**< union-find rank */
+	bool        collapsed; /**< fields are merged into the object */
+	bool        accessed;  /**< the object is accessed without a member */
+};
+
+/** A member selected from an object. */
+struct pt_field_t {
+	ir_entity  *entity;    /**< the member entity */
+	pt_class_t *cls;       /**< the class of the member */
+	pt_field_t *next;
+};
+
+/** The classes of a graph. */
+typedef struct pt_graph_t {
+	pt_class_t **nodes;    /**< the classes of the nodes by index */
+	size_t       n_nodes;
+	pt_class_t **params;   /**< the classes of the parameters */
+	size_t       n_params;
+	pt_class_t **results;  /**< the classes of the results */
+	size_t       n_results;
+} pt_graph_t;
+
+typedef struct pt_pair_t {
+	pt_class_t *a;
+	pt_class_t *b;
+} pt_pair_t;
+
+static struct obstack obst;
+static bool           computed;
+static pmap          *graphs;        /**< maps graphs to pt_graph_t */
+static pmap          *objects;       /**< maps entities to their classes */
+static pset_new_t     taken_methods; /**< methods whose address is taken */
+static pt_class_t    *unknown;       /**< everything not analyzed */
+static pt_pair_t     *pending;       /**< pending unifications */
+static unsigned       n_queries;
+static unsigned       n_no_alias;
+
+static pt_class_t *new_class(void)
+{
+	pt_class_t *cls = OALLOCZ(&obst, pt_class_t);
+	return cls;
+}
+
+static pt_class_t *find(pt_class_t *cls)
+{
+	pt_class_t *root = cls;
+	while (root->link != NULL)
+		root = root->link;
+	/* path compression */
+	while (cls != root) {
+		pt_class_t *next = cls->link;
+		cls->link = root;
+		cls       = next;
+	}
+	return root;
+}
+
+static void unify_later(pt_class_t *a, pt_class_t *b)
+{
+	pt_pair_t pair = { a, b };
+	ARR_APP1(pt_pair_t, pending, pair);
+}
+
+/**
+ * Merges all fields of a class into the class itself.
+ */
+static void collapse_later(pt_class_t *cls)
+{
+	if (cls->collapsed)
+		return;
+	cls->collapsed = true;
+	for (pt_field_t *field = cls->fields; field != NULL; field = field->next)
+		unify_later(cls, field->cls);
+	cls->fields = NULL;
+}
+
+static void merge_classes(pt_class_t *a, pt_class_t *b)
+{
+	a = find(a);
+	b = find(b);
+	if (a == b)
+		return;
+
+	if (a->rank < b->rank) {
+		pt_class_t *t = a;
+		a = b;
+		b = t;
+	} else if (a->rank == b->rank) {
+		++a->rank;
+	}
+	b->link = a;
+
+	if (b->content != NULL) {
+		if (a->content != NULL)
+			unify_later(a->content, b->content);
+		else
+			a->content = b->content;
+	}
+
+	/* a field merged with its object has no containing object anymore */
+	pt_class_t *outer_a = a->outer != NULL && find(a->outer) != a ? a->outer : NULL;
+	pt_class_t *outer_b = b->outer != NULL && find(b->outer) != a ? b->outer : NULL;
+	if (outer_a != NULL && outer_b != NULL)
+		unify_later(outer_a, outer_b);
+	a->outer = outer_a != NULL ? outer_a : outer_b;
+
+	a->accessed |= b->accessed;
+	if (a->collapsed || b->collapsed) {
+		a->collapsed = false;
+		for (pt_field_t *field = b->fields; field != NULL; field = field->next)
+			unify_later(a, field->cls);
+		collapse_later(a);
+	} else {
+		for (pt_field_t *field = b->fields, *next; field != NULL; field = next) {
+			next = field->next;
+			pt_field_t *own = a->fields;
+			while (own != NULL && own->entity != field->entity)
+				own = own->next;
+			if (own != NULL) {
+				unify_later(own->cls, field->cls);
+			} else {
+				field->next = a->fields;
+				a->fields   = field;
+			}
+		}
+		if (a->accessed && a->fields != NULL)
+			collapse_later(a);
+	}
+	b->fields = NULL;
+}
+
+static void process_pending(void)
+{
+	while (ARR_LEN(pending) > 0) {
+		pt_pair_t pair = pending[ARR_LEN(pending) - 1];
+		ARR_SHRINKLEN(pending, ARR_LEN(pending) - 1);
+		merge_classes(pair.a, pair.b);
+	}
+}
+
+static void unify(pt_class_t *a, pt_class_t *b)
+{
+	unify_later(a, b);
+	process_pending();
+}
+
+static void collapse(pt_class_t *cls)
+{
+	collapse_later(find(cls));
+	process_pending();
+}
+
+static pt_class_t *get_content(pt_class_t *cls)
+{
+	cls = find(cls);
+	if (cls->content == NULL)
+		cls->content = new_class();
+	return find(cls->content);
+}
+
+/**
+ * Returns the outermost object containing a class.
+ */
+static pt_class_t *get_root(pt_class_t *cls)
+{
+	cls = find(cls);
+	for (unsigned depth = 0; cls->outer != NULL && depth < MAX_OUTER_DEPTH; ++depth)
+		cls = find(cls->outer);
+	return cls;
+}
+
+/**
+ * Marks an object as accessed without selecting a member.
+ */
+static void mark_accessed(pt_class_t *cls)
+{
+	cls = find(cls);
+	cls->accessed = true;
+	if (cls->fields != NULL)
+		collapse(cls);
+}
+
+/**
+ * Makes an object and everything reachable from it unknown.
+ */
+static void escape(pt_class_t *cls)
+{
+	pt_class_t *root = get_root(cls);
+	collapse(root);
+	unify(root, unknown);
+}
+
+/**
+ * Returns the class of a member of an object.
+ */
+static pt_class_t *get_field(pt_class_t *cls, ir_entity *entity)
+{
+	cls = find(cls);
+	if (cls->collapsed || is_Union_type(get_entity_owner(entity)))
+		return cls;
+	if (cls->accessed) {
+		collapse(cls);
+		return find(cls);
+	}
+
+	for (pt_field_t *field = cls->fields; field != NULL; field = field->next) {
+		if (field->entity == entity)
+			return find(field->cls);
+	}
+
+	pt_field_t *field = OALLOC(&obst, pt_field_t);
+	field->entity     = entity;
+	field->cls        = new_class();
+	field->cls->outer = cls;
+	field->next       = cls->fields;
+	cls->fields       = field;
+	return field->cls;
+}
+
+static pt_class_t *get_object(ir_entity *entity)
+{
+	pt_class_t *cls = pmap_get(pt_class_t, objects, entity);
+	if (cls == NULL) {
+		cls = new_class();
+		pmap_insert(objects, entity, cls);
+	}
+	return find(cls);
+}
+
+static pt_graph_t *get_graph(ir_graph *irg)
+{
+	pt_graph_t *graph = pmap_get(pt_graph_t, graphs, irg);
+	if (graph != NULL)
+		return graph;
+
+	ir_type *mtp     = get_entity_type(get_irg_entity(irg));
+	graph            = OALLOCZ(&obst, pt_graph_t);
+	graph->n_nodes   = get_irg_last_idx(irg);
+	graph->nodes     = OALLOCNZ(&obst, pt_class_t*, graph->n_nodes);
+	graph->n_params  = get_method_n_params(mtp);
+	graph->params    = OALLOCN(&obst, pt_class_t*, graph->n_params);
+	graph->n_results = get_method_n_ress(mtp);
+	graph->results   = OALLOCN(&obst, pt_class_t*, graph->n_results);
+	for (size_t i = 0; i < graph->n_params; ++i)
+		graph->params[i] = new_class();
+	for (size_t i = 0; i < graph->n_results; ++i)
+		graph->results[i] = new_class();
+	pmap_insert(graphs, irg, graph);
+	return graph;
+}
+
+/**
+ * Returns the class of the objects a node may point to.
+ */
+static pt_class_t *get_node_class(const ir_node *node)
+{
+	pt_graph_t *graph = get_graph(get_irn_irg(node));
+	unsigned    idx   = get_irn_idx(node);
+	assert(idx < graph->n_nodes);
+	if (graph->nodes[idx] == NULL)
+		graph->nodes[idx] = new_class();
+	return find(graph->nodes[idx]);
+}
+
+static void unify_node(const ir_node *node, pt_class_t *cls)
+{
+	unify(get_node_class(node), cls);
+}
+
+static bool is_pointer(const ir_node *node)
+{
+	return mode_is_reference(get_irn_mode(node));
+}
+
+/**
+ * Returns true if a Call returns newly allocated memory.
+ */
+static bool is_malloc_call(ir_entity *callee)
+{
+	return callee != NULL
+	    && (get_entity_additional_properties(callee) & mtp_property_malloc);
+}
+
+/**
+ * Returns the graph of a callee if the analysis can follow it.
+ */
+static ir_graph *get_callee_irg(ir_entity *callee)
+{
+	if (callee == NULL || is_unknown_entity(callee))
+		return NULL;
+	return get_entity_irg(callee);
+}
+
+/**
+ * Collects the possible callees of a Call, returns false if they are not
+ * known.
+ */
+static bool get_callees(const ir_node *call, ir_entity ***callees)
+{
+	ir_node *ptr = get_Call_ptr(call);
+	if (is_SymConst_addr_ent(ptr)) {
+		ARR_APP1(ir_entity*, *callees, get_SymConst_entity(ptr));
+		return true;
+	}
+	if (get_irp_callee_info_state() != irg_callee_info_consistent
+	    || !Call_has_callees(call))
+		return false;
+	for (size_t i = 0, n = get_Call_n_callees(call); i < n; ++i) {
+		ir_entity *callee = get_Call_callee(call, i);
+		if (is_unknown_entity(callee))
+			return false;
+		ARR_APP1(ir_entity*, *callees, callee);
+	}
+	return true;
+}
+
+static void process_call(ir_node *call)
+{
+	ir_entity **callees = NEW_ARR_F(ir_entity*, 0);
+	bool        known   = get_callees(call, &callees);
+
+	for (int i = 0, n = get_Call_n_params(call); i < n; ++i) {
+		ir_node *arg = get_Call_param(call, i);
+		if (!is_pointer(arg))
+			continue;
+		pt_class_t *cls = get_node_class(arg);
+		if (!known) {
+			escape(cls);
+			continue;
+		}
+		for (size_t c = 0, n_callees = ARR_LEN(callees); c < n_callees; ++c) {
+			ir_graph *callee_irg = get_callee_irg(callees[c]);
+			if (callee_irg == NULL) {
+				if (!is_malloc_call(callees[c]))
+					escape(cls);
+				continue;
+			}
+			pt_graph_t *callee = get_graph(callee_irg);
+			if ((size_t)i < callee->n_params)
+				unify(cls, callee->params[i]);
+			else
+				escape(cls);
+		}
+	}
+	DEL_ARR_F(callees);
+}
+
+static void process_call_result(ir_node *proj, ir_node *call)
+{
+	ir_entity **callees = NEW_ARR_F(ir_entity*, 0);
+	bool        known   = get_callees(call, &callees);
+	size_t      pos     = get_Proj_proj(proj);
+
+	if (!known) {
+		unify_node(proj, unknown);
+	} else {
+		for (size_t c = 0, n_callees = ARR_LEN(callees); c < n_callees; ++c) {
+			ir_graph *callee_irg = get_callee_irg(callees[c]);
+			if (callee_irg != NULL) {
+				pt_graph_t *callee = get_graph(callee_irg);
+				unify_node(proj, pos < callee->n_results
+				                 ? callee->results[pos] : unknown);
+			} else if (is_malloc_call(callees[c])) {
+				/* the Call itself represents the allocated object */
+				unify_node(proj, get_node_class(call));
+			} else {
+				unify_node(proj, unknown);
+			}
+		}
+	}
+	DEL_ARR_F(callees);
+}
+
+static void process_proj(ir_node *proj)
+{
+	ir_node *pred = get_Proj_pred(proj);
+	if (is_arg_Proj(proj)) {
+		pt_graph_t *graph = get_graph(get_irn_irg(proj));
+		size_t      pos   = get_Proj_proj(proj);
+		unify_node(proj, pos < graph->n_params ? graph->params[pos] : unknown);
+	} else if (is_Load(pred)) {
+		unify_node(proj, get_content(get_node_class(get_Load_ptr(pred))));
+	} else if (is_Alloc(pred)) {
+		unify_node(proj, get_node_class(pred));
+	} else if (is_Proj(pred) && is_Call(get_Proj_pred(pred))) {
+		process_call_result(proj, get_Proj_pred(pred));
+	} else {
+		unify_node(proj, unknown);
+	}
+}
+
+/**
+ * Adds the constraints of a node producing a pointer.
+ */
+static void process_pointer(ir_node *node)
+{
+	switch (get_irn_opcode(node)) {
+	case iro_SymConst:
+		if (is_SymConst_addr_ent(node))
+			unify_node(node, get_object(get_SymConst_entity(node)));
+		else
+			unify_node(node, unknown);
+		return;
+	case iro_Sel: {
+		ir_entity *entity = get_Sel_entity(node);
+		ir_node   *ptr    = get_Sel_ptr(node);
+		ir_type   *type   = get_entity_type(entity);
+		if (is_method_entity(entity)) {
+			unify_node(node, unknown);
+		} else if (ptr == get_irg_frame(get_irn_irg(node))) {
+			unify_node(node, get_object(entity));
+		} else if (is_Primitive_type(type) && get_primitive_base_type(type) != NULL) {
+			/* bitfields share their storage with the neighbours */
+			unify_node(node, get_node_class(ptr));
+		} else {
+			unify_node(node, get_field(get_node_class(ptr), entity));
+		}
+		return;
+	}
+	case iro_Add:
+	case iro_Sub:
+		/* pointer arithmetic may reach every part of the object */
+		for (int i = 0, n = get_irn_arity(node); i < n; ++i) {
+			ir_node *op = get_irn_n(node, i);
+			if (!is_pointer(op))
+				continue;
+			pt_class_t *cls = get_node_class(op);
+			collapse(get_root(cls));
+			unify_node(node, cls);
+		}
+		return;
+	case iro_Phi:
+	case iro_Mux:
+	case iro_Confirm:
+	case iro_Id:
+	case iro_Conv:
+		for (int i = 0, n = get_irn_arity(node); i < n; ++i) {
+			ir_node *op = get_irn_n(node, i);
+			if (is_Confirm(node) && op != get_Confirm_value(node))
+				continue;
+			if (is_pointer(op))
+				unify_node(node, get_node_class(op));
+			else if (!is_Mux(node) || op != get_Mux_sel(node))
+				unify_node(node, unknown);
+		}
+		return;
+	case iro_Const:
+		if (!tarval_is_null(get_Const_tarval(node)))
+			unify_node(node, unknown);
+		return;
+	case iro_Proj:
+		process_proj(node);
+		return;
+	case iro_Bad:
+		return;
+	default:
+		unify_node(node, unknown);
+		return;
+	}
+}
+
+/**
+ * Adds the constraints of a node using pointers.
+ */
+static void process_uses(ir_node *node)
+{
+	switch (get_irn_opcode(node)) {
+	case iro_Load: {
+		pt_class_t *cls  = get_node_class(get_Load_ptr(node));
+		ir_mode    *mode = get_Load_mode(node);
+		mark_accessed(cls);
+		/* a pointer might be read as integer and converted back */
+		if (mode_is_int(mode)
+		    && get_mode_size_bits(mode) == get_mode_size_bits(mode_P))
+			unify(get_content(cls), unknown);
+		return;
+	}
+	case iro_Store: {
+		pt_class_t *cls = get_node_class(get_Store_ptr(node));
+		ir_node    *val = get_Store_value(node);
+		mark_accessed(cls);
+		if (is_pointer(val))
+			unify(get_content(cls), get_node_class(val));
+		return;
+	}
+	case iro_CopyB: {
+		pt_class_t *dst = get_node_class(get_CopyB_dst(node));
+		pt_class_t *src = get_node_class(get_CopyB_src(node));
+		collapse(dst);
+		collapse(src);
+		mark_accessed(dst);
+		mark_accessed(src);
+		unify(get_content(dst), get_content(src));
+		return;
+	}
+	case iro_Call:
+		process_call(node);
+		return;
+	case iro_Return: {
+		pt_graph_t *graph = get_graph(get_irn_irg(node));
+		for (size_t i = 0, n = get_Return_n_ress(node); i < n; ++i) {
+			ir_node *res = get_Return_res(node, i);
+			if (is_pointer(res) && i < graph->n_results)
+				unify(graph->results[i], get_node_class(res));
+		}
+		return;
+	}
+	case iro_Conv:
+		if (!is_pointer(node) && is_pointer(get_Conv_op(node)))
+			escape(get_node_class(get_Conv_op(node)));
+		return;
+	case iro_Sel:
+	case iro_Add:
+	case iro_Sub:
+	case iro_Phi:
+	case iro_Mux:
+	case iro_Confirm:
+	case iro_Id:
+	case iro_Cmp:
+	case iro_Free:
+	case iro_Proj:
+	case iro_End:
+	case iro_Block:
+	case iro_Anchor:
+		return;
+	default:
+		/* unknown uses, e.g. Builtins and ASMs */
+		for (int i = 0, n = get_irn_arity(node); i < n; ++i) {
+			ir_node *op = get_irn_n(node, i);
+			if (is_pointer(op))
+				escape(get_node_class(op));
+		}
+		return;
+	}
+}
+
+static void process_node(ir_node *node, void *env)
+{
+	(void)env;
+	if (is_pointer(node))
+		process_pointer(node);
+	process_uses(node);
+}
+
+/**
+ * Marks the methods whose address is used other than by calling them.
+ */
+static void find_taken_methods(ir_node *node, void *env)
+{
+	(void)env;
+	for (int i = 0, n = get_irn_arity(node); i < n; ++i) {
+		ir_node *op = get_irn_n(node, i);
+		if (!is_SymConst_addr_ent(op)
+		    || !is_method_entity(get_SymConst_entity(op)))
+			continue;
+		if (is_Call(node) && op == get_Call_ptr(node))
+			continue;
+		pset_new_insert(&taken_methods, get_SymConst_entity(op));
+	}
+}
+
+/**
+ * Adds the pointers of an initializer to the content of an object.
+ */
+static void process_initializer(pt_class_t *cls, ir_type *type,
+                                const ir_initializer_t *initializer)
+{
+	switch (get_initializer_kind(initializer)) {
+	case IR_INITIALIZER_CONST: {
+		ir_node *value = get_initializer_const_value(initializer);
+		if (is_SymConst_addr_ent(value)) {
+			ir_entity *entity = get_SymConst_entity(value);
+			if (is_method_entity(entity))
+				pset_new_insert(&taken_methods, entity);
+			unify(get_content(cls), get_object(entity));
+		} else if (mode_is_reference(get_irn_mode(value))) {
+			unify(get_content(cls), unknown);
+		}
+		return;
+	}
+	case IR_INITIALIZER_TARVAL:
+	case IR_INITIALIZER_NULL:
+		return;
+	case IR_INITIALIZER_COMPOUND:
+		for (size_t i = 0, n = get_initializer_compound_n_entries(initializer);
+		     i < n; ++i) {
+			const ir_initializer_t *sub = get_initializer_compound_value(initializer, i);
+			if (is_Array_type(type)) {
+				ir_entity *element = get_array_element_entity(type);
+				process_initializer(get_field(cls, element),
+				                    get_entity_type(element), sub);
+			} else if (is_compound_type(type) && i < get_compound_n_members(type)) {
+				ir_entity *member = get_compound_member(type, i);
+				process_initializer(get_field(cls, member),
+				                    get_entity_type(member), sub);
+			} else {
+				collapse(cls);
+				process_initializer(find(cls), type, sub);
+			}
+		}
+		return;
+	}
+	panic("invalid initializer found");
+}
+
+/**
+ * Adds the constraints for the global entities.
+ */
+static void process_globals(void)
+{
+	for (ir_segment_t s = IR_SEGMENT_FIRST; s <= IR_SEGMENT_LAST; ++s) {
+		ir_type *segment = get_segment_type(s);
+		for (size_t i = 0, n = get_compound_n_members(segment); i < n; ++i) {
+			ir_entity *entity = get_compound_member(segment, i);
+			if (is_method_entity(entity))
+				continue;
+
+			pt_class_t *cls = get_object(entity);
+			const ir_initializer_t *initializer = get_entity_initializer(entity);
+			if (initializer != NULL)
+				process_initializer(cls, get_entity_type(entity), initializer);
+			if (entity_is_externally_visible(entity))
+				escape(cls);
+		}
+	}
+}
+
+/**
+ * Adds the constraints for the parameters of a graph.
+ */
+static void process_parameters(ir_graph *irg)
+{
+	pt_graph_t *graph  = get_graph(irg);
+	ir_entity  *entity = get_irg_entity(irg);
+
+	/* parameters living on the frame hold the argument values */
+	ir_type *frame = get_irg_frame_type(irg);
+	for (size_t i = 0, n = get_compound_n_members(frame); i < n; ++i) {
+		ir_entity *member = get_compound_member(frame, i);
+		if (!is_parameter_entity(member))
+			continue;
+		size_t num = get_entity_parameter_number(member);
+		unify(get_content(get_object(member)),
+		      num < graph->n_params ? graph->params[num] : unknown);
+	}
+
+	/* unknown callers may pass and receive anything */
+	if (entity_is_externally_visible(entity)
+	    || pset_new_contains(&taken_methods, entity)) {
+		for (size_t i = 0; i < graph->n_params; ++i)
+			unify(graph->params[i], unknown);
+		for (size_t i = 0; i < graph->n_results; ++i)
+			escape(graph->results[i]);
+	}
+}
+
+void compute_irp_points_to(void)
+{
+	FIRM_DBG_REGISTER(dbg, "firm.ana.pointsto");
+
+	free_irp_points_to();
+	obstack_init(&obst);
+	graphs  = pmap_create();
+	objects = pmap_create();
+	pending = NEW_ARR_F(pt_pair_t, 0);
+	pset_new_init(&taken_methods);
+
+	unknown            = new_class();
+	unknown->content   = unknown;
+	unknown->collapsed = true;
+	unknown->accessed  = true;
+
+	for (size_t i = 0, n = get_irp_n_irgs(); i < n; ++i) {
+		ir_graph *irg = get_irp_irg(i);
+		get_graph(irg);
+		irg_walk_graph(irg, NULL, find_taken_methods, NULL);
+	}
+
+	process_globals();
+	for (size_t i = 0, n = get_irp_n_irgs(); i < n; ++i) {
+		ir_graph *irg = get_irp_irg(i);
+		process_parameters(irg);
+		irg_walk_graph(irg, NULL, process_node, NULL);
+	}
+
+	pset_new_destroy(&taken_methods);
+	n_queries  = 0;
+	n_no_alias = 0;
+	computed   = true;
+}
+
+void free_irp_points_to(void)
+{
+	if (!computed)
+		return;
+
+	DB((dbg, LEVEL_1, "points-to: %u of %u queries answered with no alias\n",
+	    n_no_alias, n_queries));
+	stat_ev_int("points_to_queries", n_queries);
+	stat_ev_int("points_to_no_alias", n_no_alias);
+
+	DEL_ARR_F(pending);
+	pmap_destroy(objects);
+	pmap_destroy(graphs);
+	obstack_free(&obst, NULL);
+	computed = false;
+}
+
+/**
+ * Returns the class of an address if it was analyzed.
+ */
+static pt_class_t *lookup_class(const ir_node *node)
+{
+	pt_graph_t *graph = pmap_get(pt_graph_t, graphs, get_irn_irg(node));
+	unsigned    idx   = get_irn_idx(node);
+	if (graph == NULL || idx >= graph->n_nodes || graph->nodes[idx] == NULL)
+		return NULL;
+	return find(graph->nodes[idx]);
+}
+
+/**
+ * Check whether the object of class inner is part of the object of class
+ * outer.
+ */
+static bool is_contained(pt_class_t *inner, const pt_class_t *outer)
+{
+	for (unsigned depth = 0; depth < MAX_OUTER_DEPTH; ++depth) {
+		if (inner == outer)
+			return true;
+		if (inner->outer == NULL)
+			return false;
+		inner = find(inner->outer);
+	}
+	return true;
+}
+
+void invalidate_points_to(ir_graph *irg)
+{
+	if (!computed)
+		return;
+	pt_graph_t *graph = pmap_get(pt_graph_t, graphs, irg);
+	if (graph != NULL)
+		graph->n_nodes = 0;
+}
+
+bool points_to_computed(void)
+{
+	return computed;
+}
+
+ir_alias_relation get_points_to_relation(const ir_node *adr1,
+                                         const ir_node *adr2)
+{
+	assert(computed);
+	++n_queries;
+
+	pt_class_t *cls1 = lookup_class(adr1);
+	pt_class_t *cls2 = lookup_class(adr2);
+	if (cls1 == NULL || cls2 == NULL
+	    || is_contained(cls1, cls2) || is_contained(cls2, cls1))
+		return ir_may_alias;
+
+	++n_no_alias;
+	return ir_no_alias;
+}
+
+ir_prog_pass_t *compute_irp_points_to_pass(const char *name)
+{
+	return def_prog_pass(name ? name : "points_to", compute_irp_points_to);
+}
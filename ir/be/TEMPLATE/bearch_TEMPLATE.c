@@ -68,6 +68,7 @@ static const arch_irn_ops_t TEMPLATE_irn_ops = {
 	NULL,    /* get_op_estimated_cost   */
 	NULL,    /* possible_memory_operand */
 	NULL,    /* perform_memory_operand  */
+	NULL,    /* get_sched_insn          */
 };
 
 
@@ -122,6 +123,7 @@ static TEMPLATE_isa_t TEMPLATE_isa_template = {
 		7,                           /* costs for a spill instruction */
 		5,                           /* costs for a reload instruction */
 		true,                        /* custom abi handling */
+		NULL,                        /* no machine model */
 	},
 };
 
@@ -260,7 +262,8 @@ static const backend_params *TEMPLATE_get_backend_params(void)
 		0,     /* no trampoline support: size 0 */
 		0,     /* no trampoline support: align 0 */
 		NULL,  /* no trampoline support: no trampoline builder */
-		4      /* alignment of stack parameter: typically 4 (32bit) or 8 (64bit) */
+		4,     /* alignment of stack parameter: typically 4 (32bit) or 8 (64bit) */
+		0      /* loop unroll factor: let the optimization choose */
 	};
 	return &p;
 }
@@ -327,6 +330,7 @@ const arch_isa_if_t TEMPLATE_isa_if = {
 	TEMPLATE_init_graph,
 	TEMPLATE_get_call_abi,
 	NULL, /* mark remat */
+	NULL, /* get remat cost */
 	NULL, /* get_pic_base */
 	be_new_spill,
 	be_new_reload,
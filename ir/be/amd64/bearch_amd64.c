@@ -15,6 +15,7 @@
 #include "lower_calls.h"
 #include "debug.h"
 #include "error.h"
+#include "util.h"
 #include "be_t.h"
 #include "bearch.h"
 #include "beirg.h"
@@ -96,6 +97,7 @@ static const arch_irn_ops_t amd64_irn_ops = {
 	NULL,    /* get_op_estimated_cost   */
 	NULL,    /* possible_memory_operand */
 	NULL,    /* perform_memory_operand  */
+	NULL,    /* get_sched_insn          */
 };
 
 
@@ -224,6 +226,7 @@ static amd64_isa_t amd64_isa_template = {
 		7,                         /* costs for a spill instruction */
 		5,                         /* costs for a reload instruction */
 		false,                     /* no custom abi handling */
+		NULL,                      /* no machine model */
 	},
 };
 
@@ -295,6 +298,11 @@ static const arch_register_t *gpreg_param_reg_std[] = {
 	&amd64_registers[REG_R9],
 };
 
+static const arch_register_t *gpreg_result_reg_std[] = {
+	&amd64_registers[REG_RAX],
+	&amd64_registers[REG_RDX],
+};
+
 static const arch_register_t *amd64_get_RegParam_reg(int n)
 {
 	assert(n < 6 && n >=0 && "register param > 6 requested");
@@ -335,24 +343,149 @@ static void amd64_get_call_abi(ir_type *method_type, be_abi_call_t *abi)
 		}
 	}
 
-	/* TODO: set correct return register */
-	/* default: return value is in R0 resp. F0 */
-	if (get_method_n_ress(method_type) > 0) {
-		tp   = get_method_res_type(method_type, 0);
+	/* compounds returned in two values use RAX and RDX */
+	n = get_method_n_ress(method_type);
+	for (i = 0; i < n && i < (int)ARRAY_SIZE(gpreg_result_reg_std); ++i) {
+		tp   = get_method_res_type(method_type, i);
 		mode = get_type_mode(tp);
 
 		if (mode_is_float(mode))
 			panic("float not supported yet");
 
-		be_abi_call_res_reg(abi, 0,
-			&amd64_registers[REG_RAX], ABI_CONTEXT_BOTH);
+		be_abi_call_res_reg(abi, i, gpreg_result_reg_std[i], ABI_CONTEXT_BOTH);
+	}
+}
+
+/**
+ * The classes of the eightbytes of a compound in the System V AMD64 ABI.
+ */
+typedef enum amd64_class_t {
+	AMD64_CLASS_NO,
+	AMD64_CLASS_INTEGER,
+	AMD64_CLASS_SSE,
+	AMD64_CLASS_MEMORY,
+} amd64_class_t;
+
+static amd64_class_t amd64_merge_classes(amd64_class_t c1, amd64_class_t c2)
+{
+	if (c1 == c2 || c2 == AMD64_CLASS_NO)
+		return c1;
+	if (c1 == AMD64_CLASS_NO)
+		return c2;
+	if (c1 == AMD64_CLASS_MEMORY || c2 == AMD64_CLASS_MEMORY)
+		return AMD64_CLASS_MEMORY;
+	return AMD64_CLASS_INTEGER;
+}
+
+/**
+ * Merges the classes of the fields of a type at the given offset into the
+ * classes of the eightbytes.
+ */
+static void amd64_classify_type(ir_type *type, unsigned offset,
+                                amd64_class_t *classes)
+{
+	if (is_compound_type(type)) {
+		size_t n_members = get_compound_n_members(type);
+		for (size_t i = 0; i < n_members; ++i) {
+			ir_entity *member = get_compound_member(type, i);
+			amd64_classify_type(get_entity_type(member),
+			                    offset + get_entity_offset(member), classes);
+		}
+	} else if (is_Array_type(type)) {
+		ir_type  *elem_type = get_array_element_type(type);
+		unsigned  elem_size = get_type_size_bytes(elem_type);
+		unsigned  size      = get_type_size_bytes(type);
+		for (unsigned o = 0; elem_size > 0 && o < size; o += elem_size) {
+			amd64_classify_type(elem_type, offset + o, classes);
+		}
+	} else {
+		ir_mode       *mode  = get_type_mode(type);
+		unsigned       size  = get_type_size_bytes(type);
+		unsigned       align = get_type_alignment_bytes(type);
+		amd64_class_t  cls   = mode != NULL && mode_is_float(mode)
+		                       ? AMD64_CLASS_SSE : AMD64_CLASS_INTEGER;
+
+		/* unaligned fields and fields crossing an eightbyte are passed in
+		 * memory */
+		if ((align > 0 && offset % align != 0) || offset % 8 + size > 8)
+			cls = AMD64_CLASS_MEMORY;
+		classes[offset / 8] = amd64_merge_classes(classes[offset / 8], cls);
+	}
+}
+
+/**
+ * Determines the values a compound is passed or returned in. Compounds
+ * containing floating point fields are passed in memory, because the
+ * backend has no support for SSE registers yet.
+ */
+static aggregate_spec_t amd64_classify_compound(ir_type *type)
+{
+	amd64_class_t    classes[MAX_AGGREGATE_PIECES];
+	aggregate_spec_t spec;
+	unsigned         size = get_type_size_bytes(type);
+	unsigned         n    = (size + 7) / 8;
+
+	spec.length = 0;
+	if (n == 0 || n > MAX_AGGREGATE_PIECES)
+		return spec;
+
+	for (unsigned i = 0; i < n; ++i)
+		classes[i] = AMD64_CLASS_NO;
+	amd64_classify_type(type, 0, classes);
+
+	for (unsigned i = 0; i < n; ++i) {
+		unsigned rest = size - i * 8;
+		if (classes[i] != AMD64_CLASS_INTEGER) {
+			spec.length = 0;
+			return spec;
+		}
+		spec.modes[i] = rest > 4 ? mode_Lu : rest > 2 ? mode_Iu
+		              : rest > 1 ? mode_Hu : mode_Bu;
+		spec.length   = i + 1;
 	}
+	return spec;
+}
+
+static aggregate_spec_t amd64_lower_parameter(void *env, ir_type *type)
+{
+	unsigned         *n_used = (unsigned*)env;
+	aggregate_spec_t  spec;
+
+	spec.length = 0;
+	if (is_compound_type(type) || is_Array_type(type)) {
+		spec = amd64_classify_compound(type);
+		/* compounds are only passed in registers as a whole */
+		if (*n_used + spec.length > ARRAY_SIZE(gpreg_param_reg_std))
+			spec.length = 0;
+	}
+	*n_used += spec.length > 0 ? spec.length : 1;
+	return spec;
+}
+
+static aggregate_spec_t amd64_lower_return(void *env, ir_type *type)
+{
+	(void) env;
+	return amd64_classify_compound(type);
+}
+
+static void amd64_reset_call_state(void *env)
+{
+	unsigned *n_used = (unsigned*)env;
+	*n_used = 0;
 }
 
 static void amd64_lower_for_target(void)
 {
-	/* lower compound param handling */
-	lower_calls_with_compounds(LF_RETURN_HIDDEN);
+	/* lower compound param handling, small compounds are passed in
+	 * registers */
+	unsigned         n_used = 0;
+	lower_call_abi_t abi    = {
+		amd64_lower_parameter,
+		amd64_lower_return,
+		amd64_reset_call_state,
+		&n_used,
+	};
+	lower_calls_with_compounds_abi(LF_RETURN_HIDDEN, &abi);
 
 	size_t n_irgs = get_irp_n_irgs();
 	for (size_t i = 0; i < n_irgs; ++i) {
@@ -398,7 +531,8 @@ static const backend_params *amd64_get_backend_params(void) {
 		0,     /* no trampoline support: size 0 */
 		0,     /* no trampoline support: align 0 */
 		NULL,  /* no trampoline support: no trampoline builder */
-		8      /* alignment of stack parameter: typically 4 (32bit) or 8 (64bit) */
+		8,     /* alignment of stack parameter: typically 4 (32bit) or 8 (64bit) */
+		4      /* loop unroll factor */
 	};
 	return &p;
 }
@@ -448,6 +582,7 @@ const arch_isa_if_t amd64_isa_if = {
 	NULL,
 	amd64_get_call_abi,
 	NULL,              /* mark remat */
+	NULL,              /* get remat cost */
 	NULL,              /* get_pic_base */
 	be_new_spill,
 	be_new_reload,
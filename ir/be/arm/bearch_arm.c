@@ -98,6 +98,7 @@ static const arch_irn_ops_t arm_irn_ops = {
 	NULL,    /* get_op_estimated_cost   */
 	NULL,    /* possible_memory_operand */
 	NULL,    /* perform_memory_operand  */
+	NULL,    /* get_sched_insn          */
 };
 
 /**
@@ -381,6 +382,7 @@ static arm_isa_t arm_isa_template = {
 		7,                       /* spill costs */
 		5,                       /* reload costs */
 		true,                    /* we do have custom abi handling */
+		NULL,                    /* no machine model */
 	},
 	ARM_FPU_ARCH_FPE,          /* FPU architecture */
 };
@@ -485,7 +487,8 @@ static const backend_params *arm_get_libfirm_params(void)
 		0,     /* no trampoline support: size 0 */
 		0,     /* no trampoline support: align 0 */
 		NULL,  /* no trampoline support: no trampoline builder */
-		4      /* alignment of stack parameter */
+		4,     /* alignment of stack parameter */
+		2      /* loop unroll factor */
 	};
 
 	return &p;
@@ -523,6 +526,7 @@ const arch_isa_if_t arm_isa_if = {
 	NULL,
 	NULL,  /* get call abi */
 	NULL,  /* mark remat */
+	NULL,  /* get remat cost */
 	NULL,  /* get_pic_base */
 	be_new_spill,
 	be_new_reload,
@@ -53,6 +53,7 @@ struct be_options_t {
 	char ilp_server[128];      /**< the ilp server name */
 	char ilp_solver[128];      /**< the ilp solver name */
 	int  verbose_asm;          /**< dump verbose assembler */
+	char cache_dir[256];       /**< directory of the compile cache */
 };
 extern be_options_t be_options;
 
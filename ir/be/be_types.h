@@ -21,6 +21,8 @@ typedef struct arch_register_t           arch_register_t;
 typedef struct arch_flag_t               arch_flag_t;
 typedef struct arch_isa_if_t             arch_isa_if_t;
 typedef struct arch_env_t                arch_env_t;
+typedef struct arch_machine_t            arch_machine_t;
+typedef struct arch_sched_insn_t         arch_sched_insn_t;
 
 /**
  * Some flags describing a node in more detail.
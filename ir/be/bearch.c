@@ -84,6 +84,17 @@ int arch_get_op_estimated_cost(const ir_node *irn)
 	}
 }
 
+void arch_get_sched_insn(const ir_node *irn, arch_sched_insn_t *insn)
+{
+	const arch_irn_ops_t *ops = get_irn_ops(irn);
+
+	insn->latency     = 1;
+	insn->rthroughput = 1;
+	insn->ports       = ~0u;
+	if (ops->get_sched_insn)
+		ops->get_sched_insn(irn, insn);
+}
+
 static reg_out_info_t *get_out_info_n(const ir_node *node, unsigned pos)
 {
 	const backend_info_t *info = be_get_info(node);
@@ -87,6 +87,8 @@ ir_entity *arch_get_frame_entity(const ir_node *irn);
 int        arch_get_sp_bias(ir_node *irn);
 
 int             arch_get_op_estimated_cost(const ir_node *irn);
+void            arch_get_sched_insn(const ir_node *irn,
+                                    arch_sched_insn_t *insn);
 int             arch_possible_memory_operand(const ir_node *irn,
                                              unsigned int i);
 void            arch_perform_memory_operand(ir_node *irn, ir_node *spill,
@@ -368,6 +370,35 @@ struct arch_irn_ops_t {
 	 */
 	void (*perform_memory_operand)(ir_node *irn, ir_node *spill,
 	                               unsigned int i);
+
+	/**
+	 * Describe latency, throughput and execution ports of @p irn according
+	 * to the machine model of the arch_env. May be NULL if the backend has
+	 * no machine model.
+	 *
+	 * @param irn   The node.
+	 * @param insn  Filled with the description, initialized with a single
+	 *              cycle on any port.
+	 */
+	void (*get_sched_insn)(const ir_node *irn, arch_sched_insn_t *insn);
+};
+
+/**
+ * Machine model of the targeted microarchitecture used by the schedulers.
+ */
+struct arch_machine_t {
+	const char *name;        /**< name of the modeled CPU family */
+	unsigned    issue_width; /**< instructions issued per cycle */
+	unsigned    n_ports;     /**< number of execution ports */
+};
+
+/**
+ * Describes how an instruction uses the machine.
+ */
+struct arch_sched_insn_t {
+	unsigned latency;     /**< cycles until the results are available */
+	unsigned rthroughput; /**< reciprocal throughput: cycles the port is busy */
+	unsigned ports;       /**< bitset of the ports able to execute it */
 };
 
 /**
@@ -431,6 +462,14 @@ struct arch_isa_if_t {
 	 */
 	void (*mark_remat)(ir_node *node);
 
+	/**
+	 * Returns the costs of recomputing @p node in front of @p before instead
+	 * of reloading it, or a negative value if that is not possible. Only the
+	 * node itself is judged, the spiller checks that its operands are still
+	 * available. May be NULL, be_get_default_remat_cost() is used then.
+	 */
+	int (*get_remat_cost)(const ir_node *node, const ir_node *before);
+
 	/**
 	 * return node used as base in pic code addresses
 	 */
@@ -524,6 +563,8 @@ struct arch_env_t {
 	bool                   custom_abi : 1;   /**< backend does all abi handling
 	                                              and does not need the generic
 	                                              stuff from beabi.h/.c */
+	const arch_machine_t  *machine;          /**< machine model for the
+	                                              schedulers, may be NULL */
 };
 
 static inline bool arch_irn_is_ignore(const ir_node *irn)
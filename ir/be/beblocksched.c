@@ -18,6 +18,14 @@
  * to change as many edges to fallthroughs as possible, this is done by setting
  * a next and prev pointers on blocks. The greedy algorithm sorts the edges by
  * execution frequencies and tries to transform them to fallthroughs in this order
+ *
+ * The ext-TSP algorithm merges chains of blocks as long as this improves the
+ * extended TSP score, which rewards fallthroughs and to a lesser degree short
+ * jumps, following Newell and Pupyrev, "Improved Basic Block Reordering".
+ *
+ * Independent of the algorithm blocks executed rarely compared to the start
+ * block can be moved behind all other blocks, the emitter may put them into
+ * a separate section then.
  */
 #include "beblocksched.h"
 
@@ -34,9 +42,11 @@
 #include "execfreq.h"
 #include "irdump_t.h"
 #include "irtools.h"
+#include "util.h"
 #include "debug.h"
 #include "beirgmod.h"
 #include "bemodule.h"
+#include "besched.h"
 #include "be.h"
 #include "error.h"
 
@@ -49,14 +59,16 @@
 DEBUG_ONLY(static firm_dbg_module_t *dbg = NULL;)
 
 typedef enum blocksched_algos_t {
-	BLOCKSCHED_NAIV, BLOCKSCHED_GREEDY, BLOCKSCHED_ILP
+	BLOCKSCHED_NAIV, BLOCKSCHED_GREEDY, BLOCKSCHED_EXTTSP, BLOCKSCHED_ILP
 } blocksched_algos_t;
 
-static int algo = BLOCKSCHED_GREEDY;
+static int    algo           = BLOCKSCHED_GREEDY;
+static double cold_threshold = 0.0;
 
 static const lc_opt_enum_int_items_t blockschedalgo_items[] = {
 	{ "naiv",   BLOCKSCHED_NAIV },
 	{ "greedy", BLOCKSCHED_GREEDY },
+	{ "exttsp", BLOCKSCHED_EXTTSP },
 	{ "ilp",    BLOCKSCHED_ILP },
 	{ NULL,     0 }
 };
@@ -67,6 +79,7 @@ static lc_opt_enum_int_var_t algo_var = {
 
 static const lc_opt_table_entry_t be_blocksched_options[] = {
 	LC_OPT_ENT_ENUM_INT ("blockscheduler", "the block scheduling algorithm", &algo_var),
+	LC_OPT_ENT_DBL      ("coldblocks", "move blocks executed less often than this fraction of the start block to the cold part (0 disables)", &cold_threshold),
 	LC_OPT_LAST
 };
 
@@ -531,6 +544,572 @@ static ir_node **create_block_schedule_greedy(ir_graph *irg)
 	return block_list;
 }
 
+/*
+ *  _____        _           _____  ____   ____
+ * | ____|__  __| |_  _____ |_   _|/ ___| |  _ \
+ * |  _|  \ \/ /| __||_____|  | |  \___ \ | |_) |
+ * | |___  >  < | |_          | |   ___) ||  __/
+ * |_____|/_/\_\ \__|         |_|  |____/ |_|
+ */
+
+/** Jumps up to this distance (in bytes) forward still earn a score. */
+#define EXTTSP_FORWARD_DISTANCE   1024
+/** Jumps up to this distance (in bytes) backward still earn a score. */
+#define EXTTSP_BACKWARD_DISTANCE  640
+/** Weight of a short jump compared to a fallthrough. */
+#define EXTTSP_JUMP_WEIGHT        0.1
+/** Chains longer than this are not split when merging. */
+#define EXTTSP_MAX_SPLIT_LENGTH   32
+/** Functions with more blocks use the greedy algorithm. */
+#define EXTTSP_MAX_BLOCKS         2048
+/** Estimated size of a scheduled node in bytes. */
+#define EXTTSP_NODE_SIZE          4
+
+typedef struct exttsp_edge_t {
+	unsigned src;  /**< index of the source block */
+	unsigned dst;  /**< index of the destination block */
+	double   freq; /**< estimated execution frequency of the edge */
+} exttsp_edge_t;
+
+typedef struct exttsp_block_t {
+	ir_node  *block;
+	unsigned  size;      /**< estimated code size in bytes */
+	unsigned  chain;     /**< index of the chain containing the block */
+	unsigned  addr;      /**< address while a chain is scored */
+	unsigned  stamp;     /**< addr is valid if this equals the env stamp */
+	unsigned *out_edges; /**< indices of the edges leaving the block */
+} exttsp_block_t;
+
+typedef struct exttsp_chain_t {
+	unsigned *blocks; /**< block indices in layout order */
+	unsigned *pairs;  /**< indices of the pairs with connected chains */
+	double    score;  /**< ext-TSP score of the chain on its own */
+	double    freq;   /**< summed execution frequency of the blocks */
+	unsigned  size;   /**< summed size of the blocks */
+	bool      alive;  /**< false once merged into another chain */
+} exttsp_chain_t;
+
+/** The kinds of merges of chain x with chain y, x = x1 x2 if split. */
+typedef enum exttsp_merge_t {
+	EXTTSP_X_Y,
+	EXTTSP_Y_X,
+	EXTTSP_X1_Y_X2,
+	EXTTSP_Y_X2_X1,
+	EXTTSP_X2_X1_Y,
+	EXTTSP_X2_Y_X1,
+	EXTTSP_MERGE_LAST = EXTTSP_X2_Y_X1
+} exttsp_merge_t;
+
+typedef struct exttsp_candidate_t {
+	unsigned       x;
+	unsigned       y;
+	exttsp_merge_t kind;
+	size_t         split;
+	double         gain;
+} exttsp_candidate_t;
+
+/** Two chains connected by an edge and their best merge. */
+typedef struct exttsp_pair_t {
+	unsigned           c1;
+	unsigned           c2;
+	exttsp_candidate_t best;  /**< the best merge of the two chains */
+	bool               valid; /**< false if best has to be recomputed */
+	bool               alive; /**< false once the chains were merged */
+} exttsp_pair_t;
+
+typedef struct exttsp_env_t {
+	ir_graph       *irg;
+	exttsp_block_t *blocks;
+	exttsp_edge_t  *edges;
+	exttsp_chain_t *chains;
+	exttsp_pair_t  *pairs;
+	unsigned       *merged; /**< scratch array for candidate layouts */
+	unsigned        stamp;
+} exttsp_env_t;
+
+static double exttsp_edge_score(unsigned src_addr, unsigned src_size,
+                                unsigned dst_addr, double freq)
+{
+	unsigned src_end = src_addr + src_size;
+	if (dst_addr == src_end)
+		return freq;
+	if (dst_addr > src_end) {
+		unsigned dist = dst_addr - src_end;
+		if (dist <= EXTTSP_FORWARD_DISTANCE)
+			return freq * EXTTSP_JUMP_WEIGHT
+			     * (1.0 - (double)dist / EXTTSP_FORWARD_DISTANCE);
+	} else {
+		unsigned dist = src_end - dst_addr;
+		if (dist <= EXTTSP_BACKWARD_DISTANCE)
+			return freq * EXTTSP_JUMP_WEIGHT
+			     * (1.0 - (double)dist / EXTTSP_BACKWARD_DISTANCE);
+	}
+	return 0.0;
+}
+
+/**
+ * Computes the ext-TSP score of the edges inside a sequence of blocks.
+ */
+static double exttsp_score(exttsp_env_t *env, const unsigned *seq, size_t n)
+{
+	unsigned stamp = ++env->stamp;
+	unsigned addr  = 0;
+	for (size_t i = 0; i < n; ++i) {
+		exttsp_block_t *block = &env->blocks[seq[i]];
+		block->addr  = addr;
+		block->stamp = stamp;
+		addr        += block->size;
+	}
+
+	double score = 0.0;
+	for (size_t i = 0; i < n; ++i) {
+		const exttsp_block_t *src = &env->blocks[seq[i]];
+		for (size_t e = 0, n_edges = ARR_LEN(src->out_edges); e < n_edges; ++e) {
+			const exttsp_edge_t  *edge = &env->edges[src->out_edges[e]];
+			const exttsp_block_t *dst  = &env->blocks[edge->dst];
+			if (dst->stamp != stamp)
+				continue;
+			score += exttsp_edge_score(src->addr, src->size, dst->addr,
+			                           edge->freq);
+		}
+	}
+	return score;
+}
+
+static size_t exttsp_append(unsigned *dst, size_t n, const unsigned *src,
+                            size_t from, size_t to)
+{
+	for (size_t i = from; i < to; ++i)
+		dst[n++] = src[i];
+	return n;
+}
+
+/**
+ * Writes the layout produced by merging chain y into chain x into
+ * env->merged. Returns false if the start block would not come first.
+ */
+static bool exttsp_build_merge(exttsp_env_t *env, const exttsp_chain_t *x,
+                               const exttsp_chain_t *y, exttsp_merge_t kind,
+                               size_t split)
+{
+	unsigned *m   = env->merged;
+	size_t    n_x = ARR_LEN(x->blocks);
+	size_t    n_y = ARR_LEN(y->blocks);
+	size_t    n   = 0;
+
+	switch (kind) {
+	case EXTTSP_X_Y:
+		n = exttsp_append(m, n, x->blocks, 0, n_x);
+		n = exttsp_append(m, n, y->blocks, 0, n_y);
+		break;
+	case EXTTSP_Y_X:
+		n = exttsp_append(m, n, y->blocks, 0, n_y);
+		n = exttsp_append(m, n, x->blocks, 0, n_x);
+		break;
+	case EXTTSP_X1_Y_X2:
+		n = exttsp_append(m, n, x->blocks, 0, split);
+		n = exttsp_append(m, n, y->blocks, 0, n_y);
+		n = exttsp_append(m, n, x->blocks, split, n_x);
+		break;
+	case EXTTSP_Y_X2_X1:
+		n = exttsp_append(m, n, y->blocks, 0, n_y);
+		n = exttsp_append(m, n, x->blocks, split, n_x);
+		n = exttsp_append(m, n, x->blocks, 0, split);
+		break;
+	case EXTTSP_X2_X1_Y:
+		n = exttsp_append(m, n, x->blocks, split, n_x);
+		n = exttsp_append(m, n, x->blocks, 0, split);
+		n = exttsp_append(m, n, y->blocks, 0, n_y);
+		break;
+	case EXTTSP_X2_Y_X1:
+		n = exttsp_append(m, n, x->blocks, split, n_x);
+		n = exttsp_append(m, n, y->blocks, 0, n_y);
+		n = exttsp_append(m, n, x->blocks, 0, split);
+		break;
+	}
+	assert(n == n_x + n_y);
+
+	/* the start block has to stay in front */
+	ir_node *start = get_irg_start_block(env->irg);
+	if (env->blocks[x->blocks[0]].block == start
+	    || env->blocks[y->blocks[0]].block == start)
+		return env->blocks[m[0]].block == start;
+	return true;
+}
+
+/**
+ * Evaluates all merges of chain y into chain x and remembers the best one in
+ * best if it beats the gain found so far.
+ */
+static void exttsp_evaluate(exttsp_env_t *env, unsigned x_idx, unsigned y_idx,
+                            exttsp_candidate_t *best)
+{
+	const exttsp_chain_t *x     = &env->chains[x_idx];
+	const exttsp_chain_t *y     = &env->chains[y_idx];
+	size_t                n_x   = ARR_LEN(x->blocks);
+	size_t                n     = n_x + ARR_LEN(y->blocks);
+	double                base  = x->score + y->score;
+	size_t                max_s = n_x <= EXTTSP_MAX_SPLIT_LENGTH ? n_x : 1;
+
+	for (exttsp_merge_t kind = EXTTSP_X_Y; kind <= EXTTSP_MERGE_LAST; ++kind) {
+		bool   splits = kind >= EXTTSP_X1_Y_X2;
+		size_t s      = splits ? 1 : 0;
+		size_t s_end  = splits ? max_s : 1;
+		for (; s < s_end; ++s) {
+			if (!exttsp_build_merge(env, x, y, kind, s))
+				continue;
+			double gain = exttsp_score(env, env->merged, n) - base;
+			if (gain > best->gain) {
+				best->x     = x_idx;
+				best->y     = y_idx;
+				best->kind  = kind;
+				best->split = s;
+				best->gain  = gain;
+			}
+		}
+	}
+}
+
+static void exttsp_collect_block(exttsp_env_t *env, ir_node *block)
+{
+	exttsp_block_t entry;
+	unsigned       n_nodes = 0;
+	sched_foreach(block, node) {
+		++n_nodes;
+	}
+	entry.block     = block;
+	entry.size      = (n_nodes + 1) * EXTTSP_NODE_SIZE;
+	entry.chain     = ARR_LEN(env->blocks);
+	entry.addr      = 0;
+	entry.stamp     = 0;
+	entry.out_edges = NEW_ARR_F(unsigned, 0);
+	set_irn_link(block, INT_TO_PTR(ARR_LEN(env->blocks)));
+	ARR_APP1(exttsp_block_t, env->blocks, entry);
+}
+
+/**
+ * Collects the blocks reachable from block in depth first order.
+ */
+static void exttsp_collect_blocks(exttsp_env_t *env, ir_node *block)
+{
+	if (irn_visited_else_mark(block))
+		return;
+	exttsp_collect_block(env, block);
+	foreach_block_succ(block, edge) {
+		exttsp_collect_blocks(env, get_edge_src_irn(edge));
+	}
+}
+
+/**
+ * Estimates the execution frequency of the control flow edge from pred to
+ * block. Without critical edges one of the two blocks determines it.
+ */
+static double exttsp_edge_freq(ir_node *pred, ir_node *block)
+{
+	double freq = get_block_execfreq(block);
+	if (get_Block_n_cfgpreds(block) == 1)
+		return freq;
+
+	double pred_freq = get_block_execfreq(pred);
+	int    n_succs   = get_irn_n_edges_kind(pred, EDGE_KIND_BLOCK);
+	if (n_succs > 1)
+		pred_freq /= n_succs;
+	return pred_freq < freq ? pred_freq : freq;
+}
+
+static void exttsp_collect_edges(exttsp_env_t *env)
+{
+	for (size_t i = 0, n = ARR_LEN(env->blocks); i < n; ++i) {
+		ir_node *block = env->blocks[i].block;
+		for (int p = 0, arity = get_Block_n_cfgpreds(block); p < arity; ++p) {
+			ir_node *pred = get_Block_cfgpred_block(block, p);
+			if (pred == NULL || !irn_visited(pred))
+				continue;
+
+			exttsp_edge_t edge;
+			edge.src  = PTR_TO_INT(get_irn_link(pred));
+			edge.dst  = i;
+			edge.freq = exttsp_edge_freq(pred, block);
+			ARR_APP1(unsigned, env->blocks[edge.src].out_edges,
+			         ARR_LEN(env->edges));
+			ARR_APP1(exttsp_edge_t, env->edges, edge);
+		}
+	}
+}
+
+static void exttsp_merge(exttsp_env_t *env, const exttsp_candidate_t *cand)
+{
+	exttsp_chain_t *x = &env->chains[cand->x];
+	exttsp_chain_t *y = &env->chains[cand->y];
+	size_t          n = ARR_LEN(x->blocks) + ARR_LEN(y->blocks);
+
+	DB((dbg, LEVEL_1, "Merge chain of %+F with chain of %+F (gain %.3g)\n",
+	    env->blocks[x->blocks[0]].block, env->blocks[y->blocks[0]].block,
+	    cand->gain));
+
+	exttsp_build_merge(env, x, y, cand->kind, cand->split);
+	ARR_RESIZE(unsigned, x->blocks, n);
+	memcpy(x->blocks, env->merged, n * sizeof(*x->blocks));
+	for (size_t i = 0, n_y = ARR_LEN(y->blocks); i < n_y; ++i)
+		env->blocks[y->blocks[i]].chain = cand->x;
+
+	x->score += y->score + cand->gain;
+	x->freq  += y->freq;
+	x->size  += y->size;
+	y->alive  = false;
+	DEL_ARR_F(y->blocks);
+	y->blocks = NULL;
+}
+
+static unsigned exttsp_pair_other(const exttsp_pair_t *pair, unsigned chain)
+{
+	return pair->c1 == chain ? pair->c2 : pair->c1;
+}
+
+/**
+ * Returns the index of the pair of chains a and b or -1 if there is none.
+ */
+static unsigned exttsp_find_pair(const exttsp_env_t *env, unsigned a,
+                                 unsigned b)
+{
+	const unsigned *pairs = env->chains[a].pairs;
+	for (size_t i = 0, n = ARR_LEN(pairs); i < n; ++i) {
+		const exttsp_pair_t *pair = &env->pairs[pairs[i]];
+		if (pair->alive && exttsp_pair_other(pair, a) == b)
+			return pairs[i];
+	}
+	return (unsigned)-1;
+}
+
+static void exttsp_add_pair(exttsp_env_t *env, unsigned a, unsigned b)
+{
+	if (a == b || exttsp_find_pair(env, a, b) != (unsigned)-1)
+		return;
+
+	exttsp_pair_t pair;
+	memset(&pair, 0, sizeof(pair));
+	pair.c1    = a;
+	pair.c2    = b;
+	pair.valid = false;
+	pair.alive = true;
+	ARR_APP1(unsigned, env->chains[a].pairs, ARR_LEN(env->pairs));
+	ARR_APP1(unsigned, env->chains[b].pairs, ARR_LEN(env->pairs));
+	ARR_APP1(exttsp_pair_t, env->pairs, pair);
+}
+
+/**
+ * Moves the pairs of chain y, which was merged into chain x, over to x and
+ * invalidates the cached merges of all pairs of x.
+ */
+static void exttsp_update_pairs(exttsp_env_t *env, unsigned x, unsigned y)
+{
+	exttsp_chain_t *chain_x = &env->chains[x];
+	exttsp_chain_t *chain_y = &env->chains[y];
+
+	for (size_t i = 0, n = ARR_LEN(chain_y->pairs); i < n; ++i) {
+		exttsp_pair_t *pair  = &env->pairs[chain_y->pairs[i]];
+		unsigned       other = exttsp_pair_other(pair, y);
+		if (!pair->alive)
+			continue;
+		if (other == x || exttsp_find_pair(env, x, other) != (unsigned)-1) {
+			pair->alive = false;
+			continue;
+		}
+		if (pair->c1 == y) {
+			pair->c1 = x;
+		} else {
+			pair->c2 = x;
+		}
+		ARR_APP1(unsigned, chain_x->pairs, chain_y->pairs[i]);
+	}
+	DEL_ARR_F(chain_y->pairs);
+	chain_y->pairs = NULL;
+
+	/* drop the dead pairs and rescore the others */
+	size_t n_alive = 0;
+	for (size_t i = 0, n = ARR_LEN(chain_x->pairs); i < n; ++i) {
+		exttsp_pair_t *pair = &env->pairs[chain_x->pairs[i]];
+		if (!pair->alive)
+			continue;
+		pair->valid = false;
+		chain_x->pairs[n_alive++] = chain_x->pairs[i];
+	}
+	ARR_SHRINKLEN(chain_x->pairs, n_alive);
+}
+
+/**
+ * Merges chains greedily by the best gain. The best merge of each pair of
+ * connected chains is cached and only recomputed when one of its chains
+ * changed.
+ */
+static void exttsp_merge_chains(exttsp_env_t *env)
+{
+	for (size_t i = 0, n = ARR_LEN(env->edges); i < n; ++i) {
+		const exttsp_edge_t *edge = &env->edges[i];
+		exttsp_add_pair(env, env->blocks[edge->src].chain,
+		                env->blocks[edge->dst].chain);
+	}
+
+	for (;;) {
+		exttsp_pair_t *best = NULL;
+
+		for (size_t i = 0, n = ARR_LEN(env->pairs); i < n; ++i) {
+			exttsp_pair_t *pair = &env->pairs[i];
+			if (!pair->alive)
+				continue;
+			if (!pair->valid) {
+				memset(&pair->best, 0, sizeof(pair->best));
+				pair->best.gain = 1e-9;
+				exttsp_evaluate(env, pair->c1, pair->c2, &pair->best);
+				exttsp_evaluate(env, pair->c2, pair->c1, &pair->best);
+				pair->valid = true;
+			}
+			if (pair->best.gain > 1e-9
+			    && (best == NULL || pair->best.gain > best->best.gain))
+				best = pair;
+		}
+
+		if (best == NULL)
+			break;
+		exttsp_candidate_t cand = best->best;
+		exttsp_merge(env, &cand);
+		exttsp_update_pairs(env, cand.x, cand.y);
+	}
+}
+
+static int cmp_exttsp_chains(const void *d1, const void *d2)
+{
+	const exttsp_chain_t *c1 = *(const exttsp_chain_t *const*)d1;
+	const exttsp_chain_t *c2 = *(const exttsp_chain_t *const*)d2;
+	double dens1 = c1->freq / c1->size;
+	double dens2 = c2->freq / c2->size;
+	if (dens1 < dens2) {
+		return 1;
+	} else if (dens1 > dens2) {
+		return -1;
+	}
+	return c1 < c2 ? -1 : c1 > c2;
+}
+
+static ir_node **create_block_schedule_exttsp(ir_graph *irg)
+{
+	exttsp_env_t env;
+	env.irg    = irg;
+	env.blocks = NEW_ARR_F(exttsp_block_t, 0);
+	env.edges  = NEW_ARR_F(exttsp_edge_t, 0);
+	env.stamp  = 0;
+
+	(void)be_remove_empty_blocks(irg);
+
+	ir_reserve_resources(irg, IR_RESOURCE_IRN_VISITED | IR_RESOURCE_IRN_LINK);
+	inc_irg_visited(irg);
+	exttsp_collect_blocks(&env, get_irg_start_block(irg));
+	exttsp_collect_edges(&env);
+	ir_free_resources(irg, IR_RESOURCE_IRN_VISITED | IR_RESOURCE_IRN_LINK);
+
+	size_t n_blocks = ARR_LEN(env.blocks);
+	if (n_blocks > EXTTSP_MAX_BLOCKS) {
+		for (size_t i = 0; i < n_blocks; ++i)
+			DEL_ARR_F(env.blocks[i].out_edges);
+		DEL_ARR_F(env.edges);
+		DEL_ARR_F(env.blocks);
+		return create_block_schedule_greedy(irg);
+	}
+
+	env.chains = NEW_ARR_F(exttsp_chain_t, n_blocks);
+	env.pairs  = NEW_ARR_F(exttsp_pair_t, 0);
+	env.merged = NEW_ARR_F(unsigned, n_blocks);
+	for (size_t i = 0; i < n_blocks; ++i) {
+		exttsp_chain_t *chain = &env.chains[i];
+		chain->blocks = NEW_ARR_F(unsigned, 1);
+		chain->blocks[0] = i;
+		chain->pairs  = NEW_ARR_F(unsigned, 0);
+		chain->score  = exttsp_score(&env, chain->blocks, 1);
+		chain->freq   = get_block_execfreq(env.blocks[i].block);
+		chain->size   = env.blocks[i].size;
+		chain->alive  = true;
+	}
+
+	exttsp_merge_chains(&env);
+
+	/* the chain of the start block comes first, the others are ordered by
+	 * decreasing execution density */
+	exttsp_chain_t **order   = NEW_ARR_F(exttsp_chain_t*, 0);
+	exttsp_chain_t  *start   = &env.chains[env.blocks[0].chain];
+	for (size_t i = 0; i < n_blocks; ++i) {
+		exttsp_chain_t *chain = &env.chains[i];
+		if (chain->alive && chain != start)
+			ARR_APP1(exttsp_chain_t*, order, chain);
+	}
+	qsort(order, ARR_LEN(order), sizeof(order[0]), cmp_exttsp_chains);
+
+	ir_node **block_list = NEW_ARR_D(ir_node*, be_get_be_obst(irg), n_blocks);
+	size_t    n          = 0;
+	DB((dbg, LEVEL_1, "Blockschedule:\n"));
+	for (size_t c = 0, n_order = ARR_LEN(order); c <= n_order; ++c) {
+		exttsp_chain_t *chain = c == 0 ? start : order[c - 1];
+		for (size_t i = 0, n_chain = ARR_LEN(chain->blocks); i < n_chain; ++i) {
+			block_list[n++] = env.blocks[chain->blocks[i]].block;
+			DB((dbg, LEVEL_1, "\t%+F\n", block_list[n - 1]));
+		}
+	}
+	assert(n == n_blocks);
+	assert(block_list[0] == get_irg_start_block(irg));
+
+	DEL_ARR_F(order);
+	for (size_t i = 0; i < n_blocks; ++i) {
+		if (env.chains[i].alive) {
+			DEL_ARR_F(env.chains[i].blocks);
+			DEL_ARR_F(env.chains[i].pairs);
+		}
+		DEL_ARR_F(env.blocks[i].out_edges);
+	}
+	DEL_ARR_F(env.pairs);
+	DEL_ARR_F(env.merged);
+	DEL_ARR_F(env.chains);
+	DEL_ARR_F(env.edges);
+	DEL_ARR_F(env.blocks);
+
+	return block_list;
+}
+
+/**
+ * Moves the blocks executed less often than the cold threshold behind all
+ * other blocks, keeping their relative order, and records where the cold part
+ * of the schedule begins.
+ */
+static void split_cold_blocks(ir_graph *irg, ir_node **block_list)
+{
+	size_t    n_blocks = ARR_LEN(block_list);
+	be_irg_t *birg     = be_birg_from_irg(irg);
+	birg->n_hot_blocks = n_blocks;
+
+	/* the cold part of a function merged at link time could be left behind
+	 * referencing a discarded copy */
+	ir_entity *entity = get_irg_entity(irg);
+	if (cold_threshold <= 0.0 || (get_entity_linkage(entity) & IR_LINKAGE_MERGE))
+		return;
+
+	double    threshold = cold_threshold
+	                    * get_block_execfreq(get_irg_start_block(irg));
+	ir_node **cold      = NEW_ARR_F(ir_node*, 0);
+	size_t    n_hot     = 0;
+	for (size_t i = 0; i < n_blocks; ++i) {
+		ir_node *block = block_list[i];
+		if (i > 0 && get_block_execfreq(block) < threshold) {
+			ARR_APP1(ir_node*, cold, block);
+		} else {
+			block_list[n_hot++] = block;
+		}
+	}
+	memcpy(&block_list[n_hot], cold, ARR_LEN(cold) * sizeof(cold[0]));
+	DEL_ARR_F(cold);
+
+	birg->n_hot_blocks = n_hot;
+	DB((dbg, LEVEL_1, "%+F: %zu of %zu blocks are cold\n", irg,
+	    n_blocks - n_hot, n_blocks));
+}
+
 /*
  *  ___ _     ____
  * |_ _| |   |  _ \
@@ -735,15 +1314,24 @@ void be_init_blocksched(void)
 	FIRM_DBG_REGISTER(dbg, "firm.be.blocksched");
 }
 
-ir_node **be_create_block_schedule(ir_graph *irg)
+static ir_node **create_block_schedule(ir_graph *irg)
 {
 	switch (algo) {
 	case BLOCKSCHED_GREEDY:
 	case BLOCKSCHED_NAIV:
 		return create_block_schedule_greedy(irg);
+	case BLOCKSCHED_EXTTSP:
+		return create_block_schedule_exttsp(irg);
 	case BLOCKSCHED_ILP:
 		return create_block_schedule_ilp(irg);
 	}
 
 	panic("unknown blocksched algo");
 }
+
+ir_node **be_create_block_schedule(ir_graph *irg)
+{
+	ir_node **block_list = create_block_schedule(irg);
+	split_cold_blocks(irg, block_list);
+	return block_list;
+}
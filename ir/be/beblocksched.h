@@ -14,6 +14,11 @@
 
 #include "firm_types.h"
 
+/**
+ * Computes the order in which the blocks of irg are emitted. Rarely executed
+ * blocks may be moved to the end, the number of blocks in front of them is
+ * available as n_hot_blocks in the be_irg_t of irg afterwards.
+ */
 ir_node **be_create_block_schedule(ir_graph *irg);
 
 #endif
@@ -0,0 +1,688 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief       Cache for the emitted assembler code of graphs.
+ *
+ * The key of a graph is a hash over its nodes in walk order: opcodes, modes,
+ * predecessors, attributes, tarvals and the names and layout of referenced
+ * entities and types, combined with the backend options and the libFirm
+ * build. The cache is a directory containing the emitted assembler code of
+ * every graph in a file named after the key.
+ *
+ * Private labels defined in a fragment (blocks, jump tables, ...) are
+ * numbered per compilation unit, so they are stored as placeholders and
+ * replaced by fresh names when the fragment is reused. Graphs with
+ * attributes not covered by the hash and fragments referencing entities
+ * the backend created for them (floating point constants, trampolines, ...)
+ * are not stored.
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "becache.h"
+#include "be_t.h"
+#include "beirg.h"
+#include "beemitter.h"
+#include "begnuas.h"
+#include "bedwarf.h"
+#include "bemodule.h"
+#include "irgraph_t.h"
+#include "irnode_t.h"
+#include "irgwalk.h"
+#include "irprog_t.h"
+#include "typerep.h"
+#include "tv.h"
+#include "pset_new.h"
+#include "array_t.h"
+#include "obst.h"
+#include "xmalloc.h"
+#include "debug.h"
+#include "statev.h"
+
+DEBUG_ONLY(static firm_dbg_module_t *dbg = NULL;)
+
+/** Version of the cache format, part of every key. */
+#define CACHE_VERSION "firm-be-cache-1"
+
+/** Marks the private labels in a stored fragment. */
+#define LABEL_MARK '\x01'
+
+/** Nesting depth up to which referenced types are hashed. */
+#define TYPE_HASH_DEPTH 2
+
+#define FNV_OFFSET_BASIS UINT64_C(14695981039346656037)
+#define FNV_PRIME        UINT64_C(1099511628211)
+
+static uint64_t        options_hash = FNV_OFFSET_BASIS;
+static uint64_t        unit_hash;      /**< options and libFirm build */
+static bool            enabled;
+static be_main_env_t  *main_env;
+static pset_new_t      old_entities;   /**< entities existing before codegen */
+static size_t          n_old_entities;
+static struct obstack  capture;        /**< the emitted code of the graph */
+static bool            capturing;
+static uint64_t        current_key;
+static unsigned        n_reused;       /**< fragments emitted from the cache */
+static unsigned        n_hits;
+static unsigned        n_misses;
+static unsigned        n_stored;
+static unsigned        n_uncacheable;
+
+static void hash_bytes(uint64_t *hash, const void *data, size_t size)
+{
+	const unsigned char *bytes = (const unsigned char*)data;
+	uint64_t             h     = *hash;
+	for (size_t i = 0; i < size; ++i) {
+		h ^= bytes[i];
+		h *= FNV_PRIME;
+	}
+	*hash = h;
+}
+
+static void hash_uint(uint64_t *hash, uint64_t value)
+{
+	hash_bytes(hash, &value, sizeof(value));
+}
+
+static void hash_string(uint64_t *hash, const char *str)
+{
+	hash_bytes(hash, str, strlen(str) + 1);
+}
+
+static void hash_ident(uint64_t *hash, ident *id)
+{
+	hash_string(hash, id != NULL ? get_id_str(id) : "");
+}
+
+static void hash_mode(uint64_t *hash, const ir_mode *mode)
+{
+	hash_string(hash, mode != NULL ? get_mode_name(mode) : "");
+}
+
+static void hash_tarval(uint64_t *hash, ir_tarval *tv)
+{
+	ir_mode *mode = get_tarval_mode(tv);
+	hash_mode(hash, mode);
+	if (mode == mode_b) {
+		hash_uint(hash, tv == tarval_b_true);
+		return;
+	}
+	for (unsigned i = 0, n = get_mode_size_bytes(mode); i < n; ++i)
+		hash_uint(hash, get_tarval_sub_bits(tv, i));
+}
+
+static void hash_type(uint64_t *hash, ir_type *type, unsigned depth)
+{
+	if (type == NULL) {
+		hash_string(hash, "");
+		return;
+	}
+	hash_string(hash, get_type_tpop_name(type));
+	hash_uint(hash, get_type_size_bytes(type));
+	hash_uint(hash, get_type_alignment_bytes(type));
+	hash_mode(hash, get_type_mode(type));
+	if (depth == 0)
+		return;
+
+	switch (get_type_tpop_code(type)) {
+	case tpo_method:
+		hash_uint(hash, get_method_calling_convention(type));
+		hash_uint(hash, get_method_additional_properties(type));
+		hash_uint(hash, get_method_variadicity(type));
+		hash_uint(hash, get_method_n_params(type));
+		for (size_t i = 0, n = get_method_n_params(type); i < n; ++i)
+			hash_type(hash, get_method_param_type(type, i), depth - 1);
+		hash_uint(hash, get_method_n_ress(type));
+		for (size_t i = 0, n = get_method_n_ress(type); i < n; ++i)
+			hash_type(hash, get_method_res_type(type, i), depth - 1);
+		return;
+	case tpo_pointer:
+		hash_type(hash, get_pointer_points_to_type(type), depth - 1);
+		return;
+	case tpo_array:
+		hash_type(hash, get_array_element_type(type), depth - 1);
+		return;
+	case tpo_primitive:
+		hash_type(hash, get_primitive_base_type(type), depth - 1);
+		return;
+	case tpo_struct:
+	case tpo_union:
+	case tpo_class:
+		hash_uint(hash, get_compound_n_members(type));
+		for (size_t i = 0, n = get_compound_n_members(type); i < n; ++i) {
+			ir_entity *member = get_compound_member(type, i);
+			hash_ident(hash, get_entity_ident(member));
+			hash_uint(hash, (uint64_t)get_entity_offset(member));
+			hash_uint(hash, get_entity_offset_bits_remainder(member));
+			hash_type(hash, get_entity_type(member), depth - 1);
+		}
+		return;
+	default:
+		return;
+	}
+}
+
+static void hash_entity(uint64_t *hash, ir_entity *entity)
+{
+	hash_ident(hash, get_entity_ld_ident(entity));
+	hash_uint(hash, get_entity_visibility(entity));
+	hash_uint(hash, get_entity_linkage(entity));
+	hash_uint(hash, (uint64_t)get_entity_offset(entity));
+	hash_uint(hash, get_entity_offset_bits_remainder(entity));
+	hash_uint(hash, get_entity_alignment(entity));
+	hash_uint(hash, get_entity_volatility(entity));
+	if (is_method_entity(entity))
+		hash_uint(hash, get_entity_additional_properties(entity));
+	if (is_parameter_entity(entity))
+		hash_uint(hash, get_entity_parameter_number(entity));
+	hash_type(hash, get_entity_type(entity), TYPE_HASH_DEPTH);
+}
+
+/**
+ * Hashes the attributes of a node.
+ *
+ * @return false if the attributes of the node are not known, the graph
+ *         cannot be cached then
+ */
+static bool hash_attributes(uint64_t *hash, const ir_node *node)
+{
+	if (is_fragile_op(node))
+		hash_uint(hash, ir_throws_exception(node));
+
+	switch (get_irn_opcode(node)) {
+	case iro_Add:
+	case iro_Anchor:
+	case iro_And:
+	case iro_Bad:
+	case iro_Dummy:
+	case iro_End:
+	case iro_Eor:
+	case iro_Free:
+	case iro_Id:
+	case iro_IJmp:
+	case iro_Jmp:
+	case iro_Minus:
+	case iro_Mul:
+	case iro_Mulh:
+	case iro_Mux:
+	case iro_NoMem:
+	case iro_Not:
+	case iro_Or:
+	case iro_Phi:
+	case iro_Pin:
+	case iro_Raise:
+	case iro_Return:
+	case iro_Rotl:
+	case iro_Shl:
+	case iro_Shr:
+	case iro_Shrs:
+	case iro_Start:
+	case iro_Sub:
+	case iro_Sync:
+	case iro_Tuple:
+	case iro_Unknown:
+	case iro_Conv:
+		return true;
+	case iro_Block:
+		/* the label may be referenced from outside of the function */
+		return get_Block_entity(node) == NULL;
+	case iro_Const:
+		hash_tarval(hash, get_Const_tarval(node));
+		return true;
+	case iro_SymConst:
+		hash_uint(hash, get_SymConst_kind(node));
+		switch (get_SymConst_kind(node)) {
+		case symconst_addr_ent:
+		case symconst_ofs_ent:
+			hash_entity(hash, get_SymConst_entity(node));
+			return true;
+		case symconst_type_size:
+		case symconst_type_align:
+			hash_type(hash, get_SymConst_type(node), TYPE_HASH_DEPTH);
+			return true;
+		default:
+			return false;
+		}
+	case iro_Sel:
+		hash_entity(hash, get_Sel_entity(node));
+		return true;
+	case iro_Proj:
+		hash_uint(hash, get_Proj_proj(node));
+		return true;
+	case iro_Load:
+		hash_mode(hash, get_Load_mode(node));
+		hash_uint(hash, get_Load_volatility(node));
+		hash_uint(hash, get_Load_unaligned(node));
+		return true;
+	case iro_Store:
+		hash_uint(hash, get_Store_volatility(node));
+		hash_uint(hash, get_Store_unaligned(node));
+		return true;
+	case iro_Call:
+		hash_type(hash, get_Call_type(node), TYPE_HASH_DEPTH);
+		return true;
+	case iro_Builtin:
+		hash_uint(hash, get_Builtin_kind(node));
+		hash_type(hash, get_Builtin_type(node), TYPE_HASH_DEPTH);
+		return true;
+	case iro_Cmp:
+		hash_uint(hash, get_Cmp_relation(node));
+		return true;
+	case iro_Confirm:
+		hash_uint(hash, get_Confirm_relation(node));
+		return true;
+	case iro_Cond:
+		hash_uint(hash, get_Cond_jmp_pred(node));
+		return true;
+	case iro_Switch: {
+		const ir_switch_table *table = get_Switch_table(node);
+		hash_uint(hash, get_Switch_n_outs(node));
+		for (size_t i = 0, n = ir_switch_table_get_n_entries(table); i < n; ++i) {
+			ir_tarval *min = ir_switch_table_get_min(table, i);
+			ir_tarval *max = ir_switch_table_get_max(table, i);
+			hash_uint(hash, ir_switch_table_get_pn(table, i));
+			if (min != NULL)
+				hash_tarval(hash, min);
+			if (max != NULL)
+				hash_tarval(hash, max);
+		}
+		return true;
+	}
+	case iro_Div:
+		hash_mode(hash, get_Div_resmode(node));
+		hash_uint(hash, get_Div_no_remainder(node));
+		return true;
+	case iro_Mod:
+		hash_mode(hash, get_Mod_resmode(node));
+		return true;
+	case iro_Alloc:
+		hash_uint(hash, get_Alloc_alignment(node));
+		return true;
+	case iro_CopyB:
+		hash_type(hash, get_CopyB_type(node), TYPE_HASH_DEPTH);
+		return true;
+	case iro_InstOf:
+		hash_type(hash, get_InstOf_type(node), TYPE_HASH_DEPTH);
+		return true;
+	case iro_ASM: {
+		const ir_asm_constraint *ins  = get_ASM_input_constraints(node);
+		const ir_asm_constraint *outs = get_ASM_output_constraints(node);
+		ident                  **clobbers = get_ASM_clobbers(node);
+		hash_ident(hash, get_ASM_text(node));
+		for (int i = 0, n = get_ASM_n_inputs(node); i < n; ++i) {
+			hash_uint(hash, ins[i].pos);
+			hash_ident(hash, ins[i].constraint);
+			hash_mode(hash, ins[i].mode);
+		}
+		for (size_t i = 0, n = get_ASM_n_output_constraints(node); i < n; ++i) {
+			hash_uint(hash, outs[i].pos);
+			hash_ident(hash, outs[i].constraint);
+			hash_mode(hash, outs[i].mode);
+		}
+		for (size_t i = 0, n = get_ASM_n_clobbers(node); i < n; ++i)
+			hash_ident(hash, clobbers[i]);
+		return true;
+	}
+	default:
+		/* backend specific or unknown node */
+		return false;
+	}
+}
+
+typedef struct hash_env_t {
+	unsigned *numbers; /**< walk order numbers by node index, 0 if unvisited */
+	ir_node **nodes;   /**< the nodes in walk order */
+} hash_env_t;
+
+static void number_node(ir_node *node, void *data)
+{
+	hash_env_t *env = (hash_env_t*)data;
+	ARR_APP1(ir_node*, env->nodes, node);
+	env->numbers[get_irn_idx(node)] = ARR_LEN(env->nodes);
+}
+
+/**
+ * Computes the key of a graph.
+ *
+ * @return false if the graph cannot be cached
+ */
+static bool compute_key(ir_graph *irg, uint64_t *key)
+{
+	uint64_t hash = unit_hash;
+	hash_entity(&hash, get_irg_entity(irg));
+	hash_type(&hash, get_irg_frame_type(irg), TYPE_HASH_DEPTH);
+	hash_uint(&hash, be_birg_from_irg(irg)->cold);
+
+	hash_env_t env;
+	env.numbers = XMALLOCNZ(unsigned, get_irg_last_idx(irg));
+	env.nodes   = NEW_ARR_F(ir_node*, 0);
+	irg_walk_graph(irg, NULL, number_node, &env);
+
+	bool cacheable = true;
+	for (size_t i = 0, n = ARR_LEN(env.nodes); i < n && cacheable; ++i) {
+		ir_node *node = env.nodes[i];
+		hash_string(&hash, get_irn_opname(node));
+		hash_mode(&hash, get_irn_mode(node));
+		hash_uint(&hash, get_irn_pinned(node));
+		if (!is_Block(node))
+			hash_uint(&hash, env.numbers[get_irn_idx(get_nodes_block(node))]);
+		hash_uint(&hash, get_irn_arity(node));
+		for (int p = 0, arity = get_irn_arity(node); p < arity; ++p)
+			hash_uint(&hash, env.numbers[get_irn_idx(get_irn_n(node, p))]);
+		cacheable = hash_attributes(&hash, node);
+	}
+
+	DEL_ARR_F(env.nodes);
+	free(env.numbers);
+	*key = hash;
+	return cacheable;
+}
+
+static char *get_cache_filename(uint64_t key)
+{
+	char buf[32];
+	snprintf(buf, sizeof(buf), "%016llx.s", (unsigned long long)key);
+	size_t len  = strlen(be_options.cache_dir) + strlen(buf) + 2;
+	char  *name = XMALLOCN(char, len);
+	snprintf(name, len, "%s/%s", be_options.cache_dir, buf);
+	return name;
+}
+
+static bool is_label_char(char c)
+{
+	return isalnum((unsigned char)c) || c == '_' || c == '.' || c == '$';
+}
+
+/**
+ * Emits a stored fragment, giving its private labels fresh names.
+ */
+static void emit_fragment(const char *text, size_t len)
+{
+	const char *prefix = be_gas_get_private_prefix();
+	unsigned    nr     = n_reused++;
+	for (size_t i = 0; i < len; ++i) {
+		if (text[i] != LABEL_MARK) {
+			be_emit_char(text[i]);
+			continue;
+		}
+		size_t end = i + 1;
+		while (end < len && text[end] != LABEL_MARK)
+			++end;
+		be_emit_irprintf("%scache%u_", prefix, nr);
+		be_emit_string_len(text + i + 1, end - i - 1);
+		i = end;
+	}
+	be_emit_write_line();
+}
+
+bool be_cache_emit_cached(ir_graph *irg)
+{
+	if (!enabled)
+		return false;
+
+	if (!compute_key(irg, &current_key)) {
+		DB((dbg, LEVEL_2, "%+F cannot be cached\n", irg));
+		++n_uncacheable;
+		return false;
+	}
+
+	char *filename = get_cache_filename(current_key);
+	FILE *file     = fopen(filename, "rb");
+	free(filename);
+	if (file != NULL) {
+		struct obstack obst;
+		obstack_init(&obst);
+		char   buf[4096];
+		size_t n;
+		while ((n = fread(buf, 1, sizeof(buf), file)) > 0)
+			obstack_grow(&obst, buf, n);
+		bool   ok   = !ferror(file);
+		size_t len  = obstack_object_size(&obst);
+		char  *text = (char*)obstack_finish(&obst);
+		fclose(file);
+		if (ok) {
+			DB((dbg, LEVEL_2, "%+F found in the cache\n", irg));
+			emit_fragment(text, len);
+			/* the fragment switched sections behind the back of begnuas */
+			be_gas_reset_section();
+			obstack_free(&obst, NULL);
+			++n_hits;
+			return true;
+		}
+		obstack_free(&obst, NULL);
+	}
+
+	DB((dbg, LEVEL_2, "%+F not in the cache\n", irg));
+	++n_misses;
+	/* the fragment has to select its section itself when it is replayed */
+	be_gas_reset_section();
+	obstack_init(&capture);
+	be_emit_begin_capture(&capture);
+	capturing = true;
+	return false;
+}
+
+/**
+ * Collects the entities created since the start of the unit.
+ */
+static ir_entity **get_new_entities(void)
+{
+	ir_entity **res = NEW_ARR_F(ir_entity*, 0);
+	for (ir_segment_t s = IR_SEGMENT_FIRST; s <= IR_SEGMENT_LAST; ++s) {
+		ir_type *segment = get_segment_type(s);
+		for (size_t i = 0, n = get_compound_n_members(segment); i < n; ++i) {
+			ir_entity *entity = get_compound_member(segment, i);
+			if (!pset_new_contains(&old_entities, entity))
+				ARR_APP1(ir_entity*, res, entity);
+		}
+	}
+	return res;
+}
+
+static size_t count_entities(void)
+{
+	size_t res = 0;
+	for (ir_segment_t s = IR_SEGMENT_FIRST; s <= IR_SEGMENT_LAST; ++s)
+		res += get_compound_n_members(get_segment_type(s));
+	return res;
+}
+
+/**
+ * Checks whether a fragment references one of the given entities.
+ */
+static bool references_entity(const char *text, size_t len,
+                              ir_entity **entities)
+{
+	const char *prefix     = be_gas_get_private_prefix();
+	size_t      prefix_len = strlen(prefix);
+	for (size_t i = 0; i < len;) {
+		if (!is_label_char(text[i])) {
+			++i;
+			continue;
+		}
+		size_t start = i;
+		while (i < len && is_label_char(text[i]))
+			++i;
+		const char *token     = text + start;
+		size_t      token_len = i - start;
+		for (size_t e = 0, n = ARR_LEN(entities); e < n; ++e) {
+			ir_entity  *entity = entities[e];
+			const char *name   = get_id_str(get_entity_ld_ident(entity));
+			const char *tok    = token;
+			size_t      tlen   = token_len;
+			if (get_entity_visibility(entity) == ir_visibility_private) {
+				if (tlen < prefix_len || strncmp(tok, prefix, prefix_len) != 0)
+					continue;
+				tok  += prefix_len;
+				tlen -= prefix_len;
+			}
+			if (strlen(name) == tlen && strncmp(tok, name, tlen) == 0)
+				return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Replaces the private labels defined in a fragment by placeholders. The
+ * label of a private function stays as it is referenced by the callers.
+ */
+static void write_fragment(FILE *file, const char *text, size_t len,
+                           const ir_entity *entity)
+{
+	const char *prefix     = be_gas_get_private_prefix();
+	size_t      prefix_len = strlen(prefix);
+	const char *name       = get_id_str(get_entity_ld_ident(entity));
+
+	/* collect the labels defined at the start of a line */
+	char **labels = NEW_ARR_F(char*, 0);
+	for (size_t i = 0; i < len;) {
+		size_t start = i;
+		while (i < len && is_label_char(text[i]))
+			++i;
+		if (i < len && text[i] == ':' && i - start > prefix_len
+		    && strncmp(text + start, prefix, prefix_len) == 0
+		    && !(strlen(name) == i - start - prefix_len
+		         && strncmp(text + start + prefix_len, name, strlen(name)) == 0)) {
+			size_t label_len = i - start;
+			char  *label     = XMALLOCN(char, label_len + 1);
+			memcpy(label, text + start, label_len);
+			label[label_len] = '\0';
+			ARR_APP1(char*, labels, label);
+		}
+		while (i < len && text[i] != '\n')
+			++i;
+		++i;
+	}
+
+	for (size_t i = 0; i < len;) {
+		if (!is_label_char(text[i])) {
+			fputc(text[i++], file);
+			continue;
+		}
+		size_t start = i;
+		while (i < len && is_label_char(text[i]))
+			++i;
+		size_t token_len = i - start;
+		size_t l         = 0;
+		size_t n_labels  = ARR_LEN(labels);
+		for (; l < n_labels; ++l) {
+			if (strlen(labels[l]) == token_len
+			    && strncmp(labels[l], text + start, token_len) == 0)
+				break;
+		}
+		if (l < n_labels)
+			fprintf(file, "%c%zu%c", LABEL_MARK, l, LABEL_MARK);
+		else
+			fwrite(text + start, 1, token_len, file);
+	}
+
+	for (size_t l = 0, n = ARR_LEN(labels); l < n; ++l)
+		free(labels[l]);
+	DEL_ARR_F(labels);
+}
+
+void be_cache_store(ir_graph *irg)
+{
+	if (!capturing)
+		return;
+	be_emit_end_capture();
+	capturing = false;
+
+	size_t len  = obstack_object_size(&capture);
+	char  *text = (char*)obstack_finish(&capture);
+
+	bool cacheable = get_compound_n_members(main_env->pic_trampolines_type) == 0
+	              && get_compound_n_members(main_env->pic_symbols_type) == 0;
+	if (cacheable && count_entities() != n_old_entities) {
+		ir_entity **entities = get_new_entities();
+		cacheable = !references_entity(text, len, entities);
+		DEL_ARR_F(entities);
+	}
+
+	if (!cacheable) {
+		DB((dbg, LEVEL_2, "%+F references code generator entities\n", irg));
+		++n_uncacheable;
+	} else {
+		char *filename = get_cache_filename(current_key);
+		char *tmpname  = XMALLOCN(char, strlen(filename) + 5);
+		sprintf(tmpname, "%s.tmp", filename);
+		FILE *file = fopen(tmpname, "wb");
+		if (file != NULL) {
+			write_fragment(file, text, len, get_irg_entity(irg));
+			bool ok = !ferror(file);
+			ok &= fclose(file) == 0;
+			/* rename makes the fragment visible at once */
+			if (ok && rename(tmpname, filename) == 0) {
+				DB((dbg, LEVEL_2, "%+F stored as %s\n", irg, filename));
+				++n_stored;
+			} else {
+				remove(tmpname);
+			}
+		}
+		free(tmpname);
+		free(filename);
+	}
+	obstack_free(&capture, NULL);
+}
+
+void be_cache_add_option(const char *arg)
+{
+	hash_string(&options_hash, arg);
+}
+
+void be_cache_begin_unit(be_main_env_t *env)
+{
+	enabled = be_options.cache_dir[0] != '\0'
+	       && !be_options.opt_profile_generate
+	       && !be_options.opt_profile_use
+	       && !be_dwarf_enabled();
+	n_reused      = 0;
+	n_hits        = 0;
+	n_misses      = 0;
+	n_stored      = 0;
+	n_uncacheable = 0;
+	if (!enabled)
+		return;
+
+	main_env  = env;
+	unit_hash = options_hash;
+	hash_string(&unit_hash, CACHE_VERSION);
+	hash_string(&unit_hash, ir_get_version_build());
+
+	pset_new_init(&old_entities);
+	for (ir_segment_t s = IR_SEGMENT_FIRST; s <= IR_SEGMENT_LAST; ++s) {
+		ir_type *segment = get_segment_type(s);
+		for (size_t i = 0, n = get_compound_n_members(segment); i < n; ++i)
+			pset_new_insert(&old_entities, get_compound_member(segment, i));
+	}
+	n_old_entities = count_entities();
+}
+
+void be_cache_end_unit(void)
+{
+	if (!enabled)
+		return;
+
+	DB((dbg, LEVEL_1, "cache: %u hits, %u misses, %u stored, %u uncacheable\n",
+	    n_hits, n_misses, n_stored, n_uncacheable));
+	stat_ev_int("be_cache_hits", n_hits);
+	stat_ev_int("be_cache_misses", n_misses);
+	stat_ev_int("be_cache_stored", n_stored);
+	stat_ev_int("be_cache_uncacheable", n_uncacheable);
+
+	pset_new_destroy(&old_entities);
+	enabled = false;
+}
+
+BE_REGISTER_MODULE_CONSTRUCTOR(be_init_cache)
+void be_init_cache(void)
+{
+	FIRM_DBG_REGISTER(dbg, "firm.be.cache");
+}
@@ -0,0 +1,48 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief       Cache for the emitted assembler code of graphs.
+ */
+#ifndef FIRM_BE_BECACHE_H
+#define FIRM_BE_BECACHE_H
+
+#include <stdbool.h>
+#include "firm_types.h"
+#include "be_types.h"
+
+/**
+ * Records a backend option, graphs are only reused with the same options.
+ */
+void be_cache_add_option(const char *arg);
+
+/**
+ * Prepares the cache for a compilation unit. The cache is only used if a
+ * cache directory is set and neither profiling nor debug information is
+ * requested.
+ */
+void be_cache_begin_unit(be_main_env_t *env);
+
+/**
+ * Emits the cached code of a graph if the cache contains it. Otherwise starts
+ * recording the emitted code for be_cache_store().
+ *
+ * @return true if the cached code was emitted and the graph must not be
+ *         compiled
+ */
+bool be_cache_emit_cached(ir_graph *irg);
+
+/**
+ * Stores the code emitted for a graph since be_cache_emit_cached().
+ */
+void be_cache_store(ir_graph *irg);
+
+/**
+ * Reports the cache statistics of the compilation unit.
+ */
+void be_cache_end_unit(void);
+
+#endif
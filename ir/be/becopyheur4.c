@@ -13,6 +13,13 @@
  * originally written in Java by Sebastian Hack.
  * (also known as "heur3" :)
  * Performs simple copy minimization.
+ *
+ * For register classes with at most 32 registers the recoloring keeps the
+ * candidate colors of a node in a bitmask and picks them in cost order on
+ * demand instead of sorting a cost array for every node. Recolorings that
+ * failed without hitting the recursion limit are memoized as long as the
+ * temporary coloring they were tried in stays the same. Both can be
+ * switched off to compare against the original algorithm.
  */
 #define DISABLE_STATEV
 
@@ -21,6 +28,7 @@
 #include "array.h"
 #include "irnode_t.h"
 #include "bitset.h"
+#include "bitfiddle.h"
 #include "raw_bitset.h"
 #include "irnodemap.h"
 #include "pqueue.h"
@@ -59,6 +67,7 @@ typedef float real_t;
 
 static unsigned last_chunk_id   = 0;
 static int recolor_limit        = 7;
+static int use_fast_recoloring  = 1;
 static double dislike_influence = REAL(0.1);
 
 typedef struct col_cost_t {
@@ -73,6 +82,7 @@ typedef struct aff_chunk_t {
 	const ir_node  **n;                     /**< An ARR_F containing all nodes of the chunk. */
 	const ir_node  **interfere;             /**< An ARR_F containing all inference. */
 	int              weight;                /**< Weight of this chunk */
+	int              aff_weight;            /**< Incrementally computed sum of the internal affinity costs. */
 	unsigned         weight_consistent : 1; /**< Set if the weight is consistent. */
 	unsigned         deleted           : 1; /**< For debugging: Set if the was deleted. */
 	unsigned         id;                    /**< An id of this chunk. */
@@ -101,7 +111,13 @@ typedef struct co_mst_env_t {
 	be_ifg_t         *ifg;           /**< the interference graph */
 	copy_opt_t       *co;            /**< the copy opt object */
 	unsigned         chunk_visited;
+	unsigned         node_visited;   /**< visited counter for nodes */
 	col_cost_t      **single_cols;
+	bool             fast;           /**< incremental weights and memoization */
+	bool             use_masks;      /**< colors are kept in bitmasks */
+	unsigned         state;          /**< id of the current temporary coloring */
+	unsigned         last_state;     /**< last id handed out for a temporary coloring */
+	bool             hit_limit;      /**< the recolor limit was reached */
 } co_mst_env_t;
 
 /* stores coalescing related information for a node */
@@ -110,6 +126,7 @@ typedef struct co_mst_irn_t {
 	aff_chunk_t      *chunk;            /**< the chunk this irn belongs to */
 	bitset_t         *adm_colors;       /**< set of admissible colors for this irn */
 	ir_node          **int_neighs;      /**< array of all interfering neighbours (cached for speed reasons) */
+	struct co_mst_irn_t **int_neigh_irns; /**< coalescing info of the interfering neighbours, computed on demand */
 	int              n_neighs;          /**< length of the interfering neighbours array. */
 	int              int_aff_neigh;     /**< number of interfering affinity neighbours */
 	int              col;               /**< color currently assigned */
@@ -118,6 +135,9 @@ typedef struct co_mst_irn_t {
 	unsigned         fixed     : 1;     /**< the color is fixed */
 	struct list_head list;              /**< Queue for coloring undo. */
 	real_t           constr_factor;
+	unsigned         visited;           /**< visited counter */
+	unsigned         memo_state;        /**< temporary coloring failed_cols belongs to */
+	unsigned         failed_cols;       /**< colors which could not be excluded */
 } co_mst_irn_t;
 
 /**
@@ -131,8 +151,12 @@ static co_mst_irn_t *co_mst_irn_init(co_mst_env_t *env, const ir_node *irn)
 	res->fixed         = 0;
 	res->tmp_col       = -1;
 	res->int_neighs    = NULL;
+	res->int_neigh_irns = NULL;
 	/* set the number of interfering affinity neighbours to -1, they are calculated later */
 	res->int_aff_neigh = -1;
+	res->visited       = 0;
+	res->memo_state    = 0;
+	res->failed_cols   = 0;
 	res->col           = arch_get_irn_register(irn)->index;
 	res->init_col      = res->col;
 	INIT_LIST_HEAD(&res->list);
@@ -177,6 +201,22 @@ static co_mst_irn_t *get_co_mst_irn(co_mst_env_t *env, const ir_node *node)
 	return res;
 }
 
+/**
+ * Returns the coalescing info of all interfering neighbours of @p node.
+ */
+static co_mst_irn_t **get_int_neigh_irns(co_mst_env_t *env, co_mst_irn_t *node)
+{
+	if (node->int_neigh_irns == NULL) {
+		co_mst_irn_t **irns = OALLOCN(&env->obst, co_mst_irn_t*, node->n_neighs);
+		int            i;
+
+		for (i = 0; i < node->n_neighs; ++i)
+			irns[i] = get_co_mst_irn(env, node->int_neighs[i]);
+		node->int_neigh_irns = irns;
+	}
+	return node->int_neigh_irns;
+}
+
 typedef int decide_func_t(const co_mst_irn_t *node, int col);
 
 #ifdef DEBUG_libfirm
@@ -311,6 +351,7 @@ static inline aff_chunk_t *new_aff_chunk(co_mst_env_t *env)
 	c->n                 = NEW_ARR_F(const ir_node *, 0);
 	c->interfere         = NEW_ARR_F(const ir_node *, 0);
 	c->weight            = -1;
+	c->aff_weight        = 0;
 	c->weight_consistent = 0;
 	c->deleted           = 0;
 	c->id                = ++last_chunk_id;
@@ -389,16 +430,49 @@ static int nodes_insert(const ir_node ***arr, const ir_node *irn)
 	return 0;
 }
 
+/**
+ * Adds the affinity costs between @p node and the nodes already in chunk
+ * @p c to the weight of @p c.
+ */
+static void aff_chunk_add_weight(co_mst_env_t *env, aff_chunk_t *c,
+                                 const co_mst_irn_t *node)
+{
+	const affinity_node_t *an = get_affinity_info(env->co, node->irn);
+	if (an == NULL)
+		return;
+
+	co_gs_foreach_neighb(an, neigh) {
+		const ir_node      *m = neigh->irn;
+		const co_mst_irn_t *mirn;
+
+		if (m == node->irn) {
+			c->aff_weight += neigh->costs;
+			continue;
+		}
+		if (arch_irn_is_ignore(m))
+			continue;
+
+		/* affinity edges are symmetric, count both directions */
+		mirn = ir_nodemap_get(co_mst_irn_t, &env->map, m);
+		if (mirn != NULL && mirn->chunk == c)
+			c->aff_weight += 2 * neigh->costs;
+	}
+}
+
 /**
  * Adds a node to an affinity chunk
  */
-static inline void aff_chunk_add_node(aff_chunk_t *c, co_mst_irn_t *node)
+static inline void aff_chunk_add_node(co_mst_env_t *env, aff_chunk_t *c,
+                                      co_mst_irn_t *node)
 {
 	int i;
 
 	if (! nodes_insert(&c->n, node->irn))
 		return;
 
+	if (env->fast)
+		aff_chunk_add_weight(env, c, node);
+
 	c->weight_consistent = 0;
 	node->chunk          = c;
 
@@ -488,28 +562,28 @@ static int aff_chunk_absorb(co_mst_env_t *env, const ir_node *src, const ir_node
 			if (i < 0) {
 				/* create one containing both nodes */
 				c1 = new_aff_chunk(env);
-				aff_chunk_add_node(c1, get_co_mst_irn(env, src));
-				aff_chunk_add_node(c1, get_co_mst_irn(env, tgt));
+				aff_chunk_add_node(env, c1, get_co_mst_irn(env, src));
+				aff_chunk_add_node(env, c1, get_co_mst_irn(env, tgt));
 				goto absorbed;
 			}
 		} else {
 			/* c2 already exists */
 			if (! aff_chunk_interferes(c2, src)) {
-				aff_chunk_add_node(c2, get_co_mst_irn(env, src));
+				aff_chunk_add_node(env, c2, get_co_mst_irn(env, src));
 				goto absorbed;
 			}
 		}
 	} else if (c2 == NULL) {
 		/* c1 already exists */
 		if (! aff_chunk_interferes(c1, tgt)) {
-			aff_chunk_add_node(c1, get_co_mst_irn(env, tgt));
+			aff_chunk_add_node(env, c1, get_co_mst_irn(env, tgt));
 			goto absorbed;
 		}
 	} else if (c1 != c2 && ! aff_chunks_interfere(c1, c2)) {
 		int idx, len;
 
 		for (idx = 0, len = ARR_LEN(c2->n); idx < len; ++idx)
-			aff_chunk_add_node(c1, get_co_mst_irn(env, c2->n[idx]));
+			aff_chunk_add_node(env, c1, get_co_mst_irn(env, c2->n[idx]));
 
 		for (idx = 0, len = ARR_LEN(c2->interfere); idx < len; ++idx) {
 			const ir_node *irn = c2->interfere[idx];
@@ -554,7 +628,8 @@ static void aff_chunk_assure_weight(co_mst_env_t *env, aff_chunk_t *c)
 					c->color_affinity[col].cost += node->constr_factor;
 			}
 
-			if (an != NULL) {
+			/* the fast mode maintains the weight incrementally */
+			if (an != NULL && !env->fast) {
 				co_gs_foreach_neighb(an, neigh) {
 					const ir_node *m = neigh->irn;
 
@@ -565,6 +640,8 @@ static void aff_chunk_assure_weight(co_mst_env_t *env, aff_chunk_t *c)
 				}
 			}
 		}
+		if (env->fast)
+			w = c->aff_weight;
 
 		for (i = 0; i < env->n_regs; ++i)
 			c->color_affinity[i].cost *= (REAL(1.0) / ARR_LEN(c->n));
@@ -692,7 +769,7 @@ static void build_affinity_chunks(co_mst_env_t *env)
 
 		/* no chunk is allocated so far, do it now */
 		aff_chunk_t *curr_chunk = new_aff_chunk(env);
-		aff_chunk_add_node(curr_chunk, mirn);
+		aff_chunk_add_node(env, curr_chunk, mirn);
 
 		aff_chunk_assure_weight(env, curr_chunk);
 
@@ -772,7 +849,7 @@ static __attribute__((unused)) void chunk_order_nodes(co_mst_env_t *env, aff_chu
 /**
  * Greedy collect affinity neighbours into thew new chunk @p chunk starting at node @p node.
  */
-static void expand_chunk_from(co_mst_env_t *env, co_mst_irn_t *node, bitset_t *visited,
+static void expand_chunk_from(co_mst_env_t *env, co_mst_irn_t *node,
 	aff_chunk_t *chunk, aff_chunk_t *orig_chunk, decide_func_t *decider, int col)
 {
 	waitq *nodes = new_waitq();
@@ -781,8 +858,8 @@ static void expand_chunk_from(co_mst_env_t *env, co_mst_irn_t *node, bitset_t *v
 
 	/* init queue and chunk */
 	waitq_put(nodes, node);
-	bitset_set(visited, get_irn_idx(node->irn));
-	aff_chunk_add_node(chunk, node);
+	node->visited = env->node_visited;
+	aff_chunk_add_node(env, chunk, node);
 	DB((dbg, LEVEL_1, " %+F", node->irn));
 
 	/* as long as there are nodes in the queue */
@@ -794,7 +871,6 @@ static void expand_chunk_from(co_mst_env_t *env, co_mst_irn_t *node, bitset_t *v
 		if (an != NULL) {
 			co_gs_foreach_neighb(an, neigh) {
 				const ir_node *m    = neigh->irn;
-				int            m_idx = get_irn_idx(m);
 				co_mst_irn_t *n2;
 
 				if (arch_irn_is_ignore(m))
@@ -802,7 +878,7 @@ static void expand_chunk_from(co_mst_env_t *env, co_mst_irn_t *node, bitset_t *v
 
 				n2 = get_co_mst_irn(env, m);
 
-				if (! bitset_is_set(visited, m_idx)  &&
+				if (n2->visited != env->node_visited &&
 					decider(n2, col)                 &&
 					! n2->fixed                      &&
 					! aff_chunk_interferes(chunk, m) &&
@@ -816,8 +892,8 @@ static void expand_chunk_from(co_mst_env_t *env, co_mst_irn_t *node, bitset_t *v
 						- the new chunk doesn't interfere with the neighbour
 						- neighbour belongs or belonged once to the original chunk
 					*/
-					bitset_set(visited, m_idx);
-					aff_chunk_add_node(chunk, n2);
+					n2->visited = env->node_visited;
+					aff_chunk_add_node(env, chunk, n2);
 					DB((dbg, LEVEL_1, " %+F", n2->irn));
 					/* enqueue for further search */
 					waitq_put(nodes, n2);
@@ -836,10 +912,11 @@ static void expand_chunk_from(co_mst_env_t *env, co_mst_irn_t *node, bitset_t *v
  */
 static aff_chunk_t *fragment_chunk(co_mst_env_t *env, int col, aff_chunk_t *c, waitq *tmp)
 {
-	bitset_t    *visited = bitset_malloc(get_irg_last_idx(env->co->irg));
 	int         idx, len;
 	aff_chunk_t *best = NULL;
 
+	++env->node_visited;
+
 	for (idx = 0, len = ARR_LEN(c->n); idx < len; ++idx) {
 		const ir_node *irn;
 		co_mst_irn_t  *node;
@@ -847,11 +924,10 @@ static aff_chunk_t *fragment_chunk(co_mst_env_t *env, int col, aff_chunk_t *c, w
 		decide_func_t *decider;
 		int           check_for_best;
 
-		irn = c->n[idx];
-		if (bitset_is_set(visited, get_irn_idx(irn)))
-			continue;
-
+		irn  = c->n[idx];
 		node = get_co_mst_irn(env, irn);
+		if (node->visited == env->node_visited)
+			continue;
 
 		if (get_mst_irn_col(node) == col) {
 			decider        = decider_has_color;
@@ -867,7 +943,7 @@ static aff_chunk_t *fragment_chunk(co_mst_env_t *env, int col, aff_chunk_t *c, w
 		/* create a new chunk starting at current node */
 		tmp_chunk = new_aff_chunk(env);
 		waitq_put(tmp, tmp_chunk);
-		expand_chunk_from(env, node, visited, tmp_chunk, c, decider, col);
+		expand_chunk_from(env, node, tmp_chunk, c, decider, col);
 		assert(ARR_LEN(tmp_chunk->n) > 0 && "No nodes added to chunk");
 
 		/* remember the local best */
@@ -877,7 +953,6 @@ static aff_chunk_t *fragment_chunk(co_mst_env_t *env, int col, aff_chunk_t *c, w
 	}
 
 	assert(best && "No chunk found?");
-	free(visited);
 	return best;
 }
 
@@ -931,6 +1006,7 @@ static void determine_color_costs(co_mst_env_t *env, co_mst_irn_t *node, col_cos
 {
 	const int n_regs  = env->n_regs;
 	int   *neigh_cols = ALLOCAN(int, n_regs);
+	co_mst_irn_t **neighs = get_int_neigh_irns(env, node);
 	int    n_loose    = 0;
 	real_t coeff;
 	int    i;
@@ -942,7 +1018,7 @@ static void determine_color_costs(co_mst_env_t *env, co_mst_irn_t *node, col_cos
 	}
 
 	for (i = 0; i < node->n_neighs; ++i) {
-		co_mst_irn_t *n = get_co_mst_irn(env, node->int_neighs[i]);
+		co_mst_irn_t *n = neighs[i];
 		int col = get_mst_irn_col(n);
 		assert (col < n_regs);
 		if (is_loose(n)) {
@@ -959,8 +1035,50 @@ static void determine_color_costs(co_mst_env_t *env, co_mst_irn_t *node, col_cos
 	}
 }
 
+/**
+ * Returns the mask of all colors with non-zero costs.
+ */
+static unsigned get_color_candidates(const co_mst_env_t *env, const col_cost_t *costs)
+{
+	unsigned cand = 0;
+	int      i;
+
+	for (i = 0; i < env->n_regs; ++i) {
+		if (costs[i].cost != REAL(0.0))
+			cand |= 1u << i;
+	}
+	return cand;
+}
+
+/**
+ * Returns the next color to try in a recoloring or -1 if all further colors
+ * are forbidden. Without bitmasks @p costs is sorted and @p i is the position
+ * to look at. Otherwise the best color of the candidate set @p cand is picked
+ * (in the same order sorting would give) and removed from @p cand.
+ */
+static int next_color(const co_mst_env_t *env, const col_cost_t *costs, unsigned *cand, int i)
+{
+	unsigned rest;
+	int      best;
+
+	if (!env->use_masks)
+		return costs[i].cost == REAL(0.0) ? -1 : costs[i].col;
+
+	if (*cand == 0)
+		return -1;
+
+	best = ntz(*cand);
+	for (rest = *cand & (*cand - 1); rest != 0; rest &= rest - 1) {
+		int col = ntz(rest);
+		if (costs[col].cost > costs[best].cost)
+			best = col;
+	}
+	*cand &= ~(1u << best);
+	return best;
+}
+
 /* need forward declaration due to recursive call */
-static int recolor_nodes(co_mst_env_t *env, co_mst_irn_t *node, col_cost_t *costs, struct list_head *changed_ones, int depth, int *max_depth, int *trip);
+static int recolor_nodes(co_mst_env_t *env, co_mst_irn_t *node, col_cost_t *costs, unsigned cand, struct list_head *changed_ones, int depth, int *max_depth, int *trip);
 
 /**
  * Tries to change node to a color but @p explude_col.
@@ -973,14 +1091,26 @@ static int change_node_color_excluded(co_mst_env_t *env, co_mst_irn_t *node, int
 
 	/* neighbours has already a different color -> good, temporary fix it */
 	if (col != exclude_col) {
-		if (is_loose(node))
+		if (is_loose(node)) {
 			set_temp_color(node, col, changed);
+			env->state = ++env->last_state;
+		}
 		return 1;
 	}
 
 	/* The node has the color it should not have _and_ has not been visited yet. */
 	if (is_loose(node)) {
 		col_cost_t *costs = ALLOCAN(col_cost_t, env->n_regs);
+		unsigned    cand  = 0;
+		bool        hit_limit;
+
+		/* did this already fail with the current temporary coloring? */
+		if (env->use_masks && env->fast
+		    && node->memo_state == env->state
+		    && (node->failed_cols & (1u << exclude_col))) {
+			DBG((dbg, LEVEL_4, "\t%+F cannot leave color %d (memoized)\n", node->irn, exclude_col));
+			return 0;
+		}
 
 		/* Get the costs for giving the node a specific color. */
 		determine_color_costs(env, node, costs);
@@ -988,11 +1118,28 @@ static int change_node_color_excluded(co_mst_env_t *env, co_mst_irn_t *node, int
 		/* Since the node must not have the not_col, set the costs for that color to "infinity" */
 		costs[exclude_col].cost = REAL(0.0);
 
-		/* sort the colors according costs, cheapest first. */
-		qsort(costs, env->n_regs, sizeof(costs[0]), cmp_col_cost_gt);
+		if (env->use_masks) {
+			cand = get_color_candidates(env, costs);
+		} else {
+			/* sort the colors according costs, cheapest first. */
+			qsort(costs, env->n_regs, sizeof(costs[0]), cmp_col_cost_gt);
+		}
 
 		/* Try recoloring the node using the color list. */
-		res = recolor_nodes(env, node, costs, changed, depth + 1, max_depth, trip);
+		hit_limit      = env->hit_limit;
+		env->hit_limit = false;
+		res = recolor_nodes(env, node, costs, cand, changed, depth + 1, max_depth, trip);
+
+		/* A failed recoloring leaves the temporary coloring untouched, so
+		 * unless the recolor limit was the reason, trying again will fail. */
+		if (!res && !env->hit_limit && env->use_masks && env->fast) {
+			if (node->memo_state != env->state) {
+				node->memo_state  = env->state;
+				node->failed_cols = 0;
+			}
+			node->failed_cols |= 1u << exclude_col;
+		}
+		env->hit_limit |= hit_limit;
 	}
 
 	return res;
@@ -1000,13 +1147,15 @@ static int change_node_color_excluded(co_mst_env_t *env, co_mst_irn_t *node, int
 
 /**
  * Tries to bring node @p node to cheapest color and color all interfering neighbours with other colors.
- * ATTENTION: Expect @p costs already sorted by increasing costs.
+ * ATTENTION: Expect @p costs already sorted by increasing costs, unless the
+ * colors are kept as bitmasks, then @p cand contains the colors to try.
  * @return 1 if coloring could be applied, 0 otherwise.
  */
-static int recolor_nodes(co_mst_env_t *env, co_mst_irn_t *node, col_cost_t *costs, struct list_head *changed, int depth, int *max_depth, int *trip)
+static int recolor_nodes(co_mst_env_t *env, co_mst_irn_t *node, col_cost_t *costs, unsigned cand, struct list_head *changed, int depth, int *max_depth, int *trip)
 {
 	int   i;
 	struct list_head local_changed;
+	co_mst_irn_t **neighs = get_int_neigh_irns(env, node);
 
 	++*trip;
 	if (depth > *max_depth)
@@ -1018,16 +1167,18 @@ static int recolor_nodes(co_mst_env_t *env, co_mst_irn_t *node, col_cost_t *cost
 
 	if (depth >= recolor_limit) {
 		DBG((dbg, LEVEL_4, "\tHit recolor limit\n"));
+		env->hit_limit = true;
 		return 0;
 	}
 
 	for (i = 0; i < env->n_regs; ++i) {
-		int tgt_col  = costs[i].col;
-		int neigh_ok = 1;
-		int j;
+		int      tgt_col  = next_color(env, costs, &cand, i);
+		int      neigh_ok = 1;
+		unsigned state    = env->state;
+		int      j;
 
 		/* If the costs for that color (and all successive) are infinite, bail out we won't make it anyway. */
-		if (costs[i].cost == REAL(0.0)) {
+		if (tgt_col < 0) {
 			DBG((dbg, LEVEL_4, "\tAll further colors forbidden\n"));
 			return 0;
 		}
@@ -1036,21 +1187,16 @@ static int recolor_nodes(co_mst_env_t *env, co_mst_irn_t *node, col_cost_t *cost
 		assert(node->tmp_col < 0 && "Node must not have been temporary fixed.");
 		INIT_LIST_HEAD(&local_changed);
 		set_temp_color(node, tgt_col, &local_changed);
+		env->state = ++env->last_state;
 		DBG((dbg, LEVEL_4, "\tTemporary setting %+F to color %d\n", node->irn, tgt_col));
 
 		/* try to color all interfering neighbours with current color forbidden */
+		/* (ignore nodes are not part of int_neighs) */
 		for (j = 0; j < node->n_neighs; ++j) {
-			co_mst_irn_t *nn;
-			ir_node      *neigh;
-
-			neigh = node->int_neighs[j];
-
-			if (arch_irn_is_ignore(neigh))
-				continue;
+			co_mst_irn_t *nn = neighs[j];
 
-			nn = get_co_mst_irn(env, neigh);
 			DB((dbg, LEVEL_4, "\tHandling neighbour %+F, at position %d (fixed: %d, tmp_col: %d, col: %d)\n",
-				neigh, j, nn->fixed, nn->tmp_col, nn->col));
+				nn->irn, j, nn->fixed, nn->tmp_col, nn->col));
 
 			/*
 				Try to change the color of the neighbor and record all nodes which
@@ -1079,6 +1225,7 @@ static int recolor_nodes(co_mst_env_t *env, co_mst_irn_t *node, col_cost_t *cost
 		else {
 			/* coloring of neighbours failed, so we try next color */
 			reject_coloring(&local_changed);
+			env->state = state;
 		}
 	}
 
@@ -1108,13 +1255,16 @@ static int change_node_color(co_mst_env_t *env, co_mst_irn_t *node, int tgt_col,
 	*/
 	if (is_loose(node) && bitset_is_set(node->adm_colors, tgt_col)) {
 		col_cost_t *costs = env->single_cols[tgt_col];
+		unsigned    cand  = env->use_masks ? 1u << tgt_col : 0;
 		int res, max_depth, trip;
 
 		max_depth = 0;
 		trip      = 0;
+		env->state     = ++env->last_state;
+		env->hit_limit = false;
 
 		DBG((dbg, LEVEL_4, "\t\tCNC: Attempt to recolor %+F ===>>\n", node->irn));
-		res = recolor_nodes(env, node, costs, changed, 0, &max_depth, &trip);
+		res = recolor_nodes(env, node, costs, cand, changed, 0, &max_depth, &trip);
 		DBG((dbg, LEVEL_4, "\t\tCNC: <<=== Recoloring of %+F %s\n", node->irn, res ? "succeeded" : "failed"));
 		stat_ev_int("heur4_recolor_depth_max", max_depth);
 		stat_ev_int("heur4_recolor_trip", trip);
@@ -1151,7 +1301,6 @@ static void color_aff_chunk(co_mst_env_t *env, aff_chunk_t *c)
 	waitq       *tmp_chunks   = new_waitq();
 	waitq       *best_starts  = NULL;
 	col_cost_t  *order        = ALLOCANZ(col_cost_t, env->n_regs);
-	bitset_t    *visited;
 	int         i;
 	size_t      idx;
 	size_t      len;
@@ -1304,6 +1453,9 @@ static void color_aff_chunk(co_mst_env_t *env, aff_chunk_t *c)
 
 	/* return if coloring failed */
 	if (! best_chunk) {
+		/* the chunk is deleted by the caller, do not leave dangling links */
+		for (idx = 0, len = ARR_LEN(c->n); idx < len; ++idx)
+			get_co_mst_irn(env, c->n[idx])->chunk = NULL;
 		if (best_starts)
 			del_waitq(best_starts);
 		return;
@@ -1357,33 +1509,30 @@ static void color_aff_chunk(co_mst_env_t *env, aff_chunk_t *c)
 		co_mst_irn_t  *nn = get_co_mst_irn(env, n);
 		nn->chunk = c;
 	}
+	for (idx = 0, len = ARR_LEN(best_chunk->n); idx < len; ++idx) {
+		const ir_node *n  = best_chunk->n[idx];
+		co_mst_irn_t  *nn = get_co_mst_irn(env, n);
+		nn->chunk = NULL;
+	}
 
 	/* fragment the remaining chunk */
-	visited = bitset_malloc(get_irg_last_idx(env->co->irg));
+	++env->node_visited;
 	for (idx = 0, len = ARR_LEN(best_chunk->n); idx < len; ++idx)
-		bitset_set(visited, get_irn_idx(best_chunk->n[idx]));
+		get_co_mst_irn(env, best_chunk->n[idx])->visited = env->node_visited;
 
 	for (idx = 0, len = ARR_LEN(c->n); idx < len; ++idx) {
-		const ir_node *irn = c->n[idx];
-		if (! bitset_is_set(visited, get_irn_idx(irn))) {
-			aff_chunk_t  *new_chunk = new_aff_chunk(env);
-			co_mst_irn_t *node      = get_co_mst_irn(env, irn);
+		co_mst_irn_t *node = get_co_mst_irn(env, c->n[idx]);
+		if (node->visited != env->node_visited) {
+			aff_chunk_t *new_chunk = new_aff_chunk(env);
 
-			expand_chunk_from(env, node, visited, new_chunk, c, decider_always_yes, 0);
+			expand_chunk_from(env, node, new_chunk, c, decider_always_yes, 0);
 			aff_chunk_assure_weight(env, new_chunk);
 			pqueue_put(env->chunks, new_chunk, new_chunk->weight);
 		}
 	}
 
-	for (idx = 0, len = ARR_LEN(best_chunk->n); idx < len; ++idx) {
-		const ir_node *n  = best_chunk->n[idx];
-		co_mst_irn_t  *nn = get_co_mst_irn(env, n);
-		nn->chunk = NULL;
-	}
-
 	/* clear obsolete chunks and free some memory */
 	delete_aff_chunk(best_chunk);
-	free(visited);
 	if (best_starts)
 		del_waitq(best_starts);
 
@@ -1413,7 +1562,14 @@ static int co_solve_heuristic_mst(copy_opt_t *co)
 	mst_env.ifg              = co->cenv->ifg;
 	INIT_LIST_HEAD(&mst_env.chunklist);
 	mst_env.chunk_visited    = 0;
+	mst_env.node_visited     = 0;
 	mst_env.single_cols      = OALLOCN(&mst_env.obst, col_cost_t*, n_regs);
+	mst_env.fast             = use_fast_recoloring;
+	mst_env.use_masks        = use_fast_recoloring
+	                           && n_regs <= sizeof(unsigned) * 8;
+	mst_env.state            = 0;
+	mst_env.last_state       = 0;
+	mst_env.hit_limit        = false;
 
 	for (unsigned i = 0; i < n_regs; ++i) {
 		col_cost_t *vec = OALLOCN(&mst_env.obst, col_cost_t, n_regs);
@@ -1476,6 +1632,7 @@ static int co_solve_heuristic_mst(copy_opt_t *co)
 static const lc_opt_table_entry_t options[] = {
 	LC_OPT_ENT_INT      ("limit", "limit recoloring",  &recolor_limit),
 	LC_OPT_ENT_DBL      ("di",    "dislike influence", &dislike_influence),
+	LC_OPT_ENT_BOOL     ("fast",  "use bitmasks, memoization and incremental weights", &use_fast_recoloring),
 	LC_OPT_LAST
 };
 
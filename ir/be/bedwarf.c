@@ -521,6 +521,14 @@ void be_dwarf_method_end(void)
 	}
 }
 
+void be_dwarf_method_part_end(void)
+{
+	if (debug_level < LEVEL_FRAMEINFO)
+		return;
+	be_emit_cstring("\t.cfi_endproc\n");
+	be_emit_write_line();
+}
+
 static void emit_base_type_abbrev(void)
 {
 	begin_abbrev(abbrev_base_type, DW_TAG_base_type, DW_CHILDREN_no);
@@ -937,6 +945,11 @@ void be_dwarf_close(void)
 	pset_new_destroy(&env.emitted_types);
 }
 
+bool be_dwarf_enabled(void)
+{
+	return debug_level != LEVEL_NONE;
+}
+
 /* Opens a dwarf handler */
 void be_dwarf_open(void)
 {
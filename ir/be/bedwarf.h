@@ -11,6 +11,7 @@
 #ifndef FIRM_BE_BEDWARF_H
 #define FIRM_BE_BEDWARF_H
 
+#include <stdbool.h>
 #include "beabi.h"
 
 typedef struct parameter_dbg_info_t {
@@ -24,6 +25,9 @@ void be_dwarf_open(void);
 /** close a debug handler. */
 void be_dwarf_close(void);
 
+/** returns true if any debug information is emitted */
+bool be_dwarf_enabled(void);
+
 /** start a compilation unit */
 void be_dwarf_unit_begin(const char *filename);
 
@@ -40,6 +44,10 @@ void be_dwarf_method_begin(void);
 /** debug for a method end */
 void be_dwarf_method_end(void);
 
+/** end the callframe info of a method part begun with be_dwarf_method_begin
+ * which is not the method itself, like its cold part */
+void be_dwarf_method_part_end(void);
+
 /** dump a variable in the global type */
 void be_dwarf_variable(const ir_entity *ent);
 
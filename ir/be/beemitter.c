@@ -21,6 +21,7 @@
 
 FILE           *emit_file;
 struct obstack  emit_obst;
+static struct obstack *capture_obst;
 
 void be_emit_init(FILE *file)
 {
@@ -33,6 +34,16 @@ void be_emit_exit(void)
 	obstack_free(&emit_obst, NULL);
 }
 
+void be_emit_begin_capture(struct obstack *obst)
+{
+	capture_obst = obst;
+}
+
+void be_emit_end_capture(void)
+{
+	capture_obst = NULL;
+}
+
 void be_emit_irvprintf(const char *fmt, va_list args)
 {
 	ir_obst_vprintf(&emit_obst, fmt, args);
@@ -53,6 +64,8 @@ void be_emit_write_line(void)
 	char   *line = (char*)obstack_finish(&emit_obst);
 
 	fwrite(line, 1, len, emit_file);
+	if (capture_obst != NULL)
+		obstack_grow(capture_obst, line, len);
 	obstack_free(&emit_obst, line);
 }
 
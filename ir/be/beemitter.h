@@ -75,6 +75,16 @@ void be_emit_init(FILE *F);
  */
 void be_emit_exit(void);
 
+/**
+ * Starts copying everything written to the output file into obst.
+ */
+void be_emit_begin_capture(struct obstack *obst);
+
+/**
+ * Stops copying the output.
+ */
+void be_emit_end_capture(void);
+
 /**
  * Emit the output of an ir_printf.
  *
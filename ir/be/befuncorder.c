@@ -0,0 +1,444 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief       Ordering of the emitted functions.
+ *
+ * Places functions calling each other frequently next to each other to reduce
+ * i-TLB and i-cache misses. The c3 algorithm (Ottoni and Maher, "Optimizing
+ * Function Placement for Large-Scale Data-Center Applications") visits the
+ * functions from the most to the least frequently executed and appends the
+ * cluster of each function to the cluster of its most frequent caller, as long
+ * as the result fits into a page. The clusters are emitted by decreasing
+ * density.
+ *
+ * Only direct calls are considered. The execution frequency of a function is
+ * propagated from the externally visible functions, which are assumed to run
+ * once, along the calls weighted by the frequency of the calling blocks.
+ * Recursive calls are ignored for this.
+ */
+#include "befuncorder.h"
+
+#include <stdlib.h>
+
+#include "array.h"
+#include "debug.h"
+#include "execfreq.h"
+#include "irgraph_t.h"
+#include "irgwalk.h"
+#include "irnode_t.h"
+#include "irprintf.h"
+#include "irtools.h"
+#include "irprog_t.h"
+#include "pmap.h"
+#include "util.h"
+#include "xmalloc.h"
+#include "beirg.h"
+#include "bemodule.h"
+
+#include "lc_opts.h"
+#include "lc_opts_enum.h"
+
+DEBUG_ONLY(static firm_dbg_module_t *dbg = NULL;)
+
+/** Clusters are not grown beyond this estimated size in bytes. */
+#define C3_MAX_CLUSTER_SIZE  4096
+/** Estimated size of a node in bytes. */
+#define NODE_SIZE            4
+
+typedef enum funcorder_algos_t {
+	FUNCORDER_NONE, FUNCORDER_C3
+} funcorder_algos_t;
+
+static int    algo           = FUNCORDER_NONE;
+static double cold_threshold = 0.0;
+static int    report         = 0;
+
+static const lc_opt_enum_int_items_t funcorder_items[] = {
+	{ "none", FUNCORDER_NONE },
+	{ "c3",   FUNCORDER_C3 },
+	{ NULL,   0 }
+};
+
+static lc_opt_enum_int_var_t algo_var = {
+	&algo, funcorder_items
+};
+
+static const lc_opt_table_entry_t be_funcorder_options[] = {
+	LC_OPT_ENT_ENUM_INT ("funcorder",       "the function ordering algorithm", &algo_var),
+	LC_OPT_ENT_DBL      ("coldfuncs",       "place functions executed less often than this fraction of the most frequent one into the cold section (0 disables)", &cold_threshold),
+	LC_OPT_ENT_BOOL     ("funcorderreport", "print the function order to stderr", &report),
+	LC_OPT_LAST
+};
+
+typedef struct call_edge_t {
+	size_t caller; /**< index of the calling function */
+	double freq;   /**< calls per execution of the caller */
+	bool   back;   /**< the call is part of a recursion */
+} call_edge_t;
+
+typedef struct func_t {
+	ir_graph    *irg;
+	call_edge_t *callers;  /**< incoming calls */
+	size_t      *callees;  /**< indices of the called functions */
+	double       freq;     /**< estimated executions */
+	unsigned     size;     /**< estimated code size in bytes */
+	size_t       cluster;  /**< index of the cluster containing the function */
+	bool         cold;
+	bool         on_stack; /**< used to detect recursions */
+	bool         visited;
+} func_t;
+
+typedef struct cluster_t {
+	size_t   *funcs;   /**< function indices in emission order */
+	double    weight;  /**< summed frequency times size of the functions */
+	unsigned  size;
+} cluster_t;
+
+typedef struct funcorder_env_t {
+	func_t    *funcs;
+	pmap      *indices; /**< maps graphs to their function index + 1 */
+	size_t    *topo;   /**< function indices callers first */
+	cluster_t *clusters;
+} funcorder_env_t;
+
+/**
+ * Returns the index of the function of irg or (size_t)-1 if it is not part
+ * of the program.
+ */
+static size_t get_func_idx(const funcorder_env_t *env, const ir_graph *irg)
+{
+	return (size_t)PTR_TO_INT(pmap_get(void, env->indices, irg)) - 1;
+}
+
+static void count_node(ir_node *node, void *data)
+{
+	func_t *func = (func_t*)data;
+	(void)node;
+	func->size += NODE_SIZE;
+}
+
+static void collect_call(ir_node *node, void *data)
+{
+	funcorder_env_t *env = (funcorder_env_t*)data;
+	if (!is_Call(node))
+		return;
+
+	ir_node *ptr = get_Call_ptr(node);
+	if (!is_SymConst_addr_ent(ptr))
+		return;
+	ir_graph *callee = get_entity_irg(get_SymConst_entity(ptr));
+	if (callee == NULL)
+		return;
+	size_t callee_idx = get_func_idx(env, callee);
+	if (callee_idx == (size_t)-1)
+		return;
+
+	call_edge_t edge;
+	edge.caller = get_func_idx(env, get_irn_irg(node));
+	edge.freq   = get_block_execfreq(get_nodes_block(node));
+	edge.back   = false;
+
+	ARR_APP1(call_edge_t, env->funcs[callee_idx].callers, edge);
+	ARR_APP1(size_t, env->funcs[edge.caller].callees, callee_idx);
+}
+
+/**
+ * Orders the functions reachable from func callers first and marks calls
+ * into the functions on the stack as recursions.
+ */
+static void topo_walk(funcorder_env_t *env, size_t idx, size_t **postorder)
+{
+	func_t *func = &env->funcs[idx];
+	func->visited  = true;
+	func->on_stack = true;
+	for (size_t i = 0, n = ARR_LEN(func->callees); i < n; ++i) {
+		size_t callee = func->callees[i];
+		if (!env->funcs[callee].visited)
+			topo_walk(env, callee, postorder);
+	}
+	func->on_stack = false;
+	ARR_APP1(size_t, *postorder, idx);
+}
+
+static void mark_recursions(funcorder_env_t *env)
+{
+	size_t  n_funcs = ARR_LEN(env->funcs);
+	size_t *pos     = XMALLOCN(size_t, n_funcs);
+	for (size_t i = 0; i < n_funcs; ++i)
+		pos[env->topo[i]] = i;
+
+	/* a call from a function placed behind its callee closes a cycle */
+	for (size_t f = 0; f < n_funcs; ++f) {
+		func_t *func = &env->funcs[f];
+		for (size_t i = 0, n = ARR_LEN(func->callers); i < n; ++i) {
+			call_edge_t *edge = &func->callers[i];
+			edge->back = pos[edge->caller] >= pos[f];
+		}
+	}
+	free(pos);
+}
+
+static void compute_frequencies(funcorder_env_t *env)
+{
+	size_t  n_funcs   = ARR_LEN(env->funcs);
+	size_t *postorder = NEW_ARR_F(size_t, 0);
+
+	/* start with the roots so the cycles are broken where they are entered */
+	for (size_t i = 0; i < n_funcs; ++i) {
+		func_t *func = &env->funcs[i];
+		if (!func->visited && ARR_LEN(func->callers) == 0)
+			topo_walk(env, i, &postorder);
+	}
+	for (size_t i = 0; i < n_funcs; ++i) {
+		if (!env->funcs[i].visited)
+			topo_walk(env, i, &postorder);
+	}
+
+	env->topo = NEW_ARR_F(size_t, n_funcs);
+	for (size_t i = 0; i < n_funcs; ++i)
+		env->topo[i] = postorder[n_funcs - 1 - i];
+	DEL_ARR_F(postorder);
+
+	mark_recursions(env);
+
+	for (size_t i = 0; i < n_funcs; ++i) {
+		func_t    *func   = &env->funcs[env->topo[i]];
+		ir_entity *entity = get_irg_entity(func->irg);
+		double     freq   = entity_is_externally_visible(entity)
+		                    || ARR_LEN(func->callers) == 0 ? 1.0 : 0.0;
+		for (size_t c = 0, n = ARR_LEN(func->callers); c < n; ++c) {
+			const call_edge_t *edge = &func->callers[c];
+			if (!edge->back)
+				freq += edge->freq * env->funcs[edge->caller].freq;
+		}
+		func->freq = freq;
+	}
+}
+
+static funcorder_env_t *sort_env;
+
+static int cmp_func_freq(const void *d1, const void *d2)
+{
+	const func_t *f1 = &sort_env->funcs[*(const size_t*)d1];
+	const func_t *f2 = &sort_env->funcs[*(const size_t*)d2];
+	if (f1->freq < f2->freq) {
+		return 1;
+	} else if (f1->freq > f2->freq) {
+		return -1;
+	}
+	return f1 < f2 ? -1 : f1 > f2;
+}
+
+static int cmp_cluster_density(const void *d1, const void *d2)
+{
+	const cluster_t *c1 = &sort_env->clusters[*(const size_t*)d1];
+	const cluster_t *c2 = &sort_env->clusters[*(const size_t*)d2];
+	double dens1 = c1->weight / c1->size;
+	double dens2 = c2->weight / c2->size;
+	if (dens1 < dens2) {
+		return 1;
+	} else if (dens1 > dens2) {
+		return -1;
+	}
+	return c1 < c2 ? -1 : c1 > c2;
+}
+
+/**
+ * Returns the index of the caller calling func most often, or func itself if
+ * there is none.
+ */
+static size_t get_hottest_caller(const funcorder_env_t *env, size_t idx)
+{
+	const func_t *func      = &env->funcs[idx];
+	size_t        best      = idx;
+	double        best_freq = 0.0;
+	for (size_t i = 0, n = ARR_LEN(func->callers); i < n; ++i) {
+		const call_edge_t *edge   = &func->callers[i];
+		const func_t      *caller = &env->funcs[edge->caller];
+		double             freq   = edge->freq * caller->freq;
+		if (edge->caller == idx || caller->cold || freq <= best_freq)
+			continue;
+		best      = edge->caller;
+		best_freq = freq;
+	}
+	return best;
+}
+
+static void merge_clusters(funcorder_env_t *env, size_t into, size_t from)
+{
+	cluster_t *dst = &env->clusters[into];
+	cluster_t *src = &env->clusters[from];
+	for (size_t i = 0, n = ARR_LEN(src->funcs); i < n; ++i) {
+		env->funcs[src->funcs[i]].cluster = into;
+		ARR_APP1(size_t, dst->funcs, src->funcs[i]);
+	}
+	dst->weight += src->weight;
+	dst->size   += src->size;
+	DEL_ARR_F(src->funcs);
+	src->funcs = NULL;
+}
+
+static void cluster_functions(funcorder_env_t *env)
+{
+	size_t n_funcs = ARR_LEN(env->funcs);
+	env->clusters = NEW_ARR_F(cluster_t, n_funcs);
+	for (size_t i = 0; i < n_funcs; ++i) {
+		func_t    *func    = &env->funcs[i];
+		cluster_t *cluster = &env->clusters[i];
+		cluster->funcs     = NEW_ARR_F(size_t, 1);
+		cluster->funcs[0]  = i;
+		cluster->weight    = func->freq * func->size;
+		cluster->size      = func->size;
+		func->cluster      = i;
+	}
+
+	size_t *by_freq = NEW_ARR_F(size_t, n_funcs);
+	for (size_t i = 0; i < n_funcs; ++i)
+		by_freq[i] = i;
+	sort_env = env;
+	qsort(by_freq, n_funcs, sizeof(by_freq[0]), cmp_func_freq);
+
+	for (size_t i = 0; i < n_funcs; ++i) {
+		size_t  idx  = by_freq[i];
+		func_t *func = &env->funcs[idx];
+		if (func->cold)
+			continue;
+		size_t caller = get_hottest_caller(env, idx);
+		if (caller == idx)
+			continue;
+
+		size_t into = env->funcs[caller].cluster;
+		size_t from = func->cluster;
+		if (into == from)
+			continue;
+		if (env->clusters[into].size + env->clusters[from].size
+		    > C3_MAX_CLUSTER_SIZE)
+			continue;
+
+		DB((dbg, LEVEL_2, "append cluster of %+F to cluster of %+F\n",
+		    func->irg, env->funcs[caller].irg));
+		merge_clusters(env, into, from);
+	}
+	DEL_ARR_F(by_freq);
+}
+
+static void print_report(const funcorder_env_t *env, ir_graph **order)
+{
+	for (size_t i = 0, n = ARR_LEN(order); i < n; ++i) {
+		const func_t *func = &env->funcs[get_func_idx(env, order[i])];
+		ir_fprintf(stderr, "funcorder: %3zu %+F freq %g size %u cluster %zu%s\n",
+		           i, get_irg_entity(func->irg), func->freq, func->size,
+		           func->cluster, func->cold ? " cold" : "");
+	}
+}
+
+ir_graph **be_order_functions(void)
+{
+	size_t     n_irgs = get_irp_n_irgs();
+	ir_graph **order  = NEW_ARR_F(ir_graph*, 0);
+
+	if (algo == FUNCORDER_NONE && cold_threshold <= 0.0) {
+		for (size_t i = 0; i < n_irgs; ++i)
+			ARR_APP1(ir_graph*, order, get_irp_irg(i));
+		return order;
+	}
+
+	funcorder_env_t env;
+	env.funcs    = NEW_ARR_FZ(func_t, n_irgs);
+	env.indices  = pmap_create();
+	env.topo     = NULL;
+	env.clusters = NULL;
+	for (size_t i = 0; i < n_irgs; ++i) {
+		func_t *func = &env.funcs[i];
+		func->irg     = get_irp_irg(i);
+		func->callers = NEW_ARR_F(call_edge_t, 0);
+		func->callees = NEW_ARR_F(size_t, 0);
+		pmap_insert(env.indices, func->irg, INT_TO_PTR(i + 1));
+	}
+	for (size_t i = 0; i < n_irgs; ++i) {
+		func_t *func = &env.funcs[i];
+		irg_walk_graph(func->irg, count_node, NULL, func);
+		irg_walk_graph(func->irg, collect_call, NULL, &env);
+	}
+
+	compute_frequencies(&env);
+
+	/* mark the cold functions */
+	double max_freq = 0.0;
+	for (size_t i = 0; i < n_irgs; ++i) {
+		if (env.funcs[i].freq > max_freq)
+			max_freq = env.funcs[i].freq;
+	}
+	for (size_t i = 0; i < n_irgs; ++i) {
+		func_t *func = &env.funcs[i];
+		func->cold = func->freq < cold_threshold * max_freq;
+		if (func->cold && func->irg->be_data != NULL
+		    && !(get_entity_linkage(get_irg_entity(func->irg)) & IR_LINKAGE_MERGE))
+			be_birg_from_irg(func->irg)->cold = true;
+	}
+
+	if (algo == FUNCORDER_C3) {
+		cluster_functions(&env);
+
+		size_t *clusters = NEW_ARR_F(size_t, 0);
+		for (size_t i = 0; i < n_irgs; ++i) {
+			if (env.clusters[i].funcs != NULL)
+				ARR_APP1(size_t, clusters, i);
+		}
+		sort_env = &env;
+		qsort(clusters, ARR_LEN(clusters), sizeof(clusters[0]),
+		      cmp_cluster_density);
+
+		/* hot functions by cluster, the cold ones keep the program order */
+		for (size_t c = 0, n = ARR_LEN(clusters); c < n; ++c) {
+			const cluster_t *cluster = &env.clusters[clusters[c]];
+			for (size_t f = 0, n_f = ARR_LEN(cluster->funcs); f < n_f; ++f) {
+				func_t *func = &env.funcs[cluster->funcs[f]];
+				if (!func->cold)
+					ARR_APP1(ir_graph*, order, func->irg);
+			}
+		}
+		DEL_ARR_F(clusters);
+	} else {
+		for (size_t i = 0; i < n_irgs; ++i) {
+			if (!env.funcs[i].cold)
+				ARR_APP1(ir_graph*, order, env.funcs[i].irg);
+		}
+	}
+	for (size_t i = 0; i < n_irgs; ++i) {
+		if (env.funcs[i].cold)
+			ARR_APP1(ir_graph*, order, env.funcs[i].irg);
+	}
+	assert(ARR_LEN(order) == n_irgs);
+
+	if (report)
+		print_report(&env, order);
+
+	for (size_t i = 0; i < n_irgs; ++i) {
+		DEL_ARR_F(env.funcs[i].callers);
+		DEL_ARR_F(env.funcs[i].callees);
+		if (env.clusters != NULL && env.clusters[i].funcs != NULL)
+			DEL_ARR_F(env.clusters[i].funcs);
+	}
+	if (env.clusters != NULL)
+		DEL_ARR_F(env.clusters);
+	DEL_ARR_F(env.topo);
+	DEL_ARR_F(env.funcs);
+	pmap_destroy(env.indices);
+
+	return order;
+}
+
+BE_REGISTER_MODULE_CONSTRUCTOR(be_init_funcorder)
+void be_init_funcorder(void)
+{
+	lc_opt_entry_t *be_grp = lc_opt_get_grp(firm_opt_get_root(), "be");
+
+	lc_opt_add_table(be_grp, be_funcorder_options);
+
+	FIRM_DBG_REGISTER(dbg, "firm.be.funcorder");
+}
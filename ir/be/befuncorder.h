@@ -0,0 +1,25 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief       Ordering of the emitted functions.
+ */
+#ifndef FIRM_BE_BEFUNCORDER_H
+#define FIRM_BE_BEFUNCORDER_H
+
+#include "firm_types.h"
+
+/**
+ * Computes the order in which the graphs of the program are emitted. Needs
+ * the block execution frequencies of all graphs. Graphs executed rarely may
+ * be marked as cold in their be_irg_t, which places them in the section for
+ * rarely executed code.
+ *
+ * @return a flexible array containing all graphs of the program
+ */
+ir_graph **be_order_functions(void);
+
+#endif
@@ -29,6 +29,7 @@
 #include "bearch.h"
 #include "beemitter.h"
 #include "bedwarf.h"
+#include "beirg.h"
 
 /** by default, we generate assembler code for the Linux gas */
 object_file_format_t  be_gas_object_file_format = OBJECT_FILE_FORMAT_ELF;
@@ -78,6 +79,7 @@ static void emit_section_macho(be_gas_section_t section)
 		case GAS_SECTION_DEBUG_LINE:      name = "section __DWARF,__debug_line,regular,debug"; break;
 		case GAS_SECTION_DEBUG_PUBNAMES:  name = "section __DWARF,__debug_pubnames,regular,debug"; break;
 		case GAS_SECTION_DEBUG_FRAME:     name = "section __DWARF,__debug_frame,regular,debug"; break;
+		case GAS_SECTION_TEXT_UNLIKELY:   name = "section __TEXT,__text_cold,regular,pure_instructions"; break;
 		default: panic("unsupported scetion type 0x%X", section);
 		}
 	} else if (flags & GAS_SECTION_FLAG_COMDAT) {
@@ -115,8 +117,9 @@ static void emit_section_sparc(be_gas_section_t section, const ir_entity *entity
 		"debug_info",
 		"debug_abbrev",
 		"debug_line",
-		"debug_pubnames"
+		"debug_pubnames",
 		"debug_frame",
+		"text.unlikely",
 	};
 
 	if (current_section == section && !(section & GAS_SECTION_FLAG_COMDAT))
@@ -184,6 +187,7 @@ static void emit_section(be_gas_section_t section, const ir_entity *entity)
 		{ "debug_line",     "progbits", ""   },
 		{ "debug_pubnames", "progbits", ""   },
 		{ "debug_frame",    "progbits", ""   },
+		{ "text.unlikely",  "progbits", "ax" },
 	};
 
 	if (be_gas_object_file_format == OBJECT_FILE_FORMAT_MACH_O) {
@@ -261,6 +265,11 @@ static void emit_section(be_gas_section_t section, const ir_entity *entity)
 
 
 
+void be_gas_reset_section(void)
+{
+	current_section = (be_gas_section_t) -1;
+}
+
 void be_gas_emit_switch_section(be_gas_section_t section)
 {
 	/* you have to produce a switch_section call with entity manually
@@ -492,6 +501,16 @@ static void emit_visibility(const ir_entity *entity)
 	}
 }
 
+/**
+ * Returns true if the function was placed into the section for rarely
+ * executed code by the function ordering.
+ */
+static bool is_cold_function(const ir_entity *entity)
+{
+	ir_graph *irg = get_entity_irg(entity);
+	return irg != NULL && irg->be_data != NULL && be_birg_from_irg(irg)->cold;
+}
+
 void be_gas_emit_function_prolog(const ir_entity *entity, unsigned po2alignment, const parameter_dbg_info_t *parameter_infos)
 {
 	be_gas_section_t section;
@@ -499,6 +518,8 @@ void be_gas_emit_function_prolog(const ir_entity *entity, unsigned po2alignment,
 	be_dwarf_method_before(entity, parameter_infos);
 
 	section = determine_section(NULL, entity);
+	if (section == GAS_SECTION_TEXT && is_cold_function(entity))
+		section = GAS_SECTION_TEXT_UNLIKELY;
 	emit_section(section, entity);
 
 	/* write the begin line (makes the life easier for scripts parsing the
@@ -554,6 +575,16 @@ void be_gas_emit_function_prolog(const ir_entity *entity, unsigned po2alignment,
 	be_dwarf_method_begin();
 }
 
+/**
+ * Lets the block labels of the following code start at the next round
+ * number.
+ */
+static void advance_block_numbers(void)
+{
+	next_block_nr += 199;
+	next_block_nr -= next_block_nr % 100;
+}
+
 void be_gas_emit_function_epilog(const ir_entity *entity)
 {
 	be_dwarf_method_end();
@@ -577,8 +608,54 @@ void be_gas_emit_function_epilog(const ir_entity *entity)
 	be_emit_char('\n');
 	be_emit_write_line();
 
-	next_block_nr += 199;
-	next_block_nr -= next_block_nr % 100;
+	advance_block_numbers();
+}
+
+/**
+ * Emits the label of the cold part of a function.
+ */
+static void emit_cold_part_name(const ir_entity *entity)
+{
+	be_gas_emit_entity(entity);
+	be_emit_cstring(".cold");
+}
+
+void be_gas_emit_cold_part_prolog(const ir_entity *entity)
+{
+	emit_section(GAS_SECTION_TEXT_UNLIKELY, entity);
+
+	if (be_gas_object_file_format == OBJECT_FILE_FORMAT_ELF) {
+		be_emit_cstring("\t.type\t");
+		emit_cold_part_name(entity);
+		be_emit_cstring(", ");
+		be_emit_char(be_gas_elf_type_char);
+		be_emit_cstring("function\n");
+		be_emit_write_line();
+	}
+	emit_cold_part_name(entity);
+	be_emit_cstring(":\n");
+	be_emit_write_line();
+
+	be_dwarf_method_begin();
+}
+
+void be_gas_emit_cold_part_epilog(const ir_entity *entity)
+{
+	be_dwarf_method_part_end();
+
+	if (be_gas_object_file_format == OBJECT_FILE_FORMAT_ELF) {
+		be_emit_cstring("\t.size\t");
+		emit_cold_part_name(entity);
+		be_emit_cstring(", .-");
+		emit_cold_part_name(entity);
+		be_emit_char('\n');
+		be_emit_write_line();
+	}
+
+	be_emit_char('\n');
+	be_emit_write_line();
+
+	advance_block_numbers();
 }
 
 /**
@@ -32,7 +32,8 @@ typedef enum {
 	GAS_SECTION_DEBUG_LINE,      /**< dwarf debug line */
 	GAS_SECTION_DEBUG_PUBNAMES,  /**< dwarf pub names */
 	GAS_SECTION_DEBUG_FRAME,     /**< dwarf callframe infos */
-	GAS_SECTION_LAST = GAS_SECTION_DEBUG_FRAME,
+	GAS_SECTION_TEXT_UNLIKELY,   /**< rarely executed program code */
+	GAS_SECTION_LAST = GAS_SECTION_TEXT_UNLIKELY,
 	GAS_SECTION_TYPE_MASK    = 0xFF,
 
 	GAS_SECTION_FLAG_TLS     = 1 << 8,  /**< thread local flag */
@@ -70,6 +71,12 @@ extern char                 be_gas_elf_type_char;
  */
 void be_gas_emit_switch_section(be_gas_section_t section);
 
+/**
+ * Forgets the current output section, so the next section switch is emitted
+ * even if it selects the same section.
+ */
+void be_gas_reset_section(void);
+
 /**
  * emit assembler instructions necessary before starting function code
  */
@@ -79,6 +86,18 @@ void be_gas_emit_function_prolog(const ir_entity *entity,
 
 void be_gas_emit_function_epilog(const ir_entity *entity);
 
+/**
+ * Starts the cold part of a function in the section for rarely executed code.
+ * The function itself has to be closed with be_gas_emit_function_epilog()
+ * before.
+ */
+void be_gas_emit_cold_part_prolog(const ir_entity *entity);
+
+/**
+ * Ends the cold part of a function.
+ */
+void be_gas_emit_cold_part_epilog(const ir_entity *entity);
+
 char const *be_gas_get_private_prefix(void);
 
 /**
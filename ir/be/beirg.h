@@ -78,6 +78,13 @@ typedef struct be_irg_t {
 	                                                  in the irg obst, because it gets replaced
 	                                                  during code selection) */
 	void                      *isa_link;         /**< architecture specific per-graph data*/
+	unsigned                   n_reloads;        /**< reloads inserted by the spillers */
+	unsigned                   n_remats;         /**< values recomputed instead of reloaded */
+	size_t                     n_hot_blocks;     /**< blocks in the block schedule
+	                                                  before the cold part */
+	bool                       cold;             /**< the function is placed into
+	                                                  the section for rarely
+	                                                  executed code */
 } be_irg_t;
 
 static inline be_irg_t *be_birg_from_irg(const ir_graph *irg)
@@ -56,6 +56,8 @@
 #include "beirg.h"
 #include "bestack.h"
 #include "beemitter.h"
+#include "befuncorder.h"
+#include "becache.h"
 
 #define NEW_ID(s) new_id_from_chars(s, sizeof(s) - 1)
 
@@ -71,6 +73,7 @@ be_options_t be_options = {
 	"",                                /* ilp server */
 	"",                                /* ilp solver */
 	1,                                 /* verbose assembler output */
+	"",                                /* no compile cache */
 };
 
 /* back end instruction set architecture to use */
@@ -118,6 +121,7 @@ static const lc_opt_table_entry_t be_main_options[] = {
 
 	LC_OPT_ENT_STR("ilp.server", "the ilp server name", &be_options.ilp_server),
 	LC_OPT_ENT_STR("ilp.solver", "the ilp solver name", &be_options.ilp_solver),
+	LC_OPT_ENT_STR("cache", "directory of the compile cache for emitted functions", &be_options.cache_dir),
 	LC_OPT_LAST
 };
 
@@ -276,6 +280,7 @@ int be_parse_arg(const char *arg)
 		lc_opt_print_help_for_entry(be_grp, '-', stdout);
 		return -1;
 	}
+	be_cache_add_option(arg);
 	return lc_opt_from_single_arg(be_grp, arg);
 }
 
@@ -575,13 +580,23 @@ static void be_main_loop(FILE *file_handle, const char *cup_name)
 		be_timer_pop(T_EXECFREQ);
 	}
 
+	ir_graph **order = be_order_functions();
+
+	be_cache_begin_unit(&env);
+
 	/* For all graphs */
 	for (i = 0; i < num_irgs; ++i) {
-		ir_graph  *const irg    = get_irp_irg(i);
+		ir_graph  *const irg    = order[i];
 		ir_entity *const entity = get_irg_entity(irg);
 		if (get_entity_linkage(entity) & IR_LINKAGE_NO_CODEGEN)
 			continue;
 
+		/* reuse the code emitted for an identical graph before */
+		if (be_cache_emit_cached(irg)) {
+			be_free_birg(irg);
+			continue;
+		}
+
 		/* set the current graph (this is important for several firm functions) */
 		current_ir_graph = irg;
 
@@ -651,6 +666,9 @@ static void be_main_loop(FILE *file_handle, const char *cup_name)
 
 		dump(DUMP_SCHED, irg, "sched");
 
+		if (stat_ev_enabled)
+			stat_ev_dbl("bemain_sched_cycles", be_estimate_sched_cycles(irg));
+
 		/* check schedule */
 		be_timer_push(T_VERIFY);
 		be_sched_verify(irg, be_options.verify_option);
@@ -699,6 +717,8 @@ static void be_main_loop(FILE *file_handle, const char *cup_name)
 		be_allocate_registers(irg);
 
 		stat_ev_dbl("bemain_costs_before_ra", be_estimate_irg_costs(irg));
+		stat_ev_ull("bemain_reloads", be_birg_from_irg(irg)->n_reloads);
+		stat_ev_ull("bemain_remats", be_birg_from_irg(irg)->n_remats);
 
 		dump(DUMP_RA, irg, "ra");
 
@@ -734,6 +754,7 @@ static void be_main_loop(FILE *file_handle, const char *cup_name)
 		if (arch_env->impl->emit != NULL)
 			arch_env->impl->emit(irg);
 		be_timer_pop(T_EMIT);
+		be_cache_store(irg);
 
 		dump(DUMP_FINAL, irg, "end");
 
@@ -766,6 +787,8 @@ static void be_main_loop(FILE *file_handle, const char *cup_name)
 		be_free_birg(irg);
 		stat_ev_ctx_pop("bemain_irg");
 	}
+	DEL_ARR_F(order);
+	be_cache_end_unit();
 
 	be_gas_end_compilation_unit(&env);
 	be_emit_exit();
@@ -18,6 +18,8 @@
 void be_init_abi(void);
 void be_init_sched(void);
 void be_init_blocksched(void);
+void be_init_funcorder(void);
+void be_init_cache(void);
 void be_init_spill(void);
 void be_init_spilloptions(void);
 void be_init_listsched(void);
@@ -38,6 +40,7 @@ void be_init_copyilp2(void);
 void be_init_copynone(void);
 void be_init_copystat(void);
 void be_init_daemelspill(void);
+void be_init_loopspill(void);
 void be_init_dwarf(void);
 void be_init_arch_ia32(void);
 void be_init_arch_arm(void);
@@ -79,6 +82,8 @@ void be_init_modules(void)
 	be_init_spillslots();
 	be_init_sched();
 	be_init_blocksched();
+	be_init_funcorder();
+	be_init_cache();
 	be_init_spill();
 	be_init_spilloptions();
 
@@ -104,6 +109,7 @@ void be_init_modules(void)
 	be_init_ra();
 	be_init_spillbelady();
 	be_init_daemelspill();
+	be_init_loopspill();
 	be_init_dwarf();
 	be_init_ssaconstr();
 	be_init_pref_alloc();
@@ -688,6 +688,7 @@ ir_node *be_new_FrameAddr(const arch_register_class_t *cls_frame, ir_node *bl, i
 	a->base.exc.pin_state = op_pin_state_floats;
 	be_node_set_reg_class_in(irn, 0, cls_frame);
 	be_node_set_reg_class_out(irn, 0, cls_frame);
+	arch_set_irn_flags(irn, arch_irn_flags_rematerializable);
 
 	return optimize_node(irn);
 }
@@ -980,6 +981,7 @@ static const arch_irn_ops_t be_node_irn_ops = {
 	NULL,    /* get_op_estimated_cost   */
 	NULL,    /* possible_memory_operand */
 	NULL,    /* perform_memory_operand  */
+	NULL,    /* get_sched_insn          */
 };
 
 static int get_start_reg_index(ir_graph *irg, const arch_register_t *reg)
@@ -1044,6 +1046,7 @@ static const arch_irn_ops_t dummy_be_irn_ops = {
 	NULL,      /* get_op_estimated_cost */
 	NULL,      /* possible_memory_operand */
 	NULL,      /* perform_memory_operand */
+	NULL,      /* get_sched_insn */
 };
 
 
@@ -1116,6 +1119,7 @@ static const arch_irn_ops_t phi_irn_ops = {
 	NULL,    /* get_op_estimated_cost   */
 	NULL,    /* possible_memory_operand */
 	NULL,    /* perform_memory_operand  */
+	NULL,    /* get_sched_insn          */
 };
 
 
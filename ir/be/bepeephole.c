@@ -17,6 +17,7 @@
 #include "irgmod.h"
 #include "heights.h"
 #include "error.h"
+#include "statev_t.h"
 
 #include "beirg.h"
 #include "belive_t.h"
@@ -31,6 +32,8 @@ DEBUG_ONLY(static firm_dbg_module_t *dbg = NULL;)
 static const arch_env_t *arch_env;
 static be_lv_t          *lv;
 static ir_node          *current_node;
+static be_peephole_pattern_t **patterns_by_opcode;
+static be_peephole_pattern_t  *patterns_any;
 ir_node                **register_values;
 
 static void clear_reg_value(ir_node *node)
@@ -152,6 +155,86 @@ void be_peephole_exchange(ir_node *old, ir_node *nw)
 	be_liveness_introduce(lv, nw);
 }
 
+void be_peephole_remove(ir_node *node)
+{
+	DB((dbg, LEVEL_1, "Remove %+F\n", node));
+	assert(sched_is_scheduled(node));
+
+	if (current_node == node)
+		current_node = sched_next(node);
+
+	be_foreach_value(node, value,
+		if (!mode_is_data(get_irn_mode(value)))
+			continue;
+		const arch_register_t *reg = arch_get_irn_register(value);
+		if (register_values[reg->global_index] == value)
+			register_values[reg->global_index] = NULL;
+		be_liveness_remove(lv, value);
+	);
+
+	sched_remove(node);
+	kill_node(node);
+}
+
+void be_peephole_add_uses(ir_node *node)
+{
+	set_uses(node);
+}
+
+/**
+ * Collects the window of @p pattern ending at @p node.
+ * @return true if the window matches the opcodes of the pattern
+ */
+static bool match_window(const be_peephole_pattern_t *pattern, ir_node *node,
+                         ir_node **window)
+{
+	for (unsigned i = pattern->n_ops; i-- > 0;) {
+		if (i + 1 < pattern->n_ops) {
+			node = sched_prev(node);
+			if (sched_is_begin(node) || is_Phi(node))
+				return false;
+		}
+		if (pattern->ops[i] != NULL && get_irn_op(node) != pattern->ops[i])
+			return false;
+		window[i] = node;
+	}
+	return true;
+}
+
+/**
+ * Tries the patterns of the list @p patterns at @p node until one applies.
+ * @return true if a pattern was applied
+ */
+static bool apply_pattern_list(be_peephole_pattern_t *patterns, ir_node *node)
+{
+	ir_node *window[BE_PEEPHOLE_MAX_WINDOW];
+
+	for (be_peephole_pattern_t *pattern = patterns; pattern != NULL;
+	     pattern = pattern->next) {
+		if (!match_window(pattern, node, window))
+			continue;
+
+		DB((dbg, LEVEL_2, "try %s at %+F\n", pattern->name, node));
+		if (pattern->func(window)) {
+			DB((dbg, LEVEL_1, "applied %s at %+F\n", pattern->name, node));
+			++pattern->hits;
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Tries the patterns ending with the opcode of @p node and then the ones
+ * ending with any node until one applies.
+ */
+static void apply_patterns(ir_node *node)
+{
+	if (apply_pattern_list(patterns_by_opcode[get_irn_opcode(node)], node))
+		return;
+	apply_pattern_list(patterns_any, node);
+}
+
 /**
  * block-walker: run peephole optimization on the given block.
  */
@@ -183,6 +266,12 @@ static void process_block(ir_node *block, void *data)
 		clear_defs(current_node);
 		set_uses(current_node);
 
+		if (patterns_by_opcode != NULL) {
+			apply_patterns(current_node);
+			assert(!is_Bad(current_node));
+			continue;
+		}
+
 		op            = get_irn_op(current_node);
 		peephole_node = (peephole_opt_func)op->ops.generic;
 		if (peephole_node == NULL)
@@ -411,6 +500,34 @@ void be_peephole_opt(ir_graph *irg)
 	free(register_values);
 }
 
+void be_peephole_opt_patterns(ir_graph *irg, be_peephole_pattern_t *patterns,
+                              size_t n_patterns)
+{
+	patterns_by_opcode = XMALLOCNZ(be_peephole_pattern_t*, ir_get_n_opcodes());
+
+	/* chain the patterns by their last opcode, keeping their order */
+	for (size_t i = n_patterns; i-- > 0;) {
+		be_peephole_pattern_t  *pattern = &patterns[i];
+		assert(pattern->n_ops > 0 && pattern->n_ops <= BE_PEEPHOLE_MAX_WINDOW);
+		ir_op                  *op      = pattern->ops[pattern->n_ops - 1];
+		be_peephole_pattern_t **list    = op != NULL
+			? &patterns_by_opcode[get_op_code(op)] : &patterns_any;
+
+		pattern->hits = 0;
+		pattern->next = *list;
+		*list         = pattern;
+	}
+
+	be_peephole_opt(irg);
+
+	for (size_t i = 0; i < n_patterns; ++i)
+		stat_ev_int(patterns[i].name, patterns[i].hits);
+
+	free(patterns_by_opcode);
+	patterns_by_opcode = NULL;
+	patterns_any       = NULL;
+}
+
 BE_REGISTER_MODULE_CONSTRUCTOR(be_init_peephole)
 void be_init_peephole(void)
 {
@@ -31,6 +31,33 @@ static inline ir_node *be_peephole_get_reg_value(const arch_register_t *reg)
  */
 typedef void (*peephole_opt_func) (ir_node *node);
 
+/** Maximum number of nodes in the window of a peephole pattern. */
+#define BE_PEEPHOLE_MAX_WINDOW 4
+
+/**
+ * Rewrite function of a peephole pattern. @p window contains the matched
+ * nodes in schedule order, the last one is the node currently looked at.
+ *
+ * @return true if the pattern was applied, false if it did not fit
+ */
+typedef bool (*be_peephole_pattern_func)(ir_node **window);
+
+typedef struct be_peephole_pattern_t be_peephole_pattern_t;
+
+/**
+ * A peephole pattern matching a window of consecutively scheduled nodes
+ * ending at the node currently looked at. Patterns ending with a fixed
+ * opcode are tried before the ones ending with any node.
+ */
+struct be_peephole_pattern_t {
+	const char               *name;   /**< name used for statistics */
+	be_peephole_pattern_func  func;   /**< the rewrite function */
+	unsigned                  n_ops;  /**< number of nodes in the window */
+	ir_op                    *ops[BE_PEEPHOLE_MAX_WINDOW]; /**< opcodes of the window, NULL matches any node */
+	unsigned                  hits;   /**< number of times the pattern was applied */
+	be_peephole_pattern_t    *next;   /**< next pattern ending with the same opcode */
+};
+
 /**
  * When doing peephole optimisation use this function instead of plain
  * exchange(), so it can update its internal state.  This function also removes
@@ -48,6 +75,18 @@ void be_peephole_exchange(ir_node *old, ir_node *nw);
  */
 ir_node *be_peephole_IncSP_IncSP(ir_node *node);
 
+/**
+ * Removes @p node, whose values must not be used anymore, from the schedule.
+ * Must be run from a be_peephole_opt() context.
+ */
+void be_peephole_remove(ir_node *node);
+
+/**
+ * Marks the values used by @p node as live. Call this after adding inputs
+ * to the node currently looked at.
+ */
+void be_peephole_add_uses(ir_node *node);
+
 bool be_has_only_one_user(ir_node *node);
 
 /**
@@ -74,4 +113,14 @@ bool be_can_move_up(ir_heights_t *heights, const ir_node *node,
  */
 void be_peephole_opt(ir_graph *irg);
 
+/**
+ * Do peephole optimisations driven by patterns instead of the generic op
+ * handlers. The schedule is traversed like in be_peephole_opt(); at each
+ * node the patterns ending with its opcode and then the patterns ending with
+ * ANY are tried, each group in the given order, until one applies. The hit counters of the patterns are reset and reported
+ * as statistic events.
+ */
+void be_peephole_opt_patterns(ir_graph *irg, be_peephole_pattern_t *patterns,
+                              size_t n_patterns);
+
 #endif
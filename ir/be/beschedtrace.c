@@ -18,6 +18,8 @@
 #include "benode.h"
 #include "belive.h"
 #include "bemodule.h"
+#include "bearch.h"
+#include "util.h"
 
 /* we need a special mark */
 static char _mark;
@@ -30,13 +32,18 @@ typedef struct trace_irn {
 	int      reg_diff;           /**< The difference of num(out registers) - num(in registers) */
 	int      preorder;           /**< The pre-order position */
 	unsigned critical_path_len;  /**< The weighted length of the longest critical path */
+	arch_sched_insn_t insn;      /**< machine model description of the node */
 	unsigned is_root       : 1;  /**< is a root node of a block */
+	unsigned has_insn      : 1;  /**< insn was queried from the backend */
 } trace_irn_t;
 
 typedef struct trace_env {
 	trace_irn_t      *sched_info;               /**< trace scheduling information about the nodes */
 	sched_timestep_t curr_time;                 /**< current time of the scheduler */
 	be_lv_t          *liveness;                 /**< The liveness for the irg */
+	const arch_machine_t *machine;              /**< the machine model or NULL */
+	sched_timestep_t port_free[32];             /**< time when each port can accept
+	                                                 the next instruction */
 	DEBUG_ONLY(firm_dbg_module_t *dbg;)
 } trace_env_t;
 
@@ -202,8 +209,25 @@ static inline void set_irn_critical_path_len(trace_env_t *env, ir_node *n, unsig
 	env->sched_info[idx].critical_path_len = len;
 }
 
+/**
+ * Returns the machine model description of node n.
+ */
+static const arch_sched_insn_t *get_irn_insn(trace_env_t *env, ir_node *n)
+{
+	unsigned const idx = get_irn_idx(n);
+	assert(idx < ARR_LEN(env->sched_info));
+	trace_irn_t *const info = &env->sched_info[idx];
+	if (!info->has_insn) {
+		arch_get_sched_insn(n, &info->insn);
+		info->has_insn = 1;
+	}
+	return &info->insn;
+}
+
 /**
  * returns the exec-time for node n.
+ * With a machine model, time is counted in issue slots, so a cycle has
+ * issue_width timesteps.
  */
 static sched_timestep_t exectime(trace_env_t *env, ir_node *n)
 {
@@ -213,6 +237,16 @@ static sched_timestep_t exectime(trace_env_t *env, ir_node *n)
 	return 1;
 }
 
+/**
+ * Returns the time until the results of node n are available.
+ */
+static sched_timestep_t result_latency(trace_env_t *env, ir_node *n)
+{
+	if (env->machine == NULL || be_is_Keep(n) || is_Proj(n))
+		return exectime(env, n);
+	return get_irn_insn(env, n)->latency * env->machine->issue_width;
+}
+
 /**
  * Calculates the latency for between two ops
  */
@@ -228,7 +262,69 @@ static sched_timestep_t latency(trace_env_t *env, ir_node *pred, int pred_cycle,
 	if (is_Proj(curr))
 		return 0;
 
-	return 1;
+	if (env->machine == NULL)
+		return 1;
+
+	/* data results of a tuple are available after its latency, memory and
+	 * control flow orders only need the producer to be issued */
+	if (is_Proj(pred)) {
+		if (!mode_is_datab(get_irn_mode(pred)))
+			return 1;
+		pred = get_Proj_pred(pred);
+	}
+	return result_latency(env, pred);
+}
+
+/**
+ * Returns the first time a port able to execute node n is free.
+ */
+static sched_timestep_t get_port_time(trace_env_t *env, ir_node *n)
+{
+	if (env->machine == NULL || exectime(env, n) == 0)
+		return 0;
+
+	unsigned const   ports = get_irn_insn(env, n)->ports;
+	sched_timestep_t best  = UINT_MAX;
+	for (unsigned p = 0; p < env->machine->n_ports; ++p) {
+		if ((ports & (1u << p)) && env->port_free[p] < best)
+			best = env->port_free[p];
+	}
+	return best == UINT_MAX ? 0 : best;
+}
+
+/**
+ * Returns the earliest time node n could be issued considering its operands
+ * and the occupation of the execution ports.
+ */
+static sched_timestep_t get_irn_ready_time(trace_env_t *env, ir_node *n)
+{
+	sched_timestep_t etime = get_irn_etime(env, n);
+	sched_timestep_t ptime = get_port_time(env, n);
+	return MAX(etime, ptime);
+}
+
+/**
+ * Occupies the best port for node n which is issued at the current time and
+ * returns the issue time.
+ */
+static sched_timestep_t reserve_port(trace_env_t *env, ir_node *n)
+{
+	unsigned const           width = env->machine->issue_width;
+	arch_sched_insn_t const *insn  = get_irn_insn(env, n);
+	unsigned                 best  = env->machine->n_ports;
+
+	for (unsigned p = 0; p < env->machine->n_ports; ++p) {
+		if ((insn->ports & (1u << p))
+		    && (best == env->machine->n_ports
+		        || env->port_free[p] < env->port_free[best]))
+			best = p;
+	}
+	if (best == env->machine->n_ports)
+		return env->curr_time;
+
+	sched_timestep_t const issue = MAX(env->curr_time, env->port_free[best]);
+	env->port_free[best] = issue + insn->rthroughput * width;
+	return issue;
 }
 
 /**
@@ -314,7 +410,7 @@ static void descent(ir_node *root, ir_node *block, ir_node **list, trace_env_t *
 	int i;
 
 	if (! is_Phi(root)) {
-		path_len += exectime(env, root);
+		path_len += result_latency(env, root);
 		if (get_irn_critical_path_len(env, root) < path_len) {
 			set_irn_critical_path_len(env, root, path_len);
 		}
@@ -471,6 +567,9 @@ static void trace_update_time(void *data, ir_node *irn)
 		env->curr_time += get_irn_etime(env, irn);
 	}
 	else {
+		/* in-order issue: wait for a free port */
+		if (env->machine != NULL && exectime(env, irn) > 0)
+			env->curr_time = reserve_port(env, irn);
 		env->curr_time += exectime(env, irn);
 	}
 }
@@ -488,6 +587,8 @@ static trace_env_t *trace_init(ir_graph *irg)
 	env->curr_time  = 0;
 	env->sched_info = NEW_ARR_FZ(trace_irn_t, nn);
 	env->liveness   = be_get_irg_liveness(irg);
+	env->machine    = be_get_irg_arch_env(irg)->machine;
+	assert(env->machine == NULL || env->machine->n_ports <= ARRAY_SIZE(env->port_free));
 	FIRM_DBG_REGISTER(env->dbg, "firm.be.sched.trace");
 
 	be_assure_live_chk(irg);
@@ -545,7 +646,7 @@ static ir_node *muchnik_select(void *block_env, ir_nodeset_t *ready_set)
 	foreach_ir_nodeset(ready_set, irn, iter) {
 		if (get_irn_delay(env, irn) == max_delay) {
 			ir_nodeset_insert(&mcands, irn);
-			if (get_irn_etime(env, irn) <= env->curr_time)
+			if (get_irn_ready_time(env, irn) <= env->curr_time)
 				ir_nodeset_insert(&ecands, irn);
 		}
 	}
@@ -652,7 +753,7 @@ static ir_node *heuristic_select(void *block_env, ir_nodeset_t *ns)
 			cur_prio = (get_irn_critical_path_len(trace_env, irn) << PRIO_LEVEL)
 				//- (get_irn_delay(trace_env, irn) << PRIO_LEVEL)
 				+ (get_irn_num_user(trace_env, irn) << PRIO_NUMSUCCS)
-				- (get_irn_etime(trace_env, irn) << PRIO_TIME)
+				- (get_irn_ready_time(trace_env, irn) << PRIO_TIME)
 				//- ((get_irn_reg_diff(trace_env, irn) >> PRIO_CHG_PRESS) << ((cur_pressure >> PRIO_CUR_PRESS) - 3))
 				- reg_fact
 				+ (get_irn_preorder(trace_env, irn) << PRIO_PREORD); /* high preorder means early schedule */
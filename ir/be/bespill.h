@@ -47,6 +47,15 @@ void be_register_spiller(const char *name, be_spiller_t *spiller);
  */
 void be_do_spill(ir_graph *irg, const arch_register_class_t *cls);
 
+/**
+ * Belady's spill algorithm. Exported so spillers making global decisions
+ * can leave the remaining block-local work to it.
+ *
+ * @param irg   the graph to spill on
+ * @param cls   the register class to spill
+ */
+void be_spill_belady(ir_graph *irg, const arch_register_class_t *cls);
+
 /**
  * Adds additional copies, so constraints needing additional registers to be
  * solved correctly induce the additional register pressure.
@@ -919,7 +919,7 @@ static void fix_block_borders(ir_node *block, void *data)
 	}
 }
 
-static void be_spill_belady(ir_graph *irg, const arch_register_class_t *rcls)
+void be_spill_belady(ir_graph *irg, const arch_register_class_t *rcls)
 {
 	int i;
 
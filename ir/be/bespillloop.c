@@ -0,0 +1,442 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief       Loop-aware global spilling.
+ * @brief
+ *   Belady spills block-locally and fixes the block borders afterwards, so a
+ *   value that is merely live across a loop is often evicted somewhere
+ *   inside the loop and reloaded in its body.
+ *
+ *   This spiller first walks the loop tree from the outside in. Whenever the
+ *   register pressure of a loop exceeds the number of registers, values that
+ *   are live through the loop without being used in it are spilled around
+ *   the whole loop: the spill is placed behind the definition (outside the
+ *   loop) and the value is reloaded (or rematerialized) at the loop exits.
+ *   Candidates are chosen by their execution frequency weighted spill and
+ *   reload costs and are only taken if that is cheaper than a single reload
+ *   at the loop header. The remaining pressure is then handled by Belady on
+ *   the rewritten graph.
+ */
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "debug.h"
+#include "array.h"
+#include "bitset.h"
+#include "irloop.h"
+#include "iredges_t.h"
+#include "statev_t.h"
+#include "error.h"
+
+#include "beirg.h"
+#include "bespill.h"
+#include "bespillutil.h"
+#include "beloopana.h"
+#include "bemodule.h"
+#include "besched.h"
+#include "bearch.h"
+#include "be_t.h"
+#include "benode.h"
+#include "belive_t.h"
+
+DEBUG_ONLY(static firm_dbg_module_t *dbg = NULL;)
+
+static spill_env_t                 *spill_env;
+static be_loopana_t                *loop_ana;
+static unsigned                     n_regs;
+static const arch_register_class_t *cls;
+static const be_lv_t               *lv;
+static bitset_t                    *spilled_around; /**< values spilled around
+                                                         an enclosing loop */
+static bitset_t                    *spilled_nodes;  /**< values spilled at
+                                                         all */
+static unsigned                     n_loop_spills;
+static unsigned                     n_loop_reloads;
+
+typedef struct loop_candidate_t {
+	double   costs;
+	ir_node *node;
+	bool     used_inside; /**< reloaded in front of its uses in the loop */
+} loop_candidate_t;
+
+static int compare_loop_candidates(const void *d1, const void *d2)
+{
+	const loop_candidate_t *c1 = (const loop_candidate_t*)d1;
+	const loop_candidate_t *c2 = (const loop_candidate_t*)d2;
+
+	/* values live through the loop go first */
+	if (c1->used_inside != c2->used_inside)
+		return c1->used_inside ? 1 : -1;
+	if (c1->costs < c2->costs)
+		return -1;
+	if (c1->costs > c2->costs)
+		return 1;
+	return (int)get_irn_idx(c1->node) - (int)get_irn_idx(c2->node);
+}
+
+/**
+ * Returns true if @p block is part of @p loop or one of its sub-loops.
+ */
+static bool block_in_loop(const ir_node *block, const ir_loop *loop)
+{
+	unsigned depth = get_loop_depth(loop);
+	ir_loop *l     = get_irn_loop(block);
+
+	while (l != NULL && get_loop_depth(l) > depth)
+		l = get_loop_outer_loop(l);
+	return l == loop;
+}
+
+static void collect_loop_blocks(ir_loop *loop, ir_node ***blocks)
+{
+	for (size_t i = 0, n = get_loop_n_elements(loop); i < n; ++i) {
+		loop_element elem = get_loop_element(loop, i);
+
+		if (*elem.kind == k_ir_node) {
+			ARR_APP1(ir_node*, *blocks, elem.node);
+		} else {
+			assert(*elem.kind == k_ir_loop);
+			collect_loop_blocks(elem.son, blocks);
+		}
+	}
+}
+
+static bool has_sub_loops(const ir_loop *loop)
+{
+	for (size_t i = 0, n = get_loop_n_elements(loop); i < n; ++i) {
+		if (*get_loop_element(loop, i).kind == k_ir_loop)
+			return true;
+	}
+	return false;
+}
+
+/**
+ * Returns the place in @p block where a value entering the block is
+ * reloaded: behind the Phis and the Keeps attached to them.
+ */
+static ir_node *get_reload_point(ir_node *block)
+{
+	sched_foreach(block, node) {
+		if (!is_Phi(node) && !be_is_Keep(node) && !be_is_CopyKeep(node))
+			return node;
+	}
+	panic("no reload point in %+F", block);
+}
+
+/**
+ * Returns true if @p node is used inside @p loop. Phi uses count for the
+ * predecessor block they are coming from.
+ */
+static bool is_used_in_loop(const ir_node *node, const ir_loop *loop)
+{
+	foreach_out_edge(node, edge) {
+		ir_node *use = get_edge_src_irn(edge);
+		ir_node *block;
+
+		if (is_Anchor(use))
+			continue;
+		if (is_Phi(use)) {
+			int pos = get_edge_src_pos(edge);
+			block = get_Block_cfgpred_block(get_nodes_block(use), pos);
+		} else {
+			block = get_nodes_block(use);
+		}
+		if (block_in_loop(block, loop))
+			return true;
+	}
+	return false;
+}
+
+/**
+ * Calculates the frequency weighted costs of reloading @p node in front of
+ * each of its uses inside @p loop. Returns a negative value if the node is
+ * kept alive inside the loop.
+ */
+static double get_reload_costs_in_loop(ir_node *node, const ir_loop *loop)
+{
+	double costs = 0;
+	foreach_out_edge(node, edge) {
+		ir_node *use = get_edge_src_irn(edge);
+		if (is_Anchor(use))
+			continue;
+
+		if (is_Phi(use)) {
+			int      pos   = get_edge_src_pos(edge);
+			ir_node *block = get_nodes_block(use);
+			if (!block_in_loop(get_Block_cfgpred_block(block, pos), loop))
+				continue;
+			costs += be_get_reload_costs_on_edge(spill_env, node, block, pos);
+		} else {
+			if (!block_in_loop(get_nodes_block(use), loop))
+				continue;
+			if (be_is_Keep(use))
+				return -1;
+			costs += be_get_reload_costs(spill_env, node, use);
+		}
+	}
+	return costs;
+}
+
+static void add_reloads_in_loop(ir_node *node, const ir_loop *loop)
+{
+	foreach_out_edge(node, edge) {
+		ir_node *use = get_edge_src_irn(edge);
+		if (is_Anchor(use))
+			continue;
+
+		if (is_Phi(use)) {
+			int      pos   = get_edge_src_pos(edge);
+			ir_node *block = get_nodes_block(use);
+			if (!block_in_loop(get_Block_cfgpred_block(block, pos), loop))
+				continue;
+			be_add_reload_on_edge(spill_env, node, block, pos, cls, 1);
+		} else {
+			if (!block_in_loop(get_nodes_block(use), loop))
+				continue;
+			be_add_reload(spill_env, node, use, cls, 1);
+		}
+		++n_loop_reloads;
+	}
+}
+
+/**
+ * Calculates the frequency weighted costs of spilling @p node in front of
+ * the loop and reloading it at the loop exits.
+ */
+static double get_spill_around_costs(ir_node *node, ir_node **exits)
+{
+	double costs = 0;
+
+	/* the spill behind the definition is shared by all loops */
+	if (!bitset_is_set(spilled_nodes, get_irn_idx(node)))
+		costs += be_get_spill_costs(spill_env, node, skip_Proj(node));
+
+	for (size_t i = 0, n = ARR_LEN(exits); i < n; ++i) {
+		ir_node *exit = exits[i];
+		if (!be_is_live_in(lv, exit, node))
+			continue;
+		costs += be_get_reload_costs(spill_env, node, get_reload_point(exit));
+	}
+	return costs;
+}
+
+static void spill_around_loop(const loop_candidate_t *candidate,
+                              const ir_loop *loop, ir_node **exits)
+{
+	ir_node *node = candidate->node;
+	if (candidate->used_inside)
+		add_reloads_in_loop(node, loop);
+
+	for (size_t i = 0, n = ARR_LEN(exits); i < n; ++i) {
+		ir_node *exit = exits[i];
+		if (!be_is_live_in(lv, exit, node))
+			continue;
+		be_add_reload(spill_env, node, get_reload_point(exit), cls, 1);
+		++n_loop_reloads;
+	}
+
+	bitset_set(spilled_around, get_irn_idx(node));
+	bitset_set(spilled_nodes, get_irn_idx(node));
+	++n_loop_spills;
+}
+
+/**
+ * Spills the cheapest values live through @p loop until @p excess values are
+ * gone. Values without a use inside the loop are preferred, loop invariants
+ * used in an innermost loop are reloaded in front of their uses.
+ */
+static unsigned spill_live_through(ir_loop *loop, ir_node *header,
+                                   ir_node **exits, unsigned excess,
+                                   ir_node ***spilled)
+{
+	ir_node          *header_point = get_reload_point(header);
+	bool              innermost    = !has_sub_loops(loop);
+	loop_candidate_t *candidates   = NEW_ARR_F(loop_candidate_t, 0);
+	be_lv_foreach_cls(lv, header, be_lv_state_in, cls, node) {
+		if (bitset_is_set(spilled_around, get_irn_idx(node)))
+			continue;
+		if (arch_irn_is(skip_Proj_const(node), dont_spill))
+			continue;
+		if (block_in_loop(get_nodes_block(node), loop))
+			continue;
+
+		double costs       = get_spill_around_costs(node, exits);
+		bool   used_inside = is_used_in_loop(node, loop);
+		if (used_inside) {
+			/* reloads in outer loops would end up in the inner loops,
+			 * belady handles those better */
+			if (!innermost)
+				continue;
+			double inside = get_reload_costs_in_loop(node, loop);
+			if (inside < 0)
+				continue;
+			costs += inside;
+		} else {
+			/* leave it to belady if a reload inside the loop is cheaper */
+			double inside = be_get_reload_costs(spill_env, node, header_point);
+			if (costs >= inside)
+				continue;
+		}
+		DB((dbg, LEVEL_3, "\tcandidate %+F costs %f%s\n", node, costs,
+		    used_inside ? " (used inside)" : ""));
+
+		loop_candidate_t candidate = { costs, node, used_inside };
+		ARR_APP1(loop_candidate_t, candidates, candidate);
+	}
+
+	qsort(candidates, ARR_LEN(candidates), sizeof(candidates[0]),
+	      compare_loop_candidates);
+
+	unsigned n_spilled = 0;
+	for (size_t c = 0, n_candidates = ARR_LEN(candidates);
+	     c < n_candidates && n_spilled < excess; ++c) {
+		ir_node *node = candidates[c].node;
+
+		DB((dbg, LEVEL_2, "\tspill %+F around loop %ld (costs %f)\n", node,
+		    get_loop_loop_nr(loop), candidates[c].costs));
+		spill_around_loop(&candidates[c], loop, exits);
+		ARR_APP1(ir_node*, *spilled, node);
+		++n_spilled;
+	}
+	DEL_ARR_F(candidates);
+	return n_spilled;
+}
+
+/**
+ * Spills values around @p loop until its register pressure fits into the
+ * available registers or no cheap candidates are left.
+ *
+ * @param removed  number of values already spilled around enclosing loops
+ * @return the number of values spilled around @p loop
+ */
+static unsigned process_loop(ir_loop *loop, unsigned removed,
+                             ir_node ***spilled)
+{
+	unsigned pressure = be_get_loop_pressure(loop_ana, cls, loop);
+	if (pressure <= removed || pressure - removed <= n_regs)
+		return 0;
+
+	DB((dbg, LEVEL_1, "loop %ld: pressure %u (%u removed), %u regs\n",
+	    get_loop_loop_nr(loop), pressure, removed, n_regs));
+
+	ir_node **blocks = NEW_ARR_F(ir_node*, 0);
+	collect_loop_blocks(loop, &blocks);
+
+	/* determine the loop header and the blocks behind the loop exits */
+	ir_node  *header       = NULL;
+	ir_node **exits        = NEW_ARR_F(ir_node*, 0);
+	bool      single_entry = true;
+	for (size_t b = 0, n_blocks = ARR_LEN(blocks); b < n_blocks; ++b) {
+		ir_node *block = blocks[b];
+
+		for (int i = 0, arity = get_Block_n_cfgpreds(block); i < arity; ++i) {
+			ir_node *pred = get_Block_cfgpred_block(block, i);
+			if (pred == NULL || block_in_loop(pred, loop))
+				continue;
+			if (header != NULL && header != block)
+				single_entry = false;
+			header = block;
+		}
+
+		foreach_block_succ(block, edge) {
+			ir_node *succ = get_edge_src_irn(edge);
+			if (block_in_loop(succ, loop))
+				continue;
+
+			bool found = false;
+			for (size_t e = 0, n_exits = ARR_LEN(exits); e < n_exits; ++e) {
+				if (exits[e] == succ) {
+					found = true;
+					break;
+				}
+			}
+			if (!found)
+				ARR_APP1(ir_node*, exits, succ);
+		}
+	}
+	DEL_ARR_F(blocks);
+
+	/* irreducible loops may be entered behind the reloads */
+	unsigned n_spilled = 0;
+	if (header != NULL && single_entry) {
+		n_spilled = spill_live_through(loop, header, exits,
+		                               pressure - removed - n_regs, spilled);
+	} else {
+		DB((dbg, LEVEL_2, "\tloop has no single entry, skipping\n"));
+	}
+
+	DEL_ARR_F(exits);
+	return n_spilled;
+}
+
+static void process_loop_tree(ir_loop *loop, unsigned removed)
+{
+	ir_node **spilled = NEW_ARR_F(ir_node*, 0);
+	removed += process_loop(loop, removed, &spilled);
+
+	for (size_t i = 0, n = get_loop_n_elements(loop); i < n; ++i) {
+		loop_element elem = get_loop_element(loop, i);
+		if (*elem.kind == k_ir_loop)
+			process_loop_tree(elem.son, removed);
+	}
+
+	/* sibling loops may spill these values around themselves again */
+	for (size_t i = 0, n = ARR_LEN(spilled); i < n; ++i) {
+		bitset_clear(spilled_around, get_irn_idx(spilled[i]));
+	}
+	DEL_ARR_F(spilled);
+}
+
+static void be_spill_loop(ir_graph *irg, const arch_register_class_t *new_cls)
+{
+	be_assure_live_sets(irg);
+	assure_loopinfo(irg);
+
+	cls            = new_cls;
+	n_regs         = be_get_n_allocatable_regs(irg, cls);
+	lv             = be_get_irg_liveness(irg);
+	spill_env      = be_new_spill_env(irg);
+	loop_ana       = be_new_loop_pressure(irg, cls);
+	spilled_around = bitset_malloc(get_irg_last_idx(irg));
+	spilled_nodes  = bitset_malloc(get_irg_last_idx(irg));
+	n_loop_spills  = 0;
+	n_loop_reloads = 0;
+
+	DBG((dbg, LEVEL_1, "*** RegClass %s\n", cls->name));
+
+	/* the outermost loop is the whole graph, nothing to spill around */
+	ir_loop *root = get_irg_loop(irg);
+	for (size_t i = 0, n = get_loop_n_elements(root); i < n; ++i) {
+		loop_element elem = get_loop_element(root, i);
+		if (*elem.kind == k_ir_loop)
+			process_loop_tree(elem.son, 0);
+	}
+
+	stat_ev_dbl("spill_loop_values", n_loop_spills);
+	stat_ev_dbl("spill_loop_reloads", n_loop_reloads);
+
+	free(spilled_nodes);
+	free(spilled_around);
+	be_free_loop_pressure(loop_ana);
+
+	be_insert_spills_reloads(spill_env);
+	be_delete_spill_env(spill_env);
+
+	/* the remaining pressure is block-local, leave it to belady */
+	be_spill_belady(irg, cls);
+}
+
+BE_REGISTER_MODULE_CONSTRUCTOR(be_init_loopspill)
+void be_init_loopspill(void)
+{
+	static be_spiller_t loop_spiller = {
+		be_spill_loop
+	};
+
+	be_register_spiller("loop", &loop_spiller);
+	FIRM_DBG_REGISTER(dbg, "firm.be.spill.loop");
+}
@@ -9,6 +9,7 @@
  * @author      Matthias Braun
  * @date        26.07.2006
  */
+#include <stdint.h>
 #include <stdlib.h>
 
 #include "set.h"
@@ -18,6 +19,10 @@
 #include "execfreq.h"
 #include "unionfind.h"
 #include "irdump_t.h"
+#include "irdom.h"
+#include "iredges_t.h"
+#include "pqueue.h"
+#include "xmalloc.h"
 
 #include "benode.h"
 #include "besched.h"
@@ -26,7 +31,6 @@
 #include "bechordal_t.h"
 #include "statev_t.h"
 #include "bemodule.h"
-#include "beintlive_t.h"
 #include "beirg.h"
 #include "bearch.h"
 #include "bespillutil.h"
@@ -169,165 +173,337 @@ void be_node_needs_frame_entity(be_fec_env_t *env, ir_node *node,
 	ARR_APP1(ir_node *, env->reloads, node);
 }
 
-static int merge_interferences(be_fec_env_t *env, bitset_t** interferences,
-                               int* spillslot_unionfind, int s1, int s2)
+/**
+ * A half-open range [from, to) of program points in which a spilled value
+ * occupies its spillslot.
+ */
+typedef struct live_segment_t {
+	unsigned from;
+	unsigned to;
+} live_segment_t;
+
+/**
+ * Linearisation of the program used to build the live segments. Blocks are
+ * numbered in dominance tree preorder so the live range of a value lies
+ * within the number range of the dominance subtree of its definition.
+ * Every node at position p uses its operands at point 2p and defines its
+ * results at point 2p+1.
+ */
+typedef struct coalesce_env_t {
+	be_fec_env_t     *env;
+	unsigned         *points;     /**< position of nodes and block begins */
+	unsigned         *block_ends; /**< position of block ends */
+	unsigned          n_points;
+	ir_node         **worklist;
+	live_segment_t   *segments;   /**< segments of the value in progress */
+	ir_node          *def_block;
+	unsigned          def_point;
+} coalesce_env_t;
+
+static void number_block(ir_node *block, void *data)
 {
-	int res;
-	size_t spillcount;
-	size_t i;
+	coalesce_env_t *cenv = (coalesce_env_t*)data;
 
-	/* merge spillslots and interferences */
-	res = uf_union(spillslot_unionfind, s1, s2);
-	/* we assume that we always merge s2 to s1 so swap s1, s2 if necessary */
-	if (res != s1) {
-		int t = s1;
-		s1 = s2;
-		s2 = t;
+	cenv->points[get_irn_idx(block)] = cenv->n_points++;
+	sched_foreach(block, node) {
+		cenv->points[get_irn_idx(node)] = cenv->n_points++;
 	}
+	cenv->block_ends[get_irn_idx(block)] = cenv->n_points++;
+}
 
-	bitset_or(interferences[s1], interferences[s2]);
+static unsigned get_block_begin_point(const coalesce_env_t *cenv,
+                                      const ir_node *block)
+{
+	return 2 * cenv->points[get_irn_idx(block)];
+}
 
-	/* update other interferences */
-	spillcount = ARR_LEN(env->spills);
-	for (i = 0; i < spillcount; ++i) {
-		bitset_t *intfs = interferences[i];
-		if (bitset_is_set(intfs, s2))
-			bitset_set(intfs, s1);
+static unsigned get_block_end_point(const coalesce_env_t *cenv,
+                                    const ir_node *block)
+{
+	return 2 * cenv->block_ends[get_irn_idx(block)] + 1;
+}
+
+static unsigned get_def_point(const coalesce_env_t *cenv, const ir_node *node)
+{
+	node = skip_Proj_const(node);
+	if (is_Phi(node) || !sched_is_scheduled(node))
+		return get_block_begin_point(cenv, get_nodes_block(node)) + 1;
+	return 2 * cenv->points[get_irn_idx(node)] + 1;
+}
+
+static unsigned get_use_point(const coalesce_env_t *cenv, const ir_node *node)
+{
+	if (!sched_is_scheduled(node))
+		return get_block_end_point(cenv, get_nodes_block(node)) - 1;
+	return 2 * cenv->points[get_irn_idx(node)];
+}
+
+static void add_segment(coalesce_env_t *cenv, unsigned from, unsigned to)
+{
+	live_segment_t segment = { from, to };
+	assert(from < to);
+	ARR_APP1(live_segment_t, cenv->segments, segment);
+}
+
+static void add_live_out_preds(coalesce_env_t *cenv, ir_node *block)
+{
+	int arity = get_Block_n_cfgpreds(block);
+	int i;
+	for (i = 0; i < arity; ++i) {
+		ir_node *pred = get_Block_cfgpred_block(block, i);
+		if (pred == NULL || Block_block_visited(pred))
+			continue;
+		mark_Block_block_visited(pred);
+		ARR_APP1(ir_node*, cenv->worklist, pred);
 	}
+}
 
-	return res;
+static void add_use(coalesce_env_t *cenv, ir_node *block, unsigned point)
+{
+	if (block == cenv->def_block && point > cenv->def_point) {
+		add_segment(cenv, cenv->def_point, point);
+		return;
+	}
+	add_segment(cenv, get_block_begin_point(cenv, block), point);
+	add_live_out_preds(cenv, block);
 }
 
-static bool my_values_interfere2(ir_graph *const irg, ir_node const *a, ir_node const *b)
-{
-	if (value_dominates(b, a)) {
-		/* Adjust a and b so, that a dominates b if
-		 * a dominates b or vice versa. */
-		ir_node const *const t = a;
-		a = b;
-		b = t;
-	} else if (!value_dominates(a, b)) {
-		/* If there is no dominance relation, they do not interfere. */
-		return 0;
-	}
-
-	ir_node *const bb = get_nodes_block(b);
-
-	/* If a is live end in b's block it is
-	 * live at b's definition (a dominates b) */
-	be_lv_t *const lv = be_get_irg_liveness(irg);
-	if (be_is_live_end(lv, bb, a))
-		return true;
-
-	/* Look at all usages of a.
-	 * If there's one usage of a in the block of b, then
-	 * we check, if this use is dominated by b, if that's true
-	 * a and b interfere. Note that b must strictly dominate the user,
-	 * since if b is the last user of in the block, b and a do not
-	 * interfere.
-	 * Uses of a not in b's block can be disobeyed, because the
-	 * check for a being live at the end of b's block is already
-	 * performed. */
-	foreach_out_edge(a, edge) {
-		ir_node const *const user = get_edge_src_irn(edge);
+static void add_users(coalesce_env_t *cenv, ir_node *value)
+{
+	foreach_out_edge(value, edge) {
+		ir_node *user = get_edge_src_irn(edge);
 		if (is_Sync(user)) {
-			foreach_out_edge(user, edge2) {
-				ir_node const *const user2 = get_edge_src_irn(edge2);
-				assert(!is_Sync(user2));
-				if (get_nodes_block(user2) == bb && !is_Phi(user2) &&
-				    _value_strictly_dominates_intrablock(b, user2))
-					return true;
-			}
+			add_users(cenv, user);
+		} else if (is_Phi(user)) {
+			/* phi arguments are used at the end of the predecessor block */
+			int      pos   = get_edge_src_pos(edge);
+			ir_node *block = get_nodes_block(user);
+			ir_node *pred  = get_Block_cfgpred_block(block, pos);
+			add_use(cenv, pred, get_block_end_point(cenv, pred) - 1);
 		} else {
-			if (get_nodes_block(user) == bb && !is_Phi(user) &&
-			    _value_strictly_dominates_intrablock(b, user))
-				return true;
+			add_use(cenv, get_nodes_block(user), get_use_point(cenv, user));
 		}
 	}
+}
+
+/**
+ * Collects the live segments of a single (non-Sync) definition by walking
+ * from its uses upwards to the definition.
+ */
+static void collect_def_segments(coalesce_env_t *cenv, ir_node *def)
+{
+	ir_graph *irg = cenv->env->irg;
+
+	cenv->def_block = get_nodes_block(def);
+	cenv->def_point = get_def_point(cenv, def);
+
+	inc_irg_block_visited(irg);
+	/* the value occupies its slot at least at its definition */
+	add_segment(cenv, cenv->def_point, cenv->def_point + 1);
+	add_users(cenv, def);
+
+	while (ARR_LEN(cenv->worklist) > 0) {
+		size_t   n_work = ARR_LEN(cenv->worklist);
+		ir_node *block  = cenv->worklist[n_work - 1];
+		ARR_SHRINKLEN(cenv->worklist, n_work - 1);
+		if (block == cenv->def_block) {
+			add_segment(cenv, cenv->def_point,
+			            get_block_end_point(cenv, block));
+		} else {
+			add_segment(cenv, get_block_begin_point(cenv, block),
+			            get_block_end_point(cenv, block));
+			add_live_out_preds(cenv, block);
+		}
+	}
+}
 
+static int cmp_segment(const void *d1, const void *d2)
+{
+	const live_segment_t *s1 = (const live_segment_t*)d1;
+	const live_segment_t *s2 = (const live_segment_t*)d2;
+	return (s1->from > s2->from) - (s1->from < s2->from);
+}
+
+/**
+ * Computes the sorted and disjoint live segments of a spill.
+ * NoMem spills occupy no memory and get no segments.
+ */
+static live_segment_t *compute_live_segments(coalesce_env_t *cenv,
+                                             ir_node *spill)
+{
+	live_segment_t *res;
+	size_t          n_segments;
+	size_t          i;
+
+	res = NEW_ARR_F(live_segment_t, 0);
+	if (is_NoMem(spill))
+		return res;
+
+	ARR_SHRINKLEN(cenv->segments, 0);
+	if (is_Sync(spill)) {
+		int arity = get_irn_arity(spill);
+		int p;
+		for (p = 0; p < arity; ++p) {
+			collect_def_segments(cenv, get_irn_n(spill, p));
+		}
+	} else {
+		collect_def_segments(cenv, spill);
+	}
+
+	n_segments = ARR_LEN(cenv->segments);
+	qsort(cenv->segments, n_segments, sizeof(cenv->segments[0]), cmp_segment);
+	for (i = 0; i < n_segments; ++i) {
+		live_segment_t segment = cenv->segments[i];
+		size_t          n_res  = ARR_LEN(res);
+		if (n_res > 0 && res[n_res - 1].to >= segment.from) {
+			if (segment.to > res[n_res - 1].to)
+				res[n_res - 1].to = segment.to;
+		} else {
+			ARR_APP1(live_segment_t, res, segment);
+		}
+	}
+	return res;
+}
+
+/**
+ * Tests whether two sorted lists of disjoint segments overlap.
+ */
+static bool segments_overlap(const live_segment_t *s1,
+                             const live_segment_t *s2)
+{
+	size_t n1 = ARR_LEN(s1);
+	size_t n2 = ARR_LEN(s2);
+	size_t i1 = 0;
+	size_t i2 = 0;
+
+	while (i1 < n1 && i2 < n2) {
+		if (s1[i1].to <= s2[i2].from) {
+			++i1;
+		} else if (s2[i2].to <= s1[i1].from) {
+			++i2;
+		} else {
+			return true;
+		}
+	}
 	return false;
 }
 
 /**
- * same as values_interfere but with special handling for Syncs
+ * Merges two sorted lists of disjoint segments. Both lists are freed.
  */
-static int my_values_interfere(ir_graph *irg, ir_node *a, ir_node *b)
+static live_segment_t *merge_segments(live_segment_t *s1, live_segment_t *s2)
 {
-	if (is_Sync(a)) {
-		int i, arity = get_irn_arity(a);
-		for (i = 0; i < arity; ++i) {
-			ir_node *in = get_irn_n(a, i);
-			if (my_values_interfere(irg, in, b))
-				return 1;
+	size_t          n1  = ARR_LEN(s1);
+	size_t          n2  = ARR_LEN(s2);
+	size_t          i1  = 0;
+	size_t          i2  = 0;
+	live_segment_t *res = NEW_ARR_F(live_segment_t, 0);
+
+	while (i1 < n1 || i2 < n2) {
+		live_segment_t segment;
+		size_t         n_res;
+		if (i2 >= n2 || (i1 < n1 && s1[i1].from < s2[i2].from)) {
+			segment = s1[i1++];
+		} else {
+			segment = s2[i2++];
 		}
-		return 0;
-	} else if (is_Sync(b)) {
-		int i, arity = get_irn_arity(b);
-		for (i = 0; i < arity; ++i) {
-			ir_node *in = get_irn_n(b, i);
-			/* a is not a sync, so no need for my_values_interfere */
-			if (my_values_interfere2(irg, a, in))
-				return 1;
+		n_res = ARR_LEN(res);
+		if (n_res > 0 && res[n_res - 1].to == segment.from) {
+			res[n_res - 1].to = segment.to;
+		} else {
+			ARR_APP1(live_segment_t, res, segment);
 		}
-		return 0;
 	}
 
-	return my_values_interfere2(irg, a, b);
+	DEL_ARR_F(s1);
+	DEL_ARR_F(s2);
+	return res;
+}
+
+static int merge_slots(live_segment_t **segments, int *spillslot_unionfind,
+                       int s1, int s2)
+{
+	int res = uf_union(spillslot_unionfind, s1, s2);
+	int other = res == s1 ? s2 : s1;
+
+	segments[res]   = merge_segments(segments[res], segments[other]);
+	segments[other] = NULL;
+	return res;
+}
+
+/** The hull of the live segments of a slot. */
+typedef struct slot_range_t {
+	unsigned begin;
+	unsigned end;
+	int      slot;
+} slot_range_t;
+
+/** Compare 2 slots by the begin of their live range (used in quicksort) */
+static int cmp_slot_begin(const void *d1, const void *d2)
+{
+	const slot_range_t *r1 = (const slot_range_t*)d1;
+	const slot_range_t *r2 = (const slot_range_t*)d2;
+	if (r1->begin != r2->begin)
+		return (r1->begin > r2->begin) - (r1->begin < r2->begin);
+	return (r1->slot > r2->slot) - (r1->slot < r2->slot);
 }
 
 /**
- * A greedy coalescing algorithm for spillslots:
- *  1. Sort the list of affinity edges
- *  2. Try to merge slots with affinity edges (most expensive slots first)
- *  3. Try to merge everything else that is possible
+ * An interval based coalescing algorithm for spillslots:
+ *  1. Compute the live segments of all spills on a linearised program
+ *  2. Sort the list of affinity edges
+ *  3. Try to merge slots with affinity edges (most expensive slots first)
+ *  4. Assign the remaining slots with a linear scan over their live ranges,
+ *     reusing every slot whose live range has ended
  */
 static void do_greedy_coalescing(be_fec_env_t *env)
 {
-	spill_t **spills     = env->spills;
-	size_t    spillcount = ARR_LEN(spills);
-	size_t    i;
-	size_t    affinity_edge_count;
-	bitset_t **interferences;
-	int* spillslot_unionfind;
-	struct obstack data;
+	spill_t        **spills     = env->spills;
+	size_t           spillcount = ARR_LEN(spills);
+	ir_graph        *irg        = env->irg;
+	unsigned         n_idx      = get_irg_last_idx(irg);
+	size_t           i;
+	size_t           affinity_edge_count;
+	live_segment_t **segments;
+	int             *spillslot_unionfind;
+	slot_range_t    *ranges;
+	size_t           n_ranges;
+	unsigned        *slot_ends;
+	int             *free_slots;
+	int              nomem_slot;
+	pqueue_t        *active;
+	coalesce_env_t   cenv;
 
 	if (spillcount == 0)
 		return;
 
-	obstack_init(&data);
-
 	DB((dbg, DBG_COALESCING, "Coalescing %d spillslots\n", spillcount));
 
-	interferences       = OALLOCN(&data, bitset_t*, spillcount);
-	spillslot_unionfind = OALLOCN(&data, int,       spillcount);
-
+	/* linearise the program */
+	assure_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE);
+	cenv.env        = env;
+	cenv.points     = XMALLOCN(unsigned, n_idx);
+	cenv.block_ends = XMALLOCN(unsigned, n_idx);
+	cenv.n_points   = 0;
+	cenv.worklist   = NEW_ARR_F(ir_node*, 0);
+	cenv.segments   = NEW_ARR_F(live_segment_t, 0);
+	dom_tree_walk_irg(irg, number_block, NULL, &cenv);
+
+	/* construct live segments */
+	segments            = XMALLOCN(live_segment_t*, spillcount);
+	spillslot_unionfind = XMALLOCN(int, spillcount);
 	uf_init(spillslot_unionfind, spillcount);
 
+	ir_reserve_resources(irg, IR_RESOURCE_BLOCK_VISITED);
 	for (i = 0; i < spillcount; ++i) {
-		interferences[i] = bitset_obstack_alloc(&data, spillcount);
+		segments[i] = compute_live_segments(&cenv, spills[i]->spill);
 	}
+	ir_free_resources(irg, IR_RESOURCE_BLOCK_VISITED);
 
-	/* construct interferences */
-	for (i = 0; i < spillcount; ++i) {
-		size_t   i2;
-		ir_node *spill1 = spills[i]->spill;
-		if (is_NoMem(spill1))
-			continue;
-
-		for (i2 = i+1; i2 < spillcount; ++i2) {
-			ir_node *spill2 = spills[i2]->spill;
-			if (is_NoMem(spill2))
-				continue;
-
-			if (my_values_interfere(env->irg, spill1, spill2)) {
-				DB((dbg, DBG_INTERFERENCES,
-				     "Slot %d and %d interfere\n", i, i2));
-
-				bitset_set(interferences[i], i2);
-				bitset_set(interferences[i2], i);
-			}
-		}
-	}
+	DEL_ARR_F(cenv.segments);
+	DEL_ARR_F(cenv.worklist);
+	free(cenv.block_ends);
+	free(cenv.points);
 
 	/* sort affinity edges */
 	affinity_edge_count = ARR_LEN(env->affinity_edges);
@@ -339,57 +515,97 @@ static void do_greedy_coalescing(be_fec_env_t *env)
 		const affinity_edge_t *edge = env->affinity_edges[i];
 		int s1 = uf_find(spillslot_unionfind, edge->slot1);
 		int s2 = uf_find(spillslot_unionfind, edge->slot2);
+		if (s1 == s2)
+			continue;
 
 		/* test if values interfere */
-		if (bitset_is_set(interferences[s1], s2)) {
-			assert(bitset_is_set(interferences[s2], s1));
+		if (segments_overlap(segments[s1], segments[s2])) {
+			DB((dbg, DBG_INTERFERENCES, "Slot %d and %d interfere\n", s1, s2));
 			continue;
 		}
 
 		DB((dbg, DBG_COALESCING,
 		    "Merging %d and %d because of affinity edge\n", s1, s2));
 
-		merge_interferences(env, interferences, spillslot_unionfind, s1, s2);
+		merge_slots(segments, spillslot_unionfind, s1, s2);
 	}
 
-	/* try to merge as much remaining spillslots as possible */
+	/* order the remaining slots by the begin of their live range */
+	ranges     = XMALLOCN(slot_range_t, spillcount);
+	n_ranges   = 0;
+	nomem_slot = -1;
 	for (i = 0; i < spillcount; ++i) {
-		size_t i2;
-		int    s1 = uf_find(spillslot_unionfind, i);
-		if (s1 != (int)i)
+		const live_segment_t *slot_segments;
+		if (uf_find(spillslot_unionfind, i) != (int)i)
 			continue;
-
-		for (i2 = i+1; i2 < spillcount; ++i2) {
-			int s2 = uf_find(spillslot_unionfind, i2);
-			if (s2 != (int)i2)
-				continue;
-
-			/* test if values interfere
-			 * we have to test n1-n2 and n2-n1, because only 1 side gets updated
-			 * when node merging occurs
-			 */
-			if (bitset_is_set(interferences[s1], s2)) {
-				assert(bitset_is_set(interferences[s2], s1));
-				continue;
+		slot_segments = segments[i];
+		if (ARR_LEN(slot_segments) == 0) {
+			/* NoMem spills interfere with nothing */
+			nomem_slot = nomem_slot < 0 ? (int)i
+				: uf_union(spillslot_unionfind, nomem_slot, (int)i);
+			continue;
+		}
+		ranges[n_ranges].begin = slot_segments[0].from;
+		ranges[n_ranges].end   = slot_segments[ARR_LEN(slot_segments) - 1].to;
+		ranges[n_ranges].slot  = (int)i;
+		++n_ranges;
+	}
+	qsort(ranges, n_ranges, sizeof(ranges[0]), cmp_slot_begin);
+
+	/* linear scan: the active slots are ordered by the end of their live
+	 * range, a slot is reused as soon as its live range has ended */
+	slot_ends  = XMALLOCN(unsigned, spillcount);
+	active     = new_pqueue();
+	free_slots = NEW_ARR_F(int, 0);
+	for (i = 0; i < n_ranges; ++i) {
+		const slot_range_t *range = &ranges[i];
+		int                 slot  = range->slot;
+		size_t              n_free;
+
+		while (!pqueue_empty(active)) {
+			int top = (int)(intptr_t)pqueue_pop_front(active);
+			if (slot_ends[top] > range->begin) {
+				pqueue_put(active, (void*)(intptr_t)top, -(int)slot_ends[top]);
+				break;
 			}
+			ARR_APP1(int, free_slots, top);
+		}
 
-			DB((dbg, DBG_COALESCING,
-			     "Merging %d and %d because it is possible\n", s1, s2));
+		n_free = ARR_LEN(free_slots);
+		if (n_free > 0) {
+			int other = free_slots[n_free - 1];
+			ARR_SHRINKLEN(free_slots, n_free - 1);
 
-			if (merge_interferences(env, interferences, spillslot_unionfind, s1, s2) != 0) {
-				/* we can break the loop here, because s2 is the new supernode
-				 * now and we'll test s2 again later anyway */
-				break;
-			}
+			DB((dbg, DBG_COALESCING,
+			     "Merging %d and %d because it is possible\n", other, slot));
+			slot = uf_union(spillslot_unionfind, other, slot);
 		}
+
+		slot_ends[slot] = range->end;
+		pqueue_put(active, (void*)(intptr_t)slot, -(int)range->end);
+	}
+	del_pqueue(active);
+	DEL_ARR_F(free_slots);
+	free(slot_ends);
+
+	/* NoMem spills can share any slot */
+	if (nomem_slot >= 0 && n_ranges > 0) {
+		uf_union(spillslot_unionfind, uf_find(spillslot_unionfind,
+		         ranges[0].slot), nomem_slot);
 	}
+	free(ranges);
 
 	/* assign spillslots to spills */
 	for (i = 0; i < spillcount; ++i) {
 		spills[i]->spillslot = uf_find(spillslot_unionfind, i);
 	}
 
-	obstack_free(&data, 0);
+	for (i = 0; i < spillcount; ++i) {
+		if (segments[i] != NULL)
+			DEL_ARR_F(segments[i]);
+	}
+	free(segments);
+	free(spillslot_unionfind);
 }
 
 typedef struct spill_slot_t {
@@ -644,8 +860,6 @@ be_fec_env_t *be_new_frame_entity_coalescer(ir_graph *irg)
 {
 	be_fec_env_t *env = XMALLOCZ(be_fec_env_t);
 
-	be_assure_live_chk(irg);
-
 	obstack_init(&env->obst);
 	env->irg            = irg;
 	env->spills         = NEW_ARR_F(spill_t*, 0);
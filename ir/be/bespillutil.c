@@ -471,6 +471,37 @@ static void spill_node(spill_env_t *env, spill_info_t *spillinfo)
  *
  */
 
+/**
+ * Tests whether @p value is live in front of @p before, i.e. it is defined
+ * earlier and used by @p before or later.
+ */
+static bool is_live_before(const be_lv_t *lv, const ir_node *value,
+                           const ir_node *before)
+{
+	if (is_Block(before))
+		return false;
+
+	const ir_node *block = get_nodes_block(before);
+	const ir_node *insn  = skip_Proj_const(value);
+	if (get_nodes_block(insn) == block) {
+		if (!sched_is_scheduled(insn) || !sched_comes_after(insn, before))
+			return false;
+	} else if (!be_is_live_in(lv, block, value)) {
+		return false;
+	}
+
+	if (be_is_live_end(lv, block, value))
+		return true;
+	foreach_out_edge(value, edge) {
+		const ir_node *user = get_edge_src_irn(edge);
+		if (is_Phi(user) || get_nodes_block(user) != block)
+			continue;
+		if (user == before || sched_comes_after(before, user))
+			return true;
+	}
+	return false;
+}
+
 /**
  * Tests whether value @p arg is available before node @p reloader
  * @returns 1 if value is available, 0 otherwise
@@ -487,8 +518,6 @@ static int is_value_available(spill_env_t *env, const ir_node *arg,
 	if (arg == get_irg_frame(env->irg))
 		return 1;
 
-	(void)reloader;
-
 	if (get_irn_mode(arg) == mode_T)
 		return 0;
 
@@ -498,13 +527,49 @@ static int is_value_available(spill_env_t *env, const ir_node *arg,
 	if (arch_irn_is_ignore(arg))
 		return 1;
 
-	return 0;
+	/* values still live at the reloader can be used if they stay in their
+	 * register, i.e. they are not spilled themselves */
+	if (!mode_is_datab(get_irn_mode(arg)))
+		return 0;
+	spill_info_t info;
+	info.to_spill = (ir_node*)arg;
+	if (set_find(spill_info_t, env->spills, &info, sizeof(info),
+	             hash_irn(arg)) != NULL)
+		return 0;
+	return is_live_before(be_get_irg_liveness(env->irg), arg, reloader);
+}
+
+int be_get_default_remat_cost(const ir_node *node, const ir_node *before)
+{
+	(void)before;
+	if (!arch_irn_is(node, rematerializable))
+		return -1;
+	/* never rematerialize a node which modifies the flags.
+	 * (would be better to test whether the flags are actually live at point
+	 * reloader...)
+	 */
+	if (arch_irn_is(node, modify_flags))
+		return -1;
+
+	if (be_is_Reload(node))
+		return 2;
+	return arch_get_op_estimated_cost(node);
+}
+
+static int get_remat_cost(const spill_env_t *env, const ir_node *node,
+                          const ir_node *before)
+{
+	const arch_isa_if_t *isa = env->arch_env->impl;
+	if (isa->get_remat_cost != NULL)
+		return isa->get_remat_cost(node, before);
+	return be_get_default_remat_cost(node, before);
 }
 
 /**
  * Check if a node is rematerializable. This tests for the following conditions:
  *
- * - The node itself is rematerializable
+ * - The node itself is rematerializable (asks the isa, see
+ *   arch_isa_if_t::get_remat_cost)
  * - All arguments of the node are available or also rematerialisable
  * - The costs for the rematerialisation operation is less or equal a limit
  *
@@ -520,24 +585,14 @@ static int check_remat_conditions_costs(spill_env_t *env,
 	const ir_node *insn = skip_Proj_const(spilled);
 
 	assert(!be_is_Spill(insn));
-	if (!arch_irn_is(insn, rematerializable))
+	int insn_costs = get_remat_cost(env, insn, reloader);
+	if (insn_costs < 0)
 		return REMAT_COST_INFINITE;
 
-	if (be_is_Reload(insn)) {
-		costs += 2;
-	} else {
-		costs += arch_get_op_estimated_cost(insn);
-	}
+	costs += insn_costs;
 	if (parentcosts + costs >= env->reload_cost + env->spill_cost) {
 		return REMAT_COST_INFINITE;
 	}
-	/* never rematerialize a node which modifies the flags.
-	 * (would be better to test whether the flags are actually live at point
-	 * reloader...)
-	 */
-	if (arch_irn_is(insn, modify_flags)) {
-		return REMAT_COST_INFINITE;
-	}
 
 	argremats = 0;
 	for (i = 0, arity = get_irn_arity(insn); i < arity; ++i) {
@@ -717,7 +772,6 @@ static void determine_spill_costs(spill_env_t *env, spill_info_t *spillinfo)
 		return;
 
 	assert(!arch_irn_is(insn, dont_spill));
-	assert(!be_is_Reload(insn));
 
 	/* some backends have virtual noreg/unknown nodes that are not scheduled
 	 * and simply always available.
@@ -739,6 +793,23 @@ static void determine_spill_costs(spill_env_t *env, spill_info_t *spillinfo)
 		return;
 	}
 
+	/* a reloaded value already lives in a spill slot (this happens when a
+	 * spiller runs on a graph another spiller has worked on before), so we
+	 * simply reuse the memory it was reloaded from */
+	if (be_is_Reload(insn)) {
+		spill_t *spill = OALLOC(&env->obst, spill_t);
+		spill->after = NULL;
+		spill->next  = NULL;
+		spill->spill = get_irn_n(insn, n_be_Reload_mem);
+
+		spillinfo->spills      = spill;
+		spillinfo->spill_costs = 0;
+
+		DB((dbg, LEVEL_1, "%+F is a reload, reuse %+F\n", to_spill,
+		    spill->spill));
+		return;
+	}
+
 	spill_block    = get_nodes_block(insn);
 	spill_execfreq = get_block_execfreq(spill_block);
 
@@ -977,6 +1048,10 @@ void be_insert_spills_reloads(spill_env_t *env)
 	stat_ev_dbl("spill_remats", env->remat_count);
 	stat_ev_dbl("spill_spilled_phis", env->spilled_phi_count);
 
+	be_irg_t *birg = be_birg_from_irg(env->irg);
+	birg->n_reloads += env->reload_count;
+	birg->n_remats  += env->remat_count;
+
 	/* Matze: In theory be_ssa_construction should take care of the liveness...
 	 * try to disable this again in the future */
 	be_invalidate_live_sets(env->irg);
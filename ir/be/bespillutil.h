@@ -139,6 +139,14 @@ void be_get_total_spill_costs(ir_graph *irg, be_total_spill_costs_t *costs);
  */
 int be_is_rematerializable(spill_env_t *env, const ir_node *to_remat, const ir_node *before);
 
+/**
+ * Returns the costs of recomputing @p node in front of @p before or a negative
+ * value if it must not be rematerialized: the node has to be marked
+ * rematerializable and must not modify the flags. Used when the isa has no
+ * get_remat_cost callback.
+ */
+int be_get_default_remat_cost(const ir_node *node, const ir_node *before);
+
 /**
  * Create a be_Spill node. This function is compatible to the
  * arch_env->new_spill callback.
@@ -9,6 +9,7 @@
  * @author      Christian Wuerdig, Matthias Braun
  */
 #include <time.h>
+#include <string.h>
 
 #include "irnode_t.h"
 #include "irgwalk.h"
@@ -16,6 +17,8 @@
 #include "execfreq.h"
 #include "firmstat_t.h"
 #include "error.h"
+#include "util.h"
+#include "xmalloc.h"
 #include "statev_t.h"
 
 #include "bearch.h"
@@ -129,6 +132,85 @@ double be_estimate_irg_costs(ir_graph *irg)
 
 
 
+typedef struct estimate_sched_cycles_env_t {
+	const arch_machine_t *machine;
+	unsigned             *ready;  /**< cycle the result of a node is available */
+	double                cycles;
+} estimate_sched_cycles_env_t;
+
+/**
+ * Simulates in-order issue of the schedule of a block on the machine model.
+ */
+static void estimate_block_cycles(ir_node *block, void *data)
+{
+	estimate_sched_cycles_env_t *env     = (estimate_sched_cycles_env_t*)data;
+	const arch_machine_t        *machine = env->machine;
+	unsigned                     port_free[32];
+	unsigned                     cycle   = 0;
+	unsigned                     issued  = 0;
+
+	memset(port_free, 0, sizeof(port_free));
+	sched_foreach(block, node) {
+		arch_sched_insn_t insn;
+		unsigned          start = cycle;
+		unsigned          best  = machine->n_ports;
+		unsigned          p;
+		int               i;
+
+		if (is_Phi(node) || be_is_Keep(node))
+			continue;
+		arch_get_sched_insn(node, &insn);
+
+		for (i = get_irn_arity(node) - 1; i >= 0; --i) {
+			ir_node *pred = get_irn_n(node, i);
+			if (!mode_is_datab(get_irn_mode(pred)))
+				continue;
+			pred = skip_Proj(pred);
+			if (get_nodes_block(pred) == block && !is_Phi(pred))
+				start = MAX(start, env->ready[get_irn_idx(pred)]);
+		}
+
+		for (p = 0; p < machine->n_ports; ++p) {
+			if ((insn.ports & (1u << p))
+			    && (best == machine->n_ports || port_free[p] < port_free[best]))
+				best = p;
+		}
+		if (best < machine->n_ports)
+			start = MAX(start, port_free[best]);
+
+		if (start > cycle) {
+			cycle  = start;
+			issued = 0;
+		} else if (issued == machine->issue_width) {
+			++cycle;
+			issued = 0;
+		}
+		++issued;
+		if (best < machine->n_ports)
+			port_free[best] = cycle + insn.rthroughput;
+		env->ready[get_irn_idx(node)] = cycle + insn.latency;
+	}
+
+	env->cycles += (cycle + 1) * get_block_execfreq(block);
+}
+
+double be_estimate_sched_cycles(ir_graph *irg)
+{
+	estimate_sched_cycles_env_t env;
+
+	env.machine = be_get_irg_arch_env(irg)->machine;
+	if (env.machine == NULL)
+		return 0.0;
+	assert(env.machine->n_ports <= 32);
+
+	env.ready  = XMALLOCNZ(unsigned, get_irg_last_idx(irg));
+	env.cycles = 0.0;
+	irg_block_walk_graph(irg, estimate_block_cycles, NULL, &env);
+	free(env.ready);
+
+	return env.cycles;
+}
+
 static void node_stat_walker(ir_node *irn, void *data)
 {
 	be_node_stats_t *const stats = (be_node_stats_t*)data;
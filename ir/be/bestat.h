@@ -48,6 +48,13 @@ void be_do_stat_reg_pressure(ir_graph *irg, const arch_register_class_t *cls);
  */
 double be_estimate_irg_costs(ir_graph *irg);
 
+/**
+ * Estimates the cycles needed to execute the schedule (weighted with the
+ * execution frequencies) by simulating in-order issue on the machine model
+ * of the backend. Returns 0 if the backend has no machine model.
+ */
+double be_estimate_sched_cycles(ir_graph *irg);
+
 /**
  * return number of "instructions" (=nodes without some virtual nodes like Proj,
  * Start, End)
@@ -22,6 +22,7 @@
 #include "cgana.h"
 #include "debug.h"
 #include "execfreq_t.h"
+#include "irmemory_t.h"
 
 #include "beirg.h"
 #include "beabi.h"
@@ -382,6 +383,7 @@ void be_transform_graph(ir_graph *irg, arch_pretrans_nodes *func)
 	struct obstack old_obst = irg->obst;
 	obstack_init(&irg->obst);
 	irg->last_node_idx = 0;
+	invalidate_points_to(irg);
 
 	free_vrp_data(irg);
 
@@ -33,11 +33,13 @@
 #include "lower_softfloat.h"
 #include "lower_builtins.h"
 #include "firmstat_t.h"
+#include "statev_t.h"
 
 #include "beabi.h"
 #include "benode.h"
 #include "belower.h"
 #include "besched.h"
+#include "belive_t.h"
 #include "be.h"
 #include "be_t.h"
 #include "beirgmod.h"
@@ -428,6 +430,26 @@ static const be_abi_callbacks_t ia32_abi_callbacks = {
 };
 
 /* register allocator interface */
+/**
+ * Describes @p irn according to the machine model selected with -mtune.
+ * Address mode operations additionally wait for their load.
+ */
+static void ia32_get_sched_insn(const ir_node *irn, arch_sched_insn_t *insn)
+{
+	ia32_exec_unit_t const unit = get_ia32_exec_unit(irn);
+	if (!ia32_get_unit_model(unit, insn)) {
+		insn->latency = get_ia32_latency(irn);
+		return;
+	}
+
+	if (unit != ia32_unit_load && unit != ia32_unit_store
+	    && get_ia32_op_type(irn) != ia32_Normal) {
+		arch_sched_insn_t load;
+		ia32_get_unit_model(ia32_unit_load, &load);
+		insn->latency += load.latency;
+	}
+}
+
 static const arch_irn_ops_t ia32_irn_ops = {
 	ia32_get_frame_entity,
 	ia32_set_frame_offset,
@@ -435,6 +457,7 @@ static const arch_irn_ops_t ia32_irn_ops = {
 	ia32_get_op_estimated_cost,
 	ia32_possible_memory_operand,
 	ia32_perform_memory_operand,
+	ia32_get_sched_insn,
 };
 
 static int gprof = 0;
@@ -455,6 +478,46 @@ static void ia32_before_abi(ir_graph *irg)
 	}
 }
 
+/**
+ * Reports a node which uses or produces a value in an x87 register.
+ */
+static void report_x87_walker(ir_node *node, void *data)
+{
+	unsigned *const n_x87 = (unsigned*)data;
+	/* a call clobbers all x87 registers, the users of an st0 result are
+	 * reported themselves */
+	if (!is_ia32_irn(node) || is_ia32_Call(node))
+		return;
+
+	arch_register_class_t const *const cls_fp
+		= &ia32_reg_classes[CLASS_ia32_fp];
+	bool uses_x87 = false;
+	be_foreach_out(node, o) {
+		if (arch_get_irn_register_req_out(node, o)->cls == cls_fp)
+			uses_x87 = true;
+	}
+	for (int i = 0, arity = get_irn_arity(node); i < arity; ++i) {
+		if (arch_get_irn_register_req_in(node, i)->cls == cls_fp)
+			uses_x87 = true;
+	}
+	if (!uses_x87)
+		return;
+
+	ir_fprintf(stderr, "%+F: %+F needs the x87 unit\n",
+	           get_irg_entity(get_irn_irg(node)), node);
+	++*n_x87;
+}
+
+/**
+ * Reports all nodes which still need the x87 unit after code selection.
+ */
+static void report_x87(ir_graph *irg)
+{
+	unsigned n_x87 = 0;
+	irg_walk_graph(irg, report_x87_walker, NULL, &n_x87);
+	stat_ev_int("ia32_x87_nodes", n_x87);
+}
+
 /**
  * Transforms the standard firm graph into
  * an ia32 firm graph
@@ -501,6 +564,9 @@ static void ia32_prepare_graph(ir_graph *irg)
 
 	if (irg_data->dump)
 		dump_ir_graph(irg, "place");
+
+	if (ia32_cg_config.no_x87)
+		report_x87(irg);
 }
 
 ir_node *ia32_turn_back_am(ir_node *node)
@@ -1476,7 +1542,8 @@ static backend_params ia32_backend_params = {
 	12,    /* size of trampoline code */
 	4,     /* alignment of trampoline code */
 	ia32_create_trampoline_fkt,
-	4      /* alignment of stack parameter */
+	4,     /* alignment of stack parameter */
+	4      /* loop unroll factor */
 };
 
 /**
@@ -1552,6 +1619,7 @@ static ia32_isa_t ia32_isa_template = {
 		7,                        /* costs for a spill instruction */
 		5,                        /* costs for a reload instruction */
 		false,                    /* no custom abi handling */
+		NULL,                     /* machine model, set by -march */
 	},
 	NULL,                       /* tv_ents */
 	IA32_FPU_ARCH_X87,          /* FPU architecture */
@@ -1563,8 +1631,9 @@ static arch_env_t *ia32_begin_codegeneration(void)
 
 	set_tarval_output_modes();
 
-	*isa        = ia32_isa_template;
-	isa->tv_ent = pmap_create();
+	*isa              = ia32_isa_template;
+	isa->tv_ent       = pmap_create();
+	isa->base.machine = ia32_get_machine();
 
 	return &isa->base;
 }
@@ -1661,6 +1730,13 @@ static const arch_register_t *ia32_get_RegParam_reg(unsigned cc, unsigned nr,
 	panic("unknown argument mode");
 }
 
+bool ia32_float_result_in_xmm(ir_type const *mtp)
+{
+	return ia32_cg_config.use_sse2 && ia32_cg_config.optimize_cc
+	    && get_method_variadicity(mtp) != variadicity_variadic
+	    && (get_method_additional_properties(mtp) & mtp_property_private);
+}
+
 /**
  * Get the ABI restrictions for procedure calls.
  */
@@ -1757,7 +1833,13 @@ static void ia32_get_call_abi(ir_type *method_type, be_abi_call_t *abi)
 		const arch_register_t *reg;
 		assert(is_atomic_type(tp));
 
-		reg = mode_is_float(mode) ? &ia32_registers[REG_ST0] : &ia32_registers[REG_EAX];
+		if (!mode_is_float(mode)) {
+			reg = &ia32_registers[REG_EAX];
+		} else if (ia32_float_result_in_xmm(method_type)) {
+			reg = &ia32_registers[REG_XMM0];
+		} else {
+			reg = &ia32_registers[REG_ST0];
+		}
 
 		be_abi_call_res_reg(abi, 0, reg, ABI_CONTEXT_BOTH);
 	}
@@ -1770,6 +1852,58 @@ static void ia32_mark_remat(ir_node *node)
 	}
 }
 
+/**
+ * Checks whether the flags are live in front of @p before.
+ */
+static bool flags_live_before(const ir_node *before)
+{
+	const arch_register_class_t *flags_cls
+		= &ia32_reg_classes[CLASS_ia32_flags];
+
+	/* Projs are not scheduled, start at their tuple */
+	for (const ir_node *node = skip_Proj_const(before); !sched_is_end(node);
+	     node = sched_next(node)) {
+		for (int i = 0, arity = get_irn_arity(node); i < arity; ++i) {
+			if (arch_get_irn_reg_class(get_irn_n(node, i)) == flags_cls)
+				return true;
+		}
+		if (arch_irn_is(node, modify_flags))
+			return false;
+	}
+
+	/* reloads at the end of a block are inserted before the block itself */
+	const ir_node *block = is_Block(before) ? before : get_nodes_block(before);
+	be_lv_t       *lv    = be_get_irg_liveness(get_irn_irg(block));
+	be_lv_foreach(lv, block, be_lv_state_end, value) {
+		if (arch_get_irn_reg_class(value) == flags_cls)
+			return true;
+	}
+	return false;
+}
+
+static int ia32_get_remat_cost(const ir_node *node, const ir_node *before)
+{
+	if (!is_ia32_irn(node))
+		return be_get_default_remat_cost(node, before);
+
+	if (!arch_irn_is(node, rematerializable))
+		return -1;
+	/* the memory operand might have changed in between */
+	if (get_ia32_op_type(node) != ia32_Normal)
+		return -1;
+	/* Lea only claims to modify the flags, see ia32_spec.pl */
+	if (arch_irn_is(node, modify_flags) && !is_ia32_Lea(node)
+	    && flags_live_before(before))
+		return -1;
+
+	int costs = ia32_get_op_estimated_cost(node);
+	/* two-address code needs an extra copy if the operands stay alive */
+	const arch_register_req_t *req = arch_get_irn_register_req_out(node, 0);
+	if (req->type & arch_register_req_type_should_be_same)
+		++costs;
+	return costs;
+}
+
 static int ia32_is_valid_clobber(const char *clobber)
 {
 	return ia32_get_clobber_register(clobber) != NULL;
@@ -1840,12 +1974,22 @@ static void ia32_lower_for_target(void)
 		ir_lower_mode_b(irg, mode_Iu);
 	}
 
+	/* Turn all small CopyBs into loads/stores, keep medium-sized CopyBs,
+	 * so we can generate rep movs later, and turn all big CopyBs into
+	 * memcpy calls. SSE2 copies 8 bytes at once with movsd. */
+	static const ir_copyb_rule copyb_rules[] = {
+		{   64, 1, ir_copyb_moves },
+		{ 8192, 1, ir_copyb_keep  },
+	};
+	ir_copyb_params copyb_params = {
+		copyb_rules, ARRAY_SIZE(copyb_rules), NULL, true
+	};
+	if (ia32_cg_config.use_sse2)
+		copyb_params.wide_mode = mode_D;
+
 	for (size_t i = 0; i < n_irgs; ++i) {
 		ir_graph *irg = get_irp_irg(i);
-		/* Turn all small CopyBs into loads/stores, keep medium-sized CopyBs,
-		 * so we can generate rep movs later, and turn all big CopyBs into
-		 * memcpy calls. */
-		lower_CopyB(irg, 64, 8193, true);
+		lower_CopyB_rules(irg, &copyb_params);
 	}
 }
 
@@ -1944,6 +2088,7 @@ const arch_isa_if_t ia32_isa_if = {
 	ia32_init_graph,
 	ia32_get_call_abi,
 	ia32_mark_remat,
+	ia32_get_remat_cost,
 	ia32_get_pic_base,   /* return node used as base in pic code addresses */
 	be_new_spill,
 	be_new_reload,
@@ -100,6 +100,13 @@ ir_node *ia32_new_NoReg_fp(ir_graph *irg);
  */
 ir_node *ia32_new_Fpu_truncate(ir_graph *irg);
 
+/**
+ * Checks whether a float result of a method with type @p mtp is passed in
+ * xmm0 instead of st0. The ABI demands st0, but with SSE2 we use xmm0 for
+ * methods which are not visible outside of the compilation unit.
+ */
+bool ia32_float_result_in_xmm(ir_type const *mtp);
+
 /**
  * Split instruction with source AM into Load and separate instruction.
  * @return result of the Load
@@ -15,6 +15,8 @@
 #include "lc_opts_enum.h"
 #include "irtools.h"
 #include "ia32_architecture.h"
+#include "ia32_nodes_attr.h"
+#include "bearch.h"
 #include "tv.h"
 
 #undef NATIVE_X86
@@ -34,44 +36,51 @@ ia32_code_gen_config_t  ia32_cg_config;
 
 /**
  * CPU architectures and features.
+ * The lowest bits hold the number of the architecture, which is used for
+ * tuning decisions. The other bits are the supported instruction set
+ * extensions.
  */
 typedef enum cpu_arch_features {
-	arch_generic32        = 0x00000001, /**< no specific architecture */
-
-	arch_i386             = 0x00000002, /**< i386 architecture */
-	arch_i486             = 0x00000004, /**< i486 architecture */
-	arch_pentium          = 0x00000008, /**< Pentium architecture */
-	arch_ppro             = 0x00000010, /**< PentiumPro architecture */
-	arch_netburst         = 0x00000020, /**< Netburst architecture */
-	arch_nocona           = 0x00000040, /**< Nocona architecture */
-	arch_core2            = 0x00000080, /**< Core2 architecture */
-	arch_atom             = 0x00000100, /**< Atom architecture */
-
-	arch_k6               = 0x00000200, /**< k6 architecture */
-	arch_geode            = 0x00000400, /**< Geode architecture */
-	arch_athlon           = 0x00000800, /**< Athlon architecture */
-	arch_k8               = 0x00001000, /**< K8/Opteron architecture */
-	arch_k10              = 0x00002000, /**< K10/Barcelona architecture */
-
-	arch_mask             = 0x00003FFF,
-
-	arch_athlon_plus      = arch_athlon | arch_k8 | arch_k10,
-	arch_all_amd          = arch_k6 | arch_geode | arch_athlon_plus,
-
-	arch_feature_mmx      = 0x00004000, /**< MMX instructions */
-	arch_feature_cmov     = 0x00008000, /**< cmov instructions */
-	arch_feature_p6_insn  = 0x00010000, /**< PentiumPro instructions */
-	arch_feature_sse1     = 0x00020000, /**< SSE1 instructions */
-	arch_feature_sse2     = 0x00040000, /**< SSE2 instructions */
-	arch_feature_sse3     = 0x00080000, /**< SSE3 instructions */
-	arch_feature_ssse3    = 0x00100000, /**< SSSE3 instructions */
-	arch_feature_3DNow    = 0x00200000, /**< 3DNow! instructions */
-	arch_feature_3DNowE   = 0x00400000, /**< Enhanced 3DNow! instructions */
-	arch_feature_64bit    = 0x00800000, /**< x86_64 support */
-	arch_feature_sse4_1   = 0x01000000, /**< SSE4.1 instructions */
-	arch_feature_sse4_2   = 0x02000000, /**< SSE4.2 instructions */
-	arch_feature_sse4a    = 0x04000000, /**< SSE4a instructions */
-	arch_feature_popcnt   = 0x08000000, /**< popcnt instruction */
+	arch_generic32        =  1, /**< no specific architecture */
+
+	arch_i386             =  2, /**< i386 architecture */
+	arch_i486             =  3, /**< i486 architecture */
+	arch_pentium          =  4, /**< Pentium architecture */
+	arch_ppro             =  5, /**< PentiumPro architecture */
+	arch_netburst         =  6, /**< Netburst architecture */
+	arch_nocona           =  7, /**< Nocona architecture */
+	arch_core2            =  8, /**< Core2 architecture */
+	arch_atom             =  9, /**< Atom architecture */
+	arch_core_i           = 10, /**< Nehalem and later Core i architectures */
+
+	arch_k6               = 11, /**< k6 architecture */
+	arch_geode            = 12, /**< Geode architecture */
+	arch_athlon           = 13, /**< Athlon architecture */
+	arch_k8               = 14, /**< K8/Opteron architecture */
+	arch_k10              = 15, /**< K10/Barcelona architecture */
+	arch_zen              = 16, /**< Zen architecture */
+
+	arch_mask             = 0x0000001F,
+
+	arch_feature_mmx      = 0x00000020, /**< MMX instructions */
+	arch_feature_cmov     = 0x00000040, /**< cmov instructions */
+	arch_feature_p6_insn  = 0x00000080, /**< PentiumPro instructions */
+	arch_feature_sse1     = 0x00000100, /**< SSE1 instructions */
+	arch_feature_sse2     = 0x00000200, /**< SSE2 instructions */
+	arch_feature_sse3     = 0x00000400, /**< SSE3 instructions */
+	arch_feature_ssse3    = 0x00000800, /**< SSSE3 instructions */
+	arch_feature_3DNow    = 0x00001000, /**< 3DNow! instructions */
+	arch_feature_3DNowE   = 0x00002000, /**< Enhanced 3DNow! instructions */
+	arch_feature_64bit    = 0x00004000, /**< x86_64 support */
+	arch_feature_sse4_1   = 0x00008000, /**< SSE4.1 instructions */
+	arch_feature_sse4_2   = 0x00010000, /**< SSE4.2 instructions */
+	arch_feature_sse4a    = 0x00020000, /**< SSE4a instructions */
+	arch_feature_popcnt   = 0x00040000, /**< popcnt instruction */
+	arch_feature_lzcnt    = 0x00080000, /**< lzcnt instruction */
+	arch_feature_bmi1     = 0x00100000, /**< BMI1 instructions (andn, blsr, tzcnt, ...) */
+	arch_feature_bmi2     = 0x00200000, /**< BMI2 instructions (shlx, shrx, sarx, ...) */
+	arch_feature_movbe    = 0x00400000, /**< movbe instruction */
+	arch_feature_erms     = 0x00800000, /**< fast rep movsb/stosb */
 
 	arch_mmx_insn     = arch_feature_mmx,                         /**< MMX instructions */
 	arch_sse1_insn    = arch_feature_sse1   | arch_mmx_insn,      /**< SSE1 instructions, include MMX */
@@ -85,6 +94,7 @@ typedef enum cpu_arch_features {
 	arch_3DNow_insn   = arch_feature_3DNow  | arch_feature_mmx,   /**< 3DNow! instructions, including MMX */
 	arch_3DNowE_insn  = arch_feature_3DNowE | arch_3DNow_insn,    /**< Enhanced 3DNow! instructions */
 	arch_64bit_insn   = arch_feature_64bit  | arch_sse2_insn,     /**< x86_64 support, includes SSE2 */
+	arch_bmi_insn     = arch_feature_bmi1   | arch_feature_bmi2 | arch_feature_lzcnt, /**< BMI1, BMI2 and lzcnt */
 
 	cpu_generic             = arch_generic32,
 
@@ -105,8 +115,12 @@ typedef enum cpu_arch_features {
 	cpu_core2_generic       = arch_core2 | arch_feature_p6_insn,
 	cpu_core2               = arch_core2 | arch_feature_cmov | arch_feature_p6_insn | arch_64bit_insn | arch_ssse3_insn,
 	cpu_penryn              = arch_core2 | arch_feature_cmov | arch_feature_p6_insn | arch_64bit_insn | arch_sse4_1_insn,
+	cpu_core_i_generic      = arch_core_i | arch_feature_p6_insn,
+	cpu_nehalem             = arch_core_i | arch_feature_cmov | arch_feature_p6_insn | arch_64bit_insn | arch_sse4_2_insn | arch_feature_popcnt,
+	cpu_haswell             = cpu_nehalem | arch_bmi_insn | arch_feature_movbe | arch_feature_erms,
 	cpu_atom_generic        = arch_atom | arch_feature_p6_insn,
-	cpu_atom                = arch_atom | arch_feature_cmov | arch_feature_p6_insn | arch_ssse3_insn,
+	cpu_atom                = arch_atom | arch_feature_cmov | arch_feature_p6_insn | arch_ssse3_insn | arch_feature_movbe,
+	cpu_silvermont          = arch_atom | arch_feature_cmov | arch_feature_p6_insn | arch_64bit_insn | arch_sse4_2_insn | arch_feature_popcnt | arch_feature_movbe,
 
 	/* AMD CPUs */
 	cpu_k6_generic     = arch_k6,
@@ -122,7 +136,11 @@ typedef enum cpu_arch_features {
 	cpu_k8             = arch_k8  | arch_3DNowE_insn | arch_feature_cmov | arch_feature_p6_insn | arch_64bit_insn,
 	cpu_k8_sse3        = arch_k8  | arch_3DNowE_insn | arch_feature_cmov | arch_feature_p6_insn | arch_64bit_insn | arch_sse3_insn,
 	cpu_k10_generic    = arch_k10 | arch_feature_p6_insn,
-	cpu_k10            = arch_k10 | arch_3DNowE_insn | arch_feature_cmov | arch_feature_p6_insn | arch_feature_popcnt | arch_64bit_insn | arch_sse4a_insn,
+	cpu_k10            = arch_k10 | arch_3DNowE_insn | arch_feature_cmov | arch_feature_p6_insn | arch_feature_popcnt | arch_feature_lzcnt | arch_64bit_insn | arch_sse4a_insn,
+	cpu_bulldozer      = arch_k10 | arch_feature_cmov | arch_feature_p6_insn | arch_feature_popcnt | arch_feature_lzcnt | arch_64bit_insn | arch_sse4_2_insn | arch_sse4a_insn,
+	cpu_piledriver     = cpu_bulldozer | arch_feature_bmi1,
+	cpu_zen_generic    = arch_zen | arch_feature_p6_insn,
+	cpu_zen            = arch_zen | arch_feature_cmov | arch_feature_p6_insn | arch_feature_popcnt | arch_64bit_insn | arch_sse4_2_insn | arch_sse4a_insn | arch_bmi_insn | arch_feature_movbe | arch_feature_erms,
 
 	/* other CPUs */
 	cpu_winchip_c6  = arch_i486 | arch_feature_mmx,
@@ -134,6 +152,15 @@ typedef enum cpu_arch_features {
 } cpu_arch_features;
 ENUM_BITSET(cpu_arch_features)
 
+/** Set of architectures containing only @p a, see is_arch(). */
+#define ARCH(a)          (1u << arch_##a)
+/** Core2 and its successors. */
+#define ARCH_CORE        (ARCH(core2) | ARCH(core_i))
+/** Athlon and its successors up to K10. */
+#define ARCH_ATHLON_PLUS (ARCH(athlon) | ARCH(k8) | ARCH(k10))
+/** All AMD architectures. */
+#define ARCH_ALL_AMD     (ARCH(k6) | ARCH(geode) | ARCH_ATHLON_PLUS | ARCH(zen))
+
 static int               opt_size             = 0;
 static int               emit_machcode        = 0;
 static int               use_softfloat        = 0;
@@ -151,6 +178,7 @@ static cpu_arch_features opt_arch             = 0;
 static int               fpu_arch             = 0;
 static int               opt_cc               = 1;
 static int               opt_unsafe_floatconv = 0;
+static int               opt_no_x87           = 0;
 
 /* instruction set architectures. */
 static const lc_opt_enum_int_items_t arch_items[] = {
@@ -176,7 +204,20 @@ static const lc_opt_enum_int_items_t arch_items[] = {
 	{ "merom",        cpu_core2 },
 	{ "core2",        cpu_core2 },
 	{ "penryn",       cpu_penryn },
+	{ "nehalem",      cpu_nehalem },
+	{ "corei7",       cpu_nehalem },
+	{ "westmere",     cpu_nehalem },
+	{ "sandybridge",  cpu_nehalem },
+	{ "corei7-avx",   cpu_nehalem },
+	{ "ivybridge",    cpu_nehalem },
+	{ "core-avx-i",   cpu_nehalem },
+	{ "haswell",      cpu_haswell },
+	{ "core-avx2",    cpu_haswell },
+	{ "broadwell",    cpu_haswell },
+	{ "skylake",      cpu_haswell },
 	{ "atom",         cpu_atom },
+	{ "bonnell",      cpu_atom },
+	{ "silvermont",   cpu_silvermont },
 
 	{ "k6",           cpu_k6 },
 	{ "k6-2",         cpu_k6_PLUS },
@@ -196,6 +237,11 @@ static const lc_opt_enum_int_items_t arch_items[] = {
 	{ "k10",          cpu_k10 },
 	{ "barcelona",    cpu_k10 },
 	{ "amdfam10",     cpu_k10 },
+	{ "bdver1",       cpu_bulldozer },
+	{ "bdver2",       cpu_piledriver },
+	{ "znver1",       cpu_zen },
+	{ "znver2",       cpu_zen },
+	{ "znver3",       cpu_zen },
 
 	{ "winchip-c6",   cpu_winchip_c6, },
 	{ "winchip2",     cpu_winchip2 },
@@ -240,6 +286,7 @@ static const lc_opt_table_entry_t ia32_architecture_options[] = {
 	LC_OPT_ENT_BOOL    ("unsafe_floatconv", "do unsafe floating point controlword optimisations", &opt_unsafe_floatconv),
 	LC_OPT_ENT_BOOL    ("machcode",         "output machine code instead of assembler",           &emit_machcode),
 	LC_OPT_ENT_BOOL    ("soft-float",       "equivalent to fpmath=softfloat",                     &use_softfloat),
+	LC_OPT_ENT_BOOL    ("nox87",            "avoid the x87 unit, report nodes needing it",        &opt_no_x87),
 	LC_OPT_ENT_BOOL    ("sse",              "gcc compatibility",                                  &use_sse),
 	LC_OPT_ENT_BOOL    ("sse2",             "gcc compatibility",                                  &use_sse2),
 	LC_OPT_ENT_BOOL    ("sse3",             "gcc compatibility",                                  &use_sse3),
@@ -419,6 +466,30 @@ static const insn_const core2_cost = {
 	10,  /* maximum skip for alignment of loops labels */
 };
 
+/* costs for Nehalem and later Core i */
+static const insn_const core_i_cost = {
+	1,   /* cost of an add instruction */
+	1,   /* cost of a lea instruction */
+	1,   /* cost of a constant shift instruction */
+	3,   /* starting cost of a multiply instruction */
+	0,   /* cost of multiply for every set bit */
+	4,   /* logarithm for alignment of function labels */
+	4,   /* logarithm for alignment of loops labels */
+	10,  /* maximum skip for alignment of loops labels */
+};
+
+/* costs for the Zen */
+static const insn_const zen_cost = {
+	1,   /* cost of an add instruction */
+	1,   /* cost of a lea instruction */
+	1,   /* cost of a constant shift instruction */
+	3,   /* starting cost of a multiply instruction */
+	0,   /* cost of multiply for every set bit */
+	4,   /* logarithm for alignment of function labels */
+	4,   /* logarithm for alignment of loops labels */
+	7,   /* maximum skip for alignment of loops labels */
+};
+
 /* costs for the generic32 */
 static const insn_const generic32_cost = {
 	1,   /* cost of an add instruction */
@@ -447,16 +518,231 @@ static void set_arch_costs(void)
 	case arch_netburst:  arch_costs = &netburst_cost;   break;
 	case arch_nocona:    arch_costs = &nocona_cost;     break;
 	case arch_core2:     arch_costs = &core2_cost;      break;
+	case arch_core_i:    arch_costs = &core_i_cost;     break;
 	case arch_k6:        arch_costs = &k6_cost;         break;
 	case arch_geode:     arch_costs = &geode_cost;      break;
 	case arch_athlon:    arch_costs = &athlon_cost;     break;
 	case arch_k8:        arch_costs = &k8_cost;         break;
 	case arch_k10:       arch_costs = &k10_cost;        break;
+	case arch_zen:       arch_costs = &zen_cost;        break;
 	default:
 	case arch_generic32: arch_costs = &generic32_cost;  break;
 	}
 }
 
+/**
+ * Machine model of a CPU family for the schedulers: latency, reciprocal
+ * throughput and execution ports for each execution unit class. The numbers
+ * are taken from the vendor optimization manuals and Agner Fog's instruction
+ * tables, using register operands and 32bit modes.
+ */
+typedef struct ia32_machine_model_t {
+	arch_machine_t    machine;
+	arch_sched_insn_t units[ia32_unit_last];
+} ia32_machine_model_t;
+
+#define P(n) (1u << (n))
+
+/* scalar in-order cores: i386, i486, Geode */
+static const ia32_machine_model_t i486_model = {
+	{ "i486", 1, 1 },
+	{
+		[ia32_unit_alu]    = {  1,  1, P(0) },
+		[ia32_unit_mul]    = { 13, 13, P(0) },
+		[ia32_unit_div]    = { 40, 40, P(0) },
+		[ia32_unit_load]   = {  1,  1, P(0) },
+		[ia32_unit_store]  = {  1,  1, P(0) },
+		[ia32_unit_branch] = {  3,  3, P(0) },
+		[ia32_unit_fp_add] = {  8,  8, P(0) },
+		[ia32_unit_fp_mul] = { 16, 16, P(0) },
+		[ia32_unit_fp_div] = { 73, 73, P(0) },
+	}
+};
+
+/* Pentium: in-order with U and V pipe */
+static const ia32_machine_model_t pentium_model = {
+	{ "pentium", 2, 2 },
+	{
+		[ia32_unit_alu]    = {  1,  1, P(0) | P(1) },
+		[ia32_unit_mul]    = { 10, 10, P(0) },
+		[ia32_unit_div]    = { 41, 41, P(0) },
+		[ia32_unit_load]   = {  1,  1, P(0) | P(1) },
+		[ia32_unit_store]  = {  1,  1, P(0) | P(1) },
+		[ia32_unit_branch] = {  1,  1, P(1) },
+		[ia32_unit_fp_add] = {  3,  1, P(0) },
+		[ia32_unit_fp_mul] = {  3,  2, P(0) },
+		[ia32_unit_fp_div] = { 39, 39, P(0) },
+	}
+};
+
+/* PentiumPro, Pentium II/III/M: ports 0,1 alu, 2 load, 3/4 store */
+static const ia32_machine_model_t ppro_model = {
+	{ "ppro", 3, 5 },
+	{
+		[ia32_unit_alu]    = {  1,  1, P(0) | P(1) },
+		[ia32_unit_mul]    = {  4,  1, P(0) },
+		[ia32_unit_div]    = { 39, 37, P(0) },
+		[ia32_unit_load]   = {  3,  1, P(2) },
+		[ia32_unit_store]  = {  1,  1, P(3) | P(4) },
+		[ia32_unit_branch] = {  1,  1, P(1) },
+		[ia32_unit_fp_add] = {  3,  1, P(0) },
+		[ia32_unit_fp_mul] = {  5,  2, P(0) },
+		[ia32_unit_fp_div] = { 38, 37, P(0) },
+	}
+};
+
+/* Pentium 4, Nocona: double speed alus on ports 0,1, long latencies */
+static const ia32_machine_model_t netburst_model = {
+	{ "netburst", 3, 4 },
+	{
+		[ia32_unit_alu]    = {  1,  1, P(0) | P(1) },
+		[ia32_unit_mul]    = { 14,  3, P(1) },
+		[ia32_unit_div]    = { 56, 23, P(1) },
+		[ia32_unit_load]   = {  4,  1, P(2) },
+		[ia32_unit_store]  = {  2,  1, P(3) },
+		[ia32_unit_branch] = {  1,  1, P(0) },
+		[ia32_unit_fp_add] = {  5,  1, P(1) },
+		[ia32_unit_fp_mul] = {  7,  2, P(0) },
+		[ia32_unit_fp_div] = { 38, 38, P(0) },
+	}
+};
+
+/* Core2: 4 wide, alus on ports 0,1,5 */
+static const ia32_machine_model_t core2_model = {
+	{ "core2", 4, 6 },
+	{
+		[ia32_unit_alu]    = {  1,  1, P(0) | P(1) | P(5) },
+		[ia32_unit_mul]    = {  3,  1, P(1) },
+		[ia32_unit_div]    = { 22, 12, P(0) },
+		[ia32_unit_load]   = {  3,  1, P(2) },
+		[ia32_unit_store]  = {  1,  1, P(3) | P(4) },
+		[ia32_unit_branch] = {  1,  1, P(5) },
+		[ia32_unit_fp_add] = {  3,  1, P(1) },
+		[ia32_unit_fp_mul] = {  5,  1, P(0) },
+		[ia32_unit_fp_div] = { 20, 18, P(0) },
+	}
+};
+
+/* Haswell and later Core i: 4 wide, alus on ports 0,1,5,6, agus on 2,3 */
+static const ia32_machine_model_t core_i_model = {
+	{ "core_i", 4, 8 },
+	{
+		[ia32_unit_alu]    = {  1,  1, P(0) | P(1) | P(5) | P(6) },
+		[ia32_unit_mul]    = {  3,  1, P(1) },
+		[ia32_unit_div]    = { 26,  6, P(0) },
+		[ia32_unit_load]   = {  5,  1, P(2) | P(3) },
+		[ia32_unit_store]  = {  1,  1, P(4) },
+		[ia32_unit_branch] = {  1,  1, P(0) | P(6) },
+		[ia32_unit_fp_add] = {  4,  1, P(0) | P(1) },
+		[ia32_unit_fp_mul] = {  4,  1, P(0) | P(1) },
+		[ia32_unit_fp_div] = { 14,  4, P(0) },
+	}
+};
+
+/* Atom: 2 wide in-order */
+static const ia32_machine_model_t atom_model = {
+	{ "atom", 2, 2 },
+	{
+		[ia32_unit_alu]    = {  1,  1, P(0) | P(1) },
+		[ia32_unit_mul]    = {  5,  2, P(0) },
+		[ia32_unit_div]    = { 49, 49, P(0) },
+		[ia32_unit_load]   = {  3,  1, P(0) },
+		[ia32_unit_store]  = {  1,  1, P(0) },
+		[ia32_unit_branch] = {  1,  1, P(1) },
+		[ia32_unit_fp_add] = {  5,  1, P(1) },
+		[ia32_unit_fp_mul] = {  5,  2, P(0) },
+		[ia32_unit_fp_div] = { 31, 31, P(0) },
+	}
+};
+
+/* K6: 2 wide, separate load, store and branch units */
+static const ia32_machine_model_t k6_model = {
+	{ "k6", 2, 5 },
+	{
+		[ia32_unit_alu]    = {  1,  1, P(0) | P(1) },
+		[ia32_unit_mul]    = {  3,  2, P(0) },
+		[ia32_unit_div]    = { 20, 20, P(0) },
+		[ia32_unit_load]   = {  2,  1, P(2) },
+		[ia32_unit_store]  = {  1,  1, P(3) },
+		[ia32_unit_branch] = {  1,  1, P(4) },
+		[ia32_unit_fp_add] = {  2,  2, P(0) },
+		[ia32_unit_fp_mul] = {  2,  2, P(0) },
+		[ia32_unit_fp_div] = { 39, 39, P(0) },
+	}
+};
+
+/* Athlon, K8, K10: 3 alus, 2 agus, separate fadd and fmul pipes */
+static const ia32_machine_model_t athlon_model = {
+	{ "athlon", 3, 7 },
+	{
+		[ia32_unit_alu]    = {  1,  1, P(0) | P(1) | P(2) },
+		[ia32_unit_mul]    = {  3,  1, P(0) },
+		[ia32_unit_div]    = { 40, 40, P(0) },
+		[ia32_unit_load]   = {  3,  1, P(3) | P(4) },
+		[ia32_unit_store]  = {  3,  1, P(3) | P(4) },
+		[ia32_unit_branch] = {  1,  1, P(0) | P(1) | P(2) },
+		[ia32_unit_fp_add] = {  4,  1, P(5) },
+		[ia32_unit_fp_mul] = {  4,  1, P(6) },
+		[ia32_unit_fp_div] = { 20, 17, P(6) },
+	}
+};
+
+/* Zen: 4 alus, 2 agus, fmul on fp pipes 0,1 and fadd on fp pipes 2,3 */
+static const ia32_machine_model_t zen_model = {
+	{ "zen", 4, 10 },
+	{
+		[ia32_unit_alu]    = {  1,  1, P(0) | P(1) | P(2) | P(3) },
+		[ia32_unit_mul]    = {  3,  1, P(1) },
+		[ia32_unit_div]    = { 25, 14, P(2) },
+		[ia32_unit_load]   = {  4,  1, P(4) | P(5) },
+		[ia32_unit_store]  = {  1,  1, P(4) | P(5) },
+		[ia32_unit_branch] = {  1,  1, P(0) | P(3) },
+		[ia32_unit_fp_add] = {  3,  1, P(8) | P(9) },
+		[ia32_unit_fp_mul] = {  3,  1, P(6) | P(7) },
+		[ia32_unit_fp_div] = { 13,  5, P(9) },
+	}
+};
+
+#undef P
+
+static const ia32_machine_model_t *machine_model = &ppro_model;
+
+static void set_machine_model(void)
+{
+	switch (opt_arch & arch_mask) {
+	case arch_i386:
+	case arch_i486:
+	case arch_geode:     machine_model = &i486_model;     break;
+	case arch_pentium:   machine_model = &pentium_model;  break;
+	case arch_netburst:
+	case arch_nocona:    machine_model = &netburst_model; break;
+	case arch_core2:     machine_model = &core2_model;    break;
+	case arch_core_i:    machine_model = &core_i_model;   break;
+	case arch_atom:      machine_model = &atom_model;     break;
+	case arch_k6:        machine_model = &k6_model;       break;
+	case arch_athlon:
+	case arch_k8:
+	case arch_k10:       machine_model = &athlon_model;   break;
+	case arch_zen:       machine_model = &zen_model;      break;
+	default:
+	case arch_ppro:
+	case arch_generic32: machine_model = &ppro_model;     break;
+	}
+}
+
+const arch_machine_t *ia32_get_machine(void)
+{
+	return &machine_model->machine;
+}
+
+bool ia32_get_unit_model(ia32_exec_unit_t unit, arch_sched_insn_t *insn)
+{
+	if (unit == ia32_unit_other)
+		return false;
+	*insn = machine_model->units[unit];
+	return true;
+}
+
 /* Evaluate the costs of an instruction. */
 int ia32_evaluate_insn(insn_kind kind, const ir_mode *mode, ir_tarval *tv)
 {
@@ -516,6 +802,8 @@ typedef struct x86_cpu_info_t {
 	unsigned      edx_features;
 	unsigned      ecx_features;
 	unsigned      add_features;
+	unsigned      ebx7_features;    /**< extended features of leaf 7 */
+	unsigned      ecx_ext_features; /**< extended features of leaf 0x80000001 */
 } x86_cpu_info_t;
 
 enum {
@@ -574,7 +862,16 @@ enum {
 	CPUID_FEAT_EDX_HTT       = 1 << 28,
 	CPUID_FEAT_EDX_TM1       = 1 << 29,
 	CPUID_FEAT_EDX_IA64      = 1 << 30,
-	CPUID_FEAT_EDX_PBE       = 1 << 31
+	CPUID_FEAT_EDX_PBE       = 1 << 31,
+
+	CPUID_FEAT_EBX7_BMI1     = 1 << 3,
+	CPUID_FEAT_EBX7_AVX2     = 1 << 5,
+	CPUID_FEAT_EBX7_BMI2     = 1 << 8,
+	CPUID_FEAT_EBX7_ERMS     = 1 << 9,
+
+	CPUID_FEAT_ECX_EXT_LAHF  = 1 << 0,
+	CPUID_FEAT_ECX_EXT_ABM   = 1 << 5,
+	CPUID_FEAT_ECX_EXT_SSE4A = 1 << 6,
 };
 
 static cpu_arch_features auto_detect_Intel(x86_cpu_info_t const *info)
@@ -610,10 +907,32 @@ static cpu_arch_features auto_detect_Intel(x86_cpu_info_t const *info)
 		case 0x15: /* Intel EP80579 */
 		case 0x16: /* Celeron Model 16 */
 		case 0x17: /* Core2 Model 17 */
+		case 0x1D: /* Xeon MP */
 			auto_arch = cpu_core2_generic;
 			break;
+		case 0x1C: /* Atom */
+		case 0x26: /* Atom Lincroft */
+		case 0x27: /* Atom Saltwell */
+		case 0x35: /* Atom Cloverview */
+		case 0x36: /* Atom Cedarview */
+		case 0x37: /* Silvermont */
+		case 0x4A: /* Silvermont */
+		case 0x4C: /* Airmont */
+		case 0x4D: /* Silvermont Avoton */
+		case 0x5A: /* Silvermont Anniedale */
+		case 0x5C: /* Goldmont */
+		case 0x5D: /* Silvermont SoFIA */
+		case 0x5F: /* Goldmont Denverton */
+		case 0x7A: /* Goldmont Plus */
+		case 0x86: /* Tremont Jacobsville */
+		case 0x96: /* Tremont Elkhart Lake */
+		case 0x9C: /* Tremont Jasper Lake */
+			auto_arch = cpu_atom_generic;
+			break;
 		default:
-			/* unknown */
+			/* Nehalem (model 1A) and all later big cores */
+			if (model >= 0x1A)
+				auto_arch = cpu_core_i_generic;
 			break;
 		}
 		break;
@@ -627,15 +946,6 @@ static cpu_arch_features auto_detect_Intel(x86_cpu_info_t const *info)
 		case 0x06: /* Pentium 4 Model 06 */
 			auto_arch = cpu_netburst_generic;
 			break;
-		case 0x1A: /* Core i7 */
-			auto_arch = cpu_core2_generic;
-			break;
-		case 0x1C: /* Atom */
-			auto_arch = cpu_atom_generic;
-			break;
-		case 0x1D: /* Xeon MP */
-			auto_arch = cpu_core2_generic;
-			break;
 		default:
 			/* unknown */
 			break;
@@ -714,8 +1024,14 @@ static cpu_arch_features auto_detect_AMD(x86_cpu_info_t const *info)
 	case 0x12: /* AMD Family 12h */
 	case 0x14: /* AMD Family 14h */
 	case 0x15: /* AMD Family 15h */
+	case 0x16: /* AMD Family 16h */
 		auto_arch = cpu_k10_generic;
 		break;
+	case 0x17: /* Zen, Zen+, Zen2 */
+	case 0x19: /* Zen3, Zen4 */
+	case 0x1A: /* Zen5 */
+		auto_arch = cpu_zen_generic;
+		break;
 	default:
 		/* unknown */
 		break;
@@ -736,6 +1052,7 @@ typedef union {
 
 static void x86_cpuid(cpuid_registers *regs, unsigned level)
 {
+	/* leaf 7 has sub-leafs selected by ecx, we always query sub-leaf 0 */
 #if defined(__GNUC__)
 #	if defined(__PIC__) && !defined(__amd64) // GCC cannot handle EBX in PIC
 	__asm (
@@ -744,16 +1061,16 @@ static void x86_cpuid(cpuid_registers *regs, unsigned level)
 		"movl %%ebx, %1\n\t"
 		"popl %%ebx"
 	: "=a" (regs->r.eax), "=r" (regs->r.ebx), "=c" (regs->r.ecx), "=d" (regs->r.edx)
-	: "a" (level)
+	: "a" (level), "c" (0)
 	);
 #	else
 	__asm ("cpuid\n\t"
 	: "=a" (regs->r.eax), "=b" (regs->r.ebx), "=c" (regs->r.ecx), "=d" (regs->r.edx)
-	: "a" (level)
+	: "a" (level), "c" (0)
 	);
 #	endif
 #elif defined(_MSC_VER)
-	__cpuid(regs->bulk, level);
+	__cpuidex(regs->bulk, level, 0);
 #else
 #	error CPUID is missing
 #endif
@@ -813,6 +1130,7 @@ static void autodetect_arch(void)
 
 		/* get vendor ID */
 		x86_cpuid(&regs, 0);
+		unsigned const max_level = regs.r.eax;
 		memcpy(&vendorid[0], &regs.r.ebx, 4);
 		memcpy(&vendorid[4], &regs.r.edx, 4);
 		memcpy(&vendorid[8], &regs.r.ecx, 4);
@@ -831,6 +1149,21 @@ static void autodetect_arch(void)
 		cpu_info.ecx_features   = regs.r.ecx;
 		cpu_info.add_features   = regs.r.ebx;
 
+		/* get structured extended feature flags */
+		cpu_info.ebx7_features = 0;
+		if (max_level >= 7) {
+			x86_cpuid(&regs, 7);
+			cpu_info.ebx7_features = regs.r.ebx;
+		}
+
+		/* get extended processor info and feature bits */
+		cpu_info.ecx_ext_features = 0;
+		x86_cpuid(&regs, 0x80000000);
+		if (regs.r.eax >= 0x80000001) {
+			x86_cpuid(&regs, 0x80000001);
+			cpu_info.ecx_ext_features = regs.r.ecx;
+		}
+
 		if        (0 == strcmp(vendorid, "GenuineIntel")) {
 			auto_arch = auto_detect_Intel(&cpu_info);
 		} else if (0 == strcmp(vendorid, "AuthenticAMD")) {
@@ -858,6 +1191,20 @@ static void autodetect_arch(void)
 			auto_arch |= arch_feature_sse4_2;
 		if (cpu_info.ecx_features & CPUID_FEAT_ECX_POPCNT)
 			auto_arch |= arch_feature_popcnt;
+		if (cpu_info.ecx_features & CPUID_FEAT_ECX_MOVBE)
+			auto_arch |= arch_feature_movbe;
+
+		if (cpu_info.ebx7_features & CPUID_FEAT_EBX7_BMI1)
+			auto_arch |= arch_feature_bmi1;
+		if (cpu_info.ebx7_features & CPUID_FEAT_EBX7_BMI2)
+			auto_arch |= arch_feature_bmi2;
+		if (cpu_info.ebx7_features & CPUID_FEAT_EBX7_ERMS)
+			auto_arch |= arch_feature_erms;
+
+		if (cpu_info.ecx_ext_features & CPUID_FEAT_ECX_EXT_ABM)
+			auto_arch |= arch_feature_lzcnt;
+		if (cpu_info.ecx_ext_features & CPUID_FEAT_ECX_EXT_SSE4A)
+			auto_arch |= arch_feature_sse4a;
 	}
 
 	arch     = auto_arch;
@@ -870,6 +1217,15 @@ static bool flags(cpu_arch_features features, cpu_arch_features flags)
 	return (features & flags) != 0;
 }
 
+/**
+ * Checks whether the architecture of @p features is in the set @p archs,
+ * which is built with the ARCH() macros.
+ */
+static bool is_arch(cpu_arch_features features, unsigned archs)
+{
+	return (archs >> (features & arch_mask)) & 1;
+}
+
 void ia32_setup_cg_config(void)
 {
 	if (use_softfloat)
@@ -882,42 +1238,59 @@ void ia32_setup_cg_config(void)
 	if (opt_arch == 0)
 		opt_arch = arch;
 
+	/* use SSE2 if it is available and nothing else was requested, without
+	 * the x87 unit fall back to the soft float library */
+	if (opt_no_x87 && fpu_arch != IA32_FPU_ARCH_SOFTFLOAT) {
+		fpu_arch = flags(arch, arch_feature_sse2)
+		         ? IA32_FPU_ARCH_SSE2 : IA32_FPU_ARCH_SOFTFLOAT;
+	} else if (fpu_arch == IA32_FPU_ARCH_NONE) {
+		fpu_arch = flags(arch, arch_feature_sse2)
+		         ? IA32_FPU_ARCH_SSE2 : IA32_FPU_ARCH_X87;
+	}
+
 	set_arch_costs();
+	set_machine_model();
 
 	ia32_code_gen_config_t *const c = &ia32_cg_config;
 	memset(c, 0, sizeof(*c));
 	c->optimize_size        = opt_size != 0;
 	/* on newer intel cpus mov, pop is often faster than leave although it has a
 	 * longer opcode */
-	c->use_leave            = flags(opt_arch, arch_i386 | arch_all_amd | arch_core2) || opt_size;
+	c->use_leave            = is_arch(opt_arch, ARCH(i386) | ARCH_ALL_AMD | ARCH_CORE) || opt_size;
 	/* P4s don't like inc/decs because they only partially write the flags
 	 * register which produces false dependencies */
-	c->use_incdec           = !flags(opt_arch, arch_netburst | arch_nocona | arch_core2 | arch_geode) || opt_size;
+	c->use_incdec           = !is_arch(opt_arch, ARCH(netburst) | ARCH(nocona) | ARCH_CORE | ARCH(geode)) || opt_size;
 	c->use_softfloat        = (fpu_arch & IA32_FPU_ARCH_SOFTFLOAT) != 0;
 	c->use_sse2             = (fpu_arch & IA32_FPU_ARCH_SSE2) != 0 && flags(arch, arch_feature_sse2);
-	c->use_ffreep           = flags(opt_arch, arch_athlon_plus);
-	c->use_femms            = flags(opt_arch, arch_athlon_plus) && flags(arch, arch_feature_3DNow);
+	c->use_ffreep           = is_arch(opt_arch, ARCH_ATHLON_PLUS | ARCH(zen));
+	c->use_femms            = is_arch(opt_arch, ARCH_ATHLON_PLUS) && flags(arch, arch_feature_3DNow);
 	c->use_fucomi           = flags(arch, arch_feature_p6_insn);
 	c->use_cmov             = flags(arch, arch_feature_cmov);
-	c->use_modeD_moves      = flags(opt_arch, arch_generic32 | arch_athlon_plus | arch_netburst | arch_nocona | arch_core2 | arch_ppro | arch_geode);
-	c->use_add_esp_4        = flags(opt_arch, arch_generic32 | arch_athlon_plus | arch_netburst | arch_nocona | arch_core2 |             arch_geode)                         && !opt_size;
-	c->use_add_esp_8        = flags(opt_arch, arch_generic32 | arch_athlon_plus | arch_netburst | arch_nocona | arch_core2 | arch_ppro | arch_geode | arch_i386 | arch_i486) && !opt_size;
-	c->use_sub_esp_4        = flags(opt_arch, arch_generic32 | arch_athlon_plus | arch_netburst | arch_nocona | arch_core2 | arch_ppro)                                      && !opt_size;
-	c->use_sub_esp_8        = flags(opt_arch, arch_generic32 | arch_athlon_plus | arch_netburst | arch_nocona | arch_core2 | arch_ppro |              arch_i386 | arch_i486) && !opt_size;
-	c->use_imul_mem_imm32   = !flags(opt_arch, arch_k8 | arch_k10) || opt_size;
-	c->use_pxor             = flags(opt_arch, arch_netburst);
-	c->use_mov_0            = flags(opt_arch, arch_k6) && !opt_size;
-	c->use_short_sex_eax    = !flags(opt_arch, arch_k6) || opt_size;
-	c->use_pad_return       = flags(opt_arch, arch_athlon_plus) && !opt_size;
-	c->use_bt               = flags(opt_arch, arch_core2 | arch_athlon_plus) || opt_size;
+	c->use_modeD_moves      = is_arch(opt_arch, ARCH(generic32) | ARCH_ATHLON_PLUS | ARCH(zen) | ARCH(netburst) | ARCH(nocona) | ARCH_CORE | ARCH(ppro) | ARCH(geode));
+	c->use_add_esp_4        = is_arch(opt_arch, ARCH(generic32) | ARCH_ATHLON_PLUS | ARCH(zen) | ARCH(netburst) | ARCH(nocona) | ARCH_CORE |              ARCH(geode))                           && !opt_size;
+	c->use_add_esp_8        = is_arch(opt_arch, ARCH(generic32) | ARCH_ATHLON_PLUS | ARCH(zen) | ARCH(netburst) | ARCH(nocona) | ARCH_CORE | ARCH(ppro) | ARCH(geode) | ARCH(i386) | ARCH(i486)) && !opt_size;
+	c->use_sub_esp_4        = is_arch(opt_arch, ARCH(generic32) | ARCH_ATHLON_PLUS | ARCH(zen) | ARCH(netburst) | ARCH(nocona) | ARCH_CORE | ARCH(ppro))                                         && !opt_size;
+	c->use_sub_esp_8        = is_arch(opt_arch, ARCH(generic32) | ARCH_ATHLON_PLUS | ARCH(zen) | ARCH(netburst) | ARCH(nocona) | ARCH_CORE | ARCH(ppro) |               ARCH(i386) | ARCH(i486)) && !opt_size;
+	c->use_imul_mem_imm32   = !is_arch(opt_arch, ARCH(k8) | ARCH(k10)) || opt_size;
+	c->use_pxor             = is_arch(opt_arch, ARCH(netburst));
+	c->use_mov_0            = is_arch(opt_arch, ARCH(k6)) && !opt_size;
+	c->use_short_sex_eax    = !is_arch(opt_arch, ARCH(k6)) || opt_size;
+	c->use_pad_return       = is_arch(opt_arch, ARCH_ATHLON_PLUS) && !opt_size;
+	c->use_bt               = is_arch(opt_arch, ARCH_CORE | ARCH_ATHLON_PLUS | ARCH(zen)) || opt_size;
 	c->use_fisttp           = flags(opt_arch & arch, arch_feature_sse3);
 	c->use_sse_prefetch     = flags(arch, (arch_feature_3DNowE | arch_feature_sse1));
 	c->use_3dnow_prefetch   = flags(arch, arch_feature_3DNow);
 	c->use_popcnt           = flags(arch, arch_feature_popcnt);
+	c->use_lzcnt            = flags(arch, arch_feature_lzcnt);
+	c->use_bmi1             = flags(arch, arch_feature_bmi1);
+	c->use_bmi2             = flags(arch, arch_feature_bmi2);
+	c->use_movbe            = flags(arch, arch_feature_movbe);
+	c->use_rep_movsb        = flags(arch, arch_feature_erms) && !opt_size;
 	c->use_bswap            = (arch & arch_mask) >= arch_i486;
 	c->use_cmpxchg          = (arch & arch_mask) != arch_i386;
 	c->optimize_cc          = opt_cc;
 	c->use_unsafe_floatconv = opt_unsafe_floatconv;
+	c->no_x87               = opt_no_x87;
 	c->emit_machcode        = emit_machcode;
 
 	c->function_alignment       = arch_costs->function_alignment;
@@ -925,8 +1298,8 @@ void ia32_setup_cg_config(void)
 	c->label_alignment_max_skip = arch_costs->label_alignment_max_skip;
 
 	c->label_alignment_factor =
-		flags(opt_arch, arch_i386 | arch_i486) || opt_size ? 0 :
-		opt_arch & arch_all_amd                            ? 3 :
+		is_arch(opt_arch, ARCH(i386) | ARCH(i486)) || opt_size ? 0 :
+		is_arch(opt_arch, ARCH_ALL_AMD)                        ? 3 :
 		2;
 }
 
@@ -11,7 +11,10 @@
 #ifndef FIRM_BE_IA32_ARCHITECTURE_H
 #define FIRM_BE_IA32_ARCHITECTURE_H
 
+#include <stdbool.h>
 #include "irarch.h"
+#include "be_types.h"
+#include "ia32_nodes_attr.h"
 
 typedef struct {
 	/** optimize for size */
@@ -65,6 +68,16 @@ typedef struct {
 	unsigned use_3dnow_prefetch:1;
 	/** use SSE4.2 or SSE4a popcnt instruction */
 	unsigned use_popcnt:1;
+	/** use lzcnt instruction */
+	unsigned use_lzcnt:1;
+	/** use BMI1 instructions (andn, blsi, blsr, tzcnt) */
+	unsigned use_bmi1:1;
+	/** use BMI2 instructions (sarx, shlx, shrx) */
+	unsigned use_bmi2:1;
+	/** use movbe instruction */
+	unsigned use_movbe:1;
+	/** use rep movsb for block copies (fast string operations) */
+	unsigned use_rep_movsb:1;
 	/** use i486 instructions */
 	unsigned use_bswap:1;
 	/** use cmpxchg */
@@ -77,6 +90,8 @@ typedef struct {
 	 * rounding mode
 	 */
 	unsigned use_unsafe_floatconv:1;
+	/** avoid the x87 unit and report nodes which still need it */
+	unsigned no_x87:1;
 	/** emit machine code instead of assembler */
 	unsigned emit_machcode:1;
 
@@ -119,4 +134,18 @@ void ia32_setup_cg_config(void);
  */
 int ia32_evaluate_insn(insn_kind kind, const ir_mode *mode, ir_tarval *tv);
 
+/**
+ * Returns the machine model for the CPU selected with the tune (or arch)
+ * option.
+ */
+const arch_machine_t *ia32_get_machine(void);
+
+/**
+ * Looks up latency, reciprocal throughput and execution ports of an
+ * execution unit class in the selected machine model.
+ *
+ * @return false for ia32_unit_other, which is not modeled
+ */
+bool ia32_get_unit_model(ia32_exec_unit_t unit, arch_sched_insn_t *insn);
+
 #endif
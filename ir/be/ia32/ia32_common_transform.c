@@ -651,8 +651,13 @@ ir_node *ia32_gen_CopyB(ir_node *node)
 	/* If we have to copy more than 32 bytes, we use REP MOVSx and */
 	/* then we need the size explicitly in ECX.                    */
 	if (size >= 32 * 4) {
-		rem = size & 0x3; /* size % 4 */
-		size >>= 2;
+		if (ia32_cg_config.use_rep_movsb) {
+			/* fast string operations: rep movsb copies all bytes */
+			rem = 0;
+		} else {
+			rem = size & 0x3; /* size % 4 */
+			size >>= 2;
+		}
 
 		res = new_bd_ia32_Const(dbgi, block, NULL, 0, 0, size);
 
@@ -51,6 +51,7 @@
 #include "bedwarf.h"
 #include "beemitter.h"
 #include "begnuas.h"
+#include "beirg.h"
 #include "beutil.h"
 
 #include "ia32_emitter.h"
@@ -1097,12 +1098,17 @@ static void emit_CopyB_prolog(unsigned size)
 }
 
 /**
- * Emit rep movsd instruction for memcopy.
+ * Emit rep movsd (or rep movsb with fast string operations) instruction for
+ * memcopy.
  */
 static void emit_ia32_CopyB(const ir_node *node)
 {
 	unsigned size = get_ia32_copyb_size(node);
 
+	if (ia32_cg_config.use_rep_movsb) {
+		ia32_emitf(node, "rep movsb");
+		return;
+	}
 	emit_CopyB_prolog(size);
 	ia32_emitf(node, "rep movsd");
 }
@@ -1143,7 +1149,7 @@ static void emit_ia32_Conv_I2FP(const ir_node *node)
 
 static void emit_ia32_Conv_FP2I(const ir_node *node)
 {
-	emit_ia32_Conv_with_FP(node, "ss2si", "sd2si");
+	emit_ia32_Conv_with_FP(node, "tss2si", "tsd2si");
 }
 
 static void emit_ia32_Conv_FP2FP(const ir_node *node)
@@ -1183,7 +1189,11 @@ static void Copy_emitter(const ir_node *node, const ir_node *op)
 	if (in->reg_class == &ia32_reg_classes[CLASS_ia32_fp])
 		return;
 
-	ia32_emitf(node, "movl %R, %R", in, out);
+	if (in->reg_class == &ia32_reg_classes[CLASS_ia32_xmm]) {
+		ia32_emitf(node, "movaps %R, %R", in, out);
+	} else {
+		ia32_emitf(node, "movl %R, %R", in, out);
+	}
 }
 
 static void emit_be_Copy(const ir_node *node)
@@ -1653,6 +1663,23 @@ static parameter_dbg_info_t *construct_parameter_infos(ir_graph *irg)
 	return infos;
 }
 
+/**
+ * Emits the callframe information valid after the function prologue.
+ */
+static void ia32_emit_callframe_setup(void)
+{
+	if (sp_relative) {
+		be_dwarf_callframe_register(&ia32_registers[REG_ESP]);
+	} else {
+		/* well not entirely correct here, we should emit this after the
+		 * "movl esp, ebp" */
+		be_dwarf_callframe_register(&ia32_registers[REG_EBP]);
+		/* TODO: do not hardcode the following */
+		be_dwarf_callframe_offset(8);
+		be_dwarf_callframe_spilloffset(&ia32_registers[REG_EBP], -8);
+	}
+}
+
 /**
  * Main driver. Emits the code for one routine.
  */
@@ -1665,7 +1692,7 @@ void ia32_gen_routine(ir_graph *irg)
 	ir_node         **blk_sched = irg_data->blk_sched;
 	be_stack_layout_t *layout   = be_get_irg_stack_layout(irg);
 	parameter_dbg_info_t *infos;
-	int i, n;
+	int i, n, n_hot;
 
 	isa    = (ia32_isa_t*) arch_env;
 	do_pic = be_options.pic;
@@ -1685,30 +1712,25 @@ void ia32_gen_routine(ir_graph *irg)
 	if (layout->sp_relative) {
 		ir_type *frame_type = get_irg_frame_type(irg);
 		frame_type_size = get_type_size_bytes(frame_type);
-		be_dwarf_callframe_register(&ia32_registers[REG_ESP]);
-	} else {
-		/* well not entirely correct here, we should emit this after the
-		 * "movl esp, ebp" */
-		be_dwarf_callframe_register(&ia32_registers[REG_EBP]);
-		/* TODO: do not hardcode the following */
-		be_dwarf_callframe_offset(8);
-		be_dwarf_callframe_spilloffset(&ia32_registers[REG_EBP], -8);
 	}
+	ia32_emit_callframe_setup();
 
 	/* we use links to point to target blocks */
 	ir_reserve_resources(irg, IR_RESOURCE_IRN_LINK);
 	irg_block_walk_graph(irg, ia32_gen_labels, NULL, &exc_list);
 
-	/* initialize next block links */
-	n = ARR_LEN(blk_sched);
+	/* initialize next block links, the cold part is emitted into another
+	 * section, so nothing falls through into it */
+	n     = ARR_LEN(blk_sched);
+	n_hot = be_birg_from_irg(irg)->n_hot_blocks;
 	for (i = 0; i < n; ++i) {
 		ir_node *block = blk_sched[i];
-		ir_node *prev  = i > 0 ? blk_sched[i-1] : NULL;
+		ir_node *prev  = i > 0 && i != n_hot ? blk_sched[i-1] : NULL;
 
 		set_irn_link(block, prev);
 	}
 
-	for (i = 0; i < n; ++i) {
+	for (i = 0; i < n_hot; ++i) {
 		ir_node *block = blk_sched[i];
 
 		ia32_gen_block(block);
@@ -1716,6 +1738,15 @@ void ia32_gen_routine(ir_graph *irg)
 
 	be_gas_emit_function_epilog(entity);
 
+	if (n_hot < n) {
+		be_gas_emit_cold_part_prolog(entity);
+		ia32_emit_callframe_setup();
+		for (i = n_hot; i < n; ++i) {
+			ia32_gen_block(blk_sched[i]);
+		}
+		be_gas_emit_cold_part_epilog(entity);
+	}
+
 	ir_free_resources(irg, IR_RESOURCE_IRN_LINK);
 
 	/* Sort the exception table using the exception label id's.
@@ -2049,8 +2080,13 @@ static void bemit_copy(const ir_node *copy)
 	if (in->reg_class == &ia32_reg_classes[CLASS_ia32_fp])
 		return;
 
-	assert(in->reg_class == &ia32_reg_classes[CLASS_ia32_gp]);
-	bemit8(0x8B);
+	if (in->reg_class == &ia32_reg_classes[CLASS_ia32_xmm]) {
+		bemit8(0x0F); // movaps
+		bemit8(0x28);
+	} else {
+		assert(in->reg_class == &ia32_reg_classes[CLASS_ia32_gp]);
+		bemit8(0x8B);
+	}
 	bemit_modrr(in, out);
 }
 
@@ -2792,6 +2828,109 @@ static void bemit_popcnt(ir_node const *const node)
 	bemit_0f_unop_reg(node, 0xB8, n_ia32_Popcnt_operand);
 }
 
+/**
+ * Emits a three byte VEX prefix for an instruction of the 0F38 opcode map.
+ *
+ * @param vvvv  the additional register operand
+ * @param pp    the implied prefix: 0 none, 1 0x66, 2 0xF3, 3 0xF2
+ */
+static void bemit_vex_0f38(const arch_register_t *vvvv, unsigned char pp)
+{
+	bemit8(0xC4);
+	/* R, X and B are inverted and unused in 32bit mode */
+	bemit8(0xE0 | 0x02);
+	bemit8(((~vvvv->encoding & 0xF) << 3) | pp);
+}
+
+static void bemit_andn(ir_node const *const node)
+{
+	const arch_register_t *left = arch_get_irn_register_in(node, n_ia32_Andn_left);
+	const arch_register_t *out  = arch_get_irn_register_out(node, pn_ia32_Andn_res);
+	bemit_vex_0f38(left, 0);
+	bemit8(0xF2);
+	if (get_ia32_op_type(node) == ia32_Normal) {
+		const arch_register_t *right = arch_get_irn_register_in(node, n_ia32_Andn_right);
+		bemit_modrr(right, out);
+	} else {
+		bemit_mod_am(out->encoding, node);
+	}
+}
+
+static void bemit_bmi1_unop(ir_node const *const node, unsigned char ext)
+{
+	const arch_register_t *out = arch_get_irn_register_out(node, pn_ia32_res);
+	bemit_vex_0f38(out, 0);
+	bemit_unop(node, 0xF3, ext, n_ia32_unary_op);
+}
+
+static void bemit_blsi(ir_node const *const node)
+{
+	bemit_bmi1_unop(node, 3);
+}
+
+static void bemit_blsr(ir_node const *const node)
+{
+	bemit_bmi1_unop(node, 1);
+}
+
+static void bemit_shiftx(ir_node const *const node, unsigned char pp)
+{
+	const arch_register_t *val   = arch_get_irn_register_in(node, n_ia32_Shlx_val);
+	const arch_register_t *count = arch_get_irn_register_in(node, n_ia32_Shlx_count);
+	const arch_register_t *out   = arch_get_irn_register_out(node, 0);
+	bemit_vex_0f38(count, pp);
+	bemit8(0xF7);
+	bemit_modrr(val, out);
+}
+
+static void bemit_shlx(ir_node const *const node)
+{
+	bemit_shiftx(node, 1);
+}
+
+static void bemit_shrx(ir_node const *const node)
+{
+	bemit_shiftx(node, 3);
+}
+
+static void bemit_sarx(ir_node const *const node)
+{
+	bemit_shiftx(node, 2);
+}
+
+static void bemit_lzcnt(ir_node const *const node)
+{
+	bemit8(0xF3);
+	bemit_0f_unop_reg(node, 0xBD, n_ia32_Lzcnt_operand);
+}
+
+static void bemit_tzcnt(ir_node const *const node)
+{
+	bemit8(0xF3);
+	bemit_0f_unop_reg(node, 0xBC, n_ia32_Tzcnt_operand);
+}
+
+static void bemit_movbe(ir_node const *const node, unsigned char code,
+                        const arch_register_t *reg)
+{
+	if (get_mode_size_bits(get_ia32_ls_mode(node)) == 16)
+		bemit8(0x66);
+	bemit8(0x0F);
+	bemit8(0x38);
+	bemit8(code);
+	bemit_mod_am(reg->encoding, node);
+}
+
+static void bemit_movbeload(ir_node const *const node)
+{
+	bemit_movbe(node, 0xF0, arch_get_irn_register_out(node, pn_ia32_MovbeLoad_res));
+}
+
+static void bemit_movbestore(ir_node const *const node)
+{
+	bemit_movbe(node, 0xF1, arch_get_irn_register_in(node, n_ia32_MovbeStore_val));
+}
+
 /**
  * Emit a Push.
  */
@@ -3281,8 +3420,11 @@ static void ia32_register_binary_emitters(void)
 	be_set_emitter(op_ia32_AddMem,        bemit_addmem);
 	be_set_emitter(op_ia32_And,           bemit_and);
 	be_set_emitter(op_ia32_AndMem,        bemit_andmem);
+	be_set_emitter(op_ia32_Andn,          bemit_andn);
 	be_set_emitter(op_ia32_Asm,           emit_ia32_Asm); // TODO implement binary emitter
 	be_set_emitter(op_ia32_Breakpoint,    bemit_int3);
+	be_set_emitter(op_ia32_Blsi,          bemit_blsi);
+	be_set_emitter(op_ia32_Blsr,          bemit_blsr);
 	be_set_emitter(op_ia32_Bsf,           bemit_bsf);
 	be_set_emitter(op_ia32_Bsr,           bemit_bsr);
 	be_set_emitter(op_ia32_Bswap,         bemit_bswap);
@@ -3317,7 +3459,10 @@ static void ia32_register_binary_emitters(void)
 	be_set_emitter(op_ia32_Lea,           bemit_lea);
 	be_set_emitter(op_ia32_Leave,         bemit_leave);
 	be_set_emitter(op_ia32_Load,          bemit_load);
+	be_set_emitter(op_ia32_Lzcnt,         bemit_lzcnt);
 	be_set_emitter(op_ia32_Minus64Bit,    bemit_minus64bit);
+	be_set_emitter(op_ia32_MovbeLoad,     bemit_movbeload);
+	be_set_emitter(op_ia32_MovbeStore,    bemit_movbestore);
 	be_set_emitter(op_ia32_Mul,           bemit_mul);
 	be_set_emitter(op_ia32_Neg,           bemit_neg);
 	be_set_emitter(op_ia32_NegMem,        bemit_negmem);
@@ -3338,15 +3483,18 @@ static void ia32_register_binary_emitters(void)
 	be_set_emitter(op_ia32_Sahf,          bemit_sahf);
 	be_set_emitter(op_ia32_Sar,           bemit_sar);
 	be_set_emitter(op_ia32_SarMem,        bemit_sarmem);
+	be_set_emitter(op_ia32_Sarx,          bemit_sarx);
 	be_set_emitter(op_ia32_Sbb,           bemit_sbb);
 	be_set_emitter(op_ia32_Sbb0,          bemit_sbb0);
 	be_set_emitter(op_ia32_Setcc,         bemit_setcc);
 	be_set_emitter(op_ia32_Shl,           bemit_shl);
 	be_set_emitter(op_ia32_ShlD,          bemit_shld);
 	be_set_emitter(op_ia32_ShlMem,        bemit_shlmem);
+	be_set_emitter(op_ia32_Shlx,          bemit_shlx);
 	be_set_emitter(op_ia32_Shr,           bemit_shr);
 	be_set_emitter(op_ia32_ShrD,          bemit_shrd);
 	be_set_emitter(op_ia32_ShrMem,        bemit_shrmem);
+	be_set_emitter(op_ia32_Shrx,          bemit_shrx);
 	be_set_emitter(op_ia32_Stc,           bemit_stc);
 	be_set_emitter(op_ia32_Store,         bemit_store);
 	be_set_emitter(op_ia32_Sub,           bemit_sub);
@@ -3354,6 +3502,7 @@ static void ia32_register_binary_emitters(void)
 	be_set_emitter(op_ia32_SubSP,         bemit_subsp);
 	be_set_emitter(op_ia32_SwitchJmp,     bemit_switchjmp);
 	be_set_emitter(op_ia32_Test,          bemit_test);
+	be_set_emitter(op_ia32_Tzcnt,         bemit_tzcnt);
 	be_set_emitter(op_ia32_Xor,           bemit_xor);
 	be_set_emitter(op_ia32_Xor0,          bemit_xor0);
 	be_set_emitter(op_ia32_XorMem,        bemit_xormem);
@@ -22,6 +22,7 @@
 #include "util.h"
 
 #include "ia32_new_nodes.h"
+#include "ia32_architecture.h"
 #include "bearch_ia32_t.h"
 #include "gen_ia32_regalloc_if.h"
 #include "begnuas.h"
@@ -417,6 +418,43 @@ static int map_Mod(ir_node *call, void *ctx)
 	return 1;
 }
 
+/**
+ * Maps a Conv between a float and a 64bit integer to a compiler library
+ * call. SSE2 has no such conversions in 32bit mode, so this avoids the x87
+ * unit. The __fix*di and __float*di* functions are part of libgcc on i386 as
+ * well.
+ */
+static void map_Conv_to_compilerlib(ir_node *call)
+{
+	ir_type *method = get_Call_type(call);
+	ir_mode *mode;
+	char     name[16];
+	if (get_Call_n_params(call) == 1) {
+		/* float -> long long */
+		ir_mode *h_mode = get_type_mode(get_method_res_type(method, 1));
+		mode = get_type_mode(get_method_param_type(method, 0));
+		snprintf(name, sizeof(name), "__fix%s%sdi",
+		         mode_is_signed(h_mode) ? "" : "uns",
+		         get_mode_size_bits(mode) == 32 ? "sf" : "df");
+	} else {
+		/* long long -> float */
+		ir_mode *h_mode = get_type_mode(get_method_param_type(method, BINOP_Left_High));
+		mode = get_type_mode(get_method_res_type(method, 0));
+		snprintf(name, sizeof(name), "__float%sdi%s",
+		         mode_is_signed(h_mode) ? "" : "un",
+		         get_mode_size_bits(mode) == 32 ? "sf" : "df");
+	}
+	assert(mode_is_float(mode) && get_mode_size_bits(mode) <= 64);
+
+	ir_entity      *ent = create_compilerlib_entity(new_id_from_str(name), method);
+	ir_graph       *irg = get_irn_irg(call);
+	ir_node        *ptr = get_Call_ptr(call);
+	symconst_symbol sym;
+	sym.entity_p = ent;
+	ptr = new_r_SymConst(irg, get_irn_mode(ptr), sym, symconst_addr_ent);
+	set_Call_ptr(call, ptr);
+}
+
 /**
  * Maps a Conv.
  */
@@ -431,6 +469,11 @@ static int map_Conv(ir_node *call, void *ctx)
 	ir_node   *l_res, *h_res;
 	(void) ctx;
 
+	if (ia32_cg_config.no_x87) {
+		map_Conv_to_compilerlib(call);
+		return 1;
+	}
+
 	if (n == 1) {
 		ir_node *float_to_ll;
 
@@ -450,8 +493,11 @@ static int map_Conv(ir_node *call, void *ctx)
 			h_res = new_r_Proj(float_to_ll, h_res_mode,
 							   pn_ia32_l_FloattoLL_res_high);
 		} else {
-			/* Convert from float to unsigned 64bit. */
-			ir_tarval *flt_tv   = new_tarval_from_str("9223372036854775808", 19, ia32_mode_E);
+			/* Convert from float to unsigned 64bit. With SSE2 the correction
+			 * is done in the mode of the operand, which represents 2^63
+			 * exactly, too. */
+			ir_mode   *flt_mode = ia32_cg_config.use_sse2 ? get_irn_mode(a_f) : ia32_mode_E;
+			ir_tarval *flt_tv   = new_tarval_from_str("9223372036854775808", 19, flt_mode);
 			ir_node   *flt_corr = new_r_Const(irg, flt_tv);
 			ir_node   *lower_blk = block;
 			ir_node   *upper_blk;
@@ -461,7 +507,8 @@ static int map_Conv(ir_node *call, void *ctx)
 			part_block(call);
 			upper_blk = get_nodes_block(call);
 
-			a_f   = new_rd_Conv(dbg, upper_blk, a_f, ia32_mode_E);
+			if (get_irn_mode(a_f) != flt_mode)
+				a_f = new_rd_Conv(dbg, upper_blk, a_f, flt_mode);
 			cmp   = new_rd_Cmp(dbg, upper_blk, a_f, flt_corr, ir_relation_less);
 			cond  = new_rd_Cond(dbg, upper_blk, cmp);
 			in[0] = new_r_Proj(cond, mode_X, pn_Cond_true);
@@ -478,9 +525,9 @@ static int map_Conv(ir_node *call, void *ctx)
 			int_phi = new_r_Phi(lower_blk, 2, in, h_res_mode);
 
 			in[0] = a_f;
-			in[1] = new_rd_Sub(dbg, upper_blk, a_f, flt_corr, ia32_mode_E);
+			in[1] = new_rd_Sub(dbg, upper_blk, a_f, flt_corr, flt_mode);
 
-			flt_phi = new_r_Phi(lower_blk, 2, in, ia32_mode_E);
+			flt_phi = new_r_Phi(lower_blk, 2, in, flt_mode);
 
 			/* fix Phi links for next part_block() */
 			if (is_Phi(int_phi))
@@ -648,6 +648,17 @@ unsigned get_ia32_latency(const ir_node *node)
 	return op_attr->latency;
 }
 
+/**
+ * Gets the execution unit class of the machine model.
+ */
+ia32_exec_unit_t get_ia32_exec_unit(const ir_node *node)
+{
+	assert(is_ia32_irn(node));
+	const ir_op *op               = get_irn_op(node);
+	const ia32_op_attr_t *op_attr = (ia32_op_attr_t*) get_op_attr(op);
+	return op_attr->unit;
+}
+
 const ir_switch_table *get_ia32_switch_table(const ir_node *node)
 {
 	const ia32_switch_attr_t *attr = get_ia32_switch_attr_const(node);
@@ -1059,10 +1070,11 @@ static void ia32_copy_attr(ir_graph *irg, const ir_node *old_node,
 	new_info->flags = old_info->flags;
 }
 
-static void ia32_init_op(ir_op *op, unsigned latency)
+static void ia32_init_op(ir_op *op, unsigned latency, ia32_exec_unit_t unit)
 {
 	ia32_op_attr_t *attr = OALLOCZ(&opcodes_obst, ia32_op_attr_t);
 	attr->latency = latency;
+	attr->unit    = unit;
 	set_op_attr(op, attr);
 }
 
@@ -246,6 +246,11 @@ unsigned get_ia32_copyb_size(const ir_node *node);
  */
 unsigned get_ia32_latency(const ir_node *node);
 
+/**
+ * Gets the execution unit class of the machine model.
+ */
+ia32_exec_unit_t get_ia32_exec_unit(const ir_node *node);
+
 /**
  * Get the exception label attribute.
  */
@@ -134,10 +134,29 @@ typedef enum {
 } match_flags_t;
 ENUM_BITSET(match_flags_t)
 
+/**
+ * Execution unit classes of the machine models. The class of each node is
+ * assigned in ia32_spec.pl.
+ */
+typedef enum ia32_exec_unit_t {
+	ia32_unit_other,  /**< use the latency of the spec, any port */
+	ia32_unit_alu,    /**< simple integer operations */
+	ia32_unit_mul,    /**< integer multiplication */
+	ia32_unit_div,    /**< integer division */
+	ia32_unit_load,   /**< loads from memory */
+	ia32_unit_store,  /**< stores to memory */
+	ia32_unit_branch, /**< jumps */
+	ia32_unit_fp_add, /**< floating point addition and subtraction */
+	ia32_unit_fp_mul, /**< floating point multiplication */
+	ia32_unit_fp_div, /**< floating point division */
+	ia32_unit_last
+} ia32_exec_unit_t;
+
 typedef struct ia32_op_attr_t ia32_op_attr_t;
 struct ia32_op_attr_t {
 	//match_flags_t  flags;
-	unsigned       latency;
+	unsigned         latency;
+	ia32_exec_unit_t unit;
 };
 
 #ifndef NDEBUG
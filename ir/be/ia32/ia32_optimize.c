@@ -76,6 +76,9 @@ static produces_flag_t check_produces_zero_sign(ir_node *node, int pn)
 		case iro_ia32_Add:
 		case iro_ia32_Adc:
 		case iro_ia32_And:
+		case iro_ia32_Andn:
+		case iro_ia32_Blsi:
+		case iro_ia32_Blsr:
 		case iro_ia32_Or:
 		case iro_ia32_Xor:
 		case iro_ia32_Sub:
@@ -124,18 +127,18 @@ check_shift_amount:
 /**
  * Replace Cmp(x, 0) by a Test(x, x)
  */
-static void peephole_ia32_Cmp(ir_node *const node)
+static bool peephole_ia32_Cmp(ir_node *const node)
 {
 	if (get_ia32_op_type(node) != ia32_Normal)
-		return;
+		return false;
 
 	ir_node *const right = get_irn_n(node, n_ia32_Cmp_right);
 	if (!is_ia32_Immediate(right))
-		return;
+		return false;
 
 	ia32_immediate_attr_t const *const imm = get_ia32_immediate_attr_const(right);
 	if (imm->symconst != NULL || imm->offset != 0)
-		return;
+		return false;
 
 	dbg_info *const dbgi         = get_irn_dbg_info(node);
 	ir_node  *const block        = get_nodes_block(node);
@@ -164,6 +167,7 @@ static void peephole_ia32_Cmp(ir_node *const node)
 	sched_add_before(node, test);
 	copy_mark(node, test);
 	be_peephole_exchange(node, test);
+	return true;
 }
 
 /**
@@ -171,7 +175,7 @@ static void peephole_ia32_Cmp(ir_node *const node)
  * - Remove the Test, if an appropriate flag was produced which is still live
  * - Change a Test(x, c) to 8Bit, if 0 <= c < 256 (3 byte shorter opcode)
  */
-static void peephole_ia32_Test(ir_node *node)
+static bool peephole_ia32_Test(ir_node *node)
 {
 	ir_node *left  = get_irn_n(node, n_ia32_Test_left);
 	ir_node *right = get_irn_n(node, n_ia32_Test_right);
@@ -187,7 +191,7 @@ static void peephole_ia32_Test(ir_node *node)
 		produces_flag_t  produced;
 
 		if (get_nodes_block(left) != block)
-			return;
+			return false;
 
 		if (is_Proj(op)) {
 			pn = get_Proj_proj(op);
@@ -202,14 +206,14 @@ static void peephole_ia32_Test(ir_node *node)
 			if (schedpoint == op)
 				break;
 			if (arch_irn_is(schedpoint, modify_flags))
-				return;
+				return false;
 			if (schedpoint == block)
 				panic("couldn't find left");
 		}
 
 		produced = check_produces_zero_sign(op, pn);
 		if (produced == produces_no_flag)
-			return;
+			return false;
 
 		/* make sure users only look at the sign/zero flag */
 		foreach_out_edge(node, edge) {
@@ -222,7 +226,7 @@ static void peephole_ia32_Test(ir_node *node)
 				&& (cc == ia32_cc_sign || cc == ia32_cc_not_sign)) {
 				continue;
 			}
-			return;
+			return false;
 		}
 
 		op_mode = get_ia32_ls_mode(op);
@@ -231,7 +235,7 @@ static void peephole_ia32_Test(ir_node *node)
 
 		/* Make sure we operate on the same bit size */
 		if (get_mode_size_bits(op_mode) != get_mode_size_bits(get_ia32_ls_mode(node)))
-			return;
+			return false;
 
 		if (produced == produces_zero_in_carry) {
 			/* patch users to look at the carry instead of the zero flag */
@@ -274,7 +278,7 @@ static void peephole_ia32_Test(ir_node *node)
 
 		/* A test with a symconst is rather strange, but better safe than sorry */
 		if (imm->symconst != NULL)
-			return;
+			return false;
 
 		offset = imm->offset;
 		if (get_ia32_op_type(node) == ia32_AddrModeS) {
@@ -296,7 +300,7 @@ static void peephole_ia32_Test(ir_node *node)
 				set_irn_n(node, n_ia32_Test_right, imm_node);
 				attr->am_offs += 3;
 			} else {
-				return;
+				return false;
 			}
 		} else if (offset < 256) {
 			arch_register_t const* const reg = arch_get_irn_register(left);
@@ -305,16 +309,19 @@ static void peephole_ia32_Test(ir_node *node)
 					reg != &ia32_registers[REG_EBX] &&
 					reg != &ia32_registers[REG_ECX] &&
 					reg != &ia32_registers[REG_EDX]) {
-				return;
+				return false;
 			}
 		} else {
-			return;
+			return false;
 		}
 
 		/* Technically we should build a Test8Bit because of the register
 		 * constraints, but nobody changes registers at this point anymore. */
 		set_ia32_ls_mode(node, mode_Bu);
+	} else {
+		return false;
 	}
+	return true;
 }
 
 /**
@@ -322,10 +329,10 @@ static void peephole_ia32_Test(ir_node *node)
  * conditional jump or directly preceded by other jump instruction.
  * Can be avoided by placing a Rep prefix before the return.
  */
-static void peephole_ia32_Return(ir_node *node)
+static bool peephole_ia32_Return(ir_node *node)
 {
 	if (!ia32_cg_config.use_pad_return)
-		return;
+		return false;
 
 	/* check if this return is the first on the block */
 	sched_foreach_reverse_before(node, irn) {
@@ -334,11 +341,12 @@ static void peephole_ia32_Return(ir_node *node)
 		/* arg, IncSP 0 nodes might occur, ignore these */
 		if (be_is_IncSP(irn) && be_get_IncSP_offset(irn) == 0)
 			continue;
-		return;
+		return false;
 	}
 
 	/* ensure, that the 3 byte return is generated */
 	be_Return_set_emit_pop(node, 1);
+	return true;
 }
 
 /* only optimize up to 48 stores behind IncSPs */
@@ -349,7 +357,7 @@ static void peephole_ia32_Return(ir_node *node)
  * The Stores are replaced by Push's, the IncSP is modified
  * (possibly into IncSP 0, but not removed).
  */
-static void peephole_IncSP_Store_to_push(ir_node *irn)
+static bool peephole_IncSP_Store_to_push(ir_node *irn)
 {
 	int       i;
 	int       maxslot;
@@ -364,7 +372,7 @@ static void peephole_IncSP_Store_to_push(ir_node *irn)
 
 	int inc_ofs = be_get_IncSP_offset(irn);
 	if (inc_ofs < 4)
-		return;
+		return false;
 
 	/*
 	 * We first walk the schedule after the IncSP node as long as we find
@@ -485,6 +493,7 @@ static void peephole_IncSP_Store_to_push(ir_node *irn)
 	}
 
 	be_set_IncSP_offset(irn, inc_ofs);
+	return first_push != NULL;
 }
 
 /**
@@ -492,7 +501,7 @@ static void peephole_IncSP_Store_to_push(ir_node *irn)
  * The Loads are replaced by Pops, the IncSP is modified
  * (possibly into IncSP 0, but not removed).
  */
-static void peephole_Load_IncSP_to_pop(ir_node *irn)
+static bool peephole_Load_IncSP_to_pop(ir_node *irn)
 {
 	const arch_register_t *esp = &ia32_registers[REG_ESP];
 	int      i, maxslot, ofs;
@@ -504,7 +513,7 @@ static void peephole_Load_IncSP_to_pop(ir_node *irn)
 
 	int inc_ofs = -be_get_IncSP_offset(irn);
 	if (inc_ofs < 4)
-		return;
+		return false;
 
 	/*
 	 * We first walk the schedule before the IncSP node as long as we find
@@ -586,7 +595,7 @@ static void peephole_Load_IncSP_to_pop(ir_node *irn)
 	}
 
 	if (maxslot < 0)
-		return;
+		return false;
 
 	/* find the first slot */
 	for (i = maxslot; i >= 0; --i) {
@@ -640,6 +649,7 @@ static void peephole_Load_IncSP_to_pop(ir_node *irn)
 
 	be_set_IncSP_offset(irn, -ofs);
 	be_set_IncSP_pred(irn, pred_sp);
+	return true;
 }
 
 
@@ -704,7 +714,7 @@ static ir_node *create_pop(dbg_info *dbgi, ir_node *block,
 /**
  * Optimize an IncSp by replacing it with Push/Pop.
  */
-static void peephole_be_IncSP(ir_node *node)
+static bool peephole_be_IncSP(ir_node *node)
 {
 	const arch_register_t *esp = &ia32_registers[REG_ESP];
 	const arch_register_t *reg;
@@ -712,18 +722,22 @@ static void peephole_be_IncSP(ir_node *node)
 	ir_node               *block;
 	ir_node               *stack;
 	int                    offset;
+	ir_node               *pred;
+	bool                   changed;
 
 	/* first optimize incsp->incsp combinations */
-	node = be_peephole_IncSP_IncSP(node);
+	pred    = be_peephole_IncSP_IncSP(node);
+	changed = pred != node;
+	node    = pred;
 
 	/* transform IncSP->Store combinations to Push where possible */
-	peephole_IncSP_Store_to_push(node);
+	changed |= peephole_IncSP_Store_to_push(node);
 
 	/* transform Load->IncSP combinations to Pop where possible */
-	peephole_Load_IncSP_to_pop(node);
+	changed |= peephole_Load_IncSP_to_pop(node);
 
 	if (arch_get_irn_register(node) != esp)
-		return;
+		return changed;
 
 	/* replace IncSP -4 by Pop freereg when possible */
 	offset = be_get_IncSP_offset(node);
@@ -731,13 +745,13 @@ static void peephole_be_IncSP(ir_node *node)
 	    (offset != -4 || ia32_cg_config.use_add_esp_4) &&
 	    (offset != +4 || ia32_cg_config.use_sub_esp_4) &&
 	    (offset != +8 || ia32_cg_config.use_sub_esp_8))
-		return;
+		return changed;
 
 	if (offset < 0) {
 		/* we need a free register for pop */
 		reg = get_free_gp_reg(get_irn_irg(node));
 		if (reg == NULL)
-			return;
+			return changed;
 
 		dbgi  = get_irn_dbg_info(node);
 		block = get_nodes_block(node);
@@ -764,12 +778,13 @@ static void peephole_be_IncSP(ir_node *node)
 	}
 
 	be_peephole_exchange(node, stack);
+	return true;
 }
 
 /**
  * Peephole optimisation for ia32_Const's
  */
-static void peephole_ia32_Const(ir_node *node)
+static bool peephole_ia32_Const(ir_node *node)
 {
 	const ia32_immediate_attr_t *attr = get_ia32_immediate_attr_const(node);
 	const arch_register_t       *reg;
@@ -779,12 +794,12 @@ static void peephole_ia32_Const(ir_node *node)
 
 	/* try to transform a mov 0, reg to xor reg reg */
 	if (attr->offset != 0 || attr->symconst != NULL)
-		return;
+		return false;
 	if (ia32_cg_config.use_mov_0)
-		return;
+		return false;
 	/* xor destroys the flags, so no-one must be using them */
 	if (be_peephole_get_value(REG_EFLAGS) != NULL)
-		return;
+		return false;
 
 	reg = arch_get_irn_register(node);
 	assert(be_peephole_get_reg_value(reg) == NULL);
@@ -799,6 +814,7 @@ static void peephole_ia32_Const(ir_node *node)
 
 	copy_mark(node, xorn);
 	be_peephole_exchange(node, xorn);
+	return true;
 }
 
 static inline int is_noreg(const ir_node *node)
@@ -852,7 +868,7 @@ static int is_am_minus_one(const ir_node *node)
 /**
  * Transforms a LEA into an Add or SHL if possible.
  */
-static void peephole_ia32_Lea(ir_node *node)
+static bool peephole_ia32_Lea(ir_node *node)
 {
 	ir_node               *base;
 	ir_node               *index;
@@ -871,7 +887,7 @@ static void peephole_ia32_Lea(ir_node *node)
 
 	/* we can only do this if it is allowed to clobber the flags */
 	if (be_peephole_get_value(REG_EFLAGS) != NULL)
-		return;
+		return false;
 
 	base  = get_irn_n(node, n_ia32_Lea_base);
 	index = get_irn_n(node, n_ia32_Lea_index);
@@ -894,7 +910,7 @@ static void peephole_ia32_Lea(ir_node *node)
 #ifdef DEBUG_libfirm
 		ir_fprintf(stderr, "Optimisation warning: found immediate only lea\n");
 #endif
-		return;
+		return false;
 	}
 
 	out_reg = arch_get_irn_register(node);
@@ -927,7 +943,7 @@ static void peephole_ia32_Lea(ir_node *node)
 			goto make_add;
 		}
 		/* can't create an add */
-		return;
+		return false;
 	} else if (out_reg == index_reg) {
 		if (base == NULL) {
 			if (has_immediates && scale == 0) {
@@ -949,10 +965,10 @@ static void peephole_ia32_Lea(ir_node *node)
 			goto make_add;
 		}
 		/* can't create an add */
-		return;
+		return false;
 	} else {
 		/* can't create an add */
-		return;
+		return false;
 	}
 
 make_add_immediate:
@@ -1002,12 +1018,13 @@ exchange:
 	sched_add_before(node, res);
 	copy_mark(node, res);
 	be_peephole_exchange(node, res);
+	return true;
 }
 
 /**
  * Split a Imul mem, imm into a Load mem and Imul reg, imm if possible.
  */
-static void peephole_ia32_Imul_split(ir_node *imul)
+static bool peephole_ia32_Imul_split(ir_node *imul)
 {
 	const ir_node         *right = get_irn_n(imul, n_ia32_IMul_right);
 	const arch_register_t *reg;
@@ -1015,30 +1032,32 @@ static void peephole_ia32_Imul_split(ir_node *imul)
 
 	if (!is_ia32_Immediate(right) || get_ia32_op_type(imul) != ia32_AddrModeS) {
 		/* no memory, imm form ignore */
-		return;
+		return false;
 	}
 	/* we need a free register */
 	reg = get_free_gp_reg(get_irn_irg(imul));
 	if (reg == NULL)
-		return;
+		return false;
 
 	/* fine, we can rebuild it */
 	res = ia32_turn_back_am(imul);
 	arch_set_irn_register(res, reg);
+	return true;
 }
 
 /**
  * Replace xorps r,r and xorpd r,r by pxor r,r
  */
-static void peephole_ia32_xZero(ir_node *xorn)
+static bool peephole_ia32_xZero(ir_node *xorn)
 {
 	set_irn_op(xorn, op_ia32_xPzero);
+	return true;
 }
 
 /**
  * Replace 16bit sign extension from ax to eax by shorter cwtl
  */
-static void peephole_ia32_Conv_I2I(ir_node *node)
+static bool peephole_ia32_Conv_I2I(ir_node *node)
 {
 	const arch_register_t *eax          = &ia32_registers[REG_EAX];
 	ir_mode               *smaller_mode = get_ia32_ls_mode(node);
@@ -1051,7 +1070,7 @@ static void peephole_ia32_Conv_I2I(ir_node *node)
 			!mode_is_signed(smaller_mode)          ||
 			eax != arch_get_irn_register(val)      ||
 			eax != arch_get_irn_register_out(node, pn_ia32_Conv_I2I_res))
-		return;
+		return false;
 
 	dbgi  = get_irn_dbg_info(node);
 	block = get_nodes_block(node);
@@ -1059,15 +1078,201 @@ static void peephole_ia32_Conv_I2I(ir_node *node)
 	arch_set_irn_register(cwtl, eax);
 	sched_add_before(node, cwtl);
 	be_peephole_exchange(node, cwtl);
+	return true;
+}
+
+/**
+ * Folds a Load into the following node as source address mode operand, if
+ * that node is the only user of the loaded value. This catches loads which
+ * could not be folded before register allocation, e.g. reloads of values
+ * with several users where only the last one is left after spilling.
+ */
+static bool peephole_fold_load(ir_node **window)
+{
+	ir_node *const load = window[0];
+	ir_node *const node = window[1];
+	ir_node       *res  = NULL;
+
+	/* only the loaded value may be used, not the memory or exceptions */
+	foreach_out_edge(load, edge) {
+		ir_node *const proj = get_edge_src_irn(edge);
+		if (get_Proj_proj(proj) == pn_ia32_Load_res)
+			res = proj;
+		else if (get_irn_n_edges(proj) > 0)
+			return false;
+	}
+	if (res == NULL || get_irn_n_edges(res) != 1)
+		return false;
+
+	ir_edge_t const *const edge = get_irn_out_edge_first(res);
+	if (get_edge_src_irn(edge) != node)
+		return false;
+
+	/* only operands which are not tied to the result register, so nothing
+	 * has to be swapped */
+	int const pos = get_edge_src_pos(edge);
+	if (!is_ia32_irn(node) || !arch_possible_memory_operand(node, pos))
+		return false;
+	if (get_ia32_am_support(node) == ia32_am_binary
+	    ? pos != n_ia32_binary_right : pos != n_ia32_unary_op)
+		return false;
+
+	/* the node must not look at bits the Load did not produce */
+	ir_mode *const load_mode = get_ia32_ls_mode(load);
+	ir_mode *const node_mode = get_ia32_ls_mode(node);
+	if (node_mode == NULL
+	    || get_mode_size_bits(node_mode) > get_mode_size_bits(load_mode))
+		return false;
+
+	ir_graph *const irg = get_irn_irg(node);
+	set_ia32_op_type(node, ia32_AddrModeS);
+	ia32_copy_am_attrs(node, load);
+	set_ia32_ls_mode(node, node_mode);
+	get_ia32_attr(node)->data.am_sc_no_pic_adjust
+		= get_ia32_attr_const(load)->data.am_sc_no_pic_adjust;
+	copy_mark(load, node);
+
+	set_irn_n(node, n_ia32_base,  get_irn_n(load, n_ia32_Load_base));
+	set_irn_n(node, n_ia32_index, get_irn_n(load, n_ia32_Load_index));
+	set_irn_n(node, n_ia32_mem,   get_irn_n(load, n_ia32_Load_mem));
+	set_irn_n(node, pos,          ia32_new_NoReg_gp(irg));
+
+	be_peephole_remove(load);
+	be_peephole_add_uses(node);
+	return true;
+}
+
+/**
+ * Removes a Cmp or Test if an earlier one with the same operands produced
+ * the flags and nothing changed them in between. Flag producers get
+ * duplicated when the flags have to be rematerialized.
+ */
+static bool peephole_redundant_flags(ir_node *node)
+{
+	if (get_ia32_op_type(node) != ia32_Normal)
+		return false;
+
+	/* find the last flag producer */
+	ir_node *prev = node;
+	do {
+		prev = sched_prev(prev);
+		if (sched_is_begin(prev) || is_Phi(prev))
+			return false;
+	} while (!arch_irn_is(prev, modify_flags));
+
+	if (get_irn_op(prev) != get_irn_op(node)
+	    || get_ia32_op_type(prev) != ia32_Normal
+	    || get_irn_mode(prev) != get_irn_mode(node)
+	    || get_irn_op(node)->ops.node_cmp_attr(node, prev))
+		return false;
+
+	for (int i = 0, arity = get_irn_arity(node); i < arity; ++i) {
+		ir_node *const in      = get_irn_n(node, i);
+		ir_node *const prev_in = get_irn_n(prev, i);
+		if (in == prev_in)
+			continue;
+		if (!is_ia32_Immediate(in) || !is_ia32_Immediate(prev_in)
+		    || get_irn_op(in)->ops.node_cmp_attr(in, prev_in))
+			return false;
+	}
+
+	DBG((dbg, LEVEL_1, "%+F computes the same flags as %+F\n", node, prev));
+	be_peephole_exchange(node, prev);
+	return true;
 }
 
 /**
- * Register a peephole optimisation function.
+ * Moves the Cmp or Test producing the flags of a Jcc directly in front of
+ * it, so processors supporting macro-fusion can decode both as one
+ * instruction.
  */
-static void register_peephole_optimisation(ir_op *op, peephole_opt_func func)
+static bool peephole_fuse_cmp_jcc(ir_node **window)
 {
-	assert(op->ops.generic == NULL);
-	op->ops.generic = (op_func)func;
+	ir_node *const prev  = window[0];
+	ir_node *const jcc   = window[1];
+	ir_node *const flags = get_irn_n(jcc, n_ia32_Jcc_eflags);
+
+	if (flags == prev || (!is_ia32_Cmp(flags) && !is_ia32_Test(flags)))
+		return false;
+	/* memory operands must not move across other memory operations */
+	if (get_nodes_block(flags) != get_nodes_block(jcc)
+	    || get_ia32_op_type(flags) != ia32_Normal
+	    || get_irn_n_edges(flags) != 1)
+		return false;
+
+	/* nothing in between may overwrite an operand */
+	int const arity = get_irn_arity(flags);
+	for (ir_node *schedpoint = sched_next(flags); schedpoint != jcc;
+	     schedpoint = sched_next(schedpoint)) {
+		be_foreach_out(schedpoint, o) {
+			arch_register_t const *const reg
+				= arch_get_irn_register_out(schedpoint, o);
+			if (reg == NULL)
+				continue;
+			for (int i = 0; i < arity; ++i) {
+				if (arch_get_irn_register_in(flags, i) == reg)
+					return false;
+			}
+		}
+	}
+
+	sched_remove(flags);
+	sched_add_before(jcc, flags);
+	return true;
+}
+
+/** Any node in a peephole pattern. */
+#define ANY NULL
+
+enum {
+#define NODE_PATTERN(name, pass, condition, function, op) ia32_pattern_##name,
+#define PATTERN(name, pass, condition, function, ...)     ia32_pattern_##name,
+#include "ia32_peephole.def"
+#undef PATTERN
+#undef NODE_PATTERN
+	ia32_pattern_last
+};
+
+/* wrappers for the single node patterns */
+#define NODE_PATTERN(name, pass, condition, function, op) \
+	static bool node_pattern_##name(ir_node **window) \
+	{ \
+		return function(window[0]); \
+	}
+#define PATTERN(name, pass, condition, function, ...)
+#include "ia32_peephole.def"
+#undef PATTERN
+#undef NODE_PATTERN
+
+/**
+ * Runs peephole pass @p pass with all patterns of ia32_peephole.def
+ * belonging to it.
+ */
+static void peephole_pass(ir_graph *irg, int pass)
+{
+	be_peephole_pattern_t patterns[ia32_pattern_last];
+	size_t                n_patterns = 0;
+
+#define ADD_PATTERN(id, p, condition, function, ...) \
+	if ((p) == pass && (condition)) { \
+		ir_op *const ops[] = { __VA_ARGS__ }; \
+		be_peephole_pattern_t *const pattern = &patterns[n_patterns++]; \
+		memset(pattern, 0, sizeof(*pattern)); \
+		pattern->name  = "ia32_peephole_" #id; \
+		pattern->func  = function; \
+		pattern->n_ops = ARRAY_SIZE(ops); \
+		memcpy(pattern->ops, ops, sizeof(ops)); \
+	}
+#define NODE_PATTERN(name, p, condition, function, op) \
+	ADD_PATTERN(name, p, condition, node_pattern_##name, op)
+#define PATTERN(name, p, condition, function, ...) \
+	ADD_PATTERN(name, p, condition, function, __VA_ARGS__)
+#include "ia32_peephole.def"
+#undef PATTERN
+#undef NODE_PATTERN
+#undef ADD_PATTERN
+
+	be_peephole_opt_patterns(irg, patterns, n_patterns);
 }
 
 /* Perform peephole-optimizations. */
@@ -1076,26 +1281,8 @@ void ia32_peephole_optimization(ir_graph *irg)
 	/* we currently do it in 2 passes because:
 	 *    Lea -> Add could be usefull as flag producer for Test later
 	 */
-
-	/* pass 1 */
-	ir_clear_opcodes_generic_func();
-	register_peephole_optimisation(op_ia32_Cmp,      peephole_ia32_Cmp);
-	register_peephole_optimisation(op_ia32_Lea,      peephole_ia32_Lea);
-	if (ia32_cg_config.use_short_sex_eax)
-		register_peephole_optimisation(op_ia32_Conv_I2I, peephole_ia32_Conv_I2I);
-	if (ia32_cg_config.use_pxor)
-		register_peephole_optimisation(op_ia32_xZero, peephole_ia32_xZero);
-	if (! ia32_cg_config.use_imul_mem_imm32)
-		register_peephole_optimisation(op_ia32_IMul, peephole_ia32_Imul_split);
-	be_peephole_opt(irg);
-
-	/* pass 2 */
-	ir_clear_opcodes_generic_func();
-	register_peephole_optimisation(op_ia32_Const, peephole_ia32_Const);
-	register_peephole_optimisation(op_be_IncSP,   peephole_be_IncSP);
-	register_peephole_optimisation(op_ia32_Test,  peephole_ia32_Test);
-	register_peephole_optimisation(op_be_Return,  peephole_ia32_Return);
-	be_peephole_opt(irg);
+	peephole_pass(irg, 1);
+	peephole_pass(irg, 2);
 }
 
 /**
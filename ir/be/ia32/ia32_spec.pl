@@ -331,6 +331,57 @@ AndMem => {
 	modified_flags => $status_flags
 },
 
+#
+# BMI1 and not: ~left & right
+#
+Andn => {
+	irn_flags => [ "rematerializable" ],
+	state     => "exc_pinned",
+	reg_req   => { in => [ "gp", "gp", "none", "gp", "gp" ],
+	               out => [ "gp", "flags", "none" ] },
+	ins       => [ "base", "index", "mem", "left", "right" ],
+	outs      => [ "res", "flags", "M" ],
+	am        => "source,binary",
+	emit      => "andn %AS4, %S3, %D0",
+	latency   => 1,
+	mode      => $mode_gp,
+	modified_flags => $status_flags
+},
+
+#
+# BMI1 extract lowest set bit: operand & -operand
+#
+Blsi => {
+	irn_flags => [ "rematerializable" ],
+	state     => "exc_pinned",
+	reg_req   => { in => [ "gp", "gp", "none", "gp" ],
+	               out => [ "gp", "flags", "none" ] },
+	ins       => [ "base", "index", "mem", "operand" ],
+	outs      => [ "res", "flags", "M" ],
+	am        => "source,unary",
+	emit      => "blsi %AS3, %D0",
+	latency   => 1,
+	mode      => $mode_gp,
+	modified_flags => $status_flags
+},
+
+#
+# BMI1 reset lowest set bit: operand & (operand - 1)
+#
+Blsr => {
+	irn_flags => [ "rematerializable" ],
+	state     => "exc_pinned",
+	reg_req   => { in => [ "gp", "gp", "none", "gp" ],
+	               out => [ "gp", "flags", "none" ] },
+	ins       => [ "base", "index", "mem", "operand" ],
+	outs      => [ "res", "flags", "M" ],
+	am        => "source,unary",
+	emit      => "blsr %AS3, %D0",
+	latency   => 1,
+	mode      => $mode_gp,
+	modified_flags => $status_flags
+},
+
 Or => {
 	irn_flags => [ "rematerializable" ],
 	state     => "exc_pinned",
@@ -502,6 +553,18 @@ ShlMem => {
 	modified_flags => $status_flags
 },
 
+#
+# BMI2 shifts: the count can be in any register and the flags are not modified
+#
+Shlx => {
+	irn_flags => [ "rematerializable" ],
+	reg_req   => { in => [ "gp", "gp" ], out => [ "gp" ] },
+	ins       => [ "val", "count" ],
+	emit      => "shlx %S1, %S0, %D0",
+	latency   => 1,
+	mode      => $mode_gp,
+},
+
 ShlD => {
 	irn_flags => [ "rematerializable" ],
 	reg_req   => { in => [ "gp", "gp", "ecx" ],
@@ -537,6 +600,15 @@ ShrMem => {
 	modified_flags => $status_flags
 },
 
+Shrx => {
+	irn_flags => [ "rematerializable" ],
+	reg_req   => { in => [ "gp", "gp" ], out => [ "gp" ] },
+	ins       => [ "val", "count" ],
+	emit      => "shrx %S1, %S0, %D0",
+	latency   => 1,
+	mode      => $mode_gp,
+},
+
 ShrD => {
 	irn_flags => [ "rematerializable" ],
 	reg_req   => { in => [ "gp", "gp", "ecx" ],
@@ -572,6 +644,15 @@ SarMem => {
 	modified_flags => $status_flags
 },
 
+Sarx => {
+	irn_flags => [ "rematerializable" ],
+	reg_req   => { in => [ "gp", "gp" ], out => [ "gp" ] },
+	ins       => [ "val", "count" ],
+	emit      => "sarx %S1, %S0, %D0",
+	latency   => 1,
+	mode      => $mode_gp,
+},
+
 Ror => {
 	irn_flags => [ "rematerializable" ],
 	reg_req   => { in => [ "gp", "ecx" ],
@@ -1192,6 +1273,37 @@ Popcnt => {
 	modified_flags => $status_flags
 },
 
+#
+# lzcnt and BMI1 tzcnt, unlike bsr and bsf defined for a zero operand
+#
+Lzcnt => {
+	irn_flags => [ "rematerializable" ],
+	state     => "exc_pinned",
+	reg_req   => { in => [ "gp", "gp", "none", "gp" ],
+	               out => [ "gp", "flags", "none" ] },
+	ins       => [ "base", "index", "mem", "operand" ],
+	outs      => [ "res", "flags", "M" ],
+	am        => "source,binary",
+	emit      => "lzcnt%M %AS3, %D0",
+	latency   => 3,
+	mode      => $mode_gp,
+	modified_flags => $status_flags
+},
+
+Tzcnt => {
+	irn_flags => [ "rematerializable" ],
+	state     => "exc_pinned",
+	reg_req   => { in => [ "gp", "gp", "none", "gp" ],
+	               out => [ "gp", "flags", "none" ] },
+	ins       => [ "base", "index", "mem", "operand" ],
+	outs      => [ "res", "flags", "M" ],
+	am        => "source,binary",
+	emit      => "tzcnt%M %AS3, %D0",
+	latency   => 3,
+	mode      => $mode_gp,
+	modified_flags => $status_flags
+},
+
 Call => {
 	op_flags  => [ "uses_memory", "fragile" ],
 	state     => "exc_pinned",
@@ -1251,6 +1363,31 @@ Bswap16 => {
 	mode      => $mode_gp,
 },
 
+#
+# movbe: load or store with byte swap
+#
+MovbeLoad => {
+	op_flags  => [ "uses_memory" ],
+	state     => "exc_pinned",
+	reg_req   => { in => [ "gp", "gp", "none" ],
+	               out => [ "gp", "none", "none" ] },
+	ins       => [ "base", "index", "mem" ],
+	outs      => [ "res", "unused", "M" ],
+	emit      => "movbe%M %AM, %#D0",
+	latency   => 1,
+	mode      => $mode_gp,
+},
+
+MovbeStore => {
+	op_flags  => [ "uses_memory" ],
+	state     => "exc_pinned",
+	reg_req   => { in => [ "gp", "gp", "none", "gp" ], out => [ "none" ] },
+	ins       => [ "base", "index", "mem", "val" ],
+	emit      => "movbe%M %#S3, %AM",
+	latency   => 2,
+	mode      => "mode_M",
+},
+
 CmpXChgMem => {
 	irn_flags      => [ "rematerializable" ],
 	state          => "exc_pinned",
@@ -2153,6 +2290,37 @@ xxStore => {
 
 ); # end of %nodes
 
+# Execution unit classes of the machine models in ia32_architecture.c. Nodes
+# not listed here are modeled with their latency on an arbitrary port.
+my %exec_units = (
+	alu    => [ "Adc", "Add", "AddMem", "AddSP", "And", "AndMem", "Andn",
+	            "Blsi", "Blsr", "Bswap", "Bswap16", "Bt", "CMovcc", "Cltd",
+	            "Cmc", "Cmp", "Const", "Conv_I2I", "Cwtl", "Dec", "DecMem",
+	            "Inc", "IncMem", "Lea", "Neg", "NegMem", "Not", "NotMem", "Or",
+	            "OrMem", "Rol", "RolMem", "Ror", "RorMem", "Sahf", "Sar",
+	            "SarMem", "Sarx", "Sbb", "Sbb0", "Setcc", "SetccMem", "Shl",
+	            "ShlMem", "Shlx", "Shr", "ShrMem", "Shrx", "Stc", "Sub",
+	            "SubMem", "SubSP", "Test", "Xor", "Xor0", "XorHighLow",
+	            "XorMem" ],
+	mul    => [ "IMul", "IMul1OP", "Mul" ],
+	div    => [ "Div", "IDiv" ],
+	load   => [ "Load", "MovbeLoad", "Pop", "PopEbp", "fild", "fld", "xLoad",
+	            "xxLoad" ],
+	store  => [ "MovbeStore", "Push", "PushEax", "Store", "fist", "fisttp",
+	            "fst", "xStore", "xStoreSimple", "xxStore" ],
+	branch => [ "IJmp", "Jcc", "Jmp", "SwitchJmp" ],
+	fp_add => [ "fadd", "fsub", "xAdd", "xMax", "xMin", "xSub" ],
+	fp_mul => [ "fmul", "xMul" ],
+	fp_div => [ "fdiv", "fprem", "xDiv" ],
+);
+my %exec_unit_of;
+foreach my $unit (keys(%exec_units)) {
+	foreach my $op (@{$exec_units{$unit}}) {
+		die("Unknown op $op in exec_units") if !defined($nodes{$op});
+		$exec_unit_of{$op} = $unit;
+	}
+}
+
 # Transform some attributes
 foreach my $op (keys(%nodes)) {
 	my $node         = $nodes{$op};
@@ -2171,7 +2339,8 @@ foreach my $op (keys(%nodes)) {
 			die("Latency missing for op $op");
 		}
 	}
-	$op_attr_init .= "ia32_init_op(op, ".$node->{latency} . ");";
+	my $unit = $exec_unit_of{$op} // "other";
+	$op_attr_init .= "ia32_init_op(op, ".$node->{latency} . ", ia32_unit_$unit);";
 
 	$node->{op_attr_init} = $op_attr_init;
 }
@@ -1060,13 +1060,16 @@ static ir_node *gen_binop_x87_float(ir_node *node, ir_node *op1, ir_node *op2,
 /**
  * Construct a shift/rotate binary operation, sets AM and immediate if required.
  *
- * @param op1   The first operand
- * @param op2   The second operand
- * @param func  The node constructor function
+ * @param op1       The first operand
+ * @param op2       The second operand
+ * @param func      The node constructor function
+ * @param bmi2_func The node constructor function for a shift by a register
+ *                  if BMI2 is available, may be NULL
  * @return The constructed ia32 node.
  */
 static ir_node *gen_shift_binop(ir_node *node, ir_node *op1, ir_node *op2,
                                 construct_shift_func *func,
+                                construct_shift_func *bmi2_func,
                                 match_flags_t flags)
 {
 	ir_mode *mode = get_irn_mode(node);
@@ -1112,6 +1115,12 @@ static ir_node *gen_shift_binop(ir_node *node, ir_node *op1, ir_node *op2,
 	}
 	ir_node *new_op2 = create_immediate_or_transform(op2);
 
+	/* the BMI2 shifts take the count in any register and are not
+	 * destructive */
+	if (bmi2_func != NULL && ia32_cg_config.use_bmi2
+	    && !is_ia32_Immediate(new_op2))
+		func = bmi2_func;
+
 	dbg_info *dbgi      = get_irn_dbg_info(node);
 	ir_node  *block     = get_nodes_block(node);
 	ir_node  *new_block = be_transform_node(block);
@@ -1463,6 +1472,62 @@ static ir_node *gen_Mulh(ir_node *node)
 	return proj_res_high;
 }
 
+/**
+ * Creates a BMI1 instruction computing a function of the single value @p op,
+ * which is used by @p node and by its other operand @p use.
+ */
+static ir_node *gen_bmi1_unop(ir_node *node, ir_node *op, ir_node *use,
+                              construct_binop_dest_func *func)
+{
+	/* op may be folded if node and use are its only users */
+	match_flags_t flags = match_am | match_mode_neutral;
+	if (get_irn_n_edges(use) == 1)
+		flags |= match_two_users;
+
+	ir_node            *block = get_nodes_block(node);
+	ia32_address_mode_t am;
+	match_arguments(&am, block, NULL, op, NULL, flags);
+
+	dbg_info       *dbgi      = get_irn_dbg_info(node);
+	ir_node        *new_block = be_transform_node(block);
+	ia32_address_t *addr      = &am.addr;
+	ir_node        *new_node  = func(dbgi, new_block, addr->base, addr->index,
+	                                 addr->mem, am.new_op2);
+	set_am_attributes(new_node, &am);
+	SET_IA32_ORIG_NODE(new_node, node);
+
+	return fix_mem_proj(new_node, &am);
+}
+
+/**
+ * Tries to create a BMI1 instruction for an And: andn for x & ~y, blsi for
+ * x & -x and blsr for x & (x - 1).
+ *
+ * @return The created node or NULL
+ */
+static ir_node *try_gen_And_bmi1(ir_node *node, ir_node *op1, ir_node *op2)
+{
+	for (unsigned i = 0; i < 2; ++i) {
+		ir_node *const val   = i == 0 ? op1 : op2;
+		ir_node *const other = i == 0 ? op2 : op1;
+		if (is_Minus(other) && get_Minus_op(other) == val)
+			return gen_bmi1_unop(node, val, other, new_bd_ia32_Blsi);
+		if (is_Add(other) && get_Add_left(other) == val
+		    && is_Const_Minus_1(get_Add_right(other)))
+			return gen_bmi1_unop(node, val, other, new_bd_ia32_Blsr);
+	}
+
+	/* andn has no immediate form, and + not is as good in this case */
+	if (is_Not(op1) && !is_Const(op2)) {
+		return gen_binop(node, get_Not_op(op1), op2, new_bd_ia32_Andn,
+		                 match_mode_neutral | match_am);
+	} else if (is_Not(op2) && !is_Const(op1)) {
+		return gen_binop(node, get_Not_op(op2), op1, new_bd_ia32_Andn,
+		                 match_mode_neutral | match_am);
+	}
+	return NULL;
+}
+
 /**
  * Creates an ia32 And.
  *
@@ -1494,6 +1559,13 @@ static ir_node *gen_And(ir_node *node)
 			return res;
 		}
 	}
+
+	if (ia32_cg_config.use_bmi1) {
+		ir_node *const res = try_gen_And_bmi1(node, op1, op2);
+		if (res != NULL)
+			return res;
+	}
+
 	return gen_binop(node, op1, op2, new_bd_ia32_And,
 	                 match_commutative | match_mode_neutral | match_am
 	                 | match_immediate);
@@ -1738,7 +1810,7 @@ static ir_node *gen_Shl(ir_node *node)
 	ir_node *right = get_Shl_right(node);
 
 	return gen_shift_binop(node, left, right, new_bd_ia32_Shl,
-	                       match_mode_neutral | match_immediate);
+	                       new_bd_ia32_Shlx, match_mode_neutral | match_immediate);
 }
 
 /**
@@ -1752,7 +1824,7 @@ static ir_node *gen_Shr(ir_node *node)
 	ir_node *right = get_Shr_right(node);
 
 	return gen_shift_binop(node, left, right, new_bd_ia32_Shr,
-	                       match_immediate | match_zero_ext);
+	                       new_bd_ia32_Shrx, match_immediate | match_zero_ext);
 }
 
 /**
@@ -1807,7 +1879,7 @@ static ir_node *gen_Shrs(ir_node *node)
 	}
 
 	return gen_shift_binop(node, left, right, new_bd_ia32_Sar,
-	                       match_immediate | match_upconv);
+	                       new_bd_ia32_Sarx, match_immediate | match_upconv);
 }
 
 /**
@@ -1819,7 +1891,8 @@ static ir_node *gen_Shrs(ir_node *node)
  */
 static ir_node *gen_Rol(ir_node *node, ir_node *op1, ir_node *op2)
 {
-	return gen_shift_binop(node, op1, op2, new_bd_ia32_Rol, match_immediate);
+	return gen_shift_binop(node, op1, op2, new_bd_ia32_Rol, NULL,
+	                       match_immediate);
 }
 
 /**
@@ -1833,7 +1906,8 @@ static ir_node *gen_Rol(ir_node *node, ir_node *op1, ir_node *op2)
  */
 static ir_node *gen_Ror(ir_node *node, ir_node *op1, ir_node *op2)
 {
-	return gen_shift_binop(node, op1, op2, new_bd_ia32_Ror, match_immediate);
+	return gen_shift_binop(node, op1, op2, new_bd_ia32_Ror, NULL,
+	                       match_immediate);
 }
 
 /**
@@ -2297,6 +2371,42 @@ static ir_node *dest_am_unop(ir_node *node, ir_node *op, ir_node *mem,
 	return new_node;
 }
 
+static ir_node *try_create_MovbeStore(ir_node *node, ir_node *ptr,
+                                      ir_node *mem, ir_mode *mode)
+{
+	if (!ia32_cg_config.use_movbe)
+		return NULL;
+
+	ir_node *builtin = get_Proj_pred(node);
+	if (!is_Builtin(builtin) || get_Builtin_kind(builtin) != ir_bk_bswap)
+		return NULL;
+	/* the swapped value must not be used elsewhere */
+	if (get_irn_n_edges(builtin) != 1)
+		return NULL;
+	unsigned bits = get_mode_size_bits(mode);
+	if ((bits != 16 && bits != 32)
+	    || get_mode_size_bits(get_irn_mode(node)) != bits)
+		return NULL;
+
+	ia32_address_t addr;
+	build_address_ptr(&addr, ptr, mem);
+
+	dbg_info *dbgi      = get_irn_dbg_info(node);
+	ir_node  *block     = get_nodes_block(node);
+	ir_node  *new_block = be_transform_node(block);
+	ir_node  *param     = get_Builtin_param(builtin, 0);
+	ir_node  *new_param = be_transform_node(param);
+	ir_node  *new_node  = new_bd_ia32_MovbeStore(dbgi, new_block, addr.base,
+	                                             addr.index, addr.mem,
+	                                             new_param);
+	set_address(new_node, &addr);
+	set_ia32_op_type(new_node, ia32_AddrModeD);
+	set_ia32_ls_mode(new_node, mode);
+	SET_IA32_ORIG_NODE(new_node, node);
+
+	return new_node;
+}
+
 static ir_node *try_create_SetMem(ir_node *node, ir_node *ptr, ir_node *mem)
 {
 	ir_mode              *mode      = get_irn_mode(node);
@@ -2466,6 +2576,9 @@ static ir_node *try_create_dest_am(ir_node *node)
 	case iro_Mux:
 		new_node = try_create_SetMem(val, ptr, mem);
 		break;
+	case iro_Proj:
+		new_node = try_create_MovbeStore(val, ptr, mem, mode);
+		break;
 	case iro_Minus: {
 		ir_node *op1 = get_Minus_op(val);
 		new_node = dest_am_unop(val, op1, mem, ptr, mode, new_bd_ia32_NegMem);
@@ -3636,6 +3749,87 @@ static ir_node *create_I2I_Conv(ir_mode *src_mode, ir_mode *tgt_mode,
 	return new_node;
 }
 
+/**
+ * Loads 2^31, the bias between signed and unsigned 32bit integers, into an
+ * SSE register.
+ */
+static ir_node *create_sse_uint_bias(dbg_info *dbgi, ir_node *block,
+                                     ir_mode *mode)
+{
+	ir_graph   *irg  = get_Block_irg(block);
+	ia32_isa_t *isa  = (ia32_isa_t*)be_get_irg_arch_env(irg);
+	ir_tarval  *tv   = new_tarval_from_double(2147483648.0, mode);
+	ir_entity  *ent  = ia32_create_float_const_entity(isa, tv, NULL);
+	ir_node    *load = new_bd_ia32_xLoad(dbgi, block, get_symconst_base(),
+	                                     noreg_GP, nomem, mode);
+	set_ia32_op_type(load, ia32_AddrModeS);
+	set_ia32_am_sc(load, ent);
+	arch_add_irn_flags(load, arch_irn_flags_rematerializable);
+	return new_r_Proj(load, mode_xmm, pn_ia32_xLoad_res);
+}
+
+/**
+ * Creates an SSE conversion from an unsigned 32bit integer to a float. cvtsi2sd
+ * only knows signed integers, so the operand is moved into the signed range
+ * and the bias is added back in double precision, where both steps are exact.
+ */
+static ir_node *gen_sse_conv_Iu_to_fp(dbg_info *dbgi, ir_node *block,
+                                      ir_node *new_op, ir_mode *tgt_mode)
+{
+	ir_graph *irg  = get_Block_irg(block);
+	ir_node  *imm  = ia32_create_Immediate(irg, NULL, 0, 0x80000000);
+	ir_node  *xorn = new_bd_ia32_Xor(dbgi, block, noreg_GP, noreg_GP, nomem,
+	                                 new_op, imm);
+	ir_node  *conv = new_bd_ia32_Conv_I2FP(dbgi, block, noreg_GP, noreg_GP,
+	                                       nomem, xorn);
+	set_ia32_ls_mode(conv, mode_D);
+
+	ir_node *bias = create_sse_uint_bias(dbgi, block, mode_D);
+	ir_node *res  = new_bd_ia32_xAdd(dbgi, block, noreg_GP, noreg_GP, nomem,
+	                                 conv, bias);
+	set_ia32_commutative(res);
+	set_ia32_ls_mode(res, mode_D);
+	if (tgt_mode != mode_D) {
+		res = new_bd_ia32_Conv_FP2FP(dbgi, block, noreg_GP, noreg_GP, nomem,
+		                             res);
+		set_ia32_ls_mode(res, tgt_mode);
+	}
+	return res;
+}
+
+/**
+ * Creates an SSE conversion from a float to an unsigned 32bit integer.
+ * cvttsd2si only produces signed integers, so values of at least 2^31 are
+ * converted with the bias subtracted and get the top bit set afterwards.
+ */
+static ir_node *gen_sse_conv_fp_to_Iu(dbg_info *dbgi, ir_node *block,
+                                      ir_node *new_op, ir_mode *src_mode)
+{
+	ir_graph *irg   = get_Block_irg(block);
+	ir_node  *bias  = create_sse_uint_bias(dbgi, block, src_mode);
+	ir_node  *small = new_bd_ia32_Conv_FP2I(dbgi, block, noreg_GP, noreg_GP,
+	                                        nomem, new_op);
+	set_ia32_ls_mode(small, src_mode);
+
+	ir_node *sub = new_bd_ia32_xSub(dbgi, block, noreg_GP, noreg_GP, nomem,
+	                                new_op, bias);
+	set_ia32_ls_mode(sub, src_mode);
+	ir_node *conv = new_bd_ia32_Conv_FP2I(dbgi, block, noreg_GP, noreg_GP,
+	                                      nomem, sub);
+	set_ia32_ls_mode(conv, src_mode);
+	ir_node *imm = ia32_create_Immediate(irg, NULL, 0, 0x80000000);
+	ir_node *big = new_bd_ia32_Xor(dbgi, block, noreg_GP, noreg_GP, nomem,
+	                               conv, imm);
+
+	ir_node *cmp = new_bd_ia32_Ucomi(dbgi, block, noreg_GP, noreg_GP, nomem,
+	                                 new_op, bias, false);
+	set_ia32_ls_mode(cmp, src_mode);
+	ir_node *res = new_bd_ia32_CMovcc(dbgi, block, noreg_GP, noreg_GP, nomem,
+	                                  small, big, cmp, ia32_cc_above_equal);
+	set_ia32_ls_mode(res, mode_Iu);
+	return res;
+}
+
 /**
  * Transforms a Conv node.
  *
@@ -3692,6 +3886,12 @@ static ir_node *gen_Conv(ir_node *node)
 			/* ... to int */
 			DB((dbg, LEVEL_1, "create Conv(float, int) ..."));
 			if (ia32_cg_config.use_sse2) {
+				if (tgt_bits == 32 && !mode_is_signed(tgt_mode)) {
+					res = gen_sse_conv_fp_to_Iu(dbgi, new_block, new_op,
+					                            src_mode);
+					SET_IA32_ORIG_NODE(res, node);
+					return res;
+				}
 				res = new_bd_ia32_Conv_FP2I(dbgi, new_block, noreg_GP, noreg_GP,
 				                            nomem, new_op);
 				set_ia32_ls_mode(res, src_mode);
@@ -3705,7 +3905,18 @@ static ir_node *gen_Conv(ir_node *node)
 			/* ... to float */
 			DB((dbg, LEVEL_1, "create Conv(int, float) ..."));
 			if (ia32_cg_config.use_sse2) {
-				ir_node *new_op = be_transform_node(op);
+				ir_node *new_op;
+				if (src_bits < 32) {
+					new_op = transform_upconv(op, node);
+				} else if (!mode_is_signed(src_mode)) {
+					new_op = be_transform_node(op);
+					res    = gen_sse_conv_Iu_to_fp(dbgi, new_block, new_op,
+					                               tgt_mode);
+					SET_IA32_ORIG_NODE(res, node);
+					return res;
+				} else {
+					new_op = be_transform_node(op);
+				}
 				res = new_bd_ia32_Conv_I2FP(dbgi, new_block, noreg_GP, noreg_GP,
 				                            nomem, new_op);
 				set_ia32_ls_mode(res, tgt_mode);
@@ -3770,7 +3981,8 @@ static ir_node *gen_be_FrameAddr(ir_node *node)
 }
 
 /**
- * In case SSE is used we need to copy the result from XMM0 to FPU TOS before return.
+ * In case SSE is used we need to copy the result from XMM0 to FPU TOS before
+ * return, unless the result stays in XMM0.
  */
 static ir_node *gen_be_Return(ir_node *node)
 {
@@ -3784,7 +3996,7 @@ static ir_node *gen_be_Return(ir_node *node)
 	ir_type   *tp       = get_entity_type(ent);
 	ir_type   *res_type = get_method_res_type(tp, 0);
 
-	if (!is_Primitive_type(res_type)) {
+	if (!is_Primitive_type(res_type) || ia32_float_result_in_xmm(tp)) {
 		return be_duplicate_node(node);
 	}
 
@@ -4005,10 +4217,6 @@ static ir_node *gen_ia32_l_Sbb(ir_node *node)
 
 static ir_node *gen_ia32_l_LLtoFloat(ir_node *node)
 {
-	if (ia32_cg_config.use_sse2) {
-		panic("not implemented for SSE2");
-	}
-
 	ir_node  *src_block    = get_nodes_block(node);
 	ir_node  *block        = be_transform_node(src_block);
 	ir_graph *irg          = get_Block_irg(block);
@@ -4085,6 +4293,26 @@ static ir_node *gen_ia32_l_LLtoFloat(ir_node *node)
 		set_irn_mode(fadd, mode_T);
 		res = new_rd_Proj(NULL, fadd, mode_fp, pn_ia32_res);
 	}
+
+	if (ia32_cg_config.use_sse2) {
+		/* SSE2 has no 64bit integer conversion in 32bit mode, so the x87
+		 * result is moved into an xmm register through memory */
+		ir_mode *mode = get_irn_mode(node);
+		ir_node *fst  = new_bd_ia32_fst(dbgi, block, frame, noreg_GP, nomem,
+		                                res, mode);
+		set_ia32_use_frame(fst);
+		set_ia32_op_type(fst, ia32_AddrModeD);
+		arch_add_irn_flags(fst, arch_irn_flags_spill);
+		SET_IA32_ORIG_NODE(fst, node);
+		ir_node *fst_mem = new_r_Proj(fst, mode_M, pn_ia32_fst_M);
+
+		ir_node *xld = new_bd_ia32_xLoad(dbgi, block, frame, noreg_GP, fst_mem,
+		                                 mode);
+		set_ia32_use_frame(xld);
+		set_ia32_op_type(xld, ia32_AddrModeS);
+		SET_IA32_ORIG_NODE(xld, node);
+		res = new_r_Proj(xld, mode, pn_ia32_xLoad_res);
+	}
 	return res;
 }
 
@@ -4098,6 +4326,27 @@ static ir_node *gen_ia32_l_FloattoLL(ir_node *node)
 	ir_node  *val       = get_irn_n(node, n_ia32_l_FloattoLL_val);
 	ir_node  *new_val   = be_transform_node(val);
 
+	if (ia32_cg_config.use_sse2) {
+		/* SSE2 has no 64bit integer conversion in 32bit mode, so the value
+		 * is moved into an x87 register through memory */
+		ir_mode *mode  = get_irn_mode(val);
+		ir_node *store = new_bd_ia32_xStore(dbgi, block, frame, noreg_GP, nomem,
+		                                    new_val);
+		set_ia32_use_frame(store);
+		set_ia32_op_type(store, ia32_AddrModeD);
+		set_ia32_ls_mode(store, mode);
+		arch_add_irn_flags(store, arch_irn_flags_spill);
+		SET_IA32_ORIG_NODE(store, node);
+		ir_node *store_mem = new_r_Proj(store, mode_M, pn_ia32_xStore_M);
+
+		ir_node *fld = new_bd_ia32_fld(dbgi, block, frame, noreg_GP, store_mem,
+		                               mode);
+		set_ia32_use_frame(fld);
+		set_ia32_op_type(fld, ia32_AddrModeS);
+		SET_IA32_ORIG_NODE(fld, node);
+		new_val = new_r_Proj(fld, mode_fp, pn_ia32_fld_res);
+	}
+
 	ir_node *fist = gen_fist(dbgi, block, frame, noreg_GP, nomem, new_val);
 	SET_IA32_ORIG_NODE(fist, node);
 	set_ia32_use_frame(fist);
@@ -4465,7 +4714,8 @@ static ir_node *gen_be_Call(ir_node *node)
 	ir_type        *const call_tp   = be_Call_get_type(node);
 
 	/* Run the x87 simulator if the call returns a float value */
-	if (get_method_n_ress(call_tp) > 0) {
+	bool const res_in_xmm = ia32_float_result_in_xmm(call_tp);
+	if (get_method_n_ress(call_tp) > 0 && !res_in_xmm) {
 		ir_type *const res_type = get_method_res_type(call_tp, 0);
 		ir_mode *const res_mode = get_type_mode(res_type);
 
@@ -4535,7 +4785,7 @@ static ir_node *gen_be_Call(ir_node *node)
 
 	SET_IA32_ORIG_NODE(call, node);
 
-	if (ia32_cg_config.use_sse2) {
+	if (ia32_cg_config.use_sse2 && !res_in_xmm) {
 		/* remember this call for post-processing */
 		ARR_APP1(ir_node *, call_list, call);
 		ARR_APP1(ir_type *, call_types, be_Call_get_type(node));
@@ -4788,6 +5038,9 @@ static ir_node *gen_ffs(ir_node *node)
  */
 static ir_node *gen_clz(ir_node *node)
 {
+	if (ia32_cg_config.use_lzcnt)
+		return gen_unop_AM(node, new_bd_ia32_Lzcnt);
+
 	ir_node  *bsr   = gen_unop_AM(node, new_bd_ia32_Bsr);
 	ir_node  *real  = skip_Proj(bsr);
 	dbg_info *dbgi  = get_irn_dbg_info(real);
@@ -4803,6 +5056,9 @@ static ir_node *gen_clz(ir_node *node)
  */
 static ir_node *gen_ctz(ir_node *node)
 {
+	/* tzcnt is faster than bsf on AMD CPUs */
+	if (ia32_cg_config.use_bmi1)
+		return gen_unop_AM(node, new_bd_ia32_Tzcnt);
 	return gen_unop_AM(node, new_bd_ia32_Bsf);
 }
 
@@ -4878,6 +5134,26 @@ static ir_node *gen_popcount(ir_node *node)
  */
 static ir_node *gen_bswap(ir_node *node)
 {
+	if (ia32_cg_config.use_movbe) {
+		/* swap a loaded value with movbe */
+		ir_node            *param = get_Builtin_param(node, 0);
+		ir_node            *block = get_nodes_block(node);
+		ia32_address_mode_t am;
+		match_arguments(&am, block, NULL, param, NULL,
+		                match_am | match_16bit_am | match_try_am);
+		if (am.op_type == ia32_AddrModeS) {
+			ia32_address_t *addr      = &am.addr;
+			dbg_info       *dbgi      = get_irn_dbg_info(node);
+			ir_node        *new_block = be_transform_node(block);
+			ir_node        *movbe     = new_bd_ia32_MovbeLoad(dbgi, new_block,
+				addr->base, addr->index, addr->mem);
+			set_am_attributes(movbe, &am);
+			set_ia32_ls_mode(movbe, get_irn_mode(param));
+			SET_IA32_ORIG_NODE(movbe, node);
+			return fix_mem_proj(movbe, &am);
+		}
+	}
+
 	ir_node  *param     = be_transform_node(get_Builtin_param(node, 0));
 	dbg_info *dbgi      = get_irn_dbg_info(node);
 	ir_node  *block     = get_nodes_block(node);
@@ -34,6 +34,7 @@
 #include "gen_ia32_regalloc_if.h"
 #include "ia32_x87.h"
 #include "ia32_architecture.h"
+#include "bearch_ia32_t.h"
 
 #define N_FLOAT_REGS  (N_ia32_fp_REGS-1)  // exclude NOREG
 
@@ -1403,7 +1404,7 @@ static int sim_Call(x87_state *state, ir_node *n)
 	assert(state->depth == 0 && "stack not empty before call");
 
 	ir_type *const call_tp = get_ia32_call_attr_const(n)->call_tp;
-	if (get_method_n_ress(call_tp) != 0) {
+	if (get_method_n_ress(call_tp) != 0 && !ia32_float_result_in_xmm(call_tp)) {
 		/* If the called function returns a float, it is returned in st(0).
 		 * This even happens if the return value is NOT used.
 		 * Moreover, only one return result is supported. */
@@ -67,6 +67,7 @@ static sparc_isa_t sparc_isa_template = {
 		7,                                   /* costs for a spill instruction */
 		5,                                   /* costs for a reload instruction */
 		true,                                /* custom abi handling */
+		NULL,                                /* no machine model */
 	},
 	NULL,                                  /* constants */
 };
@@ -177,6 +178,7 @@ const arch_irn_ops_t sparc_irn_ops = {
 	NULL,    /* get_op_estimated_cost   */
 	NULL,    /* possible_memory_operand */
 	NULL,    /* perform_memory_operand  */
+	NULL,    /* get_sched_insn          */
 };
 
 /**
@@ -493,11 +495,19 @@ static void sparc_lower_for_target(void)
 {
 	lower_calls_with_compounds(LF_RETURN_HIDDEN);
 
+	/* Turn all small CopyBs into loads/stores, word aligned medium-sized
+	 * CopyBs into copy loops and all bigger CopyBs into memcpy calls. */
+	static const ir_copyb_rule copyb_rules[] = {
+		{  31, 1, ir_copyb_moves },
+		{ 256, 4, ir_copyb_loop  },
+	};
+	static const ir_copyb_params copyb_params = {
+		copyb_rules, ARRAY_SIZE(copyb_rules), NULL, false
+	};
+
 	for (size_t i = 0, n_irgs = get_irp_n_irgs(); i < n_irgs; ++i) {
 		ir_graph *irg = get_irp_irg(i);
-		/* Turn all small CopyBs into loads/stores and all bigger CopyBs into
-		 * memcpy calls. */
-		lower_CopyB(irg, 31, 32, false);
+		lower_CopyB_rules(irg, &copyb_params);
 	}
 
 	if (!sparc_cg_config.use_fpu)
@@ -563,7 +573,8 @@ static const backend_params *sparc_get_backend_params(void)
 		0,     /* no trampoline support: size 0 */
 		0,     /* no trampoline support: align 0 */
 		NULL,  /* no trampoline support: no trampoline builder */
-		4      /* alignment of stack parameter: typically 4 (32bit) or 8 (64bit) */
+		4,     /* alignment of stack parameter: typically 4 (32bit) or 8 (64bit) */
+		4      /* loop unroll factor */
 	};
 
 	ir_mode *mode_long_long
@@ -638,6 +649,7 @@ const arch_isa_if_t sparc_isa_if = {
 	NULL,
 	NULL,                /* get call abi */
 	NULL,                /* mark remat */
+	NULL,                /* get remat cost */
 	NULL,                /* get_pic_base */
 	sparc_new_spill,
 	sparc_new_reload,
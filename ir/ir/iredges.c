@@ -20,40 +20,12 @@
 #include "irdump_t.h"
 #include "irprintf.h"
 #include "debug.h"
-#include "set.h"
 #include "bitset.h"
 #include "error.h"
 #include "irpass_t.h"
 
-#include "iredgeset.h"
-#include "hashptr.h"
-
-#define DO_REHASH
-#define SCALAR_RETURN
-#define HashSet                   ir_edgeset_t
-#define HashSetIterator           ir_edgeset_iterator_t
-#define ValueType                 ir_edge_t*
-#define NullValue                 NULL
-#define DeletedValue              ((ir_edge_t*)-1)
-#define Hash(this,key)            (hash_ptr(key->src) ^ (key->pos * 40013))
-#define KeysEqual(this,key1,key2) ((key1->src) == (key2->src) && (key1->pos == key2->pos))
-#define SetRangeEmpty(ptr,size)   memset(ptr, 0, (size) * sizeof((ptr)[0]))
-
-#define hashset_init            ir_edgeset_init
-void ir_edgeset_init_size(ir_edgeset_t *self, size_t size);
-#define hashset_init_size       ir_edgeset_init_size
-#define hashset_destroy         ir_edgeset_destroy
-#define hashset_insert          ir_edgeset_insert
-#define hashset_remove          ir_edgeset_remove
-ir_edge_t *ir_edgeset_find(const ir_edgeset_t *self, const ir_edge_t*);
-#define hashset_find            ir_edgeset_find
-size_t ir_edgeset_size(const ir_edgeset_t *self);
-#define hashset_size            ir_edgeset_size
-#define hashset_iterator_init   ir_edgeset_iterator_init
-#define hashset_iterator_next   ir_edgeset_iterator_next
-#define hashset_remove_iterator ir_edgeset_remove_iterator
-
-#include "hashset.c.inl"
+#include "bitfiddle.h"
+#include "util.h"
 
 /**
  * A function that allows for setting an edge.
@@ -121,7 +93,7 @@ DEBUG_ONLY(static firm_dbg_module_t *dbg;)
 static int edges_used = 0;
 
 /**
- * If set to 1, the list heads are checked every time an edge is changed.
+ * If set to 1, the outs are checked every time an edge is changed.
  */
 static int edges_dbg = 0;
 
@@ -137,77 +109,196 @@ void edges_init_graph_kind(ir_graph *irg, ir_edge_kind_t kind)
 {
 	if (edges_activated_kind(irg, kind)) {
 		irg_edge_info_t *info = get_irg_edge_info(irg, kind);
-		size_t amount = get_irg_last_idx(irg) * 5 / 4;
 
 		edges_used = 1;
 		if (info->allocated) {
-			amount = ir_edgeset_size(&info->edges);
-			ir_edgeset_destroy(&info->edges);
+			DEL_ARR_F(info->free_edges);
 			obstack_free(&info->edges_obst, NULL);
 		}
 		obstack_init(&info->edges_obst);
-		INIT_LIST_HEAD(&info->free_edges);
-		ir_edgeset_init_size(&info->edges, amount);
+		info->free_edges = NEW_ARR_F(ir_edge_t*, 0);
+		memset(info->free_arrays, 0, sizeof(info->free_arrays));
 		info->allocated = 1;
 	}
 }
 
 /**
- * Change the out count
- *
- * @param tgt  the edge target
- * @param kind the kind of the edge
+ * Allocates an array of 2^log2_size edge pointers.
  */
-static inline void edge_change_cnt(ir_node *tgt, ir_edge_kind_t kind, int ofs)
+static ir_edge_t **alloc_edge_array(irg_edge_info_t *info, unsigned log2_size)
 {
-	irn_edge_info_t *info = get_irn_edge_info(tgt, kind);
-	info->out_count += ofs;
+	ir_edge_t **arr = info->free_arrays[log2_size];
+	if (arr != NULL) {
+		/* free arrays are linked by their first element */
+		info->free_arrays[log2_size] = (ir_edge_t**)arr[0];
+		return arr;
+	}
+	return OALLOCN(&info->edges_obst, ir_edge_t*, 1u << log2_size);
+}
+
+/**
+ * Puts an array allocated by alloc_edge_array() back for reuse.
+ */
+static void free_edge_array(irg_edge_info_t *info, ir_edge_t **arr,
+                            unsigned log2_size)
+{
+	arr[0] = (ir_edge_t*)info->free_arrays[log2_size];
+	info->free_arrays[log2_size] = arr;
 }
 
 /**
- * Verify the edge list of a node, i.e. ensure it's a loop:
- * head -> e_1 -> ... -> e_n -> head
+ * Returns the index of the ins entry for the edge at position @p pos.
  */
-static inline void verify_list_head(ir_node *irn, ir_edge_kind_t kind)
-{
-	int                    num     = 0;
-	pset                   *lh_set = pset_new_ptr(16);
-	const struct list_head *head   = &get_irn_edge_info(irn, kind)->outs_head;
-	const struct list_head *pos;
-
-	list_for_each(pos, head) {
-		if (pset_find_ptr(lh_set, pos)) {
-			const ir_edge_t *edge = list_entry(pos, ir_edge_t, list);
-
-			ir_fprintf(stderr, "EDGE Verifier: edge list broken (self loop not to head) for %+F:\n", irn);
-			fprintf(stderr, "- at list entry %d\n", num);
-			if (edge->src)
-				ir_fprintf(stderr, "- edge(%ld) %+F(%d)\n", edge_get_id(edge), edge->src, edge->pos);
-			assert(0 && "No source node found");
-			break;
+static inline unsigned get_in_index(int pos, ir_edge_kind_t kind)
+{
+	return (unsigned)(pos - edge_kind_info[kind].first_idx);
+}
+
+/**
+ * Returns the ins entry for the edge at position @p pos of @p src or NULL if
+ * the ins array is too small.
+ */
+static inline ir_edge_t **find_in_slot(ir_node *src, int pos,
+                                       ir_edge_kind_t kind)
+{
+	const irn_edge_info_t *info = get_irn_edge_info(src, kind);
+	unsigned               idx  = get_in_index(pos, kind);
+	if (info->ins == NULL || idx >= 1u << info->ins_log2)
+		return NULL;
+	return &info->ins[idx];
+}
+
+/**
+ * Returns the edge at position @p pos of @p src or NULL if there is none.
+ */
+static inline ir_edge_t *find_edge(ir_node *src, int pos, ir_edge_kind_t kind)
+{
+	ir_edge_t **slot = find_in_slot(src, pos, kind);
+	return slot != NULL ? *slot : NULL;
+}
+
+/**
+ * Returns the ins entry for the edge at position @p pos of @p src,
+ * enlarging the ins array if needed.
+ */
+static ir_edge_t **get_in_slot(ir_node *src, int pos, ir_edge_kind_t kind,
+                               irg_edge_info_t *irg_info)
+{
+	irn_edge_info_t *info = get_irn_edge_info(src, kind);
+	unsigned         idx  = get_in_index(pos, kind);
+	unsigned         size = info->ins != NULL ? 1u << info->ins_log2 : 0;
+	if (idx >= size) {
+		/* make room for all inputs at once, they usually follow */
+		int      arity     = edge_kind_info[kind].get_arity(src);
+		unsigned n_ins     = MAX(idx + 1, get_in_index(arity, kind));
+		unsigned log2_size = n_ins > 1 ? log2_ceil(n_ins) : 0;
+		ir_edge_t **ins    = alloc_edge_array(irg_info, log2_size);
+
+		if (info->ins != NULL) {
+			memcpy(ins, info->ins, size * sizeof(ins[0]));
+			free_edge_array(irg_info, info->ins, info->ins_log2);
 		}
-		num++;
-		pset_insert_ptr(lh_set, pos);
+		memset(&ins[size], 0, ((1u << log2_size) - size) * sizeof(ins[0]));
+		info->ins      = ins;
+		info->ins_log2 = log2_size;
 	}
+	return &info->ins[idx];
+}
 
-	del_pset(lh_set);
+/**
+ * Appends an edge to the outs of its target.
+ */
+static void append_out(ir_edge_t *edge, ir_edge_kind_t kind,
+                       irg_edge_info_t *irg_info)
+{
+	ir_node         *tgt  = edge->tgt;
+	irn_edge_info_t *info = get_irn_edge_info(tgt, kind);
+	unsigned         size = info->outs != NULL ? 1u << info->outs_log2 : 0;
+	if (info->out_count == size) {
+		unsigned    log2_size = info->outs != NULL ? info->outs_log2 + 1 : 1;
+		ir_edge_t **outs      = alloc_edge_array(irg_info, log2_size);
+		if (info->outs != NULL) {
+			memcpy(outs, info->outs, size * sizeof(outs[0]));
+			if (info->outs != tgt->inline_outs)
+				free_edge_array(irg_info, info->outs, info->outs_log2);
+		}
+		info->outs      = outs;
+		info->outs_log2 = log2_size;
+	}
+	edge->idx = info->out_count++;
+	info->outs[edge->idx] = edge;
+}
+
+/**
+ * Removes an edge from the outs of its target, the last out takes its place.
+ */
+static void remove_out(ir_edge_t *edge, ir_edge_kind_t kind)
+{
+	irn_edge_info_t *info = get_irn_edge_info(edge->tgt, kind);
+	unsigned         idx  = edge->idx;
+	assert(idx < info->out_count && info->outs[idx] == edge);
+
+	ir_edge_t *last = info->outs[--info->out_count];
+	info->outs[idx] = last;
+	last->idx       = idx;
+}
+
+/**
+ * Verify the outs of a node, i.e. ensure that each edge knows its place
+ * and is the edge registered at its source.
+ */
+static inline void verify_outs(ir_node *irn, ir_edge_kind_t kind)
+{
+	const irn_edge_info_t *info = get_irn_edge_info(irn, kind);
+
+	for (unsigned i = 0; i < info->out_count; ++i) {
+		const ir_edge_t *edge = info->outs[i];
+		if (edge->idx == i && edge->tgt == irn
+		    && find_edge(edge->src, edge->pos, kind) == edge)
+			continue;
+
+		ir_fprintf(stderr, "EDGE Verifier: outs broken for %+F:\n", irn);
+		fprintf(stderr, "- at index %u\n", i);
+		ir_fprintf(stderr, "- edge(%ld) %+F(%d)\n", edge_get_id(edge), edge->src, edge->pos);
+		assert(0 && "broken out edge found");
+		break;
+	}
+}
+
+/**
+ * Calls a function for all nodes of a graph which are still known by their
+ * index, this includes dead nodes.
+ */
+static void visit_all_nodes(ir_graph *irg, irg_walk_func *func, void *env)
+{
+	for (unsigned idx = 0, n = get_irg_last_idx(irg); idx < n; ++idx) {
+		ir_node *node = get_idx_irn(irg, idx);
+		if (node != NULL)
+			func(node, env);
+	}
+}
+
+typedef struct dump_env_t {
+	ir_edge_kind_t kind;
+} dump_env_t;
+
+static void dump_outs(ir_node *irn, void *data)
+{
+	dump_env_t *env = (dump_env_t*)data;
+	foreach_out_edge_kind(irn, e, env->kind) {
+		ir_printf("%+F %d\n", e->src, e->pos);
+	}
 }
 
 void edges_dump_kind(ir_graph *irg, ir_edge_kind_t kind)
 {
-	irg_edge_info_t *info;
-	ir_edgeset_t    *edges;
-	ir_edgeset_iterator_t iter;
-	ir_edge_t      *e;
+	dump_env_t env;
 
 	if (!edges_activated_kind(irg, kind))
 		return;
 
-	info  = get_irg_edge_info(irg, kind);
-	edges = &info->edges;
-	foreach_ir_edgeset(edges, e, iter) {
-		ir_printf("%+F %d\n", e->src, e->pos);
-	}
+	env.kind = kind;
+	visit_all_nodes(irg, dump_outs, &env);
 }
 
 static void add_edge(ir_node *src, int pos, ir_node *tgt, ir_edge_kind_t kind,
@@ -216,34 +307,25 @@ static void add_edge(ir_node *src, int pos, ir_node *tgt, ir_edge_kind_t kind,
 	if (tgt == NULL)
 		return;
 	assert(edges_activated_kind(irg, kind));
-	irg_edge_info_t *info  = get_irg_edge_info(irg, kind);
-	ir_edgeset_t    *edges = &info->edges;
+	irg_edge_info_t *info = get_irg_edge_info(irg, kind);
 
-	struct list_head *head = &get_irn_edge_info(tgt, kind)->outs_head;
-	assert(head->next && head->prev &&
-		   "target list head must have been initialized");
+	ir_edge_t **slot = get_in_slot(src, pos, kind, info);
+	assert(*slot == NULL && "edge added twice");
 
 	/* The old target was NULL, thus, the edge is newly created. */
 	ir_edge_t *edge;
-	if (list_empty(&info->free_edges)) {
+	if (ARR_LEN(info->free_edges) == 0) {
 		edge = OALLOC(&info->edges_obst, ir_edge_t);
 	} else {
-		edge = list_entry(info->free_edges.next, ir_edge_t, list);
-		list_del(&edge->list);
+		edge = info->free_edges[ARR_LEN(info->free_edges) - 1];
+		ARR_SHRINKLEN(info->free_edges, ARR_LEN(info->free_edges) - 1);
 	}
 
-	edge->src       = src;
-	edge->pos       = pos;
-#ifdef DEBUG_libfirm
-	edge->present   = 0;
-#endif
-
-	ir_edge_t *new_edge = ir_edgeset_insert(edges, edge);
-	assert(new_edge == edge);
-
-	list_add(&new_edge->list, head);
-
-	edge_change_cnt(tgt, kind, +1);
+	edge->src = src;
+	edge->pos = pos;
+	edge->tgt = tgt;
+	*slot     = edge;
+	append_out(edge, kind, info);
 }
 
 static void delete_edge(ir_node *src, int pos, ir_node *old_tgt,
@@ -253,27 +335,18 @@ static void delete_edge(ir_node *src, int pos, ir_node *old_tgt,
 		return;
 	assert(edges_activated_kind(irg, kind));
 
-	irg_edge_info_t *info  = get_irg_edge_info(irg, kind);
-	ir_edgeset_t    *edges = &info->edges;
-
-	/* Initialize the edge template to search in the set. */
-	ir_edge_t templ;
-	templ.src = src;
-	templ.pos = pos;
-
-	/* search the edge in the set. */
-	ir_edge_t *edge = ir_edgeset_find(edges, &templ);
-
-	/* mark the edge invalid if it was found */
-	if (edge == NULL)
+	ir_edge_t **slot = find_in_slot(src, pos, kind);
+	if (slot == NULL || *slot == NULL)
 		return;
 
-	list_del(&edge->list);
-	ir_edgeset_remove(edges, edge);
-	list_add(&edge->list, &info->free_edges);
+	irg_edge_info_t *info = get_irg_edge_info(irg, kind);
+	ir_edge_t       *edge = *slot;
+	*slot = NULL;
+	remove_out(edge, kind);
+	ARR_APP1(ir_edge_t*, info->free_edges, edge);
 	edge->pos = -2;
 	edge->src = NULL;
-	edge_change_cnt(old_tgt, kind, -1);
+	edge->tgt = NULL;
 }
 
 void edges_notify_edge_kind(ir_node *src, int pos, ir_node *tgt,
@@ -293,39 +366,22 @@ void edges_notify_edge_kind(ir_node *src, int pos, ir_node *tgt,
 	if (tgt == old_tgt)
 		return;
 
-	irg_edge_info_t *info  = get_irg_edge_info(irg, kind);
-	ir_edgeset_t    *edges = &info->edges;
-
 	/*
 	 * The target is not NULL and the old target differs
-	 * from the new target, the edge shall be moved (if the
-	 * old target was != NULL) or added (if the old target was
-	 * NULL).
+	 * from the new target, the edge shall be moved.
 	 */
-	struct list_head *head = &get_irn_edge_info(tgt, kind)->outs_head;
-
-	assert(head->next && head->prev &&
-			"target list head must have been initialized");
-
-	/* Initialize the edge template to search in the set. */
-	ir_edge_t templ;
-	templ.src = src;
-	templ.pos = pos;
-
-	ir_edge_t *edge = ir_edgeset_find(edges, &templ);
+	ir_edge_t *edge = find_edge(src, pos, kind);
 	assert(edge && "edge to redirect not found!");
 
-	list_move(&edge->list, head);
-	edge_change_cnt(old_tgt, kind, -1);
-	edge_change_cnt(tgt, kind, +1);
+	remove_out(edge, kind);
+	edge->tgt = tgt;
+	append_out(edge, kind, get_irg_edge_info(irg, kind));
 
 #ifndef DEBUG_libfirm
-	/* verify list heads */
+	/* verify outs */
 	if (edges_dbg) {
-		if (tgt)
-			verify_list_head(tgt, kind);
-		if (old_tgt)
-			verify_list_head(old_tgt, kind);
+		verify_outs(tgt, kind);
+		verify_outs(old_tgt, kind);
 	}
 #endif
 }
@@ -333,6 +389,8 @@ void edges_notify_edge_kind(ir_node *src, int pos, ir_node *tgt,
 void edges_notify_edge(ir_node *src, int pos, ir_node *tgt, ir_node *old_tgt,
                        ir_graph *irg)
 {
+	irg_note_changed_node(irg, src);
+
 	if (edges_activated_kind(irg, EDGE_KIND_NORMAL)) {
 		edges_notify_edge_kind(src, pos, tgt, old_tgt, EDGE_KIND_NORMAL, irg);
 	}
@@ -424,7 +482,6 @@ static void edges_node_revival_kind(ir_node *irn, ir_edge_kind_t kind)
 
 typedef struct build_walker {
 	ir_edge_kind_t kind;
-	bitset_t       *reachable;
 	unsigned       problem_found;
 } build_walker;
 
@@ -446,50 +503,12 @@ static void build_edges_walker(ir_node *irn, void *data)
 }
 
 /**
- * Pre-Walker: initializes the list-heads and set the out-count
- * of all nodes to 0.
- */
-static void init_lh_walker(ir_node *irn, void *data)
-{
-	build_walker   *w    = (build_walker*)data;
-	ir_edge_kind_t  kind = w->kind;
-	list_head      *head = &get_irn_edge_info(irn, kind)->outs_head;
-	INIT_LIST_HEAD(head);
-	get_irn_edge_info(irn, kind)->edges_built = 0;
-	get_irn_edge_info(irn, kind)->out_count   = 0;
-}
-
-/**
- * Pre-Walker: initializes the list-heads and set the out-count
- * of all nodes to 0.
- *
- * Additionally touches DEP nodes, as they might be DEAD.
- * THIS IS UGLY, but I don't find a better way until we
- *
- * a) ensure that dead nodes are not used as input
- * b) it might be sufficient to add those stupid NO_REG nodes
- * to the anchor
+ * Walker: resets the edge info of a node.
  */
-static void init_lh_walker_dep(ir_node *irn, void *data)
+static void init_edges_walker(ir_node *irn, void *data)
 {
-	build_walker   *w    = (build_walker*)data;
-	ir_edge_kind_t  kind = w->kind;
-	list_head      *head = &get_irn_edge_info(irn, kind)->outs_head;
-	int             i;
-
-	INIT_LIST_HEAD(head);
-	get_irn_edge_info(irn, kind)->edges_built = 0;
-	get_irn_edge_info(irn, kind)->out_count   = 0;
-
-	for (i = get_irn_deps(irn) - 1; i >= 0; --i) {
-		ir_node *dep = get_irn_dep(irn, i);
-
-		head = &get_irn_edge_info(dep, kind)->outs_head;
-
-		INIT_LIST_HEAD(head);
-		get_irn_edge_info(dep, kind)->edges_built = 0;
-		get_irn_edge_info(dep, kind)->out_count   = 0;
-	}
+	build_walker *w = (build_walker*)data;
+	edges_init_node_kind(irn, w->kind);
 }
 
 void edges_activate_kind(ir_graph *irg, ir_edge_kind_t kind)
@@ -503,18 +522,11 @@ void edges_activate_kind(ir_graph *irg, ir_edge_kind_t kind)
 	 * - the identities add nodes to the "root set" that are not yet reachable
 	 *   from End. However, after some transformations, the CSE may revival these
 	 *   nodes
+	 * - Dep nodes might be dead
 	 *
-	 * These problems can be fixed using different strategies:
-	 * - Add an age flag to every node. Whenever the edge of a node is older
-	 *   then the current edge, invalidate the edges of this node.
-	 *   While this would help for revivaled nodes, it increases memory and runtime.
-	 * - Delete the identities set.
-	 *   Solves the revival problem, but may increase the memory consumption, as
-	 *   nodes cannot be revivaled at all.
-	 * - Manually iterate over the identities root set. This did not consume more memory
-	 *   but increase the computation time because the |identities| >= |V|
-	 *
-	 * Currently, we use the last option.
+	 * So the edge info of all nodes known to the graph is reset, the edges
+	 * are built for the reachable ones and revivaled nodes build their edges
+	 * when they come back.
 	 */
 	struct build_walker w;
 	irg_edge_info_t     *info = get_irg_edge_info(irg, kind);
@@ -525,17 +537,11 @@ void edges_activate_kind(ir_graph *irg, ir_edge_kind_t kind)
 
 	info->activated = 1;
 	edges_init_graph_kind(irg, kind);
-	if (kind == EDGE_KIND_DEP) {
-		irg_walk_anchors(irg, init_lh_walker_dep, NULL, &w);
-		/* Argh: Dep nodes might be dead, so we MUST visit identities first */
-		visit_all_identities(irg, init_lh_walker_dep, &w);
-		irg_walk_anchors(irg, NULL, build_edges_walker, &w);
-	} else if (kind == EDGE_KIND_BLOCK) {
-		visit_all_identities(irg, init_lh_walker, &w);
-		irg_block_walk_graph(irg, init_lh_walker, build_edges_walker, &w);
+	visit_all_nodes(irg, init_edges_walker, &w);
+	if (kind == EDGE_KIND_BLOCK) {
+		irg_block_walk_graph(irg, NULL, build_edges_walker, &w);
 	} else {
-		visit_all_identities(irg, init_lh_walker, &w);
-		irg_walk_anchors(irg, init_lh_walker, build_edges_walker, &w);
+		irg_walk_anchors(irg, NULL, build_edges_walker, &w);
 	}
 }
 
@@ -546,7 +552,7 @@ void edges_deactivate_kind(ir_graph *irg, ir_edge_kind_t kind)
 	info->activated = 0;
 	if (info->allocated) {
 		obstack_free(&info->edges_obst, NULL);
-		ir_edgeset_destroy(&info->edges);
+		DEL_ARR_F(info->free_edges);
 		info->allocated = 0;
 	}
 	clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES);
@@ -568,12 +574,12 @@ void edges_reroute_kind(ir_node *from, ir_node *to, ir_edge_kind_t kind)
 	set_edge_func_t *set_edge = edge_kind_info[kind].set_edge;
 
 	if (set_edge && edges_activated_kind(irg, kind)) {
-		struct list_head *head = &get_irn_edge_info(from, kind)->outs_head;
+		irn_edge_info_t *info = get_irn_edge_info(from, kind);
 
 		DBG((dbg, LEVEL_5, "reroute from %+F to %+F\n", from, to));
 
-		while (head != head->next) {
-			ir_edge_t *edge = list_entry(head->next, ir_edge_t, list);
+		while (info->out_count > 0) {
+			ir_edge_t *edge = info->outs[info->out_count - 1];
 			assert(edge->pos >= -1);
 			set_edge(edge->src, edge->pos, to);
 		}
@@ -596,36 +602,50 @@ void edges_reroute_except(ir_node *from, ir_node *to, ir_node *exception)
 }
 
 #ifdef DEBUG_libfirm
-static void verify_set_presence(ir_node *irn, void *data)
+static void verify_ins(ir_node *irn, void *data)
 {
-	build_walker *w     = (build_walker*)data;
-	ir_graph     *irg   = get_irn_irg(irn);
-	ir_edgeset_t *edges = &get_irg_edge_info(irg, w->kind)->edges;
+	build_walker          *w    = (build_walker*)data;
+	const irn_edge_info_t *info = get_irn_edge_info(irn, w->kind);
 	int i, n;
 
+	if (w->kind == EDGE_KIND_BLOCK && !is_Block(irn))
+		return;
+
 	foreach_tgt(irn, i, n, w->kind) {
-		ir_edge_t templ, *e;
+		ir_node   *tgt  = get_n(irn, i, w->kind);
+		ir_edge_t *edge = find_edge(irn, i, w->kind);
 
-		templ.src = irn;
-		templ.pos = i;
+		if (tgt == NULL ? edge != NULL
+		    : edge == NULL || edge->tgt != tgt || edge->src != irn
+		      || edge->pos != i)
+			w->problem_found = 1;
+	}
 
-		e = ir_edgeset_find(edges, &templ);
+	/*
+	 * Edges behind the last input are superfluous and their presence in
+	 * the ins is wrong.
+	 */
+	if (info->ins == NULL)
+		return;
+	for (unsigned idx = get_in_index(n, w->kind),
+	     size = 1u << info->ins_log2; idx < size; ++idx) {
+		const ir_edge_t *e = info->ins[idx];
 		if (e != NULL) {
-			e->present = 1;
-		} else {
 			w->problem_found = 1;
+			ir_fprintf(stderr, "Edge Verifier: edge(%ld) %+F,%d is superfluous\n", edge_get_id(e), e->src, e->pos);
 		}
 	}
 }
 
-static void verify_list_presence(ir_node *irn, void *data)
+static void verify_outs_presence(ir_node *irn, void *data)
 {
 	build_walker *w = (build_walker*)data;
 
-	bitset_set(w->reachable, get_irn_idx(irn));
+	if (w->kind == EDGE_KIND_BLOCK && !is_Block(irn))
+		return;
 
-	/* check list heads */
-	verify_list_head(irn, w->kind);
+	/* check outs array */
+	verify_outs(irn, w->kind);
 
 	foreach_out_edge_kind(irn, e, w->kind) {
 		ir_node *tgt;
@@ -648,32 +668,11 @@ int edges_verify_kind(ir_graph *irg, ir_edge_kind_t kind)
 {
 #ifdef DEBUG_libfirm
 	struct build_walker w;
-	ir_edgeset_t        *edges = &get_irg_edge_info(irg, kind)->edges;
-	ir_edge_t           *e;
-	ir_edgeset_iterator_t  iter;
 
 	w.kind          = kind;
-	w.reachable     = bitset_alloca(get_irg_last_idx(irg));
 	w.problem_found = 0;
 
-	/* Clear the present bit in all edges available. */
-	foreach_ir_edgeset(edges, e, iter) {
-		e->present = 0;
-	}
-
-	irg_walk_graph(irg, verify_set_presence, verify_list_presence, &w);
-
-	/*
-	 * Dump all edges which are not invalid and not present.
-	 * These edges are superfluous and their presence in the
-	 * edge set is wrong.
-	 */
-	foreach_ir_edgeset(edges, e, iter) {
-		if (! e->present && bitset_is_set(w.reachable, get_irn_idx(e->src))) {
-			w.problem_found = 1;
-			ir_fprintf(stderr, "Edge Verifier: edge(%ld) %+F,%d is superfluous\n", edge_get_id(e), e->src, e->pos);
-		}
-	}
+	irg_walk_graph(irg, verify_ins, verify_outs_presence, &w);
 
 	return w.problem_found;
 #else
@@ -724,7 +723,7 @@ static void count_user(ir_node *irn, void *env)
 }
 
 /**
- * Verifies if collected count, number of edges in list and stored edge count are in sync.
+ * Verifies if collected count and number of recorded edges are in sync.
  */
 static void verify_edge_counter(ir_node *irn, void *env)
 {
@@ -733,16 +732,7 @@ static void verify_edge_counter(ir_node *irn, void *env)
 		return;
 
 	bitset_t *bs       = (bitset_t*)get_irn_link(irn);
-	int       list_cnt = 0;
 	int       edge_cnt = get_irn_edge_info(irn, EDGE_KIND_NORMAL)->out_count;
-	const struct list_head *head
-		= &get_irn_edge_info(irn, EDGE_KIND_NORMAL)->outs_head;
-
-	/* We can iterate safely here, list heads have already been verified. */
-	const struct list_head *pos;
-	list_for_each(pos, head) {
-		++list_cnt;
-	}
 
 	/* check all nodes that reference us and count edges that point number
 	 * of ins that actually point to us */
@@ -760,16 +750,10 @@ static void verify_edge_counter(ir_node *irn, void *env)
 		}
 	}
 
-	if (edge_cnt != list_cnt) {
-		w->problem_found = 1;
-		ir_fprintf(stderr, "Edge Verifier: edge count is %d, but %d edge(s) are recorded in list at %+F\n",
-			edge_cnt, list_cnt, irn);
-	}
-
-	if (ref_cnt != list_cnt) {
+	if (ref_cnt != edge_cnt) {
 		w->problem_found = 1;
-		ir_fprintf(stderr, "Edge Verifier: %+F reachable by %d node(s), but the list contains %d edge(s)\n",
-			irn, ref_cnt, list_cnt);
+		ir_fprintf(stderr, "Edge Verifier: %+F reachable by %d node(s), but %d edge(s) are recorded\n",
+			irn, ref_cnt, edge_cnt);
 	}
 
 	free(bs);
@@ -15,7 +15,6 @@
 #include "debug.h"
 
 #include "set.h"
-#include "list.h"
 
 #include "irnode_t.h"
 #include "irgraph_t.h"
@@ -38,10 +37,8 @@
 struct ir_edge_t {
 	ir_node  *src;          /**< The source node of the edge. */
 	int      pos;           /**< The position of the edge at @p src. */
-#ifdef DEBUG_libfirm
-	unsigned present : 1;   /**< Used by the verifier. Don't rely on its content. */
-#endif
-	struct list_head list;  /**< The list head to queue all out edges at a node. */
+	unsigned idx;           /**< The index of the edge in the outs of @p tgt. */
+	ir_node  *tgt;          /**< The target node of the edge. */
 };
 
 /** Accessor for private irn info. */
@@ -75,15 +72,17 @@ static inline const irg_edge_info_t *get_irg_edge_info_const(
  * Get the first edge pointing to some node.
  * @note There is no order on out edges. First in this context only
  * means, that you get some starting point into the list of edges.
+ * The outs array is walked from its end, so removing the current edge
+ * (which moves an already visited edge into its place) or adding new
+ * edges (which are appended) during an iteration is fine.
  * @param irn The node.
  * @return The first out edge that points to this node.
  */
 static inline const ir_edge_t *get_irn_out_edge_first_kind_(const ir_node *irn, ir_edge_kind_t kind)
 {
-	const struct list_head *head;
 	assert(edges_activated_kind(get_irn_irg(irn), kind));
-	head = &get_irn_edge_info_const(irn, kind)->outs_head;
-	return list_empty(head) ? NULL : list_entry(head->next, ir_edge_t, list);
+	const irn_edge_info_t *info = get_irn_edge_info_const(irn, kind);
+	return info->out_count == 0 ? NULL : info->outs[info->out_count - 1];
 }
 
 /**
@@ -94,10 +93,8 @@ static inline const ir_edge_t *get_irn_out_edge_first_kind_(const ir_node *irn,
  */
 static inline const ir_edge_t *get_irn_out_edge_next_(const ir_node *irn, const ir_edge_t *last, ir_edge_kind_t kind)
 {
-	struct list_head *next = last->list.next;
-	const struct list_head *head
-		= &get_irn_edge_info_const(irn, kind)->outs_head;
-	return next == head ? NULL : list_entry(next, ir_edge_t, list);
+	unsigned idx = last->idx;
+	return idx == 0 ? NULL : get_irn_edge_info_const(irn, kind)->outs[idx - 1];
 }
 
 /**
@@ -133,6 +130,25 @@ static inline void edges_assure_kind_(ir_graph *irg, ir_edge_kind_t kind)
 
 void edges_init_graph_kind(ir_graph *irg, ir_edge_kind_t kind);
 
+/**
+ * Initialize the edge info of a node, which has no edges yet.
+ */
+static inline void edges_init_node_kind(ir_node *irn, ir_edge_kind_t kind)
+{
+	irn_edge_info_t *info = get_irn_edge_info(irn, kind);
+	if (kind == EDGE_KIND_NORMAL) {
+		info->outs      = irn->inline_outs;
+		info->outs_log2 = IRN_INLINE_OUTS_LOG2;
+	} else {
+		info->outs      = NULL;
+		info->outs_log2 = 0;
+	}
+	info->ins         = NULL;
+	info->edges_built = 0;
+	info->out_count   = 0;
+	info->ins_log2    = 0;
+}
+
 void edges_node_deleted(ir_node *irn);
 
 /**
@@ -28,7 +28,7 @@
 #include "irbackedge_t.h"
 #include "iredges_t.h"
 #include "type_t.h"
-#include "irmemory.h"
+#include "irmemory_t.h"
 #include "iroptimize.h"
 #include "irgopt.h"
 
@@ -326,6 +326,7 @@ void free_ir_graph(ir_graph *irg)
 
 	hook_free_graph(irg);
 	free_irg_outs(irg);
+	invalidate_points_to(irg);
 	del_identities(irg);
 	if (irg->ent) {
 		set_entity_irg(irg->ent, NULL);  /* not set in const code irg */
@@ -335,6 +336,8 @@ void free_ir_graph(ir_graph *irg)
 	obstack_free(&irg->obst, NULL);
 	if (irg->loc_descriptions)
 		free(irg->loc_descriptions);
+	if (irg->verify_changed != NULL)
+		DEL_ARR_F(irg->verify_changed);
 	irg->kind = k_BAD;
 	free_graph(irg);
 }
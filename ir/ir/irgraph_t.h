@@ -378,6 +378,22 @@ static inline ir_node *get_idx_irn_(const ir_graph *irg, unsigned idx)
 	return irg->idx_irn_map[idx];
 }
 
+/**
+ * Record a node created or changed since the last incremental verification.
+ * Implemented in irverify.c.
+ */
+void irg_record_changed_node(ir_graph *irg, const ir_node *node);
+
+/**
+ * Notify the incremental verifier that a node was created or one of its
+ * inputs changed. Costs a single test while changes are not tracked.
+ */
+static inline void irg_note_changed_node(ir_graph *irg, const ir_node *node)
+{
+	if (irg->verify_changed != NULL)
+		irg_record_changed_node(irg, node);
+}
+
 /**
  * Return the number of anchors in this graph.
  */
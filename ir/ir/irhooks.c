@@ -13,6 +13,10 @@
 #include "irhooks.h"
 
 hook_entry_t *hooks[hook_last];
+unsigned      hooks_active;
+
+/* every hook type needs a bit in hooks_active */
+COMPILETIME_ASSERT(hook_last <= sizeof(hooks_active) * 8, hooks_active_size)
 
 void register_hook(hook_type_t hook, hook_entry_t *entry)
 {
@@ -25,6 +29,7 @@ void register_hook(hook_type_t hook, hook_entry_t *entry)
 
   entry->next = hooks[hook];
   hooks[hook] = entry;
+  hooks_active |= 1u << hook;
 }
 
 void unregister_hook(hook_type_t hook, hook_entry_t *entry)
@@ -34,14 +39,16 @@ void unregister_hook(hook_type_t hook, hook_entry_t *entry)
   if (hooks[hook] == entry) {
     hooks[hook] = entry->next;
     entry->next = NULL;
-    return;
-  }
-
-  for (p = hooks[hook]; p && p->next != entry; p = p->next) {
+  } else {
+    for (p = hooks[hook]; p && p->next != entry; p = p->next) {
+    }
+
+    if (p) {
+      p->next     = entry->next;
+      entry->next = NULL;
+    }
   }
 
-  if (p) {
-    p->next     = entry->next;
-    entry->next = NULL;
-  }
+  if (hooks[hook] == NULL)
+    hooks_active &= ~(1u << hook);
 }
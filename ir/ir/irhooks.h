@@ -13,6 +13,7 @@
 
 #include "irop.h"
 #include "irnode.h"
+#include "compiler.h"
 
 /**
  * options for the hook_merge_nodes hook
@@ -218,16 +219,32 @@ void unregister_hook(hook_type_t hook, hook_entry_t *entry);
 /** Global list of registerd hooks. */
 extern hook_entry_t *hooks[hook_last];
 
+/** Bitmask of hook types with at least one registered entry. */
+extern unsigned hooks_active;
+
+/**
+ * Returns non-zero if entries are registered for the hook @p what.
+ * Unhooked events cost a single predictable branch. If libFirm is built
+ * with FIRM_DISABLE_HOOKS, all hooks are compiled out.
+ */
+#ifdef FIRM_DISABLE_HOOKS
+#define hook_is_active(what) 0
+#else
+#define hook_is_active(what) UNLIKELY(hooks_active & (1u << (what)))
+#endif
+
 /**
  * Executes the hook @p what with the args @p args
  * Do not use this macro directly.
  */
-#define hook_exec(what, args) do {           \
-  hook_entry_t *_p;                          \
-  for (_p = hooks[what]; _p; _p = _p->next){ \
-    void *hook_ctx_ = _p->context;           \
-    _p->hook._##what args;                   \
-  }                                          \
+#define hook_exec(what, args) do {             \
+  if (hook_is_active(what)) {                  \
+    hook_entry_t *_p;                          \
+    for (_p = hooks[what]; _p; _p = _p->next){ \
+      void *hook_ctx_ = _p->context;           \
+      _p->hook._##what args;                   \
+    }                                          \
+  }                                            \
 } while (0)
 
 /** Called when a new node opcode has been created */
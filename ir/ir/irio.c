@@ -31,6 +31,8 @@
 #include "obst.h"
 #include "pmap.h"
 #include "pdeq.h"
+#include "hashptr.h"
+#include "entity_t.h"
 
 #define SYMERROR ((unsigned) ~0)
 
@@ -63,6 +65,8 @@ typedef struct read_env_t {
 	struct obstack preds_obst;
 	delayed_initializer_t *delayed_initializers;
 	const delayed_pred_t **delayed_preds;
+	set           *merged_types; /**< types shared between the modules of an
+	                                  LTO import, NULL otherwise */
 } read_env_t;
 
 typedef struct write_env_t {
@@ -1680,6 +1684,81 @@ static ir_initializer_t *read_initializer(read_env_t *env)
 	panic("Unknown initializer kind");
 }
 
+/**
+ * Compares two types structurally. Only primitive, pointer and method types
+ * are compared, compound types stay separate per module.
+ */
+static int type_cmp(const void *elt, const void *key, size_t size)
+{
+	ir_type *type1 = *(ir_type *const*)elt;
+	ir_type *type2 = *(ir_type *const*)key;
+	size_t   i;
+	(void) size;
+
+	if (get_type_tpop(type1) != get_type_tpop(type2)
+	    || get_type_mode(type1) != get_type_mode(type2)
+	    || get_type_size_bytes(type1) != get_type_size_bytes(type2)
+	    || get_type_alignment_bytes(type1) != get_type_alignment_bytes(type2)
+	    || type1->flags != type2->flags)
+		return 1;
+
+	switch (get_type_tpop_code(type1)) {
+	case tpo_primitive:
+		return get_primitive_base_type(type1) != get_primitive_base_type(type2);
+	case tpo_pointer:
+		return get_pointer_points_to_type(type1)
+		    != get_pointer_points_to_type(type2);
+	case tpo_method:
+		if (get_method_n_params(type1) != get_method_n_params(type2)
+		    || get_method_n_ress(type1) != get_method_n_ress(type2)
+		    || get_method_variadicity(type1) != get_method_variadicity(type2)
+		    || get_method_calling_convention(type1)
+		       != get_method_calling_convention(type2)
+		    || get_method_additional_properties(type1)
+		       != get_method_additional_properties(type2))
+			return 1;
+		for (i = 0; i < get_method_n_params(type1); ++i) {
+			if (get_method_param_type(type1, i)
+			    != get_method_param_type(type2, i))
+				return 1;
+		}
+		for (i = 0; i < get_method_n_ress(type1); ++i) {
+			if (get_method_res_type(type1, i) != get_method_res_type(type2, i))
+				return 1;
+		}
+		return 0;
+	default:
+		return 1;
+	}
+}
+
+/**
+ * Returns a type of a previously imported module that is structurally equal
+ * to @p type or @p type itself.
+ */
+static ir_type *merge_type(read_env_t *env, ir_type *type)
+{
+	unsigned hash = get_type_tpop_code(type) ^ hash_ptr(get_type_mode(type));
+	size_t   i;
+
+	switch (get_type_tpop_code(type)) {
+	case tpo_primitive:
+		break;
+	case tpo_pointer:
+		hash ^= hash_ptr(get_pointer_points_to_type(type));
+		break;
+	case tpo_method:
+		hash ^= get_method_n_params(type) * 31 + get_method_n_ress(type);
+		for (i = 0; i < get_method_n_params(type); ++i)
+			hash = hash * 9 + hash_ptr(get_method_param_type(type, i));
+		break;
+	default:
+		return type;
+	}
+
+	return *set_insert(ir_type*, env->merged_types, &type, sizeof(type), hash);
+}
+
 /** Reads a type description and remembers it by its id. */
 static void read_type(read_env_t *env)
 {
@@ -1815,6 +1894,15 @@ finish_type:
 	set_type_alignment_bytes(type, align);
 	type->flags = flags;
 
+	if (env->merged_types != NULL) {
+		ir_type *merged = merge_type(env, type);
+		if (merged != type) {
+			free_type(type);
+			set_id(env, typenr, merged);
+			return;
+		}
+	}
+
 	if (state == layout_fixed)
 		ARR_APP1(ir_type *, env->fixedtypes, type);
 
@@ -2298,6 +2386,17 @@ static void read_program(read_env_t *env)
 		case kw_segment_type: {
 			ir_segment_t  segment = (ir_segment_t) read_enum(env, tt_segment);
 			ir_type      *type    = read_type_ref(env);
+			ir_type      *old     = get_segment_type(segment);
+			if (env->merged_types != NULL && old != NULL && old != type) {
+				/* another module already provided this segment */
+				size_t i;
+				for (i = get_compound_n_members(type); i > 0;) {
+					ir_entity *member = get_compound_member(type, --i);
+					set_entity_owner(member, old);
+				}
+				free_type(type);
+				break;
+			}
 			set_segment_type(segment, type);
 			break;
 		}
@@ -2328,7 +2427,8 @@ int ir_import(const char *filename)
 	return res;
 }
 
-int ir_import_file(FILE *input, const char *inputname)
+static int import_file(FILE *input, const char *inputname,
+                       set *merged_types)
 {
 	read_env_t          myenv;
 	int                 oldoptimize = get_optimize();
@@ -2349,6 +2449,7 @@ int ir_import_file(FILE *input, const char *inputname)
 	env->file       = input;
 	env->line       = 1;
 	env->delayed_initializers = NEW_ARR_F(delayed_initializer_t, 0);
+	env->merged_types = merged_types;
 
 	/* read first character */
 	read_c(env);
@@ -2436,4 +2537,168 @@ int ir_import_file(FILE *input, const char *inputname)
 	return env->read_errors;
 }
 
+int ir_import_file(FILE *input, const char *inputname)
+{
+	return import_file(input, inputname, NULL);
+}
+
+/** Returns how strongly an entity defines its symbol. */
+static int get_definition_rank(const ir_entity *entity)
+{
+	if (!entity_has_definition(entity))
+		return 0;
+	return get_entity_linkage(entity) & IR_LINKAGE_WEAK ? 1 : 2;
+}
+
+static void relink_node(ir_node *node, void *env)
+{
+	pmap *replacements = (pmap*)env;
+	if (is_SymConst(node) && SYMCONST_HAS_ENT(get_SymConst_kind(node))) {
+		ir_entity *entity = get_SymConst_entity(node);
+		ir_entity *repl;
+		/* a symbol may have been replaced several times */
+		while ((repl = pmap_get(ir_entity, replacements, entity)) != NULL)
+			entity = repl;
+		set_SymConst_entity(node, entity);
+	}
+}
+
+static void relink_initializer(ir_initializer_t *initializer,
+                               pmap *replacements)
+{
+	size_t i;
+
+	switch (get_initializer_kind(initializer)) {
+	case IR_INITIALIZER_CONST:
+		irg_walk(get_initializer_const_value(initializer), relink_node, NULL,
+		         replacements);
+		return;
+	case IR_INITIALIZER_TARVAL:
+	case IR_INITIALIZER_NULL:
+		return;
+	case IR_INITIALIZER_COMPOUND:
+		for (i = 0; i < get_initializer_compound_n_entries(initializer); ++i) {
+			ir_initializer_t *sub
+				= get_initializer_compound_value(initializer, i);
+			relink_initializer(sub, replacements);
+		}
+		return;
+	}
+	panic("invalid initializer found");
+}
+
+/**
+ * Resolves the symbols of all imported modules against each other: every
+ * externally visible symbol is represented by its strongest definition,
+ * local symbols with clashing names get unique names.
+ *
+ * @return the number of symbols with conflicting definitions
+ */
+static int link_entities(void)
+{
+	pmap        *symbols      = pmap_create();
+	pmap        *replacements = pmap_create();
+	ir_entity  **locals       = NEW_ARR_F(ir_entity*, 0);
+	int          errors       = 0;
+	pmap_entry  *entry;
+	ir_segment_t s;
+	size_t       i;
+
+	for (s = IR_SEGMENT_FIRST; s <= IR_SEGMENT_LAST; ++s) {
+		ir_type *segment = get_segment_type(s);
+		for (i = 0; i < get_compound_n_members(segment); ++i) {
+			ir_entity *entity = get_compound_member(segment, i);
+			ident     *name   = get_entity_ld_ident(entity);
+			ir_entity *other;
+			int        rank;
+			int        other_rank;
+
+			if (get_entity_visibility(entity) != ir_visibility_external) {
+				ARR_APP1(ir_entity*, locals, entity);
+				continue;
+			}
+
+			other = pmap_get(ir_entity, symbols, name);
+			if (other == NULL) {
+				pmap_insert(symbols, name, entity);
+				continue;
+			}
+
+			rank       = get_definition_rank(entity);
+			other_rank = get_definition_rank(other);
+			if (entity->entity_kind != other->entity_kind
+			    || (rank == 2 && other_rank == 2)) {
+				fprintf(stderr, "conflicting definitions of '%s'\n",
+				        get_id_str(name));
+				++errors;
+			}
+			if (rank > other_rank) {
+				pmap_insert(replacements, other, entity);
+				pmap_insert(symbols, name, entity);
+			} else {
+				pmap_insert(replacements, entity, other);
+			}
+		}
+	}
+
+	for (i = 0; i < get_irp_n_irgs(); ++i) {
+		irg_walk_graph(get_irp_irg(i), relink_node, NULL, replacements);
+	}
+	for (s = IR_SEGMENT_FIRST; s <= IR_SEGMENT_LAST; ++s) {
+		ir_type *segment = get_segment_type(s);
+		for (i = 0; i < get_compound_n_members(segment); ++i) {
+			ir_entity *entity = get_compound_member(segment, i);
+			if (entity->initializer != NULL)
+				relink_initializer(entity->initializer, replacements);
+		}
+	}
+
+	foreach_pmap(replacements, entry) {
+		ir_entity *entity = (ir_entity*)entry->key;
+		ir_graph  *irg    = get_entity_irg(entity);
+		if (irg != NULL)
+			free_ir_graph(irg);
+		free_entity(entity);
+	}
+
+	/* local symbols of different modules may share a name */
+	for (i = 0; i < ARR_LEN(locals); ++i) {
+		ir_entity *entity = locals[i];
+		ident     *name   = get_entity_ld_ident(entity);
+		if (pmap_contains(symbols, name)) {
+			name = id_mangle_dot(name, id_unique("lto%u"));
+			set_entity_ld_ident(entity, name);
+		}
+		pmap_insert(symbols, name, entity);
+	}
+
+	DEL_ARR_F(locals);
+	pmap_destroy(replacements);
+	pmap_destroy(symbols);
+	return errors;
+}
+
+int ir_import_lto(size_t n_files, const char *const *filenames)
+{
+	set   *merged_types = new_set(type_cmp, 128);
+	int    res          = 0;
+	size_t i;
+
+	for (i = 0; i < n_files; ++i) {
+		FILE *file = fopen(filenames[i], "rt");
+		if (file == NULL) {
+			perror(filenames[i]);
+			res = 1;
+			continue;
+		}
+		res |= import_file(file, filenames[i], merged_types);
+		fclose(file);
+	}
+	del_set(merged_types);
+
+	if (link_entities() != 0)
+		res = 1;
+	return res;
+}
+
 #include "gen_irio.c.inl"
@@ -108,15 +108,16 @@ ir_node *new_ir_node(dbg_info *db, ir_graph *irg, ir_node *block, ir_op *op,
 	res->node_nr = get_irp_new_node_nr();
 
 	for (ir_edge_kind_t i = EDGE_KIND_FIRST; i <= EDGE_KIND_LAST; ++i) {
-		INIT_LIST_HEAD(&res->edge_info[i].outs_head);
+		edges_init_node_kind(res, i);
 		/* edges will be build immediately */
 		res->edge_info[i].edges_built = 1;
-		res->edge_info[i].out_count = 0;
 	}
 
 	/* don't put this into the for loop, arity is -1 for some nodes! */
 	if (block != NULL)
 		edges_notify_edge(res, -1, block, NULL, irg);
+	else
+		irg_note_changed_node(irg, res);
 	for (int i = 0; i < arity; ++i)
 		edges_notify_edge(res, i, res->in[i+1], NULL, irg);
 
@@ -301,8 +302,11 @@ void delete_irn_dep(ir_node *node, ir_node *dep)
 	n_deps = ARR_LEN(node->deps);
 	for (i = 0; i < n_deps; ++i) {
 		if (node->deps[i] == dep) {
-			set_irn_dep(node, i, node->deps[n_deps-1]);
-			edges_notify_edge(node, i, NULL, dep, get_irn_irg(node));
+			ir_node  *last = node->deps[n_deps-1];
+			ir_graph *irg  = get_irn_irg(node);
+			set_irn_dep(node, i, last);
+			if (edges_activated_kind(irg, EDGE_KIND_DEP))
+				edges_notify_edge_kind(node, n_deps-1, NULL, last, EDGE_KIND_DEP, irg);
 			ARR_SHRINKLEN(node->deps, n_deps-1);
 			break;
 		}
@@ -119,6 +119,7 @@ void ir_prog_pass_mgr_add_graph_pass(
 	graph_mgr = new_graph_pass_mgr(
 		"graph_pass_wrapper", mgr->verify_all, mgr->dump_all);
 	graph_mgr->run_idx = mgr->run_idx + mgr->n_passes;
+	graph_mgr->verify_flags = mgr->verify_flags;
 
 	ir_graph_pass_mgr_add(graph_mgr, pass);
 
@@ -133,8 +134,10 @@ void ir_prog_pass_mgr_add_graph_mgr(
 
 	if (mgr->dump_all)
 		graph_mgr->dump_all = 1;
-	if (mgr->verify_all)
-		graph_mgr->verify_all = 1;
+	if (mgr->verify_all) {
+		graph_mgr->verify_all   = 1;
+		graph_mgr->verify_flags = mgr->verify_flags;
+	}
 	graph_mgr->run_idx = mgr->n_passes;
 
 	ir_prog_pass_mgr_add(mgr, pass);
@@ -160,7 +163,7 @@ int ir_graph_pass_mgr_run(ir_graph_pass_manager_t *mgr)
 				if (pass->verify_irg) {
 					pass->verify_irg(irg, pass->context);
 				} else {
-					irg_verify(irg, 0);
+					irg_verify(irg, mgr->verify_flags);
 				}
 			}
 			/* dump */
@@ -181,14 +184,14 @@ int ir_graph_pass_mgr_run(ir_graph_pass_manager_t *mgr)
 /**
  * Verify all graphs on the given ir_prog.
  */
-static int irp_verify_irgs(void)
+static int irp_verify_irgs(unsigned flags)
 {
 	int    res = 1;
 	size_t i;
 	size_t n_irgs = get_irp_n_irgs();
 
 	for (i = 0; i < n_irgs; ++i)
-		res &= irg_verify(get_irp_irg(i), 0);
+		res &= irg_verify(get_irp_irg(i), flags);
 	return res;
 }
 
@@ -207,7 +210,7 @@ int ir_prog_pass_mgr_run(ir_prog_pass_manager_t *mgr)
 			if (pass->verify_irprog) {
 				pass->verify_irprog(irp, pass->context);
 			} else {
-				irp_verify_irgs();
+				irp_verify_irgs(mgr->verify_flags);
 			}
 		}
 		/* dump */
@@ -233,11 +236,12 @@ ir_graph_pass_manager_t *new_graph_pass_mgr(
 	ir_graph_pass_manager_t *res = XMALLOCZ(ir_graph_pass_manager_t);
 
 	INIT_LIST_HEAD(&res->passes);
-	res->kind       = k_ir_graph_pass_mgr;
-	res->name       = name;
-	res->run_idx    = 0;
-	res->verify_all = verify_all != 0;
-	res->dump_all   = dump_all   != 0;
+	res->kind         = k_ir_graph_pass_mgr;
+	res->name         = name;
+	res->run_idx      = 0;
+	res->verify_flags = VERIFY_NORMAL;
+	res->verify_all   = verify_all != 0;
+	res->dump_all     = dump_all   != 0;
 
 	return res;
 }
@@ -248,11 +252,12 @@ ir_prog_pass_manager_t *new_prog_pass_mgr(
 	ir_prog_pass_manager_t *res = XMALLOCZ(ir_prog_pass_manager_t);
 
 	INIT_LIST_HEAD(&res->passes);
-	res->kind       = k_ir_prog_pass_mgr;
-	res->name       = name;
-	res->run_idx    = 0;
-	res->verify_all = verify_all != 0;
-	res->dump_all   = dump_all   != 0;
+	res->kind         = k_ir_prog_pass_mgr;
+	res->name         = name;
+	res->run_idx      = 0;
+	res->verify_flags = VERIFY_NORMAL;
+	res->verify_all   = verify_all != 0;
+	res->dump_all     = dump_all   != 0;
 
 	return res;
 }
@@ -281,6 +286,18 @@ void term_prog_pass_mgr(ir_prog_pass_manager_t *mgr)
 	free(mgr);
 }
 
+void ir_graph_pass_mgr_set_verify_flags(
+	ir_graph_pass_manager_t *mgr, unsigned flags)
+{
+	mgr->verify_flags = flags;
+}
+
+void ir_prog_pass_mgr_set_verify_flags(
+	ir_prog_pass_manager_t *mgr, unsigned flags)
+{
+	mgr->verify_flags = flags;
+}
+
 void ir_graph_pass_mgr_set_run_idx(
 	ir_graph_pass_manager_t *mgr, unsigned run_idx)
 {
@@ -105,6 +105,7 @@ struct ir_graph_pass_manager_t {
 	unsigned   n_passes;       /**< Number of added passes. */
 	const char *name;          /**< the name of the manager. */
 	unsigned   run_idx;        /**< The run number for the first pass of this manager. */
+	unsigned   verify_flags;   /**< irg_verify() flags used for verify_all. */
 	unsigned   verify_all:1;   /**< Set if every pass should be verified. */
 	unsigned   dump_all:1;     /**< Set if every pass should be dumped. */
 };
@@ -118,6 +119,7 @@ struct ir_prog_pass_manager_t {
 	unsigned   n_passes;       /**< Number of added passes. */
 	const char *name;          /**< the name of the manager. */
 	unsigned   run_idx;        /**< The run number for the first pass of this manager. */
+	unsigned   verify_flags;   /**< irg_verify() flags used for verify_all. */
 	unsigned   verify_all:1;   /**< Set if every pass should be verified. */
 	unsigned   dump_all:1;     /**< Set if every pass should be dumped. */
 };
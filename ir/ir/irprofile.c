@@ -568,6 +568,11 @@ void ir_profile_free(void)
 	}
 }
 
+bool ir_profile_available(void)
+{
+	return profile != NULL;
+}
+
 bool ir_profile_read(const char *filename)
 {
 	block_assoc_t env;
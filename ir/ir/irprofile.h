@@ -33,6 +33,11 @@ ir_graph *ir_profile_instrument(const char *filename);
  */
 bool ir_profile_read(const char *filename);
 
+/**
+ * Returns true if profile information has been read.
+ */
+bool ir_profile_available(void);
+
 /**
  * Frees the profile info
  */
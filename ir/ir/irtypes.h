@@ -386,13 +386,23 @@ typedef union ir_attr {
 	switch_attr    switcha;       /**< For Switch operation. */
 } ir_attr;
 
+/** log2 of the number of normal out edges a node holds without allocating. */
+#define IRN_INLINE_OUTS_LOG2 1
+#define IRN_INLINE_OUTS      (1 << IRN_INLINE_OUTS_LOG2)
+
 /**
  * Edge info to put into an irn.
  */
 typedef struct irn_edge_kind_info_t {
-	struct list_head outs_head;  /**< The list of all outs. */
+	ir_edge_t **outs;            /**< Array of all outs, inline_outs of the
+	                                  node for few normal outs. */
+	ir_edge_t **ins;             /**< The edge of each input (indexed by its
+	                                  position from the first edge position)
+	                                  or NULL. */
 	unsigned edges_built : 1;    /**< Set edges where built for this node. */
-	unsigned out_count : 31;     /**< Number of outs in the list. */
+	unsigned out_count : 31;     /**< Number of outs in the array. */
+	unsigned char outs_log2;     /**< log2 of the size of the outs array. */
+	unsigned char ins_log2;      /**< log2 of the size of the ins array. */
 } irn_edge_info_t;
 
 typedef irn_edge_info_t irn_edges_info_t[EDGE_KIND_LAST+1];
@@ -438,21 +448,23 @@ struct ir_node {
 	struct ir_node **deps;   /**< Additional dependencies induced by state. */
 	void            *backend_info;
 	irn_edges_info_t edge_info;  /**< Everlasting out edges. */
+	ir_edge_t *inline_outs[IRN_INLINE_OUTS]; /**< Storage for few normal
+	                                              out edges. */
 
 	/* ------- Opcode depending fields -------- */
 	ir_attr attr;            /**< The set of attributes of this node. Depends on opcode.
 	                              Must be last field of struct ir_node. */
 };
 
-#include "iredgeset.h"
-
 /**
  * Edge info to put into an irg.
  */
 typedef struct irg_edge_info_t {
-	ir_edgeset_t     edges;          /**< A set containing all edges of the current graph. */
-	struct list_head free_edges;     /**< list of all free edges. */
-	struct obstack   edges_obst;     /**< Obstack, where edges are allocated on. */
+	ir_edge_t      **free_edges;     /**< Flexible array of all free edges. */
+	ir_edge_t      **free_arrays[32];/**< Lists of free edge arrays, indexed by
+	                                      log2 of their size. */
+	struct obstack   edges_obst;     /**< Obstack, where edges and edge arrays
+	                                      are allocated on. */
 	unsigned         allocated : 1;  /**< Set if edges are allocated on the obstack. */
 	unsigned         activated : 1;  /**< Set if edges are activated for the graph. */
 } irg_edge_info_t;
@@ -553,6 +565,12 @@ struct ir_graph {
 
 	irg_edges_info_t edge_info;        /**< edge info for automatic outs */
 	ir_node **idx_irn_map;             /**< Array mapping node indexes to nodes. */
+	unsigned *verify_changed;          /**< Indices of nodes created or changed
+	                                        since the last incremental
+	                                        verification, NULL if changes are
+	                                        not tracked. */
+	unsigned  verify_changed_overflow:1; /**< Too many changes were recorded,
+	                                          verify the whole graph next time. */
 
 	size_t index;                      /**< a unique number for each graph */
 	/** extra info which should survive accross multiple passes */
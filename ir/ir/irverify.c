@@ -22,6 +22,8 @@
 #include "irpass_t.h"
 #include "irnodeset.h"
 #include "ircons.h"
+#include "array.h"
+#include "raw_bitset.h"
 
 const char *firm_verify_failure_msg;
 
@@ -1846,7 +1848,199 @@ static int check_cfg(ir_graph *irg)
 }
 #endif
 
-int irg_verify(ir_graph *irg, unsigned flags)
+/**
+ * Returns the graph a node belongs to or NULL if the node is not properly
+ * placed in a block, so it cannot be found.
+ */
+static ir_graph *get_irn_irg_safe(const ir_node *node)
+{
+	if (!ir_has_irg_ref(node)) {
+		node = get_irn_n(node, -1);
+		if (node == NULL || !ir_has_irg_ref(node))
+			return NULL;
+	}
+	return node->attr.irg.irg;
+}
+
+/**
+ * Cheap structural checks of a single node. Only the node and its direct
+ * inputs are inspected, so this is suitable for a linear sweep over the
+ * whole graph.
+ */
+static int verify_node_fast(const ir_node *n, ir_graph *irg)
+{
+	int i, arity;
+
+	if (!get_node_verification_mode())
+		return 1;
+
+	ASSERT_AND_RET_DBG(
+		get_idx_irn(irg, get_irn_idx(n)) == n,
+		"Node index and index map entry differ", 0,
+		ir_printf("node %+F\n", n);
+	);
+	ASSERT_AND_RET_DBG(get_irn_mode(n) != NULL, "node has no mode", 0,
+		ir_printf("node %+F\n", n);
+	);
+
+	if (is_Anchor(n))
+		return 1;
+
+	if (!is_Block(n)) {
+		ir_node *block = get_nodes_block(n);
+		ASSERT_AND_RET_DBG(
+			block != NULL && (is_Block(block) || (is_Bad(block)
+				&& !irg_has_properties(irg, IR_GRAPH_PROPERTY_NO_BADS))),
+			"block input is not a block", 0,
+			ir_printf("node %+F block %+F\n", n, block);
+		);
+	}
+	ASSERT_AND_RET_DBG(get_irn_irg_safe(n) == irg,
+		"Node is not stored on proper IR graph!", 0,
+		ir_printf("node %+F\n", n);
+	);
+
+	arity = get_irn_arity(n);
+	for (i = 0; i < arity; ++i) {
+		ir_node *pred = get_irn_n(n, i);
+		ASSERT_AND_RET_DBG(pred != NULL, "node has a NULL input", 0,
+			ir_printf("node %+F input %d\n", n, i);
+		);
+		ASSERT_AND_RET_DBG(!is_Deleted(pred), "node uses a deleted node", 0,
+			ir_printf("node %+F input %d\n", n, i);
+		);
+		ASSERT_AND_RET_DBG(get_irn_irg_safe(pred) == irg,
+			"node uses a node of another graph", 0,
+			ir_printf("node %+F input %d %+F\n", n, i, pred);
+		);
+	}
+
+	if (is_Proj(n)) {
+		ir_node *pred = get_Proj_pred(n);
+		ASSERT_AND_RET_DBG(is_Bad(pred) || get_irn_mode(pred) == mode_T,
+			"Proj of a node without tuple mode", 0,
+			ir_printf("node %+F pred %+F\n", n, pred);
+		);
+	} else if (is_Phi(n)
+	           && !irg_is_constrained(irg, IR_GRAPH_CONSTRAINT_CONSTRUCTION)) {
+		ir_node *block = get_nodes_block(n);
+		ASSERT_AND_RET_DBG(
+			!is_Block(block) || get_Block_n_cfgpreds(block) == arity,
+			"Phi arity differs from block arity", 0,
+			ir_printf("node %+F block %+F\n", n, block);
+		);
+	}
+	return 1;
+}
+
+/**
+ * Fast verification: Marks the nodes reachable from the anchor with an
+ * explicit worklist, then checks them in a linear sweep over the node index
+ * map. Dead nodes are not checked, they may legally refer to deleted nodes.
+ */
+static int verify_fast(ir_graph *irg)
+{
+	int       res       = 1;
+	unsigned  last_idx  = get_irg_last_idx(irg);
+	unsigned *reachable = rbitset_malloc(last_idx);
+	ir_node **worklist  = NEW_ARR_F(ir_node*, 0);
+	ir_node  *anchor    = irg->anchor;
+	unsigned  idx;
+
+	rbitset_set(reachable, get_irn_idx(anchor));
+	ARR_APP1(ir_node*, worklist, anchor);
+	while (ARR_LEN(worklist) > 0) {
+		size_t   len  = ARR_LEN(worklist);
+		ir_node *node = worklist[len - 1];
+		int      i;
+
+		ARR_SHRINKLEN(worklist, len - 1);
+		for (i = is_Block(node) ? 0 : -1; i < get_irn_arity(node); ++i) {
+			ir_node *pred = get_irn_n(node, i);
+			unsigned pred_idx;
+
+			if (pred == NULL)
+				continue;
+			/* foreign nodes are reported when checking node */
+			pred_idx = get_irn_idx(pred);
+			if (pred_idx >= last_idx || get_idx_irn(irg, pred_idx) != pred
+			    || rbitset_is_set(reachable, pred_idx))
+				continue;
+			rbitset_set(reachable, pred_idx);
+			ARR_APP1(ir_node*, worklist, pred);
+		}
+	}
+	DEL_ARR_F(worklist);
+
+	for (idx = 0; idx < last_idx; ++idx) {
+		if (!rbitset_is_set(reachable, idx))
+			continue;
+		if (!verify_node_fast(get_idx_irn(irg, idx), irg))
+			res = 0;
+	}
+	free(reachable);
+	return res;
+}
+
+/**
+ * Incremental verification: checks only the nodes recorded by
+ * irg_record_changed_node() since the last incremental verification.
+ * Users of a changed node are not rechecked unless they changed themselves.
+ */
+static int verify_changed(ir_graph *irg, unsigned flags)
+{
+	int       res       = 1;
+	unsigned  last_idx  = get_irg_last_idx(irg);
+	unsigned *seen      = rbitset_malloc(last_idx);
+	int       check_dom = (flags & VERIFY_FAST) == 0
+		&& get_irg_pinned(irg) == op_pin_state_pinned
+		&& irg_has_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE);
+	size_t    i;
+
+	for (i = 0; i < ARR_LEN(irg->verify_changed); ++i) {
+		unsigned idx = irg->verify_changed[i];
+		ir_node *node;
+
+		if (idx >= last_idx || rbitset_is_set(seen, idx))
+			continue;
+		rbitset_set(seen, idx);
+
+		/* killed or exchanged in the meantime */
+		node = get_idx_irn(irg, idx);
+		if (node == NULL || is_Deleted(node))
+			continue;
+
+		if (!verify_node_fast(node, irg)) {
+			res = 0;
+		} else if ((flags & VERIFY_FAST) == 0) {
+			if (!irn_verify_irg(node, irg)
+			    || (check_dom && !check_dominance_for_node(node)))
+				res = 0;
+		}
+	}
+	free(seen);
+	return res;
+}
+
+void irg_record_changed_node(ir_graph *irg, const ir_node *node)
+{
+	if (irg->verify_changed_overflow)
+		return;
+
+	/* once there are many more changes than nodes, verifying the whole graph
+	 * is cheaper than keeping the log */
+	if (ARR_LEN(irg->verify_changed) > 2 * (size_t)get_irg_last_idx(irg) + 64) {
+		irg->verify_changed_overflow = 1;
+		ARR_SHRINKLEN(irg->verify_changed, 0);
+		return;
+	}
+	ARR_APP1(unsigned, irg->verify_changed, get_irn_idx(node));
+}
+
+/**
+ * Full verification of all reachable nodes including the control flow.
+ */
+static int verify_full(ir_graph *irg, unsigned flags)
 {
 	int res = 1;
 #ifdef DEBUG_libfirm
@@ -1869,6 +2063,42 @@ int irg_verify(ir_graph *irg, unsigned flags)
 		NULL,
 		&res
 	);
+#else
+	(void)irg;
+	(void)flags;
+#endif /* DEBUG_libfirm */
+
+	return res;
+}
+
+int irg_verify(ir_graph *irg, unsigned flags)
+{
+	int res;
+
+#ifndef DEBUG_libfirm
+	/* the full checks are only available in debug builds, use the cheap
+	 * ones for the incremental mode */
+	if (flags & VERIFY_INCREMENTAL)
+		flags |= VERIFY_FAST;
+#endif
+
+	if ((flags & VERIFY_INCREMENTAL) && irg->verify_changed != NULL
+	    && !irg->verify_changed_overflow) {
+		res = verify_changed(irg, flags);
+	} else if (flags & VERIFY_FAST) {
+		res = verify_fast(irg);
+	} else {
+		res = verify_full(irg, flags);
+	}
+
+	if (flags & VERIFY_INCREMENTAL) {
+		/* start (or restart) recording changes */
+		if (irg->verify_changed == NULL)
+			irg->verify_changed = NEW_ARR_F(unsigned, 0);
+		else
+			ARR_SHRINKLEN(irg->verify_changed, 0);
+		irg->verify_changed_overflow = 0;
+	}
 
 	if (get_node_verification_mode() == FIRM_VERIFICATION_REPORT && ! res) {
 		ir_entity *ent = get_irg_entity(irg);
@@ -1879,11 +2109,6 @@ int irg_verify(ir_graph *irg, unsigned flags)
 			fprintf(stderr, "irg_verify: Verifying graph %p failed\n", (void *)irg);
 	}
 
-#else
-	(void)irg;
-	(void)flags;
-#endif /* DEBUG_libfirm */
-
 	return res;
 }
 
@@ -9,6 +9,7 @@
  * @author  Michael Beck, Matthias Braun
  */
 #include <stdbool.h>
+#include <string.h>
 
 #include "lower_calls.h"
 #include "lowering.h"
@@ -19,6 +20,7 @@
 #include "ircons.h"
 #include "irgmod.h"
 #include "irgwalk.h"
+#include "iredges_t.h"
 #include "irmemory.h"
 #include "irtools.h"
 #include "iroptimize.h"
@@ -29,6 +31,7 @@
 
 static pmap *pointer_types;
 static pmap *lowered_mtps;
+static const lower_call_abi_t *abi;
 
 static bool needs_lowering(const ir_type *type)
 {
@@ -49,7 +52,7 @@ static ir_type *get_pointer_type(ir_type *dest_type)
 	return res;
 }
 
-static void fix_parameter_entities(ir_graph *irg, size_t n_compound_ret)
+static void fix_parameter_entities(ir_graph *irg, const size_t *param_map)
 {
 	ir_type *frame_type = get_irg_frame_type(irg);
 	size_t   n_members  = get_compound_n_members(frame_type);
@@ -61,11 +64,12 @@ static void fix_parameter_entities(ir_graph *irg, size_t n_compound_ret)
 		if (!is_parameter_entity(member))
 			continue;
 
-		/* increase parameter number since we added a new parameter in front */
+		/* hidden parameters in front and compounds passed in several values
+		 * shift the parameter numbers */
 		num = get_entity_parameter_number(member);
 		if (num == IR_VA_START_PARAMETER_NUMBER)
 			continue;
-		set_entity_parameter_number(member, num + n_compound_ret);
+		set_entity_parameter_number(member, param_map[num]);
 	}
 }
 
@@ -88,6 +92,186 @@ static void remove_compound_param_entities(ir_graph *irg)
 	}
 }
 
+/**
+ * Classifies the compound results and parameters of a method type. Compounds
+ * passed in memory and all other types get a spec of length 0.
+ */
+static void classify_method(compound_call_lowering_flags flags, ir_type *mtp,
+                            aggregate_spec_t *res_specs,
+                            aggregate_spec_t *param_specs)
+{
+	size_t n_ress   = get_method_n_ress(mtp);
+	size_t n_params = get_method_n_params(mtp);
+	size_t i;
+
+	memset(res_specs, 0, n_ress * sizeof(*res_specs));
+	memset(param_specs, 0, n_params * sizeof(*param_specs));
+	if (abi == NULL)
+		return;
+
+	if (abi->reset_state != NULL)
+		abi->reset_state(abi->env);
+	for (i = 0; i < n_ress; ++i) {
+		ir_type *res_tp = get_method_res_type(mtp, i);
+		if (needs_lowering(res_tp) && abi->lower_return != NULL)
+			res_specs[i] = abi->lower_return(abi->env, res_tp);
+	}
+	if (abi->lower_parameter == NULL)
+		return;
+
+	/* the hidden parameters come first */
+	for (i = 0; i < n_ress; ++i) {
+		ir_type *res_tp = get_method_res_type(mtp, i);
+		if (needs_lowering(res_tp) && res_specs[i].length == 0)
+			abi->lower_parameter(abi->env, get_pointer_type(res_tp));
+	}
+	for (i = 0; i < n_params; ++i) {
+		ir_type          *param_type = get_method_param_type(mtp, i);
+		aggregate_spec_t  spec       = abi->lower_parameter(abi->env, param_type);
+		if (needs_lowering(param_type) && !(flags & LF_DONT_LOWER_ARGUMENTS))
+			param_specs[i] = spec;
+	}
+}
+
+/**
+ * @return The offset of the value n of a compound passed in values.
+ */
+static unsigned get_piece_offset(const aggregate_spec_t *spec, unsigned n)
+{
+	unsigned offset = 0;
+	unsigned i;
+
+	for (i = 0; i < n; ++i)
+		offset += get_mode_size_bytes(spec->modes[i]);
+	return offset;
+}
+
+/**
+ * @return The number of bytes of the compound type held by value n.
+ */
+static unsigned get_piece_size(const aggregate_spec_t *spec,
+                               const ir_type *type, unsigned n)
+{
+	unsigned offset = get_piece_offset(spec, n);
+	unsigned size   = get_mode_size_bytes(spec->modes[n]);
+	unsigned rest   = get_type_size_bytes(type) - offset;
+
+	assert(offset < get_type_size_bytes(type));
+	return size < rest ? size : rest;
+}
+
+/**
+ * @return The part of a piece of size bytes loaded or stored at once.
+ */
+static ir_mode *get_part_mode(unsigned size, const ir_mode *mode)
+{
+	unsigned max = get_mode_size_bytes(mode);
+
+	if (size >= 8 && max >= 8)
+		return mode_Lu;
+	else if (size >= 4 && max >= 4)
+		return mode_Iu;
+	else if (size >= 2 && max >= 2)
+		return mode_Hu;
+	return mode_Bu;
+}
+
+/**
+ * @return ptr + offset
+ */
+static ir_node *build_offset_addr(ir_node *block, ir_node *ptr, unsigned offset)
+{
+	ir_graph *irg       = get_irn_irg(block);
+	ir_mode  *addr_mode = get_irn_mode(ptr);
+	ir_mode  *offs_mode = get_reference_mode_unsigned_eq(addr_mode);
+	ir_node  *cnst;
+
+	if (offset == 0)
+		return ptr;
+	cnst = new_r_Const_long(irg, offs_mode, offset);
+	return new_r_Add(block, ptr, cnst, addr_mode);
+}
+
+/**
+ * Loads value n of a compound passed in values from the compound at ptr.
+ * Values with a size which is no power of two are loaded in several parts.
+ */
+static ir_node *build_piece_load(dbg_info *dbgi, ir_node *block, ir_node **mem,
+                                 ir_node *ptr, ir_type *type,
+                                 const aggregate_spec_t *spec, unsigned n)
+{
+	ir_graph *irg    = get_irn_irg(block);
+	ir_mode  *mode   = spec->modes[n];
+	unsigned  offset = get_piece_offset(spec, n);
+	unsigned  size   = get_piece_size(spec, type, n);
+	unsigned  align  = get_type_alignment_bytes(type);
+	ir_node  *res    = NULL;
+	unsigned  done;
+
+	for (done = 0; done < size; ) {
+		ir_mode       *part_mode = get_part_mode(size - done, mode);
+		unsigned       part      = get_mode_size_bytes(part_mode);
+		ir_node       *addr      = build_offset_addr(block, ptr, offset + done);
+		ir_cons_flags  cons      = align < part ? cons_unaligned : cons_none;
+		ir_node       *load      = new_rd_Load(dbgi, block, *mem, addr,
+		                                       part_mode, cons);
+		ir_node       *val       = new_r_Proj(load, part_mode, pn_Load_res);
+
+		*mem = new_r_Proj(load, mode_M, pn_Load_M);
+		if (part_mode != mode)
+			val = new_rd_Conv(dbgi, block, val, mode);
+		if (res != NULL) {
+			ir_node *shift = new_r_Const_long(irg, mode_Iu, done * 8);
+			val = new_rd_Shl(dbgi, block, val, shift, mode);
+			res = new_rd_Or(dbgi, block, res, val, mode);
+		} else {
+			res = val;
+		}
+		done += part;
+	}
+	return res;
+}
+
+/**
+ * Stores value n of a compound passed in values into the compound at ptr.
+ *
+ * @return the memory after the stores
+ */
+static ir_node *build_piece_store(dbg_info *dbgi, ir_node *block, ir_node *mem,
+                                  ir_node *ptr, ir_type *type,
+                                  const aggregate_spec_t *spec, unsigned n,
+                                  ir_node *value, ir_node **first_store)
+{
+	ir_graph *irg    = get_irn_irg(block);
+	ir_mode  *mode   = spec->modes[n];
+	unsigned  offset = get_piece_offset(spec, n);
+	unsigned  size   = get_piece_size(spec, type, n);
+	unsigned  align  = get_type_alignment_bytes(type);
+	unsigned  done;
+
+	for (done = 0; done < size; ) {
+		ir_mode       *part_mode = get_part_mode(size - done, mode);
+		unsigned       part      = get_mode_size_bytes(part_mode);
+		ir_node       *addr      = build_offset_addr(block, ptr, offset + done);
+		ir_cons_flags  cons      = align < part ? cons_unaligned : cons_none;
+		ir_node       *val       = value;
+		ir_node       *store;
+
+		if (done > 0) {
+			ir_node *shift = new_r_Const_long(irg, mode_Iu, done * 8);
+			val = new_rd_Shr(dbgi, block, val, shift, mode);
+		}
+		if (part_mode != mode)
+			val = new_rd_Conv(dbgi, block, val, part_mode);
+		store = new_rd_Store(dbgi, block, mem, addr, val, cons);
+		mem   = new_r_Proj(store, mode_M, pn_Store_M);
+		if (first_store != NULL && *first_store == NULL)
+			*first_store = store;
+		done += part;
+	}
+	return mem;
+}
+
 /**
  * Creates a new lowered type for a method type with compound
  * arguments. The new type is associated to the old one and returned.
@@ -102,8 +286,12 @@ static ir_type *lower_mtp(compound_call_lowering_flags flags, ir_type *mtp)
 	size_t    n_params;
 	size_t    nn_ress;
 	size_t    nn_params;
+	size_t    n_hidden;
 	size_t    i;
+	unsigned  j;
 	unsigned  cconv;
+	aggregate_spec_t *res_specs;
+	aggregate_spec_t *param_specs;
 	mtp_additional_properties mtp_properties;
 
 	if (!is_Method_type(mtp))
@@ -135,20 +323,31 @@ static ir_type *lower_mtp(compound_call_lowering_flags flags, ir_type *mtp)
 	if (!must_be_lowered)
 		return mtp;
 
-	results   = ALLOCANZ(ir_type*, n_ress);
-	params    = ALLOCANZ(ir_type*, n_params + n_ress);
+	res_specs   = ALLOCAN(aggregate_spec_t, n_ress);
+	param_specs = ALLOCAN(aggregate_spec_t, n_params);
+	classify_method(flags, mtp, res_specs, param_specs);
+
+	results   = ALLOCANZ(ir_type*, n_ress * MAX_AGGREGATE_PIECES);
+	params    = ALLOCANZ(ir_type*, n_params * MAX_AGGREGATE_PIECES + n_ress);
 	nn_ress   = 0;
 	nn_params = 0;
+	n_hidden  = 0;
 
 	/* add a hidden parameter in front for every compound result */
 	for (i = 0; i < n_ress; ++i) {
-		ir_type *res_tp = get_method_res_type(mtp, i);
-
-		if (needs_lowering(res_tp)) {
+		ir_type                *res_tp = get_method_res_type(mtp, i);
+		const aggregate_spec_t *spec   = &res_specs[i];
+
+		if (needs_lowering(res_tp) && spec->length > 0) {
+			/* this compound is returned in scalar values */
+			for (j = 0; j < spec->length; ++j)
+				results[nn_ress++] = new_type_primitive(spec->modes[j]);
+		} else if (needs_lowering(res_tp)) {
 			/* this compound will be allocated on callers stack and its
 			   address will be transmitted as a hidden parameter. */
 			ir_type *ptr_tp = get_pointer_type(res_tp);
 			params[nn_params++] = ptr_tp;
+			++n_hidden;
 			if (flags & LF_RETURN_HIDDEN)
 				results[nn_ress++] = ptr_tp;
 		} else {
@@ -158,15 +357,22 @@ static ir_type *lower_mtp(compound_call_lowering_flags flags, ir_type *mtp)
 	}
 	/* copy over parameter types */
 	for (i = 0; i < n_params; ++i) {
-		ir_type *param_type = get_method_param_type(mtp, i);
+		ir_type                *param_type = get_method_param_type(mtp, i);
+		const aggregate_spec_t *spec       = &param_specs[i];
+		if (spec->length > 0) {
+			/* this compound is passed in scalar values */
+			for (j = 0; j < spec->length; ++j)
+				params[nn_params++] = new_type_primitive(spec->modes[j]);
+			continue;
+		}
 		if (! (flags & LF_DONT_LOWER_ARGUMENTS) && needs_lowering(param_type)) {
 		    /* turn parameter into a pointer type */
 		    param_type = new_type_pointer(param_type);
 		}
 		params[nn_params++] = param_type;
 	}
-	assert(nn_ress <= n_ress);
-	assert(nn_params <= n_params + n_ress);
+	assert(nn_ress <= n_ress * MAX_AGGREGATE_PIECES);
+	assert(nn_params <= n_params * MAX_AGGREGATE_PIECES + n_ress);
 
 	/* create the new type */
 	lowered = new_d_type_method(nn_params, nn_ress, get_type_dbg_info(mtp));
@@ -180,7 +386,7 @@ static ir_type *lower_mtp(compound_call_lowering_flags flags, ir_type *mtp)
 	set_method_variadicity(lowered, get_method_variadicity(mtp));
 
 	cconv = get_method_calling_convention(mtp);
-	if (nn_params > n_params) {
+	if (n_hidden > 0) {
 		cconv |= cc_compound_ret;
 	}
 	set_method_calling_convention(lowered, cconv);
@@ -210,11 +416,33 @@ struct cl_entry {
 	bool      has_compound_param : 1;
 };
 
+/**
+ * A compound parameter of the current graph passed in scalar values.
+ */
+typedef struct reg_param_t {
+	ir_entity        *entity;  /**< the parameter entity */
+	size_t            first;   /**< the parameter number of the first value */
+	aggregate_spec_t  spec;    /**< the values the compound is passed in */
+	ir_node          *loads;   /**< Loads from the compound, linked by link */
+	bool              escapes; /**< set if its address is used otherwise */
+} reg_param_t;
+
+/**
+ * An address inside a compound parameter passed in scalar values.
+ */
+typedef struct param_addr_t {
+	reg_param_t *param;  /**< the parameter */
+	long         offset; /**< the offset inside the compound */
+} param_addr_t;
+
 /**
  * Walker environment for fix_args_and_collect_calls().
  */
 typedef struct wlk_env_t {
-	size_t               arg_shift;        /**< The Argument index shift for parameters. */
+	const size_t         *param_map;       /**< The new parameter numbers or NULL. */
+	reg_param_t          *reg_params;      /**< The compound parameters passed in values. */
+	size_t                n_reg_params;    /**< The number of reg_params. */
+	pmap                 *param_addrs;     /**< Maps nodes to their param_addr_t. */
 	struct obstack       obst;             /**< An obstack to allocate the data on. */
 	cl_entry             *cl_list;         /**< The call list. */
 	compound_call_lowering_flags flags;
@@ -313,6 +541,21 @@ static bool is_self_recursive_Call(const ir_node *call)
 	return false;
 }
 
+/**
+ * @return The compound parameter passed in values with the given entity or
+ *         NULL.
+ */
+static reg_param_t *get_reg_param(const wlk_env *env, const ir_entity *entity)
+{
+	size_t i;
+
+	for (i = 0; i < env->n_reg_params; ++i) {
+		if (env->reg_params[i].entity == entity)
+			return &env->reg_params[i];
+	}
+	return NULL;
+}
+
 /**
  * Post walker: shift all parameter indexes
  * and collect Calls with compound returns in the call list.
@@ -333,14 +576,14 @@ static void fix_args_and_collect_calls(ir_node *n, void *ctx)
 		}
 		break;
 	case iro_Proj:
-		if (env->arg_shift > 0) {
+		if (env->param_map != NULL) {
 			ir_node *pred = get_Proj_pred(n);
 			ir_graph *irg = get_irn_irg(n);
 
 			/* Fix the argument numbers */
 			if (pred == get_irg_args(irg)) {
 				long pnr = get_Proj_proj(n);
-				set_Proj_proj(n, pnr + env->arg_shift);
+				set_Proj_proj(n, env->param_map[pnr]);
 				env->changed = true;
 			}
 		}
@@ -408,7 +651,9 @@ static void fix_args_and_collect_calls(ir_node *n, void *ctx)
 		ir_type   *type   = get_entity_type(entity);
 
 		if (is_parameter_entity(entity) && needs_lowering(type)) {
-			if (! (env->flags & LF_DONT_LOWER_ARGUMENTS)) {
+			if (get_reg_param(env, entity) != NULL) {
+				/* handled by fix_reg_params() */
+			} else if (! (env->flags & LF_DONT_LOWER_ARGUMENTS)) {
 				/* note that num was already modified by fix_parameter_entities
 				 * so no need to add env->arg_shift again */
 				size_t num = get_entity_parameter_number(entity);
@@ -505,7 +750,8 @@ static ir_node *get_dummy_sel(ir_graph *irg, ir_node *block, ir_type *tp)
  * Add the hidden parameter from the CopyB node to the Call node.
  */
 static void add_hidden_param(ir_graph *irg, size_t n_com, ir_node **ins,
-                             cl_entry *entry, ir_type *ctp)
+                             cl_entry *entry, ir_type *ctp,
+                             const aggregate_spec_t *res_specs)
 {
 	ir_node *p, *n;
 	size_t n_args;
@@ -513,9 +759,20 @@ static void add_hidden_param(ir_graph *irg, size_t n_com, ir_node **ins,
 	n_args = 0;
 	for (p = entry->copyb; p; p = n) {
 		ir_node *src = get_CopyB_src(p);
-		size_t   idx = get_Proj_proj(src);
+		size_t   res = get_Proj_proj(src);
+		size_t   idx = 0;
+		size_t   i;
 		n = (ir_node*)get_irn_link(p);
 
+		/* results returned in values are fixed by fix_split_results() */
+		if (res_specs[res].length > 0)
+			continue;
+		for (i = 0; i < res; ++i) {
+			ir_type *rtp = get_method_res_type(ctp, i);
+			if (needs_lowering(rtp) && res_specs[i].length == 0)
+				++idx;
+		}
+
 		/* consider only the first CopyB */
 		if (ins[idx] == NULL) {
 			ir_node *block = get_nodes_block(p);
@@ -551,7 +808,7 @@ static void add_hidden_param(ir_graph *irg, size_t n_com, ir_node **ins,
 
 		for (j = i = 0; i < get_method_n_ress(ctp); ++i) {
 			ir_type *rtp = get_method_res_type(ctp, i);
-			if (needs_lowering(rtp)) {
+			if (needs_lowering(rtp) && res_specs[i].length == 0) {
 				if (ins[j] == NULL)
 					ins[j] = get_dummy_sel(irg, get_nodes_block(entry->call), rtp);
 				++j;
@@ -560,7 +817,8 @@ static void add_hidden_param(ir_graph *irg, size_t n_com, ir_node **ins,
 	}
 }
 
-static void fix_compound_ret(cl_entry *entry, ir_type *ctp)
+static void fix_compound_ret(cl_entry *entry, ir_type *ctp,
+                             const aggregate_spec_t *res_specs)
 {
 	ir_node  *call     = entry->call;
 	ir_graph *irg      = get_irn_irg(call);
@@ -573,7 +831,7 @@ static void fix_compound_ret(cl_entry *entry, ir_type *ctp)
 
 	for (i = 0; i < n_res; ++i) {
 		ir_type *type = get_method_res_type(ctp, i);
-		if (needs_lowering(type))
+		if (needs_lowering(type) && res_specs[i].length == 0)
 			++n_com;
 	}
 
@@ -581,7 +839,7 @@ static void fix_compound_ret(cl_entry *entry, ir_type *ctp)
 	new_in[pos++] = get_Call_mem(call);
 	new_in[pos++] = get_Call_ptr(call);
 	assert(pos == n_Call_max+1);
-	add_hidden_param(irg, n_com, &new_in[pos], entry, ctp);
+	add_hidden_param(irg, n_com, &new_in[pos], entry, ctp, res_specs);
 	pos += n_com;
 
 	/* copy all other parameters */
@@ -593,6 +851,123 @@ static void fix_compound_ret(cl_entry *entry, ir_type *ctp)
 	set_irn_in(call, pos, new_in);
 }
 
+/**
+ * Replaces the results of a Call returned in values. CopyBs from such a
+ * result store the values into their destination, other users get a frame
+ * entity holding the values.
+ */
+static void fix_split_results(wlk_env *env, cl_entry *entry, ir_type *ctp,
+                              const aggregate_spec_t *res_specs)
+{
+	ir_node  *call      = entry->call;
+	ir_graph *irg       = get_irn_irg(call);
+	size_t    n_ress    = get_method_n_ress(ctp);
+	size_t   *res_map   = ALLOCAN(size_t, n_ress);
+	ir_node  *t_res     = NULL;
+	ir_node **projs;
+	bool      has_split = false;
+	size_t    idx       = 0;
+	size_t    i;
+	unsigned  j;
+
+	/* calculate the new result numbers */
+	for (i = 0; i < n_ress; ++i) {
+		ir_type *type = get_method_res_type(ctp, i);
+
+		res_map[i] = idx;
+		if (res_specs[i].length > 0) {
+			idx      += res_specs[i].length;
+			has_split = true;
+		} else if (!needs_lowering(type) || (env->flags & LF_RETURN_HIDDEN)) {
+			++idx;
+		}
+	}
+	if (!has_split)
+		return;
+
+	foreach_out_edge(call, edge) {
+		ir_node *proj = get_edge_src_irn(edge);
+		if (is_Proj(proj) && get_Proj_proj(proj) == pn_Call_T_result) {
+			t_res = proj;
+			break;
+		}
+	}
+	if (t_res == NULL)
+		return;
+
+	/* renumber all results before creating new Projs, so these are not
+	 * CSEd with results using the old numbers */
+	projs = NEW_ARR_F(ir_node*, 0);
+	foreach_out_edge(t_res, edge) {
+		ir_node *proj = get_edge_src_irn(edge);
+		long     pn   = get_Proj_proj(proj);
+		if (res_specs[pn].length > 0) {
+			ARR_APP1(ir_node*, projs, proj);
+		} else {
+			set_Proj_proj(proj, res_map[pn]);
+		}
+	}
+
+	for (i = 0; i < ARR_LEN(projs); ++i) {
+		ir_node                *proj = projs[i];
+		long                    pn   = get_Proj_proj(proj);
+		ir_type                *type = get_method_res_type(ctp, pn);
+		const aggregate_spec_t *spec = &res_specs[pn];
+		ir_node                *values[MAX_AGGREGATE_PIECES];
+
+		for (j = 0; j < spec->length; ++j)
+			values[j] = new_r_Proj(t_res, spec->modes[j], res_map[pn] + j);
+
+		foreach_out_edge_safe(proj, edge) {
+			ir_node  *copyb = get_edge_src_irn(edge);
+			ir_node  *block;
+			ir_node  *mem;
+			dbg_info *dbgi;
+			if (!is_CopyB(copyb) || get_CopyB_src(copyb) != proj)
+				continue;
+
+			dbgi  = get_irn_dbg_info(copyb);
+			block = get_nodes_block(copyb);
+			mem   = get_CopyB_mem(copyb);
+			for (j = 0; j < spec->length; ++j) {
+				mem = build_piece_store(dbgi, block, mem, get_CopyB_dst(copyb),
+				                        type, spec, j, values[j], NULL);
+			}
+
+			/* get rid of the CopyB */
+			if (ir_throws_exception(copyb)) {
+				ir_node *const in[] = {
+					[pn_CopyB_M]         = mem,
+					[pn_CopyB_X_regular] = new_r_Jmp(block),
+					[pn_CopyB_X_except]  = new_r_Bad(irg, mode_X),
+				};
+				turn_into_tuple(copyb, ARRAY_SIZE(in), in);
+			} else {
+				ir_node *const in[] = { mem };
+				turn_into_tuple(copyb, ARRAY_SIZE(in), in);
+			}
+		}
+
+		if (get_irn_n_edges(proj) > 0) {
+			/* the address of the result is used otherwise, store the values
+			 * into a frame entity after the call */
+			ir_node *block       = get_nodes_block(call);
+			ir_node *sel         = get_dummy_sel(irg, block, type);
+			ir_node *call_mem    = new_r_Proj(call, mode_M, pn_Call_M);
+			ir_node *mem         = call_mem;
+			ir_node *first_store = NULL;
+
+			for (j = 0; j < spec->length; ++j) {
+				mem = build_piece_store(NULL, block, mem, sel, type, spec, j,
+				                        values[j], &first_store);
+			}
+			edges_reroute_except(call_mem, mem, first_store);
+			exchange(proj, sel);
+		}
+	}
+	DEL_ARR_F(projs);
+}
+
 static ir_entity *create_compound_arg_entity(ir_graph *irg, ir_type *type)
 {
 	ir_type   *frame  = get_irg_frame_type(irg);
@@ -604,7 +979,227 @@ static ir_entity *create_compound_arg_entity(ir_graph *irg, ir_type *type)
 	return entity;
 }
 
-static void fix_compound_params(cl_entry *entry, ir_type *ctp)
+static void add_param_addr(wlk_env *env, ir_node *node, reg_param_t *param,
+                           long offset)
+{
+	param_addr_t *addr = OALLOC(&env->obst, param_addr_t);
+	addr->param  = param;
+	addr->offset = offset;
+	pmap_insert(env->param_addrs, node, addr);
+}
+
+/**
+ * Post walker: finds the addresses inside compound parameters passed in
+ * values, i.e. Sels and constant offsets from their parameter entity.
+ */
+static void find_param_addrs(ir_node *n, void *ctx)
+{
+	wlk_env *env = (wlk_env*)ctx;
+
+	if (is_Sel(n)) {
+		ir_node      *ptr    = get_Sel_ptr(n);
+		ir_entity    *entity = get_Sel_entity(n);
+		param_addr_t *addr   = pmap_get(param_addr_t, env->param_addrs, ptr);
+		reg_param_t  *param;
+
+		if (get_Sel_n_indexs(n) != 0)
+			return;
+		if (addr != NULL) {
+			add_param_addr(env, n, addr->param,
+			               addr->offset + get_entity_offset(entity));
+		} else if (ptr == get_irg_frame(get_irn_irg(n))) {
+			param = get_reg_param(env, entity);
+			if (param != NULL)
+				add_param_addr(env, n, param, 0);
+		}
+	} else if (is_Add(n) && mode_is_reference(get_irn_mode(n))) {
+		ir_node      *left   = get_Add_left(n);
+		ir_node      *right  = get_Add_right(n);
+		ir_node      *offset = right;
+		param_addr_t *addr   = pmap_get(param_addr_t, env->param_addrs, left);
+
+		if (addr == NULL) {
+			addr   = pmap_get(param_addr_t, env->param_addrs, right);
+			offset = left;
+		}
+		if (addr != NULL && is_Const(offset)
+		    && tarval_is_long(get_Const_tarval(offset))) {
+			long value = get_tarval_long(get_Const_tarval(offset));
+			add_param_addr(env, n, addr->param, addr->offset + value);
+		}
+	}
+}
+
+/**
+ * @return The number of the value of a compound parameter which contains the
+ *         size bytes at offset or -1.
+ */
+static int find_param_piece(const reg_param_t *param, long offset,
+                            unsigned size)
+{
+	ir_type  *type = get_entity_type(param->entity);
+	unsigned  i;
+
+	if (offset < 0)
+		return -1;
+	for (i = 0; i < param->spec.length; ++i) {
+		unsigned piece_offset = get_piece_offset(&param->spec, i);
+		unsigned piece_size   = get_piece_size(&param->spec, type, i);
+		if ((unsigned long)offset >= piece_offset
+		    && offset + size <= piece_offset + piece_size)
+			return mode_is_int(param->spec.modes[i]) ? (int)i : -1;
+	}
+	return -1;
+}
+
+/**
+ * @return true if the Load from a compound parameter passed in values can
+ *         be replaced by one of the values.
+ */
+static bool is_param_load(const ir_node *load, const param_addr_t *addr)
+{
+	ir_mode *mode = get_Load_mode(load);
+
+	if (get_Load_volatility(load) == volatility_is_volatile)
+		return false;
+	if (!mode_is_int(mode) && !mode_is_reference(mode))
+		return false;
+	return find_param_piece(addr->param, addr->offset,
+	                        get_mode_size_bytes(mode)) >= 0;
+}
+
+/**
+ * Walker: collects the Loads from compound parameters passed in values and
+ * marks the parameters whose address is used otherwise.
+ */
+static void check_param_uses(ir_node *n, void *ctx)
+{
+	wlk_env *env     = (wlk_env*)ctx;
+	bool     is_addr = pmap_contains(env->param_addrs, n);
+	int      i;
+
+	for (i = 0; i < get_irn_arity(n); ++i) {
+		ir_node      *pred = get_irn_n(n, i);
+		param_addr_t *addr = pmap_get(param_addr_t, env->param_addrs, pred);
+
+		if (addr == NULL || is_addr)
+			continue;
+		if (is_Load(n) && i == n_Load_ptr && is_param_load(n, addr)) {
+			set_irn_link(n, addr->param->loads);
+			addr->param->loads = n;
+		} else {
+			addr->param->escapes = true;
+		}
+	}
+}
+
+/**
+ * Replaces the Loads from a compound parameter by the values it is passed in.
+ */
+static void replace_param_loads(ir_graph *irg, wlk_env *env,
+                                reg_param_t *param)
+{
+	ir_node *args = get_irg_args(irg);
+	ir_node *load;
+	ir_node *next;
+
+	for (load = param->loads; load != NULL; load = next) {
+		dbg_info     *dbgi   = get_irn_dbg_info(load);
+		ir_node      *block  = get_nodes_block(load);
+		ir_mode      *mode   = get_Load_mode(load);
+		param_addr_t *addr   = pmap_get(param_addr_t, env->param_addrs,
+		                                get_Load_ptr(load));
+		int           n      = find_param_piece(param, addr->offset,
+		                                        get_mode_size_bytes(mode));
+		ir_mode      *p_mode = param->spec.modes[n];
+		unsigned      shift  = addr->offset
+		                       - get_piece_offset(&param->spec, n);
+		ir_node      *value  = new_r_Proj(args, p_mode, param->first + n);
+
+		next = (ir_node*)get_irn_link(load);
+		if (shift > 0) {
+			ir_node *cnst = new_r_Const_long(irg, mode_Iu, shift * 8);
+			value = new_rd_Shr(dbgi, block, value, cnst, p_mode);
+		}
+		if (p_mode != mode)
+			value = new_rd_Conv(dbgi, block, value, mode);
+
+		if (ir_throws_exception(load)) {
+			ir_node *const in[] = {
+				[pn_Load_M]         = get_Load_mem(load),
+				[pn_Load_res]       = value,
+				[pn_Load_X_regular] = new_r_Jmp(block),
+				[pn_Load_X_except]  = new_r_Bad(irg, mode_X),
+			};
+			turn_into_tuple(load, ARRAY_SIZE(in), in);
+		} else {
+			ir_node *const in[] = {
+				[pn_Load_M]   = get_Load_mem(load),
+				[pn_Load_res] = value,
+			};
+			turn_into_tuple(load, ARRAY_SIZE(in), in);
+		}
+	}
+}
+
+/**
+ * Stores the values a compound parameter is passed in into a frame entity,
+ * which replaces the parameter entity.
+ */
+static void copy_reg_param(ir_graph *irg, reg_param_t *param)
+{
+	ir_type   *type        = get_entity_type(param->entity);
+	ir_entity *copy        = create_compound_arg_entity(irg, type);
+	ir_node   *start_block = get_irg_start_block(irg);
+	ir_node   *args        = get_irg_args(irg);
+	ir_node   *initial_mem = get_irg_initial_mem(irg);
+	ir_node   *mem         = initial_mem;
+	ir_node   *first_store = NULL;
+	ir_node   *addr        = new_r_simpleSel(start_block, get_irg_no_mem(irg),
+	                                         get_irg_frame(irg), copy);
+	cr_pair   *pairs;
+	unsigned   i;
+
+	for (i = 0; i < param->spec.length; ++i) {
+		ir_node *value = new_r_Proj(args, param->spec.modes[i],
+		                            param->first + i);
+		mem = build_piece_store(NULL, start_block, mem, addr, type,
+		                        &param->spec, i, value, &first_store);
+	}
+	edges_reroute_except(initial_mem, mem, first_store);
+	/* beware: reroute routes anchor edges also, revert this */
+	set_irg_initial_mem(irg, initial_mem);
+
+	NEW_ARR_A(cr_pair, pairs, 1);
+	pairs[0].ent = param->entity;
+	pairs[0].arg = addr;
+	irg_walk_graph(irg, NULL, do_copy_return_opt, pairs);
+}
+
+/**
+ * Replaces the uses of compound parameters passed in values.
+ */
+static void fix_reg_params(ir_graph *irg, wlk_env *env)
+{
+	size_t i;
+
+	env->param_addrs = pmap_create();
+	irg_walk_graph(irg, NULL, find_param_addrs, env);
+	irg_walk_graph(irg, NULL, check_param_uses, env);
+
+	for (i = 0; i < env->n_reg_params; ++i) {
+		reg_param_t *param = &env->reg_params[i];
+		if (param->escapes) {
+			copy_reg_param(irg, param);
+		} else {
+			replace_param_loads(irg, env, param);
+		}
+	}
+	pmap_destroy(env->param_addrs);
+}
+
+static void fix_compound_params(cl_entry *entry, ir_type *ctp,
+                                const aggregate_spec_t *param_specs)
 {
 	ir_node  *call     = entry->call;
 	dbg_info *dbgi     = get_irn_dbg_info(call);
@@ -612,44 +1207,72 @@ static void fix_compound_params(cl_entry *entry, ir_type *ctp)
 	ir_graph *irg      = get_irn_irg(call);
 	ir_node  *nomem    = new_r_NoMem(irg);
 	ir_node  *frame    = get_irg_frame(irg);
+	ir_node  *block    = get_nodes_block(call);
 	size_t    n_params = get_method_n_params(ctp);
+	size_t    pos      = 0;
+	ir_node **new_in;
 	size_t    i;
+	unsigned  j;
+
+	new_in = ALLOCAN(ir_node*, n_params * MAX_AGGREGATE_PIECES + n_Call_max+1);
+	new_in[pos++] = mem;
+	new_in[pos++] = get_Call_ptr(call);
+	assert(pos == n_Call_max+1);
 
 	for (i = 0; i < n_params; ++i) {
-		ir_type   *type = get_method_param_type(ctp, i);
-		ir_node   *block;
-		ir_node   *arg;
-		ir_node   *sel;
-		ir_node   *copyb;
-		ir_entity *arg_entity;
-		if (!needs_lowering(type))
+		ir_type                *type = get_method_param_type(ctp, i);
+		const aggregate_spec_t *spec = &param_specs[i];
+		ir_node                *arg  = get_Call_param(call, i);
+		ir_node                *sel;
+		ir_node                *copyb;
+		ir_entity              *arg_entity;
+		if (!needs_lowering(type)) {
+			new_in[pos++] = arg;
+			continue;
+		}
+
+		if (spec->length > 0) {
+			/* load the values the compound is passed in */
+			for (j = 0; j < spec->length; ++j) {
+				new_in[pos++] = build_piece_load(dbgi, block, &mem, arg, type,
+				                                 spec, j);
+			}
 			continue;
+		}
 
-		arg        = get_Call_param(call, i);
 		arg_entity = create_compound_arg_entity(irg, type);
-		block      = get_nodes_block(call);
 		sel        = new_rd_simpleSel(dbgi, block, nomem, frame, arg_entity);
 		copyb      = new_rd_CopyB(dbgi, block, mem, sel, arg, type);
 		mem        = new_r_Proj(copyb, mode_M, pn_CopyB_M);
-		set_Call_param(call, i, sel);
+		new_in[pos++] = sel;
 	}
-	set_Call_mem(call, mem);
+	new_in[0] = mem;
+	set_irn_in(call, pos, new_in);
 }
 
 static void fix_calls(wlk_env *env)
 {
 	cl_entry *entry;
 	for (entry = env->cl_list; entry; entry = entry->next) {
-		ir_node *call        = entry->call;
-		ir_type *ctp         = get_Call_type(call);
-		ir_type *lowered_mtp = lower_mtp(env->flags, ctp);
+		ir_node          *call        = entry->call;
+		ir_type          *ctp         = get_Call_type(call);
+		ir_type          *lowered_mtp = lower_mtp(env->flags, ctp);
+		size_t            n_ress      = get_method_n_ress(ctp);
+		size_t            n_params    = get_method_n_params(ctp);
+		aggregate_spec_t *res_specs   = OALLOCN(&env->obst, aggregate_spec_t,
+		                                        n_ress);
+		aggregate_spec_t *param_specs = OALLOCN(&env->obst, aggregate_spec_t,
+		                                        n_params);
+
+		classify_method(env->flags, ctp, res_specs, param_specs);
 		set_Call_type(call, lowered_mtp);
 
 		if (entry->has_compound_param) {
-			fix_compound_params(entry, ctp);
+			fix_compound_params(entry, ctp, param_specs);
 		}
 		if (entry->has_compound_ret) {
-			fix_compound_ret(entry, ctp);
+			fix_compound_ret(entry, ctp, res_specs);
+			fix_split_results(env, entry, ctp, res_specs);
 		}
 	}
 }
@@ -669,19 +1292,31 @@ static void transform_irg(compound_call_lowering_flags flags, ir_graph *irg)
 	size_t     n_ress      = get_method_n_ress(mtp);
 	size_t     n_params    = get_method_n_params(mtp);
 	size_t     n_param_com = 0;
+	size_t     n_ret_com   = 0;
+	size_t     n_ret_split = 0;
+	bool       shifted     = false;
 
 	ir_type   *lowered_mtp, *tp, *ft;
 	size_t    i, j, k;
 	size_t    n_cr_opt;
+	size_t    next;
+	size_t    *param_map;
 	ir_node   **new_in, *ret, *endbl, *bl, *mem, *copy;
 	cr_pair   *cr_opt;
+	aggregate_spec_t *res_specs;
+	aggregate_spec_t *param_specs;
 	wlk_env   env;
 
+	res_specs   = ALLOCAN(aggregate_spec_t, n_ress);
+	param_specs = ALLOCAN(aggregate_spec_t, n_params);
+	classify_method(flags, mtp, res_specs, param_specs);
+
 	/* calculate the number of compound returns */
-	size_t n_ret_com = 0;
 	for (i = 0; i < n_ress; ++i) {
 		ir_type *type = get_method_res_type(mtp, i);
-		if (needs_lowering(type))
+		if (res_specs[i].length > 0)
+			++n_ret_split;
+		else if (needs_lowering(type))
 			++n_ret_com;
 	}
 	for (i = 0; i < n_params; ++i) {
@@ -690,25 +1325,58 @@ static void transform_irg(compound_call_lowering_flags flags, ir_graph *irg)
 			++n_param_com;
 	}
 
-	if (n_ret_com > 0)
-		fix_parameter_entities(irg, n_ret_com);
+	/* hidden arguments are added first, compounds passed in values take
+	 * several parameters */
+	param_map = ALLOCAN(size_t, n_params);
+	next      = n_ret_com;
+	for (i = 0; i < n_params; ++i) {
+		param_map[i] = next;
+		shifted     |= next != i;
+		next        += param_specs[i].length > 0 ? param_specs[i].length : 1;
+	}
+
+	obstack_init(&env.obst);
+	env.param_map    = shifted ? param_map : NULL;
+	env.reg_params   = OALLOCN(&env.obst, reg_param_t, n_params);
+	env.n_reg_params = 0;
+	env.param_addrs  = NULL;
+
+	/* collect the compound parameters passed in values */
+	ft = get_irg_frame_type(irg);
+	for (i = 0; i < get_compound_n_members(ft); ++i) {
+		ir_entity   *member = get_compound_member(ft, i);
+		reg_param_t *param;
+		size_t       num;
+		if (!is_parameter_entity(member))
+			continue;
+		num = get_entity_parameter_number(member);
+		if (num == IR_VA_START_PARAMETER_NUMBER
+		    || param_specs[num].length == 0)
+			continue;
+
+		param          = &env.reg_params[env.n_reg_params++];
+		param->entity  = member;
+		param->first   = param_map[num];
+		param->spec    = param_specs[num];
+		param->loads   = NULL;
+		param->escapes = false;
+	}
+
+	if (shifted)
+		fix_parameter_entities(irg, param_map);
 
-	if (n_ret_com) {
+	if (n_ret_com > 0 || n_ret_split > 0) {
 		/* much easier if we have only one return */
 		normalize_one_return(irg);
-
-		/* hidden arguments are added first */
-		env.arg_shift = n_ret_com;
-	} else {
-		/* we must only search for calls */
-		env.arg_shift = 0;
-		lowered_mtp   = NULL;
 	}
 
 	lowered_mtp = lower_mtp(flags, mtp);
 	set_entity_type(ent, lowered_mtp);
 
-	obstack_init(&env.obst);
+	/* the ABI lowering reroutes memory and replaces results */
+	if (abi != NULL)
+		assure_edges(irg);
+
 	env.cl_list        = NULL;
 	env.flags          = flags;
 	env.lowered_mtp    = lowered_mtp;
@@ -719,6 +1387,11 @@ static void transform_irg(compound_call_lowering_flags flags, ir_graph *irg)
 	irg_walk_graph(irg, firm_clear_link, NULL, &env);
 	irg_walk_graph(irg, fix_args_and_collect_calls, NULL, &env);
 
+	if (env.n_reg_params > 0) {
+		fix_reg_params(irg, &env);
+		env.changed = true;
+	}
+
 	if (n_param_com > 0 && !(flags & LF_DONT_LOWER_ARGUMENTS))
 		remove_compound_param_entities(irg);
 
@@ -728,7 +1401,7 @@ static void transform_irg(compound_call_lowering_flags flags, ir_graph *irg)
 		env.changed = true;
 	}
 
-	if (n_ret_com) {
+	if (n_ret_com > 0 || n_ret_split > 0) {
 		int idx;
 
 		/* STEP 1: find the return. This is simple, we have normalized the graph. */
@@ -754,7 +1427,7 @@ static void transform_irg(compound_call_lowering_flags flags, ir_graph *irg)
 			 * STEP 2: fix it. For all compound return values add a CopyB,
 			 * all others are copied.
 			 */
-			NEW_ARR_A(ir_node *, new_in, n_ress + 1);
+			NEW_ARR_A(ir_node *, new_in, n_ress * MAX_AGGREGATE_PIECES + 1);
 
 			bl  = get_nodes_block(ret);
 			mem = get_Return_mem(ret);
@@ -766,7 +1439,19 @@ static void transform_irg(compound_call_lowering_flags flags, ir_graph *irg)
 				ir_node *pred = get_Return_res(ret, i);
 				tp = get_method_res_type(mtp, i);
 
-				if (needs_lowering(tp)) {
+				if (res_specs[i].length > 0) {
+					/* load the values the compound is returned in */
+					const aggregate_spec_t *spec = &res_specs[i];
+					unsigned                p;
+					for (p = 0; p < spec->length; ++p) {
+						if (is_Unknown(pred)) {
+							new_in[j++] = new_r_Unknown(irg, spec->modes[p]);
+						} else {
+							new_in[j++] = build_piece_load(NULL, bl, &mem, pred,
+							                               tp, spec, p);
+						}
+					}
+				} else if (needs_lowering(tp)) {
 					ir_node *arg = get_irg_args(irg);
 					arg = new_r_Proj(arg, mode_P_data, k);
 					++k;
@@ -824,6 +1509,10 @@ static void transform_irg(compound_call_lowering_flags flags, ir_graph *irg)
 		}
 	}
 
+	/* dead Sels may still reference the freed parameter entities */
+	if (abi != NULL)
+		edges_deactivate(irg);
+
 	obstack_free(&env.obst, NULL);
 }
 
@@ -851,9 +1540,16 @@ static void lower_method_types(type_or_ent tore, void *env)
 }
 
 void lower_calls_with_compounds(compound_call_lowering_flags flags)
+{
+	lower_calls_with_compounds_abi(flags, NULL);
+}
+
+void lower_calls_with_compounds_abi(compound_call_lowering_flags flags,
+                                    const lower_call_abi_t *call_abi)
 {
 	size_t i, n;
 
+	abi           = call_abi;
 	pointer_types = pmap_create();
 	lowered_mtps = pmap_create();
 
@@ -868,4 +1564,5 @@ void lower_calls_with_compounds(compound_call_lowering_flags flags)
 
 	pmap_destroy(lowered_mtps);
 	pmap_destroy(pointer_types);
+	abi = NULL;
 }
@@ -24,6 +24,43 @@ typedef enum compound_call_lowering_flags {
 } compound_call_lowering_flags;
 ENUM_BITSET(compound_call_lowering_flags)
 
+/** Maximum number of scalar values a compound is passed in. */
+#define MAX_AGGREGATE_PIECES 2
+
+/**
+ * Describes how a compound parameter or result is passed: In length scalar
+ * values of the given modes or in memory if length is 0.
+ *
+ * The first value holds the lowest bytes of the compound, each value holds
+ * as many bytes as its mode has (the last one possibly fewer).
+ */
+typedef struct aggregate_spec_t {
+	unsigned  length;                       /**< number of values */
+	ir_mode  *modes[MAX_AGGREGATE_PIECES];  /**< the modes of the values */
+} aggregate_spec_t;
+
+/**
+ * Classifies a parameter or result type of a method type.
+ */
+typedef aggregate_spec_t (*lower_call_func)(void *env, ir_type *type);
+
+/**
+ * Callbacks describing the ABI of the target for compound parameters and
+ * results.
+ *
+ * For every lowered method type reset_state is called first. Then
+ * lower_return is called for each compound result and lower_parameter for
+ * each parameter in order, including the hidden parameters of compound
+ * results passed in memory, so the ABI can count the used registers. The
+ * results of lower_parameter for non-compound types are ignored.
+ */
+typedef struct lower_call_abi_t {
+	lower_call_func  lower_parameter;         /**< classifies parameters */
+	lower_call_func  lower_return;            /**< classifies compound results */
+	void           (*reset_state)(void *env); /**< called for each method type */
+	void            *env;                     /**< passed to the callbacks */
+} lower_call_abi_t;
+
 /**
  * Lower calls with compound parameter and return types.
  * This function does the following transformations:
@@ -85,4 +122,19 @@ ENUM_BITSET(compound_call_lowering_flags)
  */
 void lower_calls_with_compounds(compound_call_lowering_flags flags);
 
+/**
+ * Lower calls with compound parameter and return types like
+ * lower_calls_with_compounds(), but passes the compounds which the abi
+ * classifies as scalar values in these values.
+ *
+ * Compound results are loaded from their address in front of the Return,
+ * the callers store them into the destination of the CopyB that copies the
+ * result. Compound parameters are loaded from the argument address by the
+ * caller. The callee replaces Loads from the parameter by the passed values
+ * and only stores the values into a frame entity if the address of the
+ * parameter is used otherwise.
+ */
+void lower_calls_with_compounds_abi(compound_call_lowering_flags flags,
+                                    const lower_call_abi_t *abi);
+
 #endif
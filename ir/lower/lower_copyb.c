@@ -5,7 +5,7 @@
 
 /**
  * @file
- * @brief   Lower small CopyB nodes into a series of Load/Store nodes
+ * @brief   Lower CopyB nodes into Load/Store nodes, copy loops or calls
  * @author  Michael Beck, Matthias Braun, Manuel Mohr
  */
 #include "adt/list.h"
@@ -16,6 +16,7 @@
 #include "irnode_t.h"
 #include "type_t.h"
 #include "irgmod.h"
+#include "iredges_t.h"
 #include "error.h"
 #include "be.h"
 #include "util.h"
@@ -27,50 +28,32 @@ struct entry {
 };
 
 /**
- * Every CopyB is assigned a size category as follows:
- *  - 'small'  iff                  size <= max_small_size,
- *  - 'medium' iff max_small_size < size <  min_large_size,
- *  - 'large'  iff                  size >= min_large_size.
+ * Every CopyB is lowered with the strategy of the first rule of the backend
+ * which matches its size and alignment:
+ *  - 'keep':  Nothing, the backend handles it itself.
+ *  - 'moves': Replace it with a series of Loads/Stores.
+ *  - 'loop':  Replace it with a loop of Loads/Stores of machine words
+ *             followed by a series of Loads/Stores for the remaining bytes.
+ *  - 'call':  Replace it with a call to memcpy.
+ * CopyBs matching no rule are large enough that a call to memcpy is worth the
+ * call overhead.
  *
- * The idea is that each backend can apply different optimizations in each
- * of the three categories.
+ * For example the x86 backend could keep medium-sized CopyBs to generate a
+ * rep-prefixed mov instruction, while backends without such an instruction
+ * use a copy loop for them.
  *
- * For small CopyBs, the x86 backend could, e.g., emit a single SSE
- * instruction to copy 16 bytes.  Other backends might just go with a series
- * of Load/Stores.  Therefore, x86 would like to keep the small CopyB nodes
- * around whereas other backends would not.
- * For medium-sized CopyBs, the x86 backend might generate a rep-prefixed mov
- * instruction.  Hence, it also wants to keep the CopyBs in these cases.  Other
- * backends might handle this differently.
- * For large CopyBs, a call to memcpy is worth the call overhead, so large
- * CopyBs should always be lowered to memcpy calls.
- *
- * The lowerer performs the following actions if the CopyB is
- * - 'small':  Replace it with a series of Loads/Stores
- * - 'medium': Nothing.
- * - 'large':  Replace it with a call to memcpy.
- *
- * max_small_size and min_large_size allow for a flexible configuration.
- * For example, one backend could specify max_small_size == 0 and
- * min_large_size == 8192 to keep all CopyB nodes smaller than 8192 and get
- * memcpy Calls for all others.  Here, the set of small CopyBs is empty.
- * Another backend could specify max_small_size == 63 and min_large_size == 64
- * to lower all small CopyBs to Loads/Stores and all big CopyBs to memcpy.
- * Hence, the set of medium-sized CopyBs is empty and this backend never
- * sees a CopyB node at all.
+ * lower_CopyB() describes the traditional three size categories with rules:
+ *  - 'small'  iff                  size <= max_small_size: 'moves',
+ *  - 'medium' iff max_small_size < size <  min_large_size: 'keep',
+ *  - 'large'  iff                  size >= min_large_size: 'call'.
  * If memcpy is not available, min_large_size can be set to UINT_MAX to prevent
  * the creation of calls to memcpy.  Note that CopyBs whose size is UINT_MAX
  * will still be lowered to memcpy calls because we check if the size is greater
  * *or equal* to min_large_size.  However, this should never occur in practice.
  */
 
-static unsigned max_small_size; /**< The maximum size of a CopyB node
-                                     so that it is regarded as 'small'. */
-static unsigned min_large_size; /**< The minimum size of a CopyB node
-                                     so that it is regarded as 'large'. */
+static const ir_copyb_params *params; /**< The rules of the backend. */
 static unsigned native_mode_bytes; /**< The size of the native mode in bytes. */
-static int allow_misalignments; /**< Whether backend can handle misaligned
-                                     loads and stores. */
 
 typedef struct walk_env {
 	struct obstack   obst;           /**< the obstack where data is allocated
@@ -92,52 +75,102 @@ static ir_mode *get_ir_mode(unsigned mode_bytes)
 }
 
 /**
- * Turn a small CopyB node into a series of Load/Store nodes.
+ * Returns the mode used to move mode_bytes bytes.
  */
-static void lower_small_copyb_node(ir_node *irn)
+static ir_mode *get_move_mode(unsigned mode_bytes)
+{
+	ir_mode *wide_mode = params->wide_mode;
+	if (wide_mode != NULL && get_mode_size_bytes(wide_mode) == mode_bytes)
+		return wide_mode;
+	return get_ir_mode(mode_bytes);
+}
+
+/**
+ * Returns the number of bytes of the widest move for copying size bytes of
+ * a type with the given alignment.
+ */
+static unsigned get_move_bytes(unsigned size, unsigned align)
+{
+	unsigned  mode_bytes = native_mode_bytes;
+	ir_mode  *wide_mode  = params->wide_mode;
+	if (wide_mode != NULL && size >= get_mode_size_bytes(wide_mode))
+		mode_bytes = get_mode_size_bytes(wide_mode);
+	if (!params->allow_misalignments) {
+		while (mode_bytes > align)
+			mode_bytes /= 2;
+	}
+	return mode_bytes;
+}
+
+/**
+ * Copies one value of the given mode from src + offset to dst + offset and
+ * returns the new memory.
+ */
+static ir_node *build_move(ir_node *block, ir_node *mem, ir_node *addr_src,
+                           ir_node *addr_dst, ir_node *offset, ir_mode *mode)
+{
+	ir_mode *addr_mode = get_irn_mode(addr_src);
+	ir_node *add;
+	ir_node *load;
+	ir_node *load_res;
+	ir_node *load_mem;
+	ir_node *store;
+
+	add      = new_r_Add(block, addr_src, offset, addr_mode);
+	load     = new_r_Load(block, mem, add, mode, cons_none);
+	load_res = new_r_Proj(load, mode, pn_Load_res);
+	load_mem = new_r_Proj(load, mode_M, pn_Load_M);
+
+	add   = new_r_Add(block, addr_dst, offset, addr_mode);
+	store = new_r_Store(block, load_mem, add, load_res, cons_none);
+	return new_r_Proj(store, mode_M, pn_Store_M);
+}
+
+/**
+ * Copies the bytes from offset up to size with a series of Load/Store nodes
+ * and returns the new memory.
+ */
+static ir_node *build_moves(ir_node *block, ir_node *mem, ir_node *addr_src,
+                            ir_node *addr_dst, unsigned offset, unsigned size,
+                            unsigned align)
 {
-	ir_graph *irg        = get_irn_irg(irn);
-	ir_node  *block      = get_nodes_block(irn);
-	ir_type  *tp         = get_CopyB_type(irn);
-	ir_node  *addr_src   = get_CopyB_src(irn);
-	ir_node  *addr_dst   = get_CopyB_dst(irn);
-	ir_node  *mem        = get_CopyB_mem(irn);
-	ir_mode  *addr_mode  = get_irn_mode(addr_src);
-	unsigned  mode_bytes = allow_misalignments ? native_mode_bytes : tp->align;
-	unsigned  size       = get_type_size_bytes(tp);
-	unsigned  offset     = 0;
-	ir_mode  *mode;
+	ir_graph *irg        = get_irn_irg(block);
+	unsigned  mode_bytes = get_move_bytes(size - offset, align);
 
 	while (offset < size) {
-		mode = get_ir_mode(mode_bytes);
-		for (; offset + mode_bytes <= size; offset += mode_bytes) {
-			/* construct offset */
-			ir_node *addr_const;
-			ir_node *add;
-			ir_node *load;
-			ir_node *load_res;
-			ir_node *load_mem;
-			ir_node *store;
-			ir_node *store_mem;
-
-			addr_const = new_r_Const_long(irg, mode_Iu, offset);
-			add        = new_r_Add(block, addr_src, addr_const, addr_mode);
-
-			load     = new_r_Load(block, mem, add, mode, cons_none);
-			load_res = new_r_Proj(load, mode, pn_Load_res);
-			load_mem = new_r_Proj(load, mode_M, pn_Load_M);
-
-			addr_const = new_r_Const_long(irg, mode_Iu, offset);
-			add        = new_r_Add(block, addr_dst, addr_const, addr_mode);
-
-			store     = new_r_Store(block, load_mem, add, load_res, cons_none);
-			store_mem = new_r_Proj(store, mode_M, pn_Store_M);
-
-			mem = store_mem;
+		if (offset + mode_bytes > size) {
+			if (params->allow_misalignments && size >= mode_bytes) {
+				/* move the last bytes together with some copied ones
+				 * instead of using several narrower moves */
+				offset = size - mode_bytes;
+			} else {
+				mode_bytes /= 2;
+				continue;
+			}
 		}
 
-		mode_bytes /= 2;
+		ir_mode *mode       = get_move_mode(mode_bytes);
+		ir_node *addr_const = new_r_Const_long(irg, mode_Iu, offset);
+		mem     = build_move(block, mem, addr_src, addr_dst, addr_const, mode);
+		offset += mode_bytes;
 	}
+	return mem;
+}
+
+/**
+ * Turn a small CopyB node into a series of Load/Store nodes.
+ */
+static void lower_small_copyb_node(ir_node *irn)
+{
+	ir_graph *irg      = get_irn_irg(irn);
+	ir_node  *block    = get_nodes_block(irn);
+	ir_type  *tp       = get_CopyB_type(irn);
+	ir_node  *addr_src = get_CopyB_src(irn);
+	ir_node  *addr_dst = get_CopyB_dst(irn);
+	ir_node  *mem      = get_CopyB_mem(irn);
+	unsigned  size     = get_type_size_bytes(tp);
+
+	mem = build_moves(block, mem, addr_src, addr_dst, 0, size, tp->align);
 
 	ir_node *const bad = new_r_Bad(irg, mode_X);
 	ir_node *const in[] = {
@@ -148,6 +181,70 @@ static void lower_small_copyb_node(ir_node *irn)
 	turn_into_tuple(irn, ARRAY_SIZE(in), in);
 }
 
+/**
+ * Turn a CopyB node into a loop copying words, followed by a series of
+ * Load/Store nodes for the remaining bytes.
+ */
+static void lower_loop_copyb_node(ir_node *irn)
+{
+	ir_graph *irg         = get_irn_irg(irn);
+	ir_type  *tp          = get_CopyB_type(irn);
+	ir_node  *addr_src    = get_CopyB_src(irn);
+	ir_node  *addr_dst    = get_CopyB_dst(irn);
+	ir_node  *mem         = get_CopyB_mem(irn);
+	ir_mode  *offset_mode = get_reference_mode_unsigned_eq(get_irn_mode(addr_src));
+	unsigned  size        = get_type_size_bytes(tp);
+	unsigned  mode_bytes  = get_move_bytes(size, tp->align);
+	ir_mode  *mode        = get_move_mode(mode_bytes);
+	unsigned  loop_bytes  = size - size % mode_bytes;
+
+	if (loop_bytes == 0) {
+		lower_small_copyb_node(irn);
+		return;
+	}
+
+	/* the loop block is entered from the upper half of the old block and
+	 * left to the lower half */
+	ir_node *lower_block = part_block_edges(irn);
+	ir_node *upper_block = get_nodes_block(irn);
+	ir_node *entry       = new_r_Jmp(upper_block);
+	ir_node *loop_in[]   = { entry, new_r_Dummy(irg, mode_X) };
+	ir_node *loop_block  = new_r_Block(irg, ARRAY_SIZE(loop_in), loop_in);
+
+	ir_node *zero        = new_r_Const(irg, get_mode_null(offset_mode));
+	ir_node *offset_in[] = { zero, new_r_Dummy(irg, offset_mode) };
+	ir_node *offset      = new_r_Phi(loop_block, ARRAY_SIZE(offset_in),
+	                                 offset_in, offset_mode);
+	ir_node *mem_in[]    = { mem, new_r_Dummy(irg, mode_M) };
+	ir_node *loop_mem    = new_r_Phi(loop_block, ARRAY_SIZE(mem_in), mem_in,
+	                                 mode_M);
+
+	ir_node *new_mem   = build_move(loop_block, loop_mem, addr_src, addr_dst,
+	                                offset, mode);
+	ir_node *step      = new_r_Const_long(irg, offset_mode, mode_bytes);
+	ir_node *next      = new_r_Add(loop_block, offset, step, offset_mode);
+	ir_node *limit     = new_r_Const_long(irg, offset_mode, loop_bytes);
+	ir_node *cmp       = new_r_Cmp(loop_block, next, limit, ir_relation_less);
+	ir_node *cond      = new_r_Cond(loop_block, cmp);
+	ir_node *proj_loop = new_r_Proj(cond, mode_X, pn_Cond_true);
+	ir_node *proj_exit = new_r_Proj(cond, mode_X, pn_Cond_false);
+
+	set_Block_cfgpred(loop_block, 1, proj_loop);
+	set_Phi_pred(offset, 1, next);
+	set_Phi_pred(loop_mem, 1, new_mem);
+
+	set_irn_in(lower_block, 1, &proj_exit);
+	mem = build_moves(lower_block, new_mem, addr_src, addr_dst, loop_bytes,
+	                  size, tp->align);
+
+	foreach_out_edge_safe(irn, edge) {
+		ir_node *proj = get_edge_src_irn(edge);
+		assert(get_Proj_proj(proj) == pn_CopyB_M);
+		exchange(proj, mem);
+	}
+	kill_node(irn);
+}
+
 static ir_type *get_memcpy_methodtype(void)
 {
 	ir_type *tp          = new_type_method(3, 1);
@@ -203,17 +300,33 @@ static void lower_large_copyb_node(ir_node *irn)
 	turn_into_tuple(irn, ARRAY_SIZE(tuple_in), tuple_in);
 }
 
+/**
+ * Returns the strategy of the first rule matching a CopyB of the given type.
+ */
+static ir_copyb_strategy get_strategy(const ir_type *tp)
+{
+	unsigned size  = get_type_size_bytes(tp);
+	unsigned align = tp->align;
+
+	for (size_t i = 0; i < params->n_rules; ++i) {
+		const ir_copyb_rule *rule = &params->rules[i];
+		if (size <= rule->max_size && align >= rule->min_align)
+			return rule->strategy;
+	}
+	return ir_copyb_call;
+}
+
 static void lower_copyb_node(ir_node *irn)
 {
-	ir_type *tp   = get_CopyB_type(irn);
-	unsigned size = get_type_size_bytes(tp);
+	ir_type *tp = get_CopyB_type(irn);
 
-	if (size <= max_small_size)
-		lower_small_copyb_node(irn);
-	else if (size >= min_large_size)
-		lower_large_copyb_node(irn);
-	else
-		assert(!"CopyB of invalid size handed to lower_copyb_node");
+	switch (get_strategy(tp)) {
+	case ir_copyb_moves: lower_small_copyb_node(irn); return;
+	case ir_copyb_loop:  lower_loop_copyb_node(irn);  return;
+	case ir_copyb_call:  lower_large_copyb_node(irn); return;
+	case ir_copyb_keep:  break;
+	}
+	panic("CopyB of invalid size handed to lower_copyb_node");
 }
 
 /**
@@ -223,9 +336,7 @@ static void find_copyb_nodes(ir_node *irn, void *ctx)
 {
 	walk_env_t *env = (walk_env_t*)ctx;
 	ir_type    *tp;
-	unsigned   size;
 	entry_t    *entry;
-	bool        medium_sized;
 
 	if (is_Proj(irn)) {
 		ir_node *pred = get_Proj_pred(irn);
@@ -233,7 +344,8 @@ static void find_copyb_nodes(ir_node *irn, void *ctx)
 		if (is_CopyB(pred) && get_Proj_proj(irn) != pn_CopyB_M) {
 			/* found an exception Proj: remove it from the list again */
 			entry = (entry_t*)get_irn_link(pred);
-			list_del(&entry->list);
+			if (entry != NULL)
+				list_del_init(&entry->list);
 		}
 		return;
 	}
@@ -241,16 +353,15 @@ static void find_copyb_nodes(ir_node *irn, void *ctx)
 	if (! is_CopyB(irn))
 		return;
 
+	set_irn_link(irn, NULL);
 	tp = get_CopyB_type(irn);
 	if (get_type_state(tp) != layout_fixed)
 		return;
 
-	size         = get_type_size_bytes(tp);
-	medium_sized = max_small_size < size && size < min_large_size;
-	if (medium_sized)
-		return; /* Nothing to do for medium-sized CopyBs. */
+	if (get_strategy(tp) == ir_copyb_keep)
+		return; /* Nothing to do, the backend handles this CopyB. */
 
-	/* Okay, either small or large CopyB, so link it in and lower it later. */
+	/* Okay, link it in and lower it later. */
 	entry = OALLOC(&env->obst, entry_t);
 	entry->copyb = irn;
 	INIT_LIST_HEAD(&entry->list);
@@ -258,26 +369,50 @@ static void find_copyb_nodes(ir_node *irn, void *ctx)
 	list_add_tail(&entry->list, &env->list);
 }
 
-void lower_CopyB(ir_graph *irg, unsigned max_small_sz, unsigned min_large_sz,
-                 int allow_misaligns)
+void lower_CopyB_rules(ir_graph *irg, const ir_copyb_params *copyb_params)
 {
 	const backend_params *bparams = be_get_backend_param();
 	walk_env_t            env;
+	bool                  changed_cf = false;
 
-	assert(max_small_sz < min_large_sz && "CopyB size ranges must not overlap");
-
-	max_small_size      = max_small_sz;
-	min_large_size      = min_large_sz;
-	native_mode_bytes   = bparams->machine_size / 8;
-	allow_misalignments = allow_misaligns;
+	params            = copyb_params;
+	native_mode_bytes = bparams->machine_size / 8;
 
 	obstack_init(&env.obst);
 	INIT_LIST_HEAD(&env.list);
 	irg_walk_graph(irg, NULL, find_copyb_nodes, &env);
 
+	list_for_each_entry(entry_t, entry, &env.list, list) {
+		if (get_strategy(get_CopyB_type(entry->copyb)) == ir_copyb_loop) {
+			assure_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES);
+			changed_cf = true;
+			break;
+		}
+	}
+
 	list_for_each_entry(entry_t, entry, &env.list, list) {
 		lower_copyb_node(entry->copyb);
 	}
 
+	if (changed_cf) {
+		clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE
+		                   | IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO);
+	}
+
 	obstack_free(&env.obst, NULL);
 }
+
+void lower_CopyB(ir_graph *irg, unsigned max_small_sz, unsigned min_large_sz,
+                 int allow_misaligns)
+{
+	assert(max_small_sz < min_large_sz && "CopyB size ranges must not overlap");
+
+	const ir_copyb_rule rules[] = {
+		{ max_small_sz,     1, ir_copyb_moves },
+		{ min_large_sz - 1, 1, ir_copyb_keep  },
+	};
+	const ir_copyb_params copyb_params = {
+		rules, ARRAY_SIZE(rules), NULL, allow_misaligns
+	};
+	lower_CopyB_rules(irg, &copyb_params);
+}
@@ -10,6 +10,7 @@
  */
 #include <stdbool.h>
 
+#include "array_t.h"
 #include "be.h"
 #include "dbginfo_t.h"
 #include "debug.h"
@@ -17,7 +18,6 @@
 #include "ircons.h"
 #include "iredges.h"
 #include "irgmod.h"
-#include "irnodeset.h"
 #include "irgwalk.h"
 #include "irmode.h"
 #include "iropt_dbg.h"
@@ -62,7 +62,20 @@ static ir_type *unop_tp_lu_f;
 /** A map from a method type to its lowered type. */
 static pmap *lowered_type;
 
-static ir_nodeset_t created_mux_nodes;
+/**
+ * A floating point operation which is lowered to integer operations after
+ * all modes are lowered.
+ */
+typedef struct fast_path_t {
+	ir_node *node;     /**< the Minus, Cmp or Conv node */
+	ir_mode *op_mode;  /**< the original mode of the operand */
+	ir_mode *mode;     /**< the original mode of the result */
+	ir_node *symconst; /**< the function handling special cases or NULL */
+	ir_type *type;     /**< the type of the function */
+} fast_path_t;
+
+/** The operations lowered to integer operations. */
+static fast_path_t *fast_paths;
 
 /**
  * @return The lowered (floating point) mode.
@@ -453,124 +466,36 @@ static void lower_Call(ir_node *node)
 }
 
 /**
- * Transforms a Cmp into the appropriate soft float function.
+ * Postpones a floating point operation which is lowered to integer
+ * operations.
+ */
+static void add_fast_path(ir_node *n, ir_mode *op_mode, ir_mode *mode,
+                          const char *name)
+{
+	fast_path_t fp;
+	fp.node     = n;
+	fp.op_mode  = op_mode;
+	fp.mode     = mode;
+	fp.symconst = NULL;
+	fp.type     = NULL;
+	if (name != NULL) {
+		fp.symconst = create_softfloat_symconst(n, name);
+		fp.type     = get_softfloat_type(n);
+	}
+	ARR_APP1(fast_path_t, fast_paths, fp);
+}
+
+/**
+ * Postpones a floating point Cmp, it is lowered to integer comparisons.
  */
 static void lower_Cmp(ir_node *n)
 {
-	ir_node         *symconst    = NULL;
-	ir_node         *block       = get_nodes_block(n);
-	ir_node         *call_result = NULL;
-	dbg_info        *dbgi        = get_irn_dbg_info(n);
-	ir_graph        *irg         = get_irn_irg(n);
-	ir_node         *left        = get_Cmp_left(n);
-	ir_relation      relation    = get_Cmp_relation(n);
-	ir_mode         *op_mode     = get_irn_mode(left);
-	ir_node         *right       = get_Cmp_right(n);
-	ir_node         *symconst2   = NULL;
-	ir_node         *zero        = new_rd_Const(dbgi, irg, get_mode_null(mode_Is));
+	ir_mode *op_mode = get_irn_mode(get_Cmp_left(n));
 
 	if (! mode_is_float(op_mode))
 		return;
 
-	switch (relation) {
-	case ir_relation_false:
-		call_result = zero;
-		break;
-	case ir_relation_equal:
-		symconst = create_softfloat_symconst(n, "eq");
-		break;
-	case ir_relation_less:
-		symconst = create_softfloat_symconst(n, "lt");
-		break;
-	case ir_relation_greater:
-		symconst = create_softfloat_symconst(n, "gt");
-		break;
-	case ir_relation_unordered:
-		symconst = create_softfloat_symconst(n, "unord");
-		relation = ir_relation_less_greater;
-		break;
-	case ir_relation_less_equal:
-		symconst = create_softfloat_symconst(n, "le");
-		break;
-	case ir_relation_greater_equal:
-		symconst = create_softfloat_symconst(n, "ge");
-		break;
-	case ir_relation_less_greater:
-		symconst  = create_softfloat_symconst(n, "unord");
-		symconst2 = create_softfloat_symconst(n, "ne");
-		break;
-	case ir_relation_less_equal_greater:
-		symconst = create_softfloat_symconst(n, "unord");
-		relation = ir_relation_equal;
-		break;
-	case ir_relation_unordered_equal:
-		symconst  = create_softfloat_symconst(n, "unord");
-		relation  = ir_relation_less_greater;
-		symconst2 = create_softfloat_symconst(n, "ne");
-		break;
-	case ir_relation_unordered_less:
-		symconst = create_softfloat_symconst(n, "ge");
-		relation = ir_relation_less;
-		break;
-	case ir_relation_unordered_less_equal:
-		symconst = create_softfloat_symconst(n, "gt");
-		relation = ir_relation_less_equal;
-		break;
-	case ir_relation_unordered_greater:
-		symconst = create_softfloat_symconst(n, "le");
-		relation = ir_relation_greater;
-		break;
-	case ir_relation_unordered_greater_equal:
-		symconst = create_softfloat_symconst(n, "lt");
-		relation = ir_relation_greater_equal;
-		break;
-	case ir_relation_unordered_less_greater:
-		symconst = create_softfloat_symconst(n, "eq");
-		relation = ir_relation_less_greater;
-		break;
-	case ir_relation_true:
-		call_result = zero;
-		break;
-	}
-
-	if (call_result == NULL) {
-		ir_node *call;
-		ir_node *call_results;
-		ir_node *in[2] = {left, right};
-		ir_node *nomem = get_irg_no_mem(irg);
-		ir_type *type  = get_softfloat_type(n);
-
-		call         = new_rd_Call(dbgi, block, nomem, symconst, 2, in, type);
-		call_results = new_r_Proj(call, mode_T, pn_Call_T_result);
-		call_result  = new_r_Proj(call_results, mode_Is, 0);
-	}
-
-	ir_node *cmp = new_r_Cmp(block, call_result, zero, relation);
-
-	/* We need two calls into the softfloat library */
-	if (symconst2 != NULL) {
-		ir_node *call;
-		ir_node *call_results;
-		ir_node *mux;
-		arch_allow_ifconv_func allow_ifconv = be_get_backend_param()->allow_ifconv;
-		ir_node *in[2]                      = {left, right};
-		ir_node *nomem                      = get_irg_no_mem(irg);
-		ir_type *type                       = get_softfloat_type(n);
-
-		call         = new_rd_Call(dbgi, block, nomem, symconst2, 2, in, type);
-		call_results = new_r_Proj(call, mode_T, pn_Call_T_result);
-		call_result  = new_r_Proj(call_results, mode_Is, 0);
-		relation     = get_Cmp_relation(n);
-
-		mux = new_rd_Mux(dbgi, block, cmp, call_result, zero, mode_Is);
-
-		if (! allow_ifconv(cmp, call_result, zero))
-			ir_nodeset_insert(&created_mux_nodes, mux);
-
-		cmp = new_r_Cmp(block, mux, zero, relation);
-	}
-
-	exchange(n, cmp);
+	add_fast_path(n, op_mode, mode_b, NULL);
 }
 
 static const tarval_mode_info hex_output = {
@@ -632,16 +557,22 @@ static void lower_Conv(ir_node *n)
 	}
 
 	if (mode_is_float(op_mode) && mode_is_float(mode)) {
+		/* normal values are converted inline */
 		if (get_mode_size_bits(op_mode) > get_mode_size_bits(mode))
-			symconst = create_softfloat_symconst(n, "trunc");
+			add_fast_path(n, op_mode, mode, "trunc");
 		else
-			symconst = create_softfloat_symconst(n, "extend");
+			add_fast_path(n, op_mode, mode, "extend");
+		return;
 	}
 	else if (mode_is_float(op_mode)) {
-		if (mode_is_signed(mode))
-			symconst = create_softfloat_symconst(n, "fix");
-		else
-			symconst = create_softfloat_symconst(n, "fixuns");
+		const char *name = mode_is_signed(mode) ? "fix" : "fixuns";
+
+		/* values fitting into 32 bits are converted inline */
+		if (get_mode_size_bits(mode) <= 32) {
+			add_fast_path(n, op_mode, mode, name);
+			return;
+		}
+		symconst = create_softfloat_symconst(n, name);
 	}
 	else {
 		if (mode_is_signed(op_mode))
@@ -757,35 +688,16 @@ static void lower_Load(ir_node *n)
 }
 
 /**
- * Transforms a Minus into the appropriate soft float function.
+ * Postpones a floating point Minus, it is lowered to a sign bit flip.
  */
 static void lower_Minus(ir_node *n)
 {
-	ir_node         *symconst;
-	ir_node         *block       = get_nodes_block(n);
-	ir_node         *call_result = NULL;
-	dbg_info        *dbgi        = get_irn_dbg_info(n);
-	ir_graph        *irg         = get_irn_irg(n);
-	ir_mode         *mode        = get_irn_mode(n);
-	ir_node         *op          = get_Minus_op(n);
+	ir_mode *mode = get_irn_mode(n);
 
 	if (! mode_is_float(mode))
 		return;
 
-	symconst = create_softfloat_symconst(n, "neg");
-
-	ir_node *call;
-	ir_node *call_results;
-	ir_node *in[1]    = {op};
-	ir_node *nomem    = get_irg_no_mem(irg);
-	ir_type *type     = get_softfloat_type(n);
-	ir_mode *res_mode = get_type_mode(get_method_res_type(type, 0));
-
-	call         = new_rd_Call(dbgi, block, nomem, symconst, 1, in, type);
-	call_results = new_r_Proj(call, mode_T, pn_Call_T_result);
-	call_result  = new_r_Proj(call_results, res_mode, 0);
-
-	exchange(n, call_result);
+	add_fast_path(n, mode, mode, NULL);
 }
 
 /**
@@ -854,6 +766,401 @@ static void lower_Sub(ir_node *n)
 	exchange(n, call_result);
 }
 
+/**
+ * @return A Const with the value (value << shift).
+ */
+static ir_node *new_shifted_Const(ir_graph *irg, ir_mode *mode, long value,
+                                  unsigned shift)
+{
+	ir_tarval *tv = new_tarval_from_long(value, mode);
+	return new_r_Const(irg, tarval_shl_unsigned(tv, shift));
+}
+
+/**
+ * @return A Const with the lowest n_bits bits set.
+ */
+static ir_node *new_mask_Const(ir_graph *irg, ir_mode *mode, unsigned n_bits)
+{
+	ir_tarval *one = get_mode_one(mode);
+	ir_tarval *tv  = tarval_sub(tarval_shl_unsigned(one, n_bits), one, NULL);
+	return new_r_Const(irg, tv);
+}
+
+/**
+ * @return The exponent bias of a floating point mode.
+ */
+static long get_exponent_bias(const ir_mode *float_mode)
+{
+	return (1L << (get_mode_exponent_size(float_mode) - 1)) - 1;
+}
+
+/**
+ * @return The absolute value of the lowered floating point value x as signed
+ *         integer.
+ */
+static ir_node *build_magnitude(ir_node *block, ir_node *x, ir_mode *mode)
+{
+	ir_graph *irg      = get_irn_irg(block);
+	ir_mode  *s_mode   = find_signed_mode(mode);
+	unsigned  bits     = get_mode_size_bits(mode);
+	ir_node  *sx       = new_r_Conv(block, x, s_mode);
+	ir_node  *mag_mask = new_mask_Const(irg, s_mode, bits - 1);
+
+	return new_r_And(block, sx, mag_mask, s_mode);
+}
+
+/**
+ * @return All bits set if the non-negative integer x is not zero, 0 otherwise.
+ */
+static ir_node *build_nonzero_mask(ir_node *block, ir_node *x, ir_mode *mode)
+{
+	ir_graph *irg    = get_irn_irg(block);
+	ir_mode  *s_mode = find_signed_mode(mode);
+	unsigned  bits   = get_mode_size_bits(mode);
+	ir_node  *sx     = new_r_Conv(block, x, s_mode);
+	ir_node  *neg    = new_r_Minus(block, sx, s_mode);
+	ir_node  *any    = new_r_Or(block, sx, neg, s_mode);
+	ir_node  *shift  = new_r_Const_long(irg, mode_Iu, bits - 1);
+
+	return new_r_Conv(block, new_r_Shrs(block, any, shift, s_mode), mode);
+}
+
+/**
+ * Turns the sign and magnitude of a lowered floating point value into a
+ * two's complement integer, which is ordered like the floating point value.
+ * Both zeros have the key 0.
+ */
+static ir_node *build_order_key(ir_node *block, ir_node *x, ir_node *mag,
+                                ir_mode *mode)
+{
+	ir_graph *irg    = get_irn_irg(block);
+	ir_mode  *s_mode = find_signed_mode(mode);
+	unsigned  bits   = get_mode_size_bits(mode);
+	ir_node  *sx     = new_r_Conv(block, x, s_mode);
+	ir_node  *shift  = new_r_Const_long(irg, mode_Iu, bits - 1);
+	ir_node  *sign   = new_r_Shrs(block, sx, shift, s_mode);
+	ir_node  *flip   = new_r_Eor(block, mag, sign, s_mode);
+
+	return new_r_Sub(block, flip, sign, s_mode);
+}
+
+/**
+ * Replaces the postponed node by the value fast if cond is true and by a call
+ * of its soft float function otherwise.
+ *
+ * The node must have been moved into the upper half of its block by
+ * part_block_edges(), lower_block is the lower half.
+ */
+static void build_special_case_call(const fast_path_t *fp, ir_node *lower_block,
+                                    ir_node *cond, ir_node *fast, ir_node *op)
+{
+	ir_node  *n         = fp->node;
+	ir_graph *irg       = get_irn_irg(n);
+	dbg_info *dbgi      = get_irn_dbg_info(n);
+	ir_node  *block     = get_nodes_block(n);
+	ir_type  *type      = lower_method_type(fp->type);
+	ir_mode  *res_mode  = get_type_mode(get_method_res_type(type, 0));
+	ir_mode  *fast_mode = get_irn_mode(fast);
+
+	ir_node *cond_node  = new_rd_Cond(dbgi, block, cond);
+	ir_node *proj_fast  = new_r_Proj(cond_node, mode_X, pn_Cond_true);
+	ir_node *proj_slow  = new_r_Proj(cond_node, mode_X, pn_Cond_false);
+	ir_node *slow_block = new_r_Block(irg, 1, &proj_slow);
+
+	ir_node *in[1]        = { op };
+	ir_node *nomem        = get_irg_no_mem(irg);
+	ir_node *call         = new_rd_Call(dbgi, slow_block, nomem, fp->symconst,
+	                                    1, in, type);
+	ir_node *call_results = new_r_Proj(call, mode_T, pn_Call_T_result);
+	ir_node *call_result  = new_r_Proj(call_results, res_mode, 0);
+	ir_node *slow_jmp     = new_r_Jmp(slow_block);
+
+	if (res_mode != fast_mode)
+		call_result = new_rd_Conv(dbgi, slow_block, call_result, fast_mode);
+
+	ir_node *lower_in[] = { proj_fast, slow_jmp };
+	set_irn_in(lower_block, ARRAY_SIZE(lower_in), lower_in);
+
+	ir_node *phi_in[] = { fast, call_result };
+	ir_node *res      = new_r_Phi(lower_block, ARRAY_SIZE(phi_in), phi_in,
+	                              fast_mode);
+	ir_mode *mode     = get_lowered_mode(fp->mode);
+	if (mode != fast_mode)
+		res = new_rd_Conv(dbgi, lower_block, res, mode);
+
+	exchange(n, res);
+}
+
+/**
+ * Lowers a Minus to a flip of the sign bit.
+ */
+static void lower_Minus_fast(const fast_path_t *fp)
+{
+	ir_node  *n     = fp->node;
+	ir_graph *irg   = get_irn_irg(n);
+	ir_node  *block = get_nodes_block(n);
+	ir_node  *op    = get_Minus_op(n);
+	ir_mode  *mode  = get_lowered_mode(fp->mode);
+	ir_node  *sign  = new_shifted_Const(irg, mode, 1,
+	                                    get_mode_size_bits(mode) - 1);
+
+	exchange(n, new_rd_Eor(get_irn_dbg_info(n), block, op, sign, mode));
+}
+
+/**
+ * Lowers a Cmp to integer comparisons of the order keys of its operands.
+ */
+static void lower_Cmp_fast(const fast_path_t *fp)
+{
+	ir_node     *n         = fp->node;
+	ir_graph    *irg       = get_irn_irg(n);
+	dbg_info    *dbgi      = get_irn_dbg_info(n);
+	ir_node     *block     = get_nodes_block(n);
+	ir_node     *left      = get_Cmp_left(n);
+	ir_node     *right     = get_Cmp_right(n);
+	ir_relation  relation  = get_Cmp_relation(n);
+	ir_relation  ordered   = relation & ir_relation_less_equal_greater;
+	bool         unordered = (relation & ir_relation_unordered) != 0;
+	ir_mode     *mode      = get_lowered_mode(fp->op_mode);
+	ir_mode     *s_mode    = find_signed_mode(mode);
+
+	if (relation == ir_relation_false) {
+		exchange(n, new_r_Const(irg, tarval_b_false));
+		return;
+	} else if (relation == ir_relation_true) {
+		exchange(n, new_r_Const(irg, tarval_b_true));
+		return;
+	}
+
+	/* a value is NaN iff its magnitude is greater than the one of infinity */
+	unsigned     exp_size = get_mode_exponent_size(fp->op_mode);
+	unsigned     man_size = get_mode_mantissa_size(fp->op_mode);
+	ir_node     *inf      = new_shifted_Const(irg, s_mode,
+	                                          (1L << exp_size) - 1, man_size);
+	ir_relation  nan_rel  = unordered ? ir_relation_greater
+	                                  : ir_relation_less_equal;
+	ir_node     *mag_l    = build_magnitude(block, left, mode);
+	ir_node     *mag_r    = build_magnitude(block, right, mode);
+	ir_node     *nan_l    = new_rd_Cmp(dbgi, block, mag_l, inf, nan_rel);
+	ir_node     *nan_r    = new_rd_Cmp(dbgi, block, mag_r, inf, nan_rel);
+	ir_node     *res;
+
+	if (unordered) {
+		res = new_rd_Or(dbgi, block, nan_l, nan_r, mode_b);
+	} else {
+		res = new_rd_And(dbgi, block, nan_l, nan_r, mode_b);
+	}
+
+	if (ordered != ir_relation_false
+	    && ordered != ir_relation_less_equal_greater) {
+		ir_node *key_l = build_order_key(block, left, mag_l, mode);
+		ir_node *key_r = build_order_key(block, right, mag_r, mode);
+		ir_node *cmp   = new_rd_Cmp(dbgi, block, key_l, key_r, ordered);
+
+		if (unordered) {
+			res = new_rd_Or(dbgi, block, res, cmp, mode_b);
+		} else {
+			res = new_rd_And(dbgi, block, res, cmp, mode_b);
+		}
+	}
+
+	exchange(n, res);
+}
+
+/**
+ * Lowers a Conv from a floating point to a 32 bit integer mode. Values which
+ * are too large for the result are converted by the soft float function.
+ */
+static void lower_Conv_to_int_fast(const fast_path_t *fp)
+{
+	ir_node  *n           = fp->node;
+	ir_graph *irg         = get_irn_irg(n);
+	ir_node  *op          = get_Conv_op(n);
+	ir_mode  *mode        = get_lowered_mode(fp->op_mode);
+	bool      is_signed   = mode_is_signed(fp->mode);
+	unsigned  bits        = get_mode_size_bits(mode);
+	unsigned  man_size    = get_mode_mantissa_size(fp->op_mode);
+	unsigned  exp_size    = get_mode_exponent_size(fp->op_mode);
+	long      bias        = get_exponent_bias(fp->op_mode);
+	/* number of value bits of the result */
+	unsigned  width       = is_signed ? 31 : 32;
+	ir_node  *lower_block = part_block_edges(n);
+	ir_node  *block       = get_nodes_block(n);
+
+	/* The exponent includes the sign for unsigned results, so negative
+	 * values take the slow path. */
+	ir_node *man_shift = new_r_Const_long(irg, mode_Iu, man_size);
+	ir_node *exp       = new_r_Shr(block, op, man_shift, mode);
+	if (is_signed) {
+		ir_node *exp_mask = new_mask_Const(irg, mode, exp_size);
+		exp = new_r_And(block, exp, exp_mask, mode);
+	}
+	exp = new_r_Conv(block, exp, mode_Is);
+
+	/* the value is the significand, aligned to the top value bit of the
+	 * result, shifted right by count */
+	ir_node *max_exp  = new_r_Const_long(irg, mode_Is, bias + width - 1);
+	ir_node *count    = new_r_Sub(block, max_exp, exp, mode_Is);
+	ir_node *man_mask = new_mask_Const(irg, mode, man_size);
+	ir_node *implicit = new_shifted_Const(irg, mode, 1, man_size);
+	ir_node *man      = new_r_And(block, op, man_mask, mode);
+	ir_node *sig      = new_r_Or(block, man, implicit, mode);
+	if (man_size + 1 <= width) {
+		ir_node *shift = new_r_Const_long(irg, mode_Iu, width - 1 - man_size);
+		sig = new_r_Conv(block, sig, mode_Iu);
+		sig = new_r_Shl(block, sig, shift, mode_Iu);
+	} else {
+		ir_node *shift = new_r_Const_long(irg, mode_Iu, man_size - (width - 1));
+		sig = new_r_Shr(block, sig, shift, mode);
+		sig = new_r_Conv(block, sig, mode_Iu);
+	}
+
+	/* values below 1 have a count greater than width - 1 and become 0 */
+	ir_node *c31       = new_r_Const_long(irg, mode_Is, 31);
+	ir_node *amount    = new_r_Conv(block, new_r_And(block, count, c31, mode_Is),
+	                                mode_Iu);
+	ir_node *max_count = new_r_Const_long(irg, mode_Is, width - 1);
+	ir_node *rest      = new_r_Sub(block, max_count, count, mode_Is);
+	ir_node *sign_bit  = new_r_Const_long(irg, mode_Iu, 31);
+	ir_node *too_small = new_r_Shrs(block, rest, sign_bit, mode_Is);
+	ir_node *keep      = new_r_Conv(block, new_r_Not(block, too_small, mode_Is),
+	                                mode_Iu);
+	ir_node *shifted   = new_r_Shr(block, sig, amount, mode_Iu);
+	ir_node *fast      = new_r_And(block, shifted, keep, mode_Iu);
+
+	if (is_signed) {
+		/* a Conv of op to mode_Is would be CSEd with n */
+		ir_node *shift = new_r_Const_long(irg, mode_Iu, bits - 1);
+		ir_node *sign  = new_r_Shr(block, op, shift, mode);
+		sign = new_r_Minus(block, new_r_Conv(block, sign, mode_Is), mode_Is);
+		fast = new_r_Conv(block, fast, mode_Is);
+		fast = new_r_Sub(block, new_r_Eor(block, fast, sign, mode_Is), sign,
+		                 mode_Is);
+	}
+
+	ir_node *zero = new_r_Const(irg, get_mode_null(mode_Is));
+	ir_node *cond = new_r_Cmp(block, count, zero, ir_relation_greater_equal);
+	build_special_case_call(fp, lower_block, cond, fast, op);
+}
+
+/**
+ * Lowers a Conv between floating point modes. Zeros and normal values whose
+ * exponent fits into the result are converted inline, the others by the soft
+ * float function.
+ */
+static void lower_Conv_float_fast(const fast_path_t *fp)
+{
+	ir_node  *n           = fp->node;
+	ir_graph *irg         = get_irn_irg(n);
+	ir_node  *op          = get_Conv_op(n);
+	ir_mode  *op_mode     = get_lowered_mode(fp->op_mode);
+	ir_mode  *mode        = get_lowered_mode(fp->mode);
+	unsigned  op_bits     = get_mode_size_bits(op_mode);
+	unsigned  bits        = get_mode_size_bits(mode);
+	unsigned  op_man_size = get_mode_mantissa_size(fp->op_mode);
+	unsigned  op_exp_size = get_mode_exponent_size(fp->op_mode);
+	unsigned  man_size    = get_mode_mantissa_size(fp->mode);
+	unsigned  exp_size    = get_mode_exponent_size(fp->mode);
+	long      delta       = get_exponent_bias(fp->op_mode)
+	                        - get_exponent_bias(fp->mode);
+	ir_node  *lower_block = part_block_edges(n);
+	ir_node  *block       = get_nodes_block(n);
+
+	/* the operand must be zero or the operand and the result must be normal
+	 * values: the biased exponent of the operand must be in
+	 * [min_exp, max_exp] */
+	long     min_exp   = delta + 1 > 1 ? delta + 1 : 1;
+	long     max_exp   = delta + (1L << exp_size) - 2;
+	if (max_exp > (1L << op_exp_size) - 2)
+		max_exp = (1L << op_exp_size) - 2;
+	ir_node *mag       = new_r_Conv(block, build_magnitude(block, op, op_mode),
+	                                op_mode);
+	ir_node *op_min    = new_shifted_Const(irg, op_mode, min_exp, op_man_size);
+	ir_node *biased    = new_r_Sub(block, mag, op_min, op_mode);
+	ir_node *n_normals = new_shifted_Const(irg, op_mode, max_exp - min_exp + 1,
+	                                       op_man_size);
+	ir_node *normal    = new_r_Cmp(block, biased, n_normals, ir_relation_less);
+	ir_node *op_zero   = new_r_Const(irg, get_mode_null(op_mode));
+	ir_node *is_zero   = new_r_Cmp(block, mag, op_zero, ir_relation_equal);
+	ir_node *cond      = new_r_Or(block, normal, is_zero, mode_b);
+
+	/* align the mantissa and rebias the exponent, a zero magnitude stays 0 */
+	ir_node *sign_shift;
+	ir_node *fast;
+	if (bits > op_bits) {
+		ir_node *shift  = new_r_Const_long(irg, mode_Iu, man_size - op_man_size);
+		ir_node *rebias = new_shifted_Const(irg, mode, -delta, man_size);
+		fast       = new_r_Conv(block, mag, mode);
+		fast       = new_r_Shl(block, fast, shift, mode);
+		fast       = new_r_Add(block, fast, rebias, mode);
+		fast       = new_r_And(block, fast,
+		                       build_nonzero_mask(block, mag, mode), mode);
+		sign_shift = new_r_Const_long(irg, mode_Iu, bits - op_bits);
+	} else {
+		/* round to nearest, ties to even; a carry out of the mantissa
+		 * correctly increments the exponent */
+		unsigned  drop   = op_man_size - man_size;
+		ir_node  *shift  = new_r_Const_long(irg, mode_Iu, drop);
+		ir_node  *rebias = new_shifted_Const(irg, op_mode, delta, man_size);
+		ir_node  *kept   = new_r_Shr(block, mag, shift, op_mode);
+		ir_node  *rest   = new_r_And(block, mag,
+		                             new_mask_Const(irg, op_mode, drop), op_mode);
+		ir_node  *one    = new_r_Const(irg, get_mode_one(op_mode));
+		ir_node  *odd    = new_r_And(block, kept, one, op_mode);
+		ir_node  *half   = new_mask_Const(irg, op_mode, drop - 1);
+		ir_node  *round  = new_r_Add(block, new_r_Add(block, rest, half, op_mode),
+		                             odd, op_mode);
+		round      = new_r_Shr(block, round, shift, op_mode);
+		fast       = new_r_Add(block, kept, round, op_mode);
+		fast       = new_r_Sub(block, fast, rebias, op_mode);
+		fast       = new_r_And(block, fast,
+		                       build_nonzero_mask(block, mag, op_mode), op_mode);
+		fast       = new_r_Conv(block, fast, mode);
+		sign_shift = new_r_Const_long(irg, mode_Iu, op_bits - bits);
+	}
+
+	ir_node *sign_mask = new_shifted_Const(irg, op_mode, 1, op_bits - 1);
+	ir_node *sign      = new_r_And(block, op, sign_mask, op_mode);
+	if (bits > op_bits) {
+		sign = new_r_Conv(block, sign, mode);
+		sign = new_r_Shl(block, sign, sign_shift, mode);
+	} else {
+		sign = new_r_Shr(block, sign, sign_shift, op_mode);
+		sign = new_r_Conv(block, sign, mode);
+	}
+	fast = new_r_Or(block, fast, sign, mode);
+
+	build_special_case_call(fp, lower_block, cond, fast, op);
+}
+
+/**
+ * Lowers the postponed operations after all modes are lowered.
+ */
+static void lower_fast_paths(void)
+{
+	for (size_t i = 0, n = ARR_LEN(fast_paths); i < n; ++i) {
+		const fast_path_t *fp   = &fast_paths[i];
+		ir_node           *node = fp->node;
+
+		DB((dbg, LEVEL_2, "lowering %+F to integer operations\n", node));
+		if (is_Minus(node)) {
+			lower_Minus_fast(fp);
+		} else if (is_Cmp(node)) {
+			lower_Cmp_fast(fp);
+		} else if (mode_is_float(fp->mode)) {
+			lower_Conv_float_fast(fp);
+			clear_irg_properties(get_irn_irg(node),
+			                     IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE
+			                     | IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO);
+		} else {
+			lower_Conv_to_int_fast(fp);
+			clear_irg_properties(get_irn_irg(node),
+			                     IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE
+			                     | IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO);
+		}
+	}
+}
+
 /**
  * Enter a lowering function into an ir_op.
  */
@@ -1021,14 +1328,6 @@ static void ir_prepare_softfloat_lowering(void)
 	}
 }
 
-/**
- * Callback to lower only the Mux nodes we created.
- */
-static int lower_mux_cb(ir_node *mux)
-{
-	return ir_nodeset_contains(&created_mux_nodes, mux);
-}
-
 void lower_floating_point(void)
 {
 	size_t i;
@@ -1047,19 +1346,14 @@ void lower_floating_point(void)
 	ir_register_softloat_lower_function(op_Mul,   lower_Mul);
 	ir_register_softloat_lower_function(op_Sub,   lower_Sub);
 
+	fast_paths = NEW_ARR_F(fast_path_t, 0);
+
 	for (i = 0; i < n_irgs; ++i) {
 		ir_graph *irg = get_irp_irg(i);
 
-		ir_nodeset_init(&created_mux_nodes);
-
 		assure_edges(irg);
 
 		irg_walk_graph(irg, NULL, lower_node, NULL);
-
-		if (ir_nodeset_size(&created_mux_nodes) > 0)
-			lower_mux(irg, lower_mux_cb);
-
-		ir_nodeset_destroy(&created_mux_nodes);
 	}
 
 	ir_clear_opcodes_generic_func();
@@ -1093,4 +1387,7 @@ void lower_floating_point(void)
 			}
 		}
 	}
+
+	lower_fast_paths();
+	DEL_ARR_F(fast_paths);
 }
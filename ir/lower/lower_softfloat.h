@@ -14,7 +14,9 @@
 /**
  * Lowers all floating-point operations.
  *
- * They are replaced by calls into a soft float library.
+ * They are replaced by calls into a soft float library. Negations,
+ * comparisons and conversions of normal values to 32 bit integers or between
+ * floating point modes are replaced by integer operations instead.
  */
 void lower_floating_point(void);
 
@@ -26,6 +26,7 @@
 #include "trouts.h"
 #include "iropt_t.h"
 #include "irpass.h"
+#include "irmemory_t.h"
 #include "pmap.h"
 
 /**
@@ -99,6 +100,7 @@ void dead_node_elimination(ir_graph *irg)
 	/* A new obstack, where the reachable nodes will be copied to. */
 	obstack_init(&irg->obst);
 	irg->last_node_idx = 0;
+	invalidate_points_to(irg);
 
 	/* We also need a new value table for CSE */
 	new_identities(irg);
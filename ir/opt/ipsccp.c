@@ -0,0 +1,477 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Interprocedural sparse conditional constant propagation.
+ *
+ * Every parameter and result of a graph gets a lattice value: top (no value
+ * seen yet), a constant or bottom (not constant). Parameters of graphs whose
+ * callers are not all known are bottom. The values are computed from all
+ * call sites and Returns until a fixpoint is reached, following the value
+ * chains of arguments through Phis, simple arithmetic and the results of
+ * other calls.
+ *
+ * Afterwards constant arguments are placed in the callee graph, constant
+ * results are placed at the call sites and results which are never used by
+ * any caller are replaced by a constant, so the code computing them dies.
+ * Running combo() or optimize_graph_df() on the changed graphs folds the
+ * remaining code.
+ */
+#include <stdbool.h>
+
+#include "iroptimize.h"
+#include "irmemory.h"
+#include "irprog_t.h"
+#include "irgraph_t.h"
+#include "irnode_t.h"
+#include "ircons.h"
+#include "irgmod.h"
+#include "irgwalk.h"
+#include "irpass.h"
+#include "tv.h"
+#include "typerep.h"
+#include "array_t.h"
+#include "obst.h"
+#include "pmap.h"
+#include "debug.h"
+#include "util.h"
+
+DEBUG_ONLY(static firm_dbg_module_t *dbg = NULL;)
+
+/** Give up evaluating a value after this many nodes. */
+#define MAX_EVAL_NODES 1000
+
+/** The lattice values of a graph. */
+typedef struct graph_info_t {
+	ir_tarval **params;     /**< lattice values of the parameters */
+	size_t      n_params;
+	ir_tarval **results;    /**< lattice values of the results */
+	bool       *res_used;   /**< results used by some caller */
+	size_t      n_results;
+	bool        private;    /**< all callers are known */
+	bool        changed;    /**< the graph was changed */
+} graph_info_t;
+
+typedef struct env_t {
+	struct obstack obst;
+	pmap          *graphs;   /**< maps graphs to graph_info_t */
+	pmap          *active;   /**< Phis currently evaluated */
+	unsigned       n_arith;  /**< arithmetic nodes currently evaluated */
+	unsigned       budget;   /**< nodes left to evaluate for this value */
+	bool           changed;  /**< a lattice value was lowered */
+	unsigned       n_args;   /**< number of arguments replaced */
+	unsigned       n_calls;  /**< number of call results replaced */
+	unsigned       n_unused; /**< number of unused results removed */
+} env_t;
+
+static ir_tarval *meet(ir_tarval *a, ir_tarval *b)
+{
+	if (a == tarval_top)
+		return b;
+	if (b == tarval_top || a == b)
+		return a;
+	return tarval_bottom;
+}
+
+static bool is_constant(ir_tarval *tv)
+{
+	return tv != tarval_top && tv != tarval_bottom;
+}
+
+static graph_info_t *get_graph_info(env_t *env, ir_graph *irg)
+{
+	return pmap_get(graph_info_t, env->graphs, irg);
+}
+
+/**
+ * Returns the graph of a callee whose results can be trusted.
+ */
+static graph_info_t *get_callee_info(env_t *env, ir_entity *callee)
+{
+	if (callee == NULL || is_unknown_entity(callee))
+		return NULL;
+	/* we don't know which function gets finally bound to a weak symbol */
+	if (get_entity_linkage(callee) & IR_LINKAGE_WEAK)
+		return NULL;
+	ir_graph *irg = get_entity_irg(callee);
+	return irg != NULL ? get_graph_info(env, irg) : NULL;
+}
+
+/**
+ * Collects the possible callees of a Call, returns false if they are not
+ * known.
+ */
+static bool get_callees(const ir_node *call, ir_entity ***callees)
+{
+	ir_node *ptr = get_Call_ptr(call);
+	if (is_SymConst_addr_ent(ptr)) {
+		ARR_APP1(ir_entity*, *callees, get_SymConst_entity(ptr));
+		return true;
+	}
+	if (get_irp_callee_info_state() != irg_callee_info_consistent
+	    || !Call_has_callees(call))
+		return false;
+	for (size_t i = 0, n = get_Call_n_callees(call); i < n; ++i) {
+		ir_entity *callee = get_Call_callee(call, i);
+		if (is_unknown_entity(callee))
+			return false;
+		ARR_APP1(ir_entity*, *callees, callee);
+	}
+	return true;
+}
+
+/**
+ * Returns the lattice value of result pos of a Call.
+ */
+static ir_tarval *get_call_result(env_t *env, const ir_node *call, size_t pos)
+{
+	ir_entity **callees = NEW_ARR_F(ir_entity*, 0);
+	ir_tarval  *tv      = tarval_top;
+	if (!get_callees(call, &callees) || ARR_LEN(callees) == 0)
+		tv = tarval_bottom;
+	for (size_t i = 0, n = ARR_LEN(callees); i < n && tv != tarval_bottom; ++i) {
+		graph_info_t *info = get_callee_info(env, callees[i]);
+		if (info == NULL || pos >= info->n_results)
+			tv = tarval_bottom;
+		else
+			tv = meet(tv, info->results[pos]);
+	}
+	DEL_ARR_F(callees);
+	return tv;
+}
+
+static ir_tarval *get_lattice_value(env_t *env, const ir_node *node);
+
+/**
+ * Computes the lattice value of an arithmetic node from its operands.
+ */
+static ir_tarval *compute_arith(env_t *env, const ir_node *node)
+{
+	ir_tarval *ops[2];
+	int        arity = get_irn_arity(node);
+	assert(arity <= 2);
+	++env->n_arith;
+	for (int i = 0; i < arity; ++i) {
+		ops[i] = get_lattice_value(env, get_irn_n(node, i));
+		if (ops[i] == tarval_bottom)
+			break;
+	}
+	--env->n_arith;
+	for (int i = 0; i < arity; ++i) {
+		if (ops[i] == tarval_bottom)
+			return tarval_bottom;
+	}
+	for (int i = 0; i < arity; ++i) {
+		if (ops[i] == tarval_top)
+			return tarval_top;
+	}
+
+	switch (get_irn_opcode(node)) {
+	case iro_Add:   return tarval_add(ops[0], ops[1]);
+	case iro_Sub:   return tarval_sub(ops[0], ops[1], get_irn_mode(node));
+	case iro_Mul:   return tarval_mul(ops[0], ops[1]);
+	case iro_And:   return tarval_and(ops[0], ops[1]);
+	case iro_Or:    return tarval_or(ops[0], ops[1]);
+	case iro_Eor:   return tarval_eor(ops[0], ops[1]);
+	case iro_Shl:   return tarval_shl(ops[0], ops[1]);
+	case iro_Shr:   return tarval_shr(ops[0], ops[1]);
+	case iro_Shrs:  return tarval_shrs(ops[0], ops[1]);
+	case iro_Minus: return tarval_neg(ops[0]);
+	case iro_Not:   return tarval_not(ops[0]);
+	case iro_Conv:  return tarval_convert_to(ops[0], get_irn_mode(node));
+	default:        return tarval_bottom;
+	}
+}
+
+/**
+ * Returns the lattice value of a node in the current state.
+ */
+static ir_tarval *get_lattice_value(env_t *env, const ir_node *node)
+{
+	if (env->budget == 0)
+		return tarval_bottom;
+	--env->budget;
+
+	switch (get_irn_opcode(node)) {
+	case iro_Const:
+		return get_Const_tarval(node);
+	case iro_Confirm:
+		return get_lattice_value(env, get_Confirm_value(node));
+	case iro_Id:
+		return get_lattice_value(env, get_Id_pred(node));
+	case iro_Phi: {
+		if (get_irn_mode(node) == mode_M)
+			return tarval_bottom;
+		/* a cycle only copying the value adds nothing, a cycle computing
+		 * something new in every iteration is not constant */
+		void *entry = pmap_get(void, env->active, node);
+		if (entry != NULL) {
+			size_t level = PTR_TO_INT(entry) - 1;
+			return level == env->n_arith ? tarval_top : tarval_bottom;
+		}
+		pmap_insert(env->active, node, INT_TO_PTR(env->n_arith + 1));
+		ir_tarval *tv = tarval_top;
+		for (int i = 0, n = get_Phi_n_preds(node); i < n && tv != tarval_bottom; ++i)
+			tv = meet(tv, get_lattice_value(env, get_Phi_pred(node, i)));
+		pmap_insert(env->active, node, NULL);
+		return tv;
+	}
+	case iro_Proj: {
+		ir_node *pred = get_Proj_pred(node);
+		if (is_arg_Proj(node)) {
+			graph_info_t *info = get_graph_info(env, get_irn_irg(node));
+			size_t        pos  = get_Proj_proj(node);
+			return pos < info->n_params ? info->params[pos] : tarval_bottom;
+		}
+		if (is_Proj(pred) && get_Proj_proj(pred) == pn_Call_T_result
+		    && is_Call(get_Proj_pred(pred)))
+			return get_call_result(env, get_Proj_pred(pred), get_Proj_proj(node));
+		return tarval_bottom;
+	}
+	case iro_Add:
+	case iro_Sub:
+	case iro_Mul:
+	case iro_And:
+	case iro_Or:
+	case iro_Eor:
+	case iro_Minus:
+	case iro_Not:
+		if (!mode_is_int(get_irn_mode(node)))
+			return tarval_bottom;
+		for (int i = 0, n = get_irn_arity(node); i < n; ++i) {
+			if (get_irn_mode(get_irn_n(node, i)) != get_irn_mode(node))
+				return tarval_bottom;
+		}
+		return compute_arith(env, node);
+	case iro_Shl:
+	case iro_Shr:
+	case iro_Shrs:
+		if (!mode_is_int(get_irn_mode(node)))
+			return tarval_bottom;
+		return compute_arith(env, node);
+	case iro_Conv:
+		if (!mode_is_int(get_irn_mode(node))
+		    || !mode_is_int(get_irn_mode(get_Conv_op(node))))
+			return tarval_bottom;
+		return compute_arith(env, node);
+	default:
+		return tarval_bottom;
+	}
+}
+
+/**
+ * Evaluates a value and lowers the lattice value in slot to it.
+ */
+static void lower_value(env_t *env, ir_tarval **slot, const ir_node *node)
+{
+	env->budget = MAX_EVAL_NODES;
+	ir_tarval *res = meet(*slot, get_lattice_value(env, node));
+	if (res != *slot) {
+		*slot        = res;
+		env->changed = true;
+	}
+}
+
+/**
+ * Walker: meets the arguments of Calls into the parameter values of the
+ * callees and the returned values into the result values of the graph.
+ */
+static void propagate_node(ir_node *node, void *ctx)
+{
+	env_t *env = (env_t*)ctx;
+
+	if (is_Return(node)) {
+		graph_info_t *info = get_graph_info(env, get_irn_irg(node));
+		for (size_t i = 0, n = get_Return_n_ress(node); i < n; ++i) {
+			if (i < info->n_results)
+				lower_value(env, &info->results[i], get_Return_res(node, i));
+		}
+	} else if (is_Call(node)) {
+		ir_node *ptr = get_Call_ptr(node);
+		/* only direct calls reach private graphs */
+		if (!is_SymConst_addr_ent(ptr))
+			return;
+		ir_graph *callee_irg = get_entity_irg(get_SymConst_entity(ptr));
+		if (callee_irg == NULL)
+			return;
+		graph_info_t *info = get_graph_info(env, callee_irg);
+		if (info == NULL || !info->private)
+			return;
+		for (size_t i = 0, n = get_Call_n_params(node); i < n && i < info->n_params; ++i)
+			lower_value(env, &info->params[i], get_Call_param(node, i));
+	}
+}
+
+/**
+ * Walker: replaces constant call results and records which results are
+ * used.
+ */
+static void replace_call_results(ir_node *node, void *ctx)
+{
+	env_t *env = (env_t*)ctx;
+	if (!is_Proj(node))
+		return;
+	ir_node *pred = get_Proj_pred(node);
+	if (!is_Proj(pred) || get_Proj_proj(pred) != pn_Call_T_result)
+		return;
+	ir_node *call = get_Proj_pred(pred);
+	if (!is_Call(call))
+		return;
+
+	size_t     pos = get_Proj_proj(node);
+	ir_tarval *tv  = get_call_result(env, call, pos);
+	if (is_constant(tv) && get_tarval_mode(tv) == get_irn_mode(node)) {
+		ir_graph *irg = get_irn_irg(node);
+		DB((dbg, LEVEL_2, "result %zu of %+F is %T\n", pos, call, tv));
+		exchange(node, new_r_Const(irg, tv));
+		get_graph_info(env, irg)->changed = true;
+		++env->n_calls;
+		return;
+	}
+
+	ir_entity **callees = NEW_ARR_F(ir_entity*, 0);
+	get_callees(call, &callees);
+	for (size_t i = 0, n = ARR_LEN(callees); i < n; ++i) {
+		ir_graph *callee_irg = get_entity_irg(callees[i]);
+		if (callee_irg == NULL)
+			continue;
+		graph_info_t *info = get_graph_info(env, callee_irg);
+		if (info != NULL && pos < info->n_results)
+			info->res_used[pos] = true;
+	}
+	DEL_ARR_F(callees);
+}
+
+/**
+ * Walker: places constant parameters in a graph.
+ */
+static void replace_args(ir_node *node, void *ctx)
+{
+	env_t *env = (env_t*)ctx;
+	if (!is_arg_Proj(node))
+		return;
+
+	ir_graph     *irg  = get_irn_irg(node);
+	graph_info_t *info = get_graph_info(env, irg);
+	size_t        pos  = get_Proj_proj(node);
+	if (pos >= info->n_params)
+		return;
+	ir_tarval *tv = info->params[pos];
+	if (!is_constant(tv) || get_tarval_mode(tv) != get_irn_mode(node))
+		return;
+
+	DB((dbg, LEVEL_2, "parameter %zu of %+F is %T\n", pos, irg, tv));
+	exchange(node, new_r_Const(irg, tv));
+	info->changed = true;
+	++env->n_args;
+}
+
+/**
+ * Replaces results which no caller uses by a constant.
+ */
+static void remove_unused_results(env_t *env, ir_graph *irg)
+{
+	graph_info_t *info = get_graph_info(env, irg);
+	ir_type      *mtp  = get_entity_type(get_irg_entity(irg));
+	ir_node      *end  = get_irg_end_block(irg);
+
+	for (size_t r = 0; r < info->n_results; ++r) {
+		if (info->res_used[r] || is_compound_type(get_method_res_type(mtp, r)))
+			continue;
+		for (int i = 0, n = get_Block_n_cfgpreds(end); i < n; ++i) {
+			ir_node *ret = get_Block_cfgpred(end, i);
+			if (!is_Return(ret) || r >= (size_t)get_Return_n_ress(ret))
+				continue;
+			ir_node *res  = get_Return_res(ret, r);
+			ir_mode *mode = get_irn_mode(res);
+			if (is_Const(res) || !mode_is_data(mode))
+				continue;
+			DB((dbg, LEVEL_2, "result %zu of %+F is unused\n", r, irg));
+			set_Return_res(ret, r, new_r_Const(irg, get_mode_null(mode)));
+			info->changed = true;
+			++env->n_unused;
+		}
+	}
+}
+
+static void init_graph_info(env_t *env, ir_graph *irg)
+{
+	ir_entity    *entity = get_irg_entity(irg);
+	ir_type      *mtp    = get_entity_type(entity);
+	graph_info_t *info   = OALLOCZ(&env->obst, graph_info_t);
+
+	info->private = !(get_entity_usage(entity) & ir_usage_address_taken)
+	             && !entity_is_externally_visible(entity)
+	             && get_method_variadicity(mtp) == variadicity_non_variadic;
+	info->n_params  = get_method_n_params(mtp);
+	info->params    = OALLOCN(&env->obst, ir_tarval*, info->n_params);
+	info->n_results = get_method_n_ress(mtp);
+	info->results   = OALLOCN(&env->obst, ir_tarval*, info->n_results);
+	info->res_used  = OALLOCNZ(&env->obst, bool, info->n_results);
+	for (size_t i = 0; i < info->n_params; ++i)
+		info->params[i] = info->private ? tarval_top : tarval_bottom;
+	for (size_t i = 0; i < info->n_results; ++i)
+		info->results[i] = tarval_top;
+	pmap_insert(env->graphs, irg, info);
+}
+
+void opt_ipsccp(void)
+{
+	FIRM_DBG_REGISTER(dbg, "firm.opt.ipsccp");
+
+	env_t env;
+	obstack_init(&env.obst);
+	env.graphs   = pmap_create();
+	env.n_args   = 0;
+	env.n_calls  = 0;
+	env.n_unused = 0;
+	env.n_arith  = 0;
+	env.active   = pmap_create();
+
+	assure_irp_globals_entity_usage_computed();
+	for (size_t i = 0, n = get_irp_n_irgs(); i < n; ++i)
+		init_graph_info(&env, get_irp_irg(i));
+
+	/* the lattice values only move down, so this terminates */
+	unsigned n_rounds = 0;
+	do {
+		env.changed = false;
+		++n_rounds;
+		for (size_t i = 0, n = get_irp_n_irgs(); i < n; ++i)
+			irg_walk_graph(get_irp_irg(i), NULL, propagate_node, &env);
+	} while (env.changed);
+	DB((dbg, LEVEL_1, "fixpoint reached after %u rounds\n", n_rounds));
+
+	for (size_t i = 0, n = get_irp_n_irgs(); i < n; ++i) {
+		ir_graph *irg = get_irp_irg(i);
+		if (get_graph_info(&env, irg)->private)
+			irg_walk_graph(irg, NULL, replace_args, &env);
+	}
+	for (size_t i = 0, n = get_irp_n_irgs(); i < n; ++i)
+		irg_walk_graph(get_irp_irg(i), NULL, replace_call_results, &env);
+	for (size_t i = 0, n = get_irp_n_irgs(); i < n; ++i) {
+		ir_graph *irg = get_irp_irg(i);
+		if (get_graph_info(&env, irg)->private)
+			remove_unused_results(&env, irg);
+	}
+
+	for (size_t i = 0, n = get_irp_n_irgs(); i < n; ++i) {
+		ir_graph *irg = get_irp_irg(i);
+		if (get_graph_info(&env, irg)->changed)
+			confirm_irg_properties(irg, IR_GRAPH_PROPERTIES_CONTROL_FLOW);
+	}
+	DB((dbg, LEVEL_1, "replaced %u arguments, %u call results and %u unused results\n",
+	    env.n_args, env.n_calls, env.n_unused));
+
+	pmap_destroy(env.active);
+	pmap_destroy(env.graphs);
+	obstack_free(&env.obst, NULL);
+}
+
+ir_prog_pass_t *opt_ipsccp_pass(const char *name)
+{
+	return def_prog_pass(name ? name : "ipsccp", opt_ipsccp);
+}
@@ -0,0 +1,759 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Loop invariant code motion for Loads and scalar promotion of
+ *          memory locations accessed in loops.
+ *
+ * place_code() only moves floating nodes out of loops. This pass handles
+ * the memory operations:
+ *
+ * - A Load from a loop invariant address is moved into the preheader of the
+ *   loop if no memory operation in the loop may write the loaded location,
+ *   which is checked with get_alias_relation(). The Load must either be
+ *   executed in every iteration leaving the loop or its address must be known
+ *   not to fault.
+ * - A location which is read and written in the loop through a loop
+ *   invariant address is promoted to a value: The location is loaded once in
+ *   the preheader, the accesses in the loop are replaced by SSA values and the
+ *   final value is stored on every loop exit. This requires that all accesses
+ *   in the loop which may alias the location are accesses of the same mode
+ *   to exactly that location, that there are no calls in the loop and that a
+ *   Store to the location is executed on every path leaving the loop.
+ *
+ * The checks are conservative: volatile accesses and memory operations other
+ * than Loads, Stores and const or pure Calls block the optimization of the
+ * whole loop. Head controlled loops rarely execute a Store on every path to
+ * the exit, so do_loop_inversion() should run before this pass.
+ */
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "iroptimize.h"
+#include "irnode_t.h"
+#include "irgraph_t.h"
+#include "ircons_t.h"
+#include "irgmod.h"
+#include "irgopt.h"
+#include "irgwalk.h"
+#include "irdom.h"
+#include "irloop_t.h"
+#include "irmemory.h"
+#include "irnodeset.h"
+#include "irouts.h"
+#include "irpass.h"
+#include "array_t.h"
+#include "bitset.h"
+#include "debug.h"
+#include "util.h"
+
+DEBUG_ONLY(static firm_dbg_module_t *dbg;)
+
+/** Maximum depth of the address computations moved out of a loop. */
+#define MAX_INVARIANT_DEPTH 8
+
+/** A memory user which is rewired to the Store on a loop exit. */
+typedef struct exit_use_t {
+	ir_node *user;  /**< the user of the memory leaving the loop */
+	int      pos;   /**< the input position of the memory */
+	size_t   exit;  /**< the index of the exit dominating the user */
+} exit_use_t;
+
+/** Information about the loop currently optimized. */
+typedef struct loop_env_t {
+	ir_graph  *irg;
+	bitset_t  *blocks;          /**< the blocks of the loop */
+	ir_node  **block_list;      /**< the blocks of the loop as list */
+	ir_node   *header;          /**< the loop header */
+	int        entry_pos;       /**< the header input entering the loop */
+	ir_node   *entry_mem;       /**< the memory entering the loop */
+	ir_node   *preheader;       /**< the preheader, created on demand */
+	ir_node  **loads;           /**< the non-volatile Loads in the loop */
+	ir_node  **stores;          /**< the non-volatile Stores in the loop */
+	ir_node  **exit_blocks;     /**< the blocks the loop exits to */
+	bool       has_clobber;     /**< the loop contains a memory operation
+	                                 writing unknown memory */
+	bool       has_call;        /**< the loop contains a Call */
+	bool       dedicated_exits; /**< all exit blocks have a single
+	                                 predecessor */
+} loop_env_t;
+
+/** Environment of the replacement walker of the scalar promotion. */
+typedef struct promote_env_t {
+	ir_nodeset_t *accesses;     /**< the Loads and Stores to replace */
+	ir_mode      *mode;         /**< the mode of the promoted location */
+} promote_env_t;
+
+static bool is_loop_block(const loop_env_t *env, const ir_node *block)
+{
+	unsigned idx = get_irn_idx(block);
+	return idx < bitset_size(env->blocks) && bitset_is_set(env->blocks, idx);
+}
+
+static bool is_in_loop(const loop_env_t *env, const ir_node *node)
+{
+	return is_loop_block(env, get_nodes_block(node));
+}
+
+static void collect_blocks(loop_env_t *env, const ir_loop *loop)
+{
+	for (size_t i = 0, n = get_loop_n_elements(loop); i < n; ++i) {
+		loop_element elem = get_loop_element(loop, i);
+		if (*elem.kind == k_ir_loop) {
+			collect_blocks(env, elem.son);
+		} else if (is_Block(elem.node)) {
+			bitset_set(env->blocks, get_irn_idx(elem.node));
+			ARR_APP1(ir_node*, env->block_list, elem.node);
+		}
+	}
+}
+
+/**
+ * Check whether a Call does only read memory.
+ */
+static bool is_Call_pure(const ir_node *call)
+{
+	ir_type *call_tp = get_Call_type(call);
+	unsigned prop    = get_method_additional_properties(call_tp);
+
+	if ((prop & (mtp_property_const|mtp_property_pure)) == 0) {
+		ir_node *ptr = get_Call_ptr(call);
+		if (is_SymConst_addr_ent(ptr))
+			prop = get_entity_additional_properties(get_SymConst_entity(ptr));
+	}
+	return (prop & (mtp_property_const|mtp_property_pure)) != 0;
+}
+
+/**
+ * Check whether a memory operation has exception control flow.
+ */
+static bool has_exception_flow(const ir_node *node)
+{
+	for (unsigned i = 0, n = get_irn_n_outs(node); i < n; ++i) {
+		const ir_node *proj = get_irn_out(node, i);
+		if (is_Proj(proj) && get_irn_mode(proj) == mode_X)
+			return true;
+	}
+	return false;
+}
+
+static bool has_mem_proj(const ir_node *node)
+{
+	for (unsigned i = 0, n = get_irn_n_outs(node); i < n; ++i) {
+		const ir_node *proj = get_irn_out(node, i);
+		if (is_Proj(proj) && get_irn_mode(proj) == mode_M)
+			return true;
+	}
+	return false;
+}
+
+/**
+ * Check whether a memory value is passed on to another memory value in its
+ * own block.
+ */
+static bool is_consumed_in_block(const ir_node *mem, const ir_node *block)
+{
+	for (unsigned i = 0, n = get_irn_n_outs(mem); i < n; ++i) {
+		const ir_node *user = get_irn_out(mem, i);
+		if (is_Phi(user) || is_End(user) || get_nodes_block(user) != block)
+			continue;
+		if (get_irn_mode(user) == mode_M
+		    || (get_irn_mode(user) == mode_T && has_mem_proj(user)))
+			return true;
+	}
+	return false;
+}
+
+/**
+ * Returns the memory value live at the end of a block or NULL if it cannot
+ * be determined.
+ */
+static ir_node *get_block_mem_out(ir_node *block)
+{
+	while (block != NULL) {
+		ir_node *last    = NULL;
+		bool     has_mem = false;
+		for (unsigned i = 0, n = get_irn_n_outs(block); i < n; ++i) {
+			ir_node *node = get_irn_out(block, i);
+			if (is_End(node) || is_NoMem(node) || is_Bad(node)
+			    || get_nodes_block(node) != block
+			    || get_irn_mode(node) != mode_M)
+				continue;
+			has_mem = true;
+			if (is_consumed_in_block(node, block))
+				continue;
+			/* parallel memory chains are not handled */
+			if (last != NULL)
+				return NULL;
+			last = node;
+		}
+		if (last != NULL)
+			return last;
+		if (has_mem)
+			return NULL;
+		block = get_Block_idom(block);
+	}
+	return NULL;
+}
+
+static void classify_node(loop_env_t *env, ir_node *node)
+{
+	switch (get_irn_opcode(node)) {
+	case iro_Load:
+		if (get_Load_volatility(node) == volatility_is_volatile)
+			env->has_clobber = true;
+		else
+			ARR_APP1(ir_node*, env->loads, node);
+		return;
+	case iro_Store:
+		if (get_Store_volatility(node) == volatility_is_volatile)
+			env->has_clobber = true;
+		else
+			ARR_APP1(ir_node*, env->stores, node);
+		return;
+	case iro_Call:
+		env->has_call = true;
+		if (!is_Call_pure(node))
+			env->has_clobber = true;
+		return;
+	case iro_Div:
+	case iro_Mod:
+	case iro_Phi:
+	case iro_Proj:
+	case iro_Sync:
+	case iro_Return:
+	case iro_Sel:
+		/* do not write memory */
+		return;
+	default:
+		for (int i = 0, n = get_irn_arity(node); i < n; ++i) {
+			if (get_irn_mode(get_irn_n(node, i)) == mode_M) {
+				env->has_clobber = true;
+				return;
+			}
+		}
+		return;
+	}
+}
+
+/**
+ * Collects the blocks, the entry, the exits and the memory operations of a
+ * loop.
+ *
+ * @return false if the loop has not exactly one entry edge
+ */
+static bool analyze_loop(loop_env_t *env, const ir_loop *loop)
+{
+	collect_blocks(env, loop);
+
+	env->header = NULL;
+	for (size_t b = 0, n_blocks = ARR_LEN(env->block_list); b < n_blocks; ++b) {
+		ir_node *block = env->block_list[b];
+		for (int i = 0, n = get_Block_n_cfgpreds(block); i < n; ++i) {
+			ir_node *pred = get_Block_cfgpred_block(block, i);
+			if (is_Bad(pred) || is_loop_block(env, pred))
+				continue;
+			if (env->header != NULL)
+				return false;
+			env->header    = block;
+			env->entry_pos = i;
+		}
+	}
+	if (env->header == NULL)
+		return false;
+
+	env->dedicated_exits = true;
+	for (size_t b = 0, n_blocks = ARR_LEN(env->block_list); b < n_blocks; ++b) {
+		ir_node *block = env->block_list[b];
+		for (unsigned i = 0, n = get_Block_n_cfg_outs(block); i < n; ++i) {
+			ir_node *succ = get_Block_cfg_out(block, i);
+			if (is_loop_block(env, succ))
+				continue;
+			if (get_Block_n_cfgpreds(succ) != 1)
+				env->dedicated_exits = false;
+			ARR_APP1(ir_node*, env->exit_blocks, succ);
+		}
+
+		for (unsigned i = 0, n = get_irn_n_outs(block); i < n; ++i) {
+			ir_node *node = get_irn_out(block, i);
+			if (!is_End(node) && get_nodes_block(node) == block)
+				classify_node(env, node);
+		}
+	}
+
+	/* the memory entering the loop */
+	ir_node *header = env->header;
+	env->entry_mem  = NULL;
+	for (unsigned i = 0, n = get_irn_n_outs(header); i < n; ++i) {
+		ir_node *phi = get_irn_out(header, i);
+		if (is_Phi(phi) && get_nodes_block(phi) == header
+		    && get_irn_mode(phi) == mode_M) {
+			env->entry_mem = get_Phi_pred(phi, env->entry_pos);
+			break;
+		}
+	}
+	if (env->entry_mem == NULL)
+		env->entry_mem = get_block_mem_out(get_Block_cfgpred_block(header, env->entry_pos));
+	return true;
+}
+
+/**
+ * Check whether a node computes the same value in every iteration of the
+ * loop and can be moved out of it.
+ */
+static bool is_invariant(const loop_env_t *env, const ir_node *node,
+                         unsigned depth)
+{
+	if (!is_in_loop(env, node))
+		return true;
+	if (depth >= MAX_INVARIANT_DEPTH
+	    || get_irn_pinned(node) != op_pin_state_floats
+	    || is_Phi(node) || is_Proj(node))
+		return false;
+
+	ir_mode *mode = get_irn_mode(node);
+	if (mode == mode_M || mode == mode_X || mode == mode_T)
+		return false;
+
+	for (int i = 0, n = get_irn_arity(node); i < n; ++i) {
+		if (!is_invariant(env, get_irn_n(node, i), depth + 1))
+			return false;
+	}
+	return true;
+}
+
+/**
+ * Moves an invariant node and its operands from the loop into the
+ * preheader.
+ */
+static void make_available(const loop_env_t *env, ir_node *node)
+{
+	if (!is_in_loop(env, node))
+		return;
+
+	set_nodes_block(node, env->preheader);
+	for (int i = 0, n = get_irn_arity(node); i < n; ++i)
+		make_available(env, get_irn_n(node, i));
+}
+
+/**
+ * Returns the preheader of the loop. Without critical edges this is usually
+ * the block entering the loop, otherwise a block is created on the entry
+ * edge.
+ */
+static ir_node *get_preheader(loop_env_t *env)
+{
+	if (env->preheader == NULL) {
+		ir_node *header = env->header;
+		ir_node *pred   = get_Block_cfgpred_block(header, env->entry_pos);
+		if (get_Block_n_cfg_outs(pred) != 1) {
+			ir_node *entry = get_Block_cfgpred(header, env->entry_pos);
+			pred = new_r_Block(env->irg, 1, &entry);
+			set_Block_cfgpred(header, env->entry_pos, new_r_Jmp(pred));
+			DB((dbg, LEVEL_2, "  created preheader %+F for %+F\n", pred, header));
+		}
+		env->preheader = pred;
+	}
+	return env->preheader;
+}
+
+/**
+ * Check whether a block is executed before every exit of the loop.
+ */
+static bool is_always_executed(const loop_env_t *env, const ir_node *block)
+{
+	size_t n_exits = ARR_LEN(env->exit_blocks);
+	for (size_t e = 0; e < n_exits; ++e) {
+		ir_node *exit_block = env->exit_blocks[e];
+		for (int i = 0, n = get_Block_n_cfgpreds(exit_block); i < n; ++i) {
+			ir_node *src = get_Block_cfgpred_block(exit_block, i);
+			if (is_loop_block(env, src) && !block_dominates(block, src))
+				return false;
+		}
+	}
+	return n_exits > 0;
+}
+
+/**
+ * Check whether a Load from an address can never fault.
+ */
+static bool is_safe_address(ir_graph *irg, const ir_node *ptr)
+{
+	if (is_SymConst_addr_ent(ptr)) {
+		ir_entity *ent = get_SymConst_entity(ptr);
+		return (get_entity_linkage(ent) & IR_LINKAGE_WEAK) == 0;
+	}
+	return is_Sel(ptr) && get_Sel_ptr(ptr) == get_irg_frame(irg)
+	    && get_Sel_n_indexs(ptr) == 0;
+}
+
+static ir_mode *get_Store_mode(const ir_node *store)
+{
+	return get_irn_mode(get_Store_value(store));
+}
+
+/**
+ * Moves the Loads reading memory which is not written in the loop into the
+ * preheader.
+ */
+static bool hoist_loads(loop_env_t *env)
+{
+	if (env->has_clobber || env->entry_mem == NULL)
+		return false;
+
+	bool changed = false;
+	for (size_t l = 0, n_loads = ARR_LEN(env->loads); l < n_loads; ++l) {
+		ir_node *load = env->loads[l];
+		ir_node *ptr  = get_Load_ptr(load);
+		ir_mode *mode = get_Load_mode(load);
+
+		if (!is_invariant(env, ptr, 0) || has_exception_flow(load))
+			continue;
+		if (!is_always_executed(env, get_nodes_block(load))
+		    && !is_safe_address(env->irg, ptr))
+			continue;
+
+		bool aliased = false;
+		for (size_t s = 0, n_stores = ARR_LEN(env->stores); s < n_stores; ++s) {
+			ir_node *store = env->stores[s];
+			if (get_alias_relation(ptr, mode, get_Store_ptr(store),
+			                       get_Store_mode(store)) != ir_no_alias) {
+				aliased = true;
+				break;
+			}
+		}
+		if (aliased)
+			continue;
+
+		DB((dbg, LEVEL_1, "  moving %+F out of the loop\n", load));
+		ir_node      *preheader = get_preheader(env);
+		ir_cons_flags flags     = cons_none;
+		if (get_Load_unaligned(load) == align_non_aligned)
+			flags |= cons_unaligned;
+		make_available(env, ptr);
+		ir_node *new_load = new_rd_Load(get_irn_dbg_info(load), preheader,
+		                                env->entry_mem, ptr, mode, flags);
+		ir_node *res      = new_r_Proj(new_load, mode, pn_Load_res);
+
+		for (unsigned i = get_irn_n_outs(load); i-- > 0; ) {
+			ir_node *proj = get_irn_out(load, i);
+			if (!is_Proj(proj))
+				continue;
+			switch (get_Proj_proj(proj)) {
+			case pn_Load_M:   exchange(proj, get_Load_mem(load)); break;
+			case pn_Load_res: exchange(proj, res);                break;
+			default:          break;
+			}
+		}
+		changed = true;
+	}
+	return changed;
+}
+
+/**
+ * Replaces the promoted Loads and Stores by SSA values.
+ */
+static void replace_access(ir_node *node, void *ctx)
+{
+	promote_env_t *env = (promote_env_t*)ctx;
+	if (!ir_nodeset_contains(env->accesses, node))
+		return;
+
+	ir_node  *block = get_nodes_block(node);
+	ir_graph *irg   = get_irn_irg(node);
+	set_r_cur_block(irg, block);
+
+	if (is_Load(node)) {
+		ir_node *val = get_r_value(irg, 0, env->mode);
+		ir_node *const in[] = {
+			[pn_Load_M]         = get_Load_mem(node),
+			[pn_Load_res]       = val,
+			[pn_Load_X_regular] = new_r_Jmp(block),
+			[pn_Load_X_except]  = new_r_Bad(irg, mode_X),
+		};
+		turn_into_tuple(node, ARRAY_SIZE(in), in);
+	} else {
+		set_r_value(irg, 0, get_Store_value(node));
+		ir_node *const in[] = {
+			[pn_Store_M]         = get_Store_mem(node),
+			[pn_Store_X_regular] = new_r_Jmp(block),
+			[pn_Store_X_except]  = new_r_Bad(irg, mode_X),
+		};
+		turn_into_tuple(node, ARRAY_SIZE(in), in);
+	}
+}
+
+/**
+ * Collects the memory users outside the loop which must see the Store
+ * inserted on an exit.
+ *
+ * @return false if a user is not dominated by an exit or an exit has no user
+ */
+static bool collect_exit_uses(const loop_env_t *env, ir_node **exit_mems,
+                              exit_use_t **uses)
+{
+	size_t n_exits = ARR_LEN(env->exit_blocks);
+	for (size_t e = 0; e < n_exits; ++e) {
+		ir_node *mem = exit_mems[e];
+		/* handle users of memory shared by several exits only once */
+		bool     seen = false;
+		for (size_t o = 0; o < e; ++o)
+			seen |= exit_mems[o] == mem;
+		if (seen)
+			continue;
+
+		for (unsigned i = 0, n = get_irn_n_outs(mem); i < n; ++i) {
+			int      pos;
+			ir_node *user = get_irn_out_ex(mem, i, &pos);
+			if (is_End(user))
+				continue;
+
+			/* a Phi uses the memory at the end of its predecessor block,
+			 * unless it is in an exit block */
+			ir_node *use_block = get_nodes_block(user);
+			if (is_Phi(user)) {
+				ir_node *pred = get_Block_cfgpred_block(use_block, pos);
+				if (!is_loop_block(env, pred) || is_loop_block(env, use_block))
+					use_block = pred;
+			}
+			if (is_loop_block(env, use_block))
+				continue;
+
+			size_t x;
+			for (x = 0; x < n_exits; ++x) {
+				if (exit_mems[x] == mem
+				    && block_dominates(env->exit_blocks[x], use_block))
+					break;
+			}
+			if (x == n_exits)
+				return false;
+
+			exit_use_t use = { user, pos, x };
+			ARR_APP1(exit_use_t, *uses, use);
+		}
+	}
+
+	for (size_t e = 0; e < n_exits; ++e) {
+		bool used = false;
+		for (size_t u = 0, n_uses = ARR_LEN(*uses); u < n_uses; ++u)
+			used |= (*uses)[u].exit == e;
+		if (!used)
+			return false;
+	}
+	return true;
+}
+
+/**
+ * Check whether the location at ptr can be promoted and collect the
+ * accesses to it.
+ */
+static bool is_promotable(const loop_env_t *env, ir_node *ptr, ir_mode *mode,
+                          ir_nodeset_t *accesses)
+{
+	bool stored = false;
+	for (size_t l = 0, n_loads = ARR_LEN(env->loads); l < n_loads; ++l) {
+		ir_node *load = env->loads[l];
+		ir_node *lptr = get_Load_ptr(load);
+		ir_mode *lmode = get_Load_mode(load);
+		ir_alias_relation rel = get_alias_relation(ptr, mode, lptr, lmode);
+		if (rel == ir_no_alias)
+			continue;
+		if (rel != ir_sure_alias || lmode != mode || has_exception_flow(load))
+			return false;
+		ir_nodeset_insert(accesses, load);
+	}
+	for (size_t s = 0, n_stores = ARR_LEN(env->stores); s < n_stores; ++s) {
+		ir_node *store  = env->stores[s];
+		ir_node *sptr   = get_Store_ptr(store);
+		ir_mode *smode  = get_Store_mode(store);
+		ir_alias_relation rel = get_alias_relation(ptr, mode, sptr, smode);
+		if (rel == ir_no_alias)
+			continue;
+		if (rel != ir_sure_alias || smode != mode || has_exception_flow(store))
+			return false;
+		ir_nodeset_insert(accesses, store);
+		stored |= is_always_executed(env, get_nodes_block(store));
+	}
+	return stored;
+}
+
+/**
+ * Promotes the location at ptr to a value in the loop.
+ */
+static void promote(loop_env_t *env, ir_node *ptr, ir_mode *mode,
+                    ir_nodeset_t *accesses, ir_node **exit_mems,
+                    const exit_use_t *uses)
+{
+	ir_graph *irg       = env->irg;
+	ir_node  *preheader = get_preheader(env);
+	make_available(env, ptr);
+
+	ir_node *init = new_r_Load(preheader, env->entry_mem, ptr, mode, cons_none);
+	ir_node *val  = new_r_Proj(init, mode, pn_Load_res);
+
+	ssa_cons_start(irg, 1);
+	set_r_cur_block(irg, preheader);
+	set_r_value(irg, 0, val);
+
+	promote_env_t penv = { accesses, mode };
+	irg_walk_blkwise_graph(irg, NULL, replace_access, &penv);
+
+	size_t    n_exits = ARR_LEN(env->exit_blocks);
+	ir_node **exit_ms = ALLOCAN(ir_node*, n_exits);
+	for (size_t e = 0; e < n_exits; ++e) {
+		ir_node *block = env->exit_blocks[e];
+		set_r_cur_block(irg, block);
+		ir_node *value = get_r_value(irg, 0, mode);
+		ir_node *store = new_r_Store(block, exit_mems[e], ptr, value, cons_none);
+		exit_ms[e]     = new_r_Proj(store, mode_M, pn_Store_M);
+	}
+	for (size_t u = 0, n_uses = ARR_LEN(uses); u < n_uses; ++u)
+		set_irn_n(uses[u].user, uses[u].pos, exit_ms[uses[u].exit]);
+
+	ssa_cons_finish(irg);
+}
+
+/**
+ * Promotes one location read and written in the loop to a value.
+ */
+static bool promote_location(loop_env_t *env)
+{
+	if (env->has_clobber || env->has_call || !env->dedicated_exits
+	    || env->entry_mem == NULL || ARR_LEN(env->exit_blocks) == 0)
+		return false;
+
+	size_t    n_exits   = ARR_LEN(env->exit_blocks);
+	ir_node **exit_mems = ALLOCAN(ir_node*, n_exits);
+	for (size_t e = 0; e < n_exits; ++e) {
+		ir_node *src = get_Block_cfgpred_block(env->exit_blocks[e], 0);
+		exit_mems[e] = get_block_mem_out(src);
+		if (exit_mems[e] == NULL)
+			return false;
+	}
+
+	bool changed = false;
+	for (size_t s = 0, n_stores = ARR_LEN(env->stores); s < n_stores; ++s) {
+		ir_node *store = env->stores[s];
+		ir_node *ptr   = get_Store_ptr(store);
+		ir_mode *mode  = get_Store_mode(store);
+		if (!is_invariant(env, ptr, 0))
+			continue;
+
+		ir_nodeset_t accesses;
+		ir_nodeset_init(&accesses);
+		exit_use_t *uses = NEW_ARR_F(exit_use_t, 0);
+		if (is_promotable(env, ptr, mode, &accesses)
+		    && collect_exit_uses(env, exit_mems, &uses)) {
+			DB((dbg, LEVEL_1, "  promoting %+F in loop of %+F\n", ptr,
+			    env->header));
+			promote(env, ptr, mode, &accesses, exit_mems, uses);
+			changed = true;
+		}
+		DEL_ARR_F(uses);
+		ir_nodeset_destroy(&accesses);
+		if (changed)
+			break;
+	}
+	return changed;
+}
+
+/**
+ * Optimizes a single loop.
+ *
+ * @return true if the graph was changed, in this case the loop is visited
+ *         again after the graph information is recomputed
+ */
+static bool optimize_loop(ir_graph *irg, const ir_loop *loop,
+                          ir_nodeset_t *done)
+{
+	loop_env_t env;
+	memset(&env, 0, sizeof(env));
+	env.irg         = irg;
+	env.blocks      = bitset_malloc(get_irg_last_idx(irg));
+	env.block_list  = NEW_ARR_F(ir_node*, 0);
+	env.loads       = NEW_ARR_F(ir_node*, 0);
+	env.stores      = NEW_ARR_F(ir_node*, 0);
+	env.exit_blocks = NEW_ARR_F(ir_node*, 0);
+
+	bool changed = false;
+	if (analyze_loop(&env, loop) && !ir_nodeset_contains(done, env.header)) {
+		DB((dbg, LEVEL_2, "loop of %+F: %zu loads, %zu stores%s\n", env.header,
+		    ARR_LEN(env.loads), ARR_LEN(env.stores),
+		    env.has_clobber ? ", clobbered" : ""));
+		changed = hoist_loads(&env) || promote_location(&env);
+		if (!changed)
+			ir_nodeset_insert(done, env.header);
+	}
+
+	DEL_ARR_F(env.exit_blocks);
+	DEL_ARR_F(env.stores);
+	DEL_ARR_F(env.loads);
+	DEL_ARR_F(env.block_list);
+	free(env.blocks);
+	return changed;
+}
+
+/**
+ * Collects the loops of the loop tree, inner loops first.
+ */
+static void collect_loops(ir_loop *loop, ir_loop ***loops)
+{
+	for (size_t i = 0, n = get_loop_n_elements(loop); i < n; ++i) {
+		loop_element elem = get_loop_element(loop, i);
+		if (*elem.kind == k_ir_loop)
+			collect_loops(elem.son, loops);
+	}
+	ARR_APP1(ir_loop*, *loops, loop);
+}
+
+void opt_licm(ir_graph *irg)
+{
+	FIRM_DBG_REGISTER(dbg, "firm.opt.licm");
+	DB((dbg, LEVEL_1, "\nDoing loop invariant code motion on %+F\n", irg));
+
+	ir_nodeset_t done;
+	ir_nodeset_init(&done);
+
+	bool changed = false;
+	for (;;) {
+		assure_irg_properties(irg,
+			IR_GRAPH_PROPERTY_NO_CRITICAL_EDGES
+			| IR_GRAPH_PROPERTY_NO_UNREACHABLE_CODE
+			| IR_GRAPH_PROPERTY_CONSISTENT_OUTS
+			| IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE
+			| IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO);
+
+		ir_loop **loops = NEW_ARR_F(ir_loop*, 0);
+		ir_loop  *root  = get_irg_loop(irg);
+		for (size_t i = 0, n = get_loop_n_elements(root); i < n; ++i) {
+			loop_element elem = get_loop_element(root, i);
+			if (*elem.kind == k_ir_loop)
+				collect_loops(elem.son, &loops);
+		}
+
+		bool round_changed = false;
+		for (size_t i = 0, n = ARR_LEN(loops); i < n && !round_changed; ++i)
+			round_changed = optimize_loop(irg, loops[i], &done);
+		DEL_ARR_F(loops);
+
+		if (!round_changed)
+			break;
+		changed = true;
+		confirm_irg_properties(irg, IR_GRAPH_PROPERTIES_NONE);
+	}
+	ir_nodeset_destroy(&done);
+
+	if (changed)
+		remove_tuples(irg);
+	confirm_irg_properties(irg, changed ? IR_GRAPH_PROPERTIES_NONE
+	                                    : IR_GRAPH_PROPERTIES_ALL);
+}
+
+ir_graph_pass_t *opt_licm_pass(const char *name)
+{
+	return def_graph_pass(name ? name : "licm", opt_licm);
+}
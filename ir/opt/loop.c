@@ -28,6 +28,9 @@
 #include "beutil.h"
 #include "irpass.h"
 #include "irdom.h"
+#include "be.h"
+#include "pmap.h"
+#include "statev_t.h"
 
 #include <math.h>
 #include "irbackedge_t.h"
@@ -53,7 +56,8 @@ static ir_loop *cur_loop;
 /* Flag for kind of unrolling. */
 typedef enum {
 	constant,
-	invariant
+	invariant,
+	epilogue
 } unrolling_kind_flag;
 
 /* Condition for performing visiting a node during copy_walk. */
@@ -93,6 +97,7 @@ typedef struct loop_stats_t {
 	unsigned u_simple_counting_loop;
 	unsigned constant_unroll;
 	unsigned invariant_unroll;
+	unsigned epilogue_unroll;
 
 	unsigned unhandled;
 } loop_stats_t;
@@ -118,6 +123,7 @@ static void print_stats(void)
 	DB((dbg, LEVEL_2, "u_simple_counting :   %d\n",stats.u_simple_counting_loop));
 	DB((dbg, LEVEL_2, "constant_unroll   :   %d\n",stats.constant_unroll));
 	DB((dbg, LEVEL_2, "invariant_unroll  :   %d\n",stats.invariant_unroll));
+	DB((dbg, LEVEL_2, "epilogue_unroll   :   %d\n",stats.epilogue_unroll));
 	DB((dbg, LEVEL_2, "=======================================\n"));
 }
 
@@ -136,6 +142,8 @@ unsigned max_unrolled_loop_size;    /* [nodes] */
 bool     allow_const_unrolling;
 bool     allow_invar_unrolling;
 unsigned invar_unrolling_min_size;  /* [nodes] */
+bool     allow_epilogue_unrolling;
+unsigned unroll_factor;             /* Factor for runtime trip counts */
 
 } loop_opt_params_t;
 
@@ -171,7 +179,11 @@ typedef struct loop_info_t {
 	ir_tarval *count_tar;               /* Number of loop iterations */
 
 	ir_node *duff_cond;                 /* Duff mod */
-	unrolling_kind_flag unroll_kind;    /* constant or invariant unrolling */
+	unrolling_kind_flag unroll_kind;    /* constant, invariant or epilogue unrolling */
+
+	/* for unrolling with epilogue loop */
+	ir_relation stay_relation;          /* iv stay_relation end_val stays in the loop */
+	ir_tarval  *span_tar;               /* (unroll_nr - 1) * |step| unsigned */
 } loop_info_t;
 
 /* Information about the current loop */
@@ -477,7 +489,8 @@ static void set_unroll_copy(ir_node *n, int nr, ir_node *cp)
 
 	info = ir_nodemap_get(unrolling_node_info, &map, n);
 	if (! info) {
-		ir_node **const arr = NEW_ARR_DZ(ir_node*, &obst, unroll_nr);
+		/* One more slot for the copy forming the epilogue loop. */
+		ir_node **const arr = NEW_ARR_DZ(ir_node*, &obst, unroll_nr + 1);
 
 		info = OALLOCZ(&obst, unrolling_node_info);
 		info->copies = arr;
@@ -1578,7 +1591,7 @@ static ir_node *clone_block_sans_bes(ir_node *node, ir_node *be_block)
 		}
 	}
 
-	return new_Block(c, ins);
+	return new_r_Block(get_irn_irg(node), c, ins);
 }
 
 /* Creates a structure to calculate absolute value of node op.
@@ -1596,6 +1609,193 @@ static ir_node *new_Abs(ir_node *op, ir_mode *mode)
 }
 
 
+/* Returns the copy nr of node, or node itself if it is not defined in the loop. */
+static ir_node *get_unroll_copy_or_self(ir_node *node, int nr)
+{
+	if (! is_in_loop(node))
+		return node;
+	return get_unroll_copy(node, nr);
+}
+
+/* Creates the runtime trip count check for unrolling with epilogue loop.
+ * The unrolled loop may be (re-)entered with iv, if iv stays in the loop
+ * and the distance of iv and end exceeds (unroll_nr - 1) * |step|.
+ * The first check is omitted if with_stay is not set. */
+static ir_node *new_epilogue_check(ir_node *block, ir_node *iv, ir_node *end,
+                                   bool with_stay)
+{
+	ir_graph   *irg      = get_irn_irg(block);
+	ir_mode    *umode    = get_tarval_mode(loop_info.span_tar);
+	ir_node    *iv_u     = new_r_Conv(block, iv, umode);
+	ir_node    *end_u    = new_r_Conv(block, end, umode);
+	ir_node    *span     = new_r_Const(irg, loop_info.span_tar);
+	ir_relation relation = loop_info.stay_relation & ir_relation_equal
+		? ir_relation_greater_equal : ir_relation_greater;
+	ir_node    *dist, *check;
+
+	/* The distance is exact in the unsigned mode, if iv stays in the loop. */
+	if (loop_info.decreasing)
+		dist = new_r_Sub(block, iv_u, end_u, umode);
+	else
+		dist = new_r_Sub(block, end_u, iv_u, umode);
+
+	check = new_r_Cmp(block, dist, span, relation);
+	if (with_stay) {
+		ir_node *stay = new_r_Cmp(block, iv, end, loop_info.stay_relation);
+		check = new_r_And(block, stay, check, mode_b);
+	}
+	return check;
+}
+
+/* Unrolling with epilogue loop: Rewire floating copies.
+ * The copies 0 to unroll_nr - 1 are lined up to the unrolled loop,
+ * which is entered and repeated only if the runtime check guarantees
+ * unroll_nr more iterations. Otherwise copy unroll_nr, the epilogue loop,
+ * does the remaining iterations. Both loops leave through a new join block.
+ *
+ *        PreHead
+ *        |     \
+ *        |  Loop 0..n-1 <-.
+ *        |     |    \     |
+ *        |     |    Check-'
+ *        |     |      |
+ *        |     |  Epilogue <-.
+ *        |     |      |  `---'
+ *        |     `---.  |
+ *        `---------Join
+ */
+static void place_copies_epilogue(void)
+{
+	ir_graph *irg        = current_ir_graph;
+	int       be_src_pos = loop_info.be_src_pos;
+	int       last       = unroll_nr - 1;
+	ir_node  *be_pred    = get_irn_n(loop_head, be_src_pos);
+	ir_node  *tail       = get_nodes_block(be_pred);
+	ir_node  *epi_head   = get_unroll_copy(loop_head, unroll_nr);
+	ir_node  *exit_pred  = loop_info.cf_out.pred;
+	ir_node  *end_val    = loop_info.end_val;
+	ir_node  *pre_head, *pre_cond, *pre_enter, *pre_skip;
+	ir_node  *check_block, *check_cond, *check_loop, *check_leave;
+	ir_node  *join, *stay, *phi;
+	ir_node  *ins[3];
+	pmap     *join_phis;
+	size_t    i;
+	int       c;
+
+	/* Serialize the copies of the unrolled loop. */
+	for (c = 0; c < last; ++c) {
+		ir_node *lower   = get_unroll_copy(loop_head, c + 1);
+		ir_node *new_jmp = new_r_Jmp(get_unroll_copy(tail, c));
+
+		ins[0] = new_jmp;
+		set_irn_in(lower, 1, ins);
+
+		for_each_phi(loop_head, phi) {
+			ir_node *def       = get_irn_n(phi, be_src_pos);
+			ir_node *lower_phi = get_unroll_copy(phi, c + 1);
+
+			if (lower_phi == NULL)
+				continue;
+			ins[0] = get_unroll_copy_or_self(def, c);
+			set_irn_in(lower_phi, 1, ins);
+			/* Need to replace phis with 1 in later. */
+		}
+	}
+
+	/* The pre-head checks if the unrolled loop is entered at all. */
+	pre_head = clone_block_sans_bes(loop_head, loop_head);
+	for_each_phi(loop_head, phi) {
+		clone_phis_sans_bes(phi, loop_head, pre_head);
+	}
+	if (is_in_loop(end_val))
+		end_val = (ir_node*)get_irn_link(end_val);
+
+	pre_cond  = new_r_Cond(pre_head, new_epilogue_check(pre_head,
+		(ir_node*)get_irn_link(loop_info.iteration_phi), end_val, true));
+	pre_enter = new_r_Proj(pre_cond, mode_X, pn_Cond_true);
+	pre_skip  = new_r_Proj(pre_cond, mode_X, pn_Cond_false);
+
+	/* The last copy stays in the loop, if the original condition holds
+	 * and the check guarantees another unroll_nr iterations. */
+	stay        = get_unroll_copy(be_pred, last);
+	check_block = new_r_Block(irg, 1, &stay);
+	check_cond  = new_r_Cond(check_block, new_epilogue_check(check_block,
+		get_unroll_copy(loop_info.add, last),
+		get_unroll_copy_or_self(loop_info.end_val, last), false));
+	check_loop  = new_r_Proj(check_cond, mode_X, pn_Cond_true);
+	check_leave = new_r_Proj(check_cond, mode_X, pn_Cond_false);
+
+	DB((dbg, LEVEL_4, "Epilogue loop %N entered by pre-head %N and check %N\n",
+	    epi_head, pre_head, check_block));
+
+	/* Epilogue loop is entered from the pre-head and after the unrolled loop.
+	 * Done before fixing the loop head, as its ins are needed. */
+	ins[0] = pre_skip;
+	ins[1] = check_leave;
+	ins[2] = get_unroll_copy(be_pred, unroll_nr);
+	set_irn_in(epi_head, 3, ins);
+	set_backedge(epi_head, 2);
+
+	for_each_phi(loop_head, phi) {
+		ir_node *def     = get_irn_n(phi, be_src_pos);
+		ir_node *epi_phi = get_unroll_copy(phi, unroll_nr);
+
+		if (epi_phi == NULL)
+			continue;
+		ins[0] = (ir_node*)get_irn_link(phi);
+		ins[1] = get_unroll_copy_or_self(def, last);
+		ins[2] = get_unroll_copy_or_self(def, unroll_nr);
+		set_irn_in(epi_phi, 3, ins);
+		set_backedge(epi_phi, 2);
+	}
+
+	/* Fix original loops head. */
+	ins[0] = pre_enter;
+	ins[1] = check_loop;
+	set_irn_in(loop_head, 2, ins);
+	set_backedge(loop_head, 1);
+
+	for_each_phi(loop_head, phi) {
+		ir_node *def = get_irn_n(phi, be_src_pos);
+
+		ins[0] = (ir_node*)get_irn_link(phi);
+		ins[1] = get_unroll_copy_or_self(def, last);
+		set_irn_in(phi, 2, ins);
+		set_backedge(phi, 1);
+	}
+	loop_info.be_src_pos = 1;
+
+	/* Both loops leave through the join block.
+	 * Values used after the loop need a phi there. */
+	ins[0] = get_unroll_copy(exit_pred, last);
+	ins[1] = get_unroll_copy(exit_pred, unroll_nr);
+	join   = new_r_Block(irg, 2, ins);
+
+	join_phis = pmap_create();
+	for (i = 0; i < ARR_LEN(loop_entries); ++i) {
+		entry_edge edge = loop_entries[i];
+		ir_node   *join_phi;
+
+		if (is_Block(edge.node)) {
+			set_irn_n(edge.node, edge.pos, new_r_Jmp(join));
+			continue;
+		}
+		/* Keep alive edges stay with the original nodes. */
+		if (is_End(edge.node))
+			continue;
+
+		join_phi = pmap_get(ir_node, join_phis, edge.pred);
+		if (join_phi == NULL) {
+			ins[0]   = get_unroll_copy(edge.pred, last);
+			ins[1]   = get_unroll_copy(edge.pred, unroll_nr);
+			join_phi = new_r_Phi(join, 2, ins, get_irn_mode(edge.pred));
+			pmap_insert(join_phis, edge.pred, join_phi);
+		}
+		set_irn_n(edge.node, edge.pos, join_phi);
+	}
+	pmap_destroy(join_phis);
+}
+
 /* Creates blocks for duffs device, using previously obtained
  * informations about the iv.
  * TODO split */
@@ -2177,6 +2377,102 @@ static unsigned get_unroll_decision_invariant(void)
 	return loop_info.max_unroll;
 }
 
+/* Checks if cur_loop is a simple tail-controlled counting loop
+ * with loop invariant end value and constant step, whose condition
+ * compares the latest iv value against the end value by <, <=, > or >=.
+ * Returns the unroll factor for unrolling with runtime trip count check
+ * and epilogue loop. */
+static unsigned get_unroll_decision_epilogue(void)
+{
+	ir_node     *cmp, *iteration_path, *iteration_phi;
+	ir_tarval   *step_tar, *factor_tar, *span_tar;
+	ir_relation  relation;
+	ir_mode     *mode, *umode;
+	unsigned     factor;
+
+	/* RETURN if loop is not 'simple' */
+	cmp = is_simple_loop();
+	if (cmp == NULL)
+		return 0;
+
+	if (! get_invariant_pred(cmp, &loop_info.end_val, &iteration_path))
+		return 0;
+
+	/* The condition has to use the latest value of the iv. */
+	if (! is_Add(iteration_path) && ! is_Sub(iteration_path))
+		return 0;
+
+	loop_info.add = iteration_path;
+	if (! get_const_pred(loop_info.add, &loop_info.step, &iteration_phi))
+		return 0;
+
+	if (! is_Const(loop_info.step) || ! is_Phi(iteration_phi)
+	    || get_nodes_block(iteration_phi) != loop_head)
+		return 0;
+
+	/* step - iv is no iv */
+	if (is_Sub(loop_info.add) && get_Sub_right(loop_info.add) != loop_info.step)
+		return 0;
+
+	loop_info.iteration_phi = iteration_phi;
+	if (! get_start_and_add(iteration_phi, epilogue)
+	    || loop_info.add != iteration_path)
+		return 0;
+
+	DB((dbg, LEVEL_4, "start %N, end %N, step %N\n",
+	    loop_info.start_val, loop_info.end_val, loop_info.step));
+
+	mode = get_irn_mode(loop_info.end_val);
+	if (! are_mode_I(loop_info.start_val, loop_info.step, loop_info.end_val))
+		return 0;
+
+	step_tar = get_Const_tarval(loop_info.step);
+	if (tarval_is_null(step_tar) || step_tar == get_mode_min(mode))
+		return 0;
+
+	loop_info.decreasing = is_Sub(loop_info.add) ^ tarval_is_negative(step_tar);
+	if (tarval_is_negative(step_tar))
+		step_tar = tarval_neg(step_tar);
+
+	/* Normalize to: iv relation end_val stays in the loop. */
+	relation = get_Cmp_relation(cmp);
+	if (loop_info.exit_cond)
+		relation = get_negated_relation(relation);
+	if (get_Cmp_left(cmp) == loop_info.end_val)
+		relation = get_inversed_relation(relation);
+	relation &= ~ir_relation_unordered;
+
+	if (loop_info.decreasing) {
+		if (relation != ir_relation_greater && relation != ir_relation_greater_equal)
+			return 0;
+	} else {
+		if (relation != ir_relation_less && relation != ir_relation_less_equal)
+			return 0;
+	}
+	loop_info.stay_relation = relation;
+
+	/* The epilogue loop is another copy of the loop. */
+	factor = opt_params.unroll_factor;
+	if (factor > loop_info.max_unroll - 1)
+		factor = loop_info.max_unroll - 1;
+	if (factor < 2)
+		return 0;
+
+	/* The check has to compare against (factor - 1) * |step|. */
+	umode      = find_unsigned_mode(mode);
+	step_tar   = tarval_convert_to(step_tar, umode);
+	factor_tar = new_tarval_from_long(factor - 1, umode);
+	span_tar   = tarval_mul(factor_tar, step_tar);
+	if (span_tar == tarval_bad || tarval_div(span_tar, factor_tar) != step_tar)
+		return 0;
+	loop_info.span_tar = span_tar;
+
+	DB((dbg, LEVEL_4, "epilogue unrolling by %u, iv %s end\n",
+	    factor, get_relation_string(relation)));
+
+	return factor;
+}
+
 /* Returns unroll factor,
  * given maximum unroll factor and number of loop passes. */
 static unsigned get_preferred_factor_constant(ir_tarval *count_tar)
@@ -2501,15 +2797,38 @@ static void unroll_loop(void)
 		loop_info.unroll_kind = constant;
 
 	} else {
-		/* invariant case? */
-		if (opt_params.allow_invar_unrolling)
-			unroll_nr = get_unroll_decision_invariant();
-		if (unroll_nr > 1)
-			loop_info.unroll_kind = invariant;
+		/* runtime trip count, unrolled loop with epilogue? */
+		if (opt_params.allow_epilogue_unrolling)
+			unroll_nr = get_unroll_decision_epilogue();
+		if (unroll_nr > 1) {
+			loop_info.unroll_kind = epilogue;
+		} else {
+			/* invariant case, duffs device? */
+			if (opt_params.allow_invar_unrolling)
+				unroll_nr = get_unroll_decision_invariant();
+			if (unroll_nr > 1)
+				loop_info.unroll_kind = invariant;
+		}
 	}
 
 	DB((dbg, LEVEL_2, " *** Unrolling %d times ***\n", unroll_nr));
 
+	if (stat_ev_enabled) {
+		static const char *const kind_names[] = { "constant", "invariant", "epilogue" };
+
+		stat_ev_ctx_push_fmt("loop", "%ld", get_loop_loop_nr(cur_loop));
+		stat_ev_int("loop_nodes", loop_info.nodes);
+		stat_ev_int("loop_unroll_factor", unroll_nr > 1 ? unroll_nr : 1);
+		if (unroll_nr > 1) {
+			stat_ev_ctx_push_str("loop_unroll_kind", kind_names[loop_info.unroll_kind]);
+			/* copies including the epilogue loop */
+			stat_ev_int("loop_unrolled_nodes", loop_info.nodes
+				* (loop_info.unroll_kind == epilogue ? unroll_nr + 1 : unroll_nr));
+			stat_ev_ctx_pop("loop_unroll_kind");
+		}
+		stat_ev_ctx_pop("loop");
+	}
+
 	if (unroll_nr > 1) {
 		loop_entries = NEW_ARR_F(entry_edge, 0);
 
@@ -2529,11 +2848,19 @@ static void unroll_loop(void)
 		ir_nodemap_init(&map, current_ir_graph);
 		obstack_init(&obst);
 
-		/* Copies the loop */
-		copy_loop(loop_entries, unroll_nr - 1);
+		if (loop_info.unroll_kind == epilogue) {
+			/* Copies the loop, the last copy is the epilogue loop */
+			copy_loop(loop_entries, unroll_nr);
 
-		/* Line up the floating copies. */
-		place_copies(unroll_nr - 1);
+			/* Line up the floating copies, create checks and epilogue. */
+			place_copies_epilogue();
+		} else {
+			/* Copies the loop */
+			copy_loop(loop_entries, unroll_nr - 1);
+
+			/* Line up the floating copies. */
+			place_copies(unroll_nr - 1);
+		}
 
 		/* Remove phis with 1 in
 		 * If there were no nested phis, this would not be necessary.
@@ -2543,6 +2870,8 @@ static void unroll_loop(void)
 
 		if (loop_info.unroll_kind == constant)
 			++stats.constant_unroll;
+		else if (loop_info.unroll_kind == epilogue)
+			++stats.epilogue_unroll;
 		else
 			++stats.invariant_unroll;
 
@@ -2641,6 +2970,13 @@ static void set_loop_params(void)
     opt_params.invar_unrolling_min_size = 20;
     opt_params.max_unrolled_loop_size = 400;
     opt_params.max_branches = 9999;
+
+    /* Runtime trip counts are handled by an epilogue loop,
+     * unrolled by the factor preferred by the target. */
+    opt_params.allow_epilogue_unrolling = true;
+    opt_params.unroll_factor = be_get_backend_param()->loop_unroll_factor;
+    if (opt_params.unroll_factor == 0)
+        opt_params.unroll_factor = 2;
 }
 
 /* Assure preconditions are met and go through all loops. */
@@ -0,0 +1,866 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Loop idiom recognition: replaces loops which set or copy memory
+ *          by calls to memset(), memcpy() or memmove().
+ *
+ * A loop is replaced if its only memory operations are a Store, or a Load
+ * and a Store of the loaded value, whose addresses advance by the size of
+ * the accessed mode in every iteration. The number of iterations must follow
+ * from a comparison of an induction variable with a loop invariant value and
+ * no value computed in the loop may be used after it.
+ *
+ * A copy becomes memcpy() if source and destination lie in different global
+ * or local entities. If both are constant offsets from the same address and
+ * the destination does not start behind the source, the forward copy of the
+ * loop equals memmove(). Copies of a small constant size
+ * become a CopyB node instead, which lower_CopyB() expands into wide moves.
+ * Loops setting a small constant number of bytes are left alone.
+ */
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "iroptimize.h"
+#include "irnode_t.h"
+#include "irgraph_t.h"
+#include "ircons_t.h"
+#include "irgmod.h"
+#include "irgopt.h"
+#include "irgwalk.h"
+#include "irdom.h"
+#include "irloop_t.h"
+#include "irnodeset.h"
+#include "irouts.h"
+#include "irpass.h"
+#include "irtools.h"
+#include "tv.h"
+#include "array_t.h"
+#include "bitset.h"
+#include "debug.h"
+
+DEBUG_ONLY(static firm_dbg_module_t *dbg;)
+
+/** Maximum depth of the address and exit condition computations. */
+#define MAX_EXPR_DEPTH 8
+/** Copies of a constant size up to this number of bytes become a CopyB. */
+#define MAX_COPYB_BYTES 128
+/** Loops setting a constant number of bytes below this are left alone. */
+#define MIN_MEMSET_BYTES 32
+
+/** A user outside of the loop of memory produced in the loop. */
+typedef struct exit_use_t {
+	ir_node *user;  /**< the user of the memory leaving the loop */
+	int      pos;   /**< the input position of the memory */
+} exit_use_t;
+
+/** Information about the loop currently analyzed. */
+typedef struct idiom_env_t {
+	ir_graph   *irg;
+	bitset_t   *blocks;     /**< the blocks of the loop */
+	ir_node   **block_list; /**< the blocks of the loop as list */
+	ir_node    *header;     /**< the loop header */
+	int         entry_pos;  /**< the header input entering the loop */
+	ir_node    *latch;      /**< the block jumping back to the header */
+	ir_node    *entry_mem;  /**< the memory entering the loop */
+	ir_node    *exit_proj;  /**< the Cond Proj leaving the loop */
+	ir_node    *exit_block; /**< the block the loop exits to */
+	int         exit_pos;   /**< the input of exit_block leaving the loop */
+	ir_node    *load;       /**< the Load of a copy loop */
+	ir_node    *store;      /**< the Store of the loop */
+	exit_use_t *exit_uses;  /**< the memory users after the loop */
+	ir_node    *preheader;  /**< the preheader, created on demand */
+} idiom_env_t;
+
+static bool is_loop_block(const idiom_env_t *env, const ir_node *block)
+{
+	unsigned idx = get_irn_idx(block);
+	return idx < bitset_size(env->blocks) && bitset_is_set(env->blocks, idx);
+}
+
+static bool is_in_loop(const idiom_env_t *env, const ir_node *node)
+{
+	return is_loop_block(env, get_nodes_block(node));
+}
+
+static void collect_blocks(idiom_env_t *env, const ir_loop *loop)
+{
+	for (size_t i = 0, n = get_loop_n_elements(loop); i < n; ++i) {
+		loop_element elem = get_loop_element(loop, i);
+		if (*elem.kind == k_ir_loop) {
+			collect_blocks(env, elem.son);
+		} else if (is_Block(elem.node)) {
+			bitset_set(env->blocks, get_irn_idx(elem.node));
+			ARR_APP1(ir_node*, env->block_list, elem.node);
+		}
+	}
+}
+
+/**
+ * Check whether a memory operation has exception control flow.
+ */
+static bool has_exception_flow(const ir_node *node)
+{
+	for (unsigned i = 0, n = get_irn_n_outs(node); i < n; ++i) {
+		const ir_node *proj = get_irn_out(node, i);
+		if (is_Proj(proj) && get_irn_mode(proj) == mode_X)
+			return true;
+	}
+	return false;
+}
+
+/**
+ * Checks a node of the loop: the only memory operations allowed are a Load
+ * and a Store, and only memory may be used after the loop.
+ */
+static bool check_node(idiom_env_t *env, ir_node *node)
+{
+	switch (get_irn_opcode(node)) {
+	case iro_Load:
+		if (env->load != NULL || has_exception_flow(node)
+		    || get_Load_volatility(node) == volatility_is_volatile)
+			return false;
+		env->load = node;
+		break;
+	case iro_Store:
+		if (env->store != NULL || has_exception_flow(node)
+		    || get_Store_volatility(node) == volatility_is_volatile)
+			return false;
+		env->store = node;
+		break;
+	case iro_Phi:
+	case iro_Proj:
+	case iro_Cond:
+	case iro_Jmp:
+		break;
+	default:
+		for (int i = 0, n = get_irn_arity(node); i < n; ++i) {
+			if (get_irn_mode(get_irn_n(node, i)) == mode_M)
+				return false;
+		}
+		break;
+	}
+
+	ir_mode *mode = get_irn_mode(node);
+	for (unsigned i = 0, n = get_irn_n_outs(node); i < n; ++i) {
+		ir_node *user = get_irn_out(node, i);
+		if (is_End(user) || mode == mode_X || is_in_loop(env, user))
+			continue;
+		if (mode != mode_M)
+			return false;
+		for (int p = 0, arity = get_irn_arity(user); p < arity; ++p) {
+			if (get_irn_n(user, p) == node) {
+				exit_use_t use = { user, p };
+				ARR_APP1(exit_use_t, env->exit_uses, use);
+			}
+		}
+	}
+	return true;
+}
+
+/**
+ * Collects the blocks, the entry, the exit and the memory operations of a
+ * loop.
+ *
+ * @return false if the loop does not have the form of a loop idiom
+ */
+static bool analyze_loop(idiom_env_t *env, const ir_loop *loop)
+{
+	collect_blocks(env, loop);
+
+	env->header = NULL;
+	for (size_t b = 0, n_blocks = ARR_LEN(env->block_list); b < n_blocks; ++b) {
+		ir_node *block = env->block_list[b];
+		for (int i = 0, n = get_Block_n_cfgpreds(block); i < n; ++i) {
+			ir_node *pred = get_Block_cfgpred_block(block, i);
+			if (is_Bad(pred) || is_loop_block(env, pred))
+				continue;
+			if (env->header != NULL)
+				return false;
+			env->header    = block;
+			env->entry_pos = i;
+		}
+	}
+	if (env->header == NULL || get_Block_n_cfgpreds(env->header) != 2)
+		return false;
+	env->latch = get_Block_cfgpred_block(env->header, 1 - env->entry_pos);
+
+	env->exit_block = NULL;
+	for (size_t b = 0, n_blocks = ARR_LEN(env->block_list); b < n_blocks; ++b) {
+		ir_node *block = env->block_list[b];
+		for (unsigned i = 0, n = get_Block_n_cfg_outs(block); i < n; ++i) {
+			ir_node *succ = get_Block_cfg_out(block, i);
+			if (is_loop_block(env, succ))
+				continue;
+			if (env->exit_block != NULL)
+				return false;
+			env->exit_block = succ;
+		}
+
+		for (unsigned i = 0, n = get_irn_n_outs(block); i < n; ++i) {
+			ir_node *node = get_irn_out(block, i);
+			if (!is_End(node) && get_nodes_block(node) == block
+			    && !check_node(env, node))
+				return false;
+		}
+	}
+	if (env->exit_block == NULL || env->store == NULL)
+		return false;
+
+	ir_node *exit_block = env->exit_block;
+	for (int i = 0, n = get_Block_n_cfgpreds(exit_block); i < n; ++i) {
+		if (is_loop_block(env, get_Block_cfgpred_block(exit_block, i))) {
+			env->exit_pos  = i;
+			env->exit_proj = get_Block_cfgpred(exit_block, i);
+		}
+	}
+	ir_node *exit_proj = env->exit_proj;
+	if (!is_Proj(exit_proj) || !is_Cond(get_Proj_pred(exit_proj)))
+		return false;
+	ir_node *exiting = get_nodes_block(exit_proj);
+	if (exiting != env->header && exiting != env->latch)
+		return false;
+
+	/* the Store must be executed in every iteration */
+	if (!block_dominates(get_nodes_block(env->store), env->latch))
+		return false;
+
+	/* the memory entering the loop */
+	ir_node *header = env->header;
+	env->entry_mem  = NULL;
+	for (unsigned i = 0, n = get_irn_n_outs(header); i < n; ++i) {
+		ir_node *phi = get_irn_out(header, i);
+		if (is_Phi(phi) && get_nodes_block(phi) == header
+		    && get_irn_mode(phi) == mode_M) {
+			if (env->entry_mem != NULL)
+				return false;
+			env->entry_mem = get_Phi_pred(phi, env->entry_pos);
+		}
+	}
+	return env->entry_mem != NULL;
+}
+
+/**
+ * Check whether a Phi of the loop header is an induction variable changed by
+ * a constant in every iteration.
+ */
+static bool get_iv_step(const idiom_env_t *env, const ir_node *phi, long *step)
+{
+	if (get_nodes_block(phi) != env->header)
+		return false;
+
+	ir_node *next = get_Phi_pred(phi, 1 - env->entry_pos);
+	ir_node *inc;
+	bool     negate = false;
+	if (is_Add(next) && get_Add_left(next) == phi) {
+		inc = get_Add_right(next);
+	} else if (is_Add(next) && get_Add_right(next) == phi) {
+		inc = get_Add_left(next);
+	} else if (is_Sub(next) && get_Sub_left(next) == phi) {
+		inc    = get_Sub_right(next);
+		negate = true;
+	} else {
+		return false;
+	}
+	if (!is_Const(inc) || !tarval_is_long(get_Const_tarval(inc)))
+		return false;
+
+	*step = get_tarval_long(get_Const_tarval(inc));
+	if (negate)
+		*step = -*step;
+	return *step != 0;
+}
+
+static bool get_const_long(const ir_node *node, long *value)
+{
+	if (!is_Const(node) || !tarval_is_long(get_Const_tarval(node)))
+		return false;
+	*value = get_tarval_long(get_Const_tarval(node));
+	return true;
+}
+
+/**
+ * Computes by how much a value changes from one iteration of the loop to the
+ * next one.
+ *
+ * @return false if the change is not constant
+ */
+static bool get_stride(const idiom_env_t *env, const ir_node *node,
+                       long *stride, unsigned depth)
+{
+	if (!is_in_loop(env, node) || is_Const(node)) {
+		*stride = 0;
+		return true;
+	}
+	if (depth >= MAX_EXPR_DEPTH)
+		return false;
+
+	long left;
+	long right;
+	long value;
+	switch (get_irn_opcode(node)) {
+	case iro_Phi:
+		return get_iv_step(env, node, stride);
+	case iro_Add:
+		if (!get_stride(env, get_Add_left(node), &left, depth + 1)
+		    || !get_stride(env, get_Add_right(node), &right, depth + 1))
+			return false;
+		*stride = left + right;
+		return true;
+	case iro_Sub:
+		if (!get_stride(env, get_Sub_left(node), &left, depth + 1)
+		    || !get_stride(env, get_Sub_right(node), &right, depth + 1))
+			return false;
+		*stride = left - right;
+		return true;
+	case iro_Minus:
+		if (!get_stride(env, get_Minus_op(node), &left, depth + 1))
+			return false;
+		*stride = -left;
+		return true;
+	case iro_Mul:
+		if (get_const_long(get_Mul_right(node), &value)) {
+			if (!get_stride(env, get_Mul_left(node), &left, depth + 1))
+				return false;
+		} else if (get_const_long(get_Mul_left(node), &value)) {
+			if (!get_stride(env, get_Mul_right(node), &left, depth + 1))
+				return false;
+		} else {
+			return false;
+		}
+		*stride = left * value;
+		return true;
+	case iro_Shl:
+		if (!get_const_long(get_Shl_right(node), &value)
+		    || value < 0 || value >= 32
+		    || !get_stride(env, get_Shl_left(node), &left, depth + 1))
+			return false;
+		*stride = left * (1L << value);
+		return true;
+	case iro_Conv: {
+		const ir_node *op      = get_Conv_op(node);
+		ir_mode       *op_mode = get_irn_mode(op);
+		ir_mode       *mode    = get_irn_mode(node);
+		if (!mode_is_int(op_mode) && !mode_is_reference(op_mode))
+			return false;
+		if (!mode_is_int(mode) && !mode_is_reference(mode))
+			return false;
+		if (get_mode_size_bits(mode) < get_mode_size_bits(op_mode))
+			return false;
+		return get_stride(env, op, stride, depth + 1);
+	}
+	default:
+		return false;
+	}
+}
+
+/**
+ * Returns the preheader of the loop, a block is created on the entry edge
+ * if the block entering the loop has other successors.
+ */
+static ir_node *get_preheader(idiom_env_t *env)
+{
+	if (env->preheader == NULL) {
+		ir_node *header = env->header;
+		ir_node *pred   = get_Block_cfgpred_block(header, env->entry_pos);
+		if (get_Block_n_cfg_outs(pred) != 1) {
+			ir_node *entry = get_Block_cfgpred(header, env->entry_pos);
+			pred = new_r_Block(env->irg, 1, &entry);
+			set_Block_cfgpred(header, env->entry_pos, new_r_Jmp(pred));
+		}
+		env->preheader = pred;
+	}
+	return env->preheader;
+}
+
+/**
+ * Builds the value a node analyzed by get_stride() has in the first
+ * iteration of the loop in the preheader.
+ */
+static ir_node *copy_at_entry(idiom_env_t *env, ir_node *node)
+{
+	if (!is_in_loop(env, node) || is_Const(node))
+		return node;
+	if (is_Phi(node))
+		return get_Phi_pred(node, env->entry_pos);
+
+	int       arity = get_irn_arity(node);
+	ir_node **ins   = ALLOCAN(ir_node*, arity);
+	ir_node  *block = get_preheader(env);
+	for (int i = 0; i < arity; ++i)
+		ins[i] = copy_at_entry(env, get_irn_n(node, i));
+
+	/* the copy must be the last node created for optimize_node() */
+	ir_node *copy = exact_copy(node);
+	set_nodes_block(copy, block);
+	for (int i = 0; i < arity; ++i)
+		set_irn_n(copy, i, ins[i]);
+	return optimize_node(copy);
+}
+
+static int get_log2(unsigned long value)
+{
+	int log = 0;
+	if (value == 0 || (value & (value - 1)) != 0)
+		return -1;
+	while (value > 1) {
+		value >>= 1;
+		++log;
+	}
+	return log;
+}
+
+/**
+ * Builds the number of bytes accessed by the loop in the preheader.
+ *
+ * @param elem_size  the number of bytes accessed in every iteration
+ * @param guard      set to a Cmp which must hold for the loop to run at all,
+ *                   NULL if the byte count is valid without a check
+ * @return the number of bytes or NULL if the exit condition is not understood
+ */
+static ir_node *build_byte_count(idiom_env_t *env, long elem_size,
+                                 ir_node **guard)
+{
+	ir_node *cond     = get_Proj_pred(env->exit_proj);
+	ir_node *selector = get_Cond_selector(cond);
+	if (!is_Cmp(selector))
+		return NULL;
+
+	/* the relation which keeps the loop running */
+	ir_relation relation = get_Cmp_relation(selector);
+	if (get_Proj_proj(env->exit_proj) == pn_Cond_true)
+		relation = get_negated_relation(relation);
+	relation &= ~ir_relation_unordered;
+
+	ir_node *iv    = get_Cmp_left(selector);
+	ir_node *bound = get_Cmp_right(selector);
+	ir_mode *mode  = get_irn_mode(iv);
+	if (!mode_is_int(mode) && !mode_is_reference(mode))
+		return NULL;
+
+	long iv_stride;
+	long bound_stride;
+	if (!get_stride(env, iv, &iv_stride, 0)
+	    || !get_stride(env, bound, &bound_stride, 0))
+		return NULL;
+	if (iv_stride == 0) {
+		ir_node *tmp = iv;
+		iv           = bound;
+		bound        = tmp;
+		iv_stride    = bound_stride;
+		bound_stride = 0;
+		relation     = get_inversed_relation(relation);
+	}
+	if (iv_stride == 0 || bound_stride != 0)
+		return NULL;
+
+	/* the number of successful tests is (bound - iv) / stride, rounded
+	 * towards the last value passing the test */
+	long step = iv_stride > 0 ? iv_stride : -iv_stride;
+	int  log  = get_log2(step);
+	long adjust;
+	if (log < 0)
+		return NULL;
+	if (relation == ir_relation_less_greater) {
+		adjust = 0;
+	} else if (relation == (iv_stride > 0 ? ir_relation_less
+	                                      : ir_relation_greater)) {
+		adjust = step - 1;
+	} else if (relation == (iv_stride > 0 ? ir_relation_less_equal
+	                                      : ir_relation_greater_equal)) {
+		adjust = step;
+	} else {
+		return NULL;
+	}
+
+	ir_graph *irg        = env->irg;
+	ir_node  *block      = get_preheader(env);
+	/* with the test behind the Store, the Store runs once more than the
+	 * test succeeds */
+	bool      test_last  = block_dominates(get_nodes_block(env->store),
+	                                       get_nodes_block(env->exit_proj));
+	ir_node  *iv0        = copy_at_entry(env, iv);
+	ir_node  *bound0     = copy_at_entry(env, bound);
+	ir_mode  *diff_mode  = mode_is_reference(mode)
+		? get_reference_mode_unsigned_eq(mode) : mode;
+	ir_mode  *size_mode  = get_reference_mode_unsigned_eq(mode_P);
+	ir_node  *conv_iv    = new_r_Conv(block, iv0, diff_mode);
+	ir_node  *conv_bound = new_r_Conv(block, bound0, diff_mode);
+	ir_node  *diff       = iv_stride > 0
+		? new_r_Sub(block, conv_bound, conv_iv, diff_mode)
+		: new_r_Sub(block, conv_iv, conv_bound, diff_mode);
+	if (adjust != 0) {
+		ir_node *c = new_r_Const_long(irg, diff_mode, adjust);
+		diff = new_r_Add(block, diff, c, diff_mode);
+	}
+	if (log > 0) {
+		ir_node *c = new_r_Const_long(irg, mode_Iu, log);
+		diff = new_r_Shr(block, diff, c, diff_mode);
+	}
+	*guard = NULL;
+	if (relation != ir_relation_less_greater) {
+		/* the first test may fail already */
+		ir_node *cmp = new_r_Cmp(block, iv0, bound0, relation);
+		if (is_Const(cmp)) {
+			if (tarval_is_null(get_Const_tarval(cmp)))
+				diff = new_r_Const(irg, get_mode_null(diff_mode));
+		} else if (test_last) {
+			/* the Store is executed once anyway, a check does not help */
+			return NULL;
+		} else {
+			*guard = cmp;
+		}
+	}
+
+	ir_node *count = new_r_Conv(block, diff, size_mode);
+	ir_node *size  = new_r_Const_long(irg, size_mode, elem_size);
+	ir_node *bytes = new_r_Mul(block, count, size, size_mode);
+	if (test_last) {
+		ir_node *c = new_r_Const_long(irg, size_mode, elem_size);
+		bytes = new_r_Add(block, bytes, c, size_mode);
+	}
+	return bytes;
+}
+
+/**
+ * Splits an address into a base and a constant offset.
+ */
+static const ir_node *get_base(const ir_node *ptr, long *offset)
+{
+	long value;
+	*offset = 0;
+	for (;;) {
+		if (is_Add(ptr) && get_const_long(get_Add_right(ptr), &value)) {
+			*offset += value;
+			ptr = get_Add_left(ptr);
+		} else if (is_Add(ptr) && get_const_long(get_Add_left(ptr), &value)) {
+			*offset += value;
+			ptr = get_Add_right(ptr);
+		} else if (is_Sub(ptr) && get_const_long(get_Sub_right(ptr), &value)) {
+			*offset -= value;
+			ptr = get_Sub_left(ptr);
+		} else {
+			return ptr;
+		}
+	}
+}
+
+static ir_type *get_mem_methodtype(ir_mode *value_mode)
+{
+	ir_type *tp        = new_type_method(3, 1);
+	ir_mode *size_mode = get_reference_mode_unsigned_eq(mode_P);
+
+	set_method_param_type(tp, 0, get_type_for_mode(mode_P));
+	set_method_param_type(tp, 1, get_type_for_mode(value_mode));
+	set_method_param_type(tp, 2, get_type_for_mode(size_mode));
+	set_method_res_type  (tp, 0, get_type_for_mode(mode_P));
+
+	return tp;
+}
+
+/**
+ * Builds a call of memset(), memcpy() or memmove().
+ *
+ * @return the memory after the call
+ */
+static ir_node *build_call(idiom_env_t *env, ir_node *block, const char *name,
+                           ir_node *dst, ir_node *value, ir_node *bytes)
+{
+	ir_graph  *irg   = env->irg;
+	ir_type   *mtp   = get_mem_methodtype(get_irn_mode(value));
+	ir_entity *ent   = create_compilerlib_entity(new_id_from_str(name), mtp);
+	ir_node   *in[3] = { dst, value, bytes };
+
+	symconst_symbol sym;
+	sym.entity_p = ent;
+	ir_node *callee = new_r_SymConst(irg, mode_P_code, sym, symconst_addr_ent);
+	ir_node *call   = new_r_Call(block, env->entry_mem, callee, 3, in, mtp);
+	return new_r_Proj(call, mode_M, pn_Call_M);
+}
+
+/**
+ * Builds a CopyB of a constant number of bytes.
+ *
+ * @return the memory after the copy
+ */
+static ir_node *build_copyb(idiom_env_t *env, ir_node *block, ir_node *dst,
+                            ir_node *src, long bytes)
+{
+	ir_type *elem_type = get_type_for_mode(mode_Bu);
+	ir_type *type      = new_type_array(1, elem_type);
+	set_array_bounds_int(type, 0, 0, bytes);
+	set_type_size_bytes(type, bytes);
+	set_type_alignment_bytes(type, 1);
+	set_type_state(type, layout_fixed);
+
+	ir_node *copyb = new_r_CopyB(block, env->entry_mem, dst, src, type);
+	return new_r_Proj(copyb, mode_M, pn_CopyB_M);
+}
+
+/**
+ * Returns the global or local entity whose memory contains all addresses
+ * derived from @p base.
+ *
+ * @return the entity or NULL if the object is unknown
+ */
+static ir_entity *get_base_entity(const ir_graph *irg, const ir_node *base)
+{
+	ir_entity *ent = NULL;
+	long       offset;
+	while (is_Sel(base)) {
+		ent  = get_Sel_entity(base);
+		base = get_base(get_Sel_ptr(base), &offset);
+	}
+	if (is_SymConst_addr_ent(base))
+		return get_SymConst_entity(base);
+	if (base == get_irg_frame(irg))
+		return ent;
+	return NULL;
+}
+
+/**
+ * Check whether a loop sets memory to a single byte value.
+ *
+ * @return the byte value as int or NULL
+ */
+static ir_node *get_memset_value(idiom_env_t *env)
+{
+	ir_node *value = get_Store_value(env->store);
+	ir_mode *mode  = get_irn_mode(value);
+	long     stride;
+	if (!get_stride(env, value, &stride, 0) || stride != 0)
+		return NULL;
+
+	ir_graph *irg = env->irg;
+	value = copy_at_entry(env, value);
+	if (get_mode_size_bytes(mode) == 1 && mode_is_int(mode))
+		return new_r_Conv(get_preheader(env), value, mode_Is);
+	if (!is_Const(value) || (!mode_is_int(mode) && !mode_is_reference(mode)))
+		return NULL;
+
+	ir_tarval *tv = get_Const_tarval(value);
+	if (tarval_is_null(tv))
+		return new_r_Const_long(irg, mode_Is, 0);
+	if (mode_is_int(mode) && tarval_is_all_one(tv))
+		return new_r_Const_long(irg, mode_Is, 0xFF);
+	return NULL;
+}
+
+/**
+ * Check whether a loop copies memory and whether source and destination may
+ * overlap.
+ *
+ * @return the name of the function implementing the copy or NULL
+ */
+static const char *get_copy_function(idiom_env_t *env, ir_node *dst,
+                                     long elem_size, ir_node **src)
+{
+	ir_node *load  = env->load;
+	ir_node *value = get_Store_value(env->store);
+	if (!is_Proj(value) || get_Proj_pred(value) != load
+	    || get_Proj_proj(value) != pn_Load_res
+	    || get_Load_mode(load) != get_irn_mode(value))
+		return NULL;
+
+	ir_node *src_ptr = get_Load_ptr(load);
+	long     stride;
+	if (!get_stride(env, src_ptr, &stride, 0) || stride != elem_size)
+		return NULL;
+	*src = copy_at_entry(env, src_ptr);
+
+	long           dst_offset;
+	long           src_offset;
+	const ir_node *dst_base = get_base(dst, &dst_offset);
+	const ir_node *src_base = get_base(*src, &src_offset);
+	if (dst_base == src_base) {
+		/* a forward copy to a lower address does not see its own Stores */
+		return dst_offset <= src_offset ? "memmove" : NULL;
+	}
+	/* the loop may copy any number of bytes, so the whole objects and not
+	 * only the first addresses must be disjoint */
+	ir_entity *dst_ent = get_base_entity(env->irg, dst_base);
+	ir_entity *src_ent = get_base_entity(env->irg, src_base);
+	if (dst_ent != NULL && src_ent != NULL && dst_ent != src_ent)
+		return "memcpy";
+	return NULL;
+}
+
+/**
+ * Replaces the loop by a memset(), memcpy(), memmove() or CopyB if it
+ * implements one of them.
+ *
+ * @return true if the loop was replaced
+ */
+static bool replace_loop(idiom_env_t *env)
+{
+	ir_node *store     = env->store;
+	ir_node *value     = get_Store_value(store);
+	ir_mode *mode      = get_irn_mode(value);
+	ir_node *ptr       = get_Store_ptr(store);
+	long     elem_size = get_mode_size_bytes(mode);
+	long     stride;
+
+	if (get_mode_size_bits(mode) % 8 != 0
+	    || !get_stride(env, ptr, &stride, 0) || stride != elem_size)
+		return false;
+
+	ir_node *guard;
+	ir_node *bytes = build_byte_count(env, elem_size, &guard);
+	if (bytes == NULL)
+		return false;
+
+	ir_node    *dst      = copy_at_entry(env, ptr);
+	ir_node    *src      = NULL;
+	ir_node    *byte     = NULL;
+	const char *name;
+	long        n_bytes  = -1;
+	bool        is_const = get_const_long(bytes, &n_bytes);
+	if (env->load == NULL) {
+		byte = get_memset_value(env);
+		if (byte == NULL || (is_const && n_bytes < MIN_MEMSET_BYTES))
+			return false;
+		name = "memset";
+	} else {
+		name = get_copy_function(env, dst, elem_size, &src);
+		if (name == NULL)
+			return false;
+	}
+
+	/* the preheader jumps directly to the exit, which makes the loop
+	 * unreachable */
+	ir_graph *irg    = env->irg;
+	ir_node  *header = env->header;
+	ir_node  *block  = get_preheader(env);
+	ir_node  *entry  = get_Block_cfgpred(header, env->entry_pos);
+	ir_node  *skip   = NULL;
+	if (guard != NULL) {
+		ir_node *cond = new_r_Cond(block, guard);
+		ir_node *run  = new_r_Proj(cond, mode_X, pn_Cond_true);
+		skip  = new_r_Proj(cond, mode_X, pn_Cond_false);
+		block = new_r_Block(irg, 1, &run);
+	}
+
+	ir_node *mem;
+	if (strcmp(name, "memcpy") == 0 && is_const
+	    && n_bytes <= MAX_COPYB_BYTES) {
+		DB((dbg, LEVEL_1, "replacing loop %+F by CopyB of %ld bytes\n",
+		    header, n_bytes));
+		mem = n_bytes > 0 ? build_copyb(env, block, dst, src, n_bytes)
+		                  : env->entry_mem;
+	} else {
+		DB((dbg, LEVEL_1, "replacing loop %+F by %s\n", header, name));
+		mem = build_call(env, block, name, dst, byte != NULL ? byte : src,
+		                 bytes);
+	}
+
+	if (guard != NULL) {
+		ir_node *in[2]     = { new_r_Jmp(block), skip };
+		ir_node *join      = new_r_Block(irg, 2, in);
+		ir_node *phi_in[2] = { mem, env->entry_mem };
+		mem   = new_r_Phi(join, 2, phi_in, mode_M);
+		entry = new_r_Jmp(join);
+	}
+
+	for (size_t i = 0, n = ARR_LEN(env->exit_uses); i < n; ++i) {
+		const exit_use_t *use = &env->exit_uses[i];
+		set_irn_n(use->user, use->pos, mem);
+	}
+	set_Block_cfgpred(env->exit_block, env->exit_pos, entry);
+	set_Block_cfgpred(header, env->entry_pos, new_r_Bad(irg, mode_X));
+	return true;
+}
+
+/**
+ * Tries to replace a single loop.
+ *
+ * @return true if the graph was changed, in this case the remaining loops
+ *         are visited again after the graph information is recomputed
+ */
+static bool optimize_loop(ir_graph *irg, const ir_loop *loop,
+                          ir_nodeset_t *done)
+{
+	idiom_env_t env;
+	memset(&env, 0, sizeof(env));
+	env.irg        = irg;
+	env.blocks     = bitset_malloc(get_irg_last_idx(irg));
+	env.block_list = NEW_ARR_F(ir_node*, 0);
+	env.exit_uses  = NEW_ARR_F(exit_use_t, 0);
+
+	bool changed = false;
+	if (analyze_loop(&env, loop) && !ir_nodeset_contains(done, env.header)) {
+		DB((dbg, LEVEL_2, "loop of %+F: %s\n", env.header,
+		    env.load != NULL ? "copy" : "set"));
+		ir_nodeset_insert(done, env.header);
+		changed = replace_loop(&env);
+		/* nodes built for a rejected loop are dead but may have created a
+		 * preheader */
+		changed |= env.preheader != NULL;
+	}
+
+	DEL_ARR_F(env.exit_uses);
+	DEL_ARR_F(env.block_list);
+	free(env.blocks);
+	return changed;
+}
+
+/**
+ * Collects the loops of the loop tree, inner loops first.
+ */
+static void collect_loops(ir_loop *loop, ir_loop ***loops)
+{
+	for (size_t i = 0, n = get_loop_n_elements(loop); i < n; ++i) {
+		loop_element elem = get_loop_element(loop, i);
+		if (*elem.kind == k_ir_loop)
+			collect_loops(elem.son, loops);
+	}
+	ARR_APP1(ir_loop*, *loops, loop);
+}
+
+void opt_loop_idiom(ir_graph *irg)
+{
+	FIRM_DBG_REGISTER(dbg, "firm.opt.loop_idiom");
+	DB((dbg, LEVEL_1, "\nDoing loop idiom recognition on %+F\n", irg));
+
+	ir_nodeset_t done;
+	ir_nodeset_init(&done);
+
+	bool changed = false;
+	for (;;) {
+		assure_irg_properties(irg,
+			IR_GRAPH_PROPERTY_NO_UNREACHABLE_CODE
+			| IR_GRAPH_PROPERTY_CONSISTENT_OUTS
+			| IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE
+			| IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO);
+
+		ir_loop **loops = NEW_ARR_F(ir_loop*, 0);
+		ir_loop  *root  = get_irg_loop(irg);
+		for (size_t i = 0, n = get_loop_n_elements(root); i < n; ++i) {
+			loop_element elem = get_loop_element(root, i);
+			if (*elem.kind == k_ir_loop)
+				collect_loops(elem.son, &loops);
+		}
+
+		bool round_changed = false;
+		for (size_t i = 0, n = ARR_LEN(loops); i < n && !round_changed; ++i)
+			round_changed = optimize_loop(irg, loops[i], &done);
+		DEL_ARR_F(loops);
+
+		if (!round_changed)
+			break;
+		changed = true;
+		confirm_irg_properties(irg, IR_GRAPH_PROPERTIES_NONE);
+	}
+	ir_nodeset_destroy(&done);
+
+	confirm_irg_properties(irg, changed ? IR_GRAPH_PROPERTIES_NONE
+	                                    : IR_GRAPH_PROPERTIES_ALL);
+}
+
+ir_graph_pass_t *opt_loop_idiom_pass(const char *name)
+{
+	return def_graph_pass(name ? name : "loop_idiom", opt_loop_idiom);
+}
@@ -0,0 +1,39 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief    Whole-program optimizations for linked modules.
+ */
+#include "iroptimize.h"
+#include "cgana.h"
+#include "irprog.h"
+#include "irgopt.h"
+#include "debug.h"
+
+DEBUG_ONLY(static firm_dbg_module_t *dbg;)
+
+static void after_inline_opt(ir_graph *irg)
+{
+	optimize_graph_df(irg);
+}
+
+void opt_lto(unsigned inline_maxsize, int inline_threshold)
+{
+	FIRM_DBG_REGISTER(dbg, "firm.opt.lto");
+
+	/* entities only referenced by discarded definitions are dead now, remove
+	 * them first so the following passes have less to look at */
+	garbage_collect_entities();
+	DB((dbg, LEVEL_1, "%zu graphs after linking\n", get_irp_n_irgs()));
+
+	/* direct calls are the precondition for inlining */
+	opt_call_addrs();
+
+	inline_functions(inline_maxsize, inline_threshold, after_inline_opt);
+	optimize_funccalls();
+	garbage_collect_entities();
+	DB((dbg, LEVEL_1, "%zu graphs after optimization\n", get_irp_n_irgs()));
+}
@@ -9,6 +9,7 @@
  * @author   Michael Beck, Goetz Lindenmaier
  */
 #include <limits.h>
+#include <math.h>
 #include <stdbool.h>
 #include <assert.h>
 
@@ -45,6 +46,9 @@
 #include "iropt_dbg.h"
 #include "irpass_t.h"
 #include "irnodemap.h"
+#include "irprofile.h"
+#include "execfreq.h"
+#include "statev_t.h"
 
 DEBUG_ONLY(static firm_dbg_module_t *dbg;)
 
@@ -649,8 +653,12 @@ typedef struct call_entry {
 	ir_node    *call;       /**< The Call node. */
 	ir_graph   *callee;     /**< The callee IR-graph. */
 	list_head  list;        /**< List head for linking the next one. */
+	double     freq;        /**< Execution frequency of the call relative to
+	                             the entry of the calling graph. */
+	unsigned   callee_size; /**< Size of the callee when this call was queued. */
 	int        loop_depth;  /**< The loop depth of this call. */
 	int        benefice;    /**< The calculated benefice of this call. */
+	int        priority;    /**< Priority in the global inliner queue. */
 	unsigned   local_adr:1; /**< Set if this call gets an address of a local variable. */
 	unsigned   all_const:1; /**< Set if this call has only constant parameters. */
 } call_entry;
@@ -691,6 +699,8 @@ typedef struct {
 	unsigned  n_call_nodes_orig; /**< for statistics */
 	unsigned  n_callers;         /**< Number of known graphs that call this graphs. */
 	unsigned  n_callers_orig;    /**< for statistics */
+	double    entry_freq;        /**< Estimated invocations of this graph per
+	                                  program run, used by the global inliner. */
 	unsigned  got_inline:1;      /**< Set, if at least one call inside this graph was inlined. */
 	unsigned  recursive:1;       /**< Set, if this function is self recursive. */
 } inline_irg_env;
@@ -710,6 +720,7 @@ static inline_irg_env *alloc_inline_irg_env(void)
 	env->n_call_nodes_orig = 0;
 	env->n_callers         = 0;
 	env->n_callers_orig    = 0;
+	env->entry_freq        = 0.0;
 	env->got_inline        = 0;
 	env->recursive         = 0;
 	return env;
@@ -761,12 +772,15 @@ static void collect_calls2(ir_node *call, void *ctx)
 
 		/* link it in the list of possible inlinable entries */
 		entry = OALLOC(&temp_obst, call_entry);
-		entry->call       = call;
-		entry->callee     = callee;
-		entry->loop_depth = get_irn_loop(get_nodes_block(call))->depth;
-		entry->benefice   = 0;
-		entry->local_adr  = 0;
-		entry->all_const  = 0;
+		entry->call        = call;
+		entry->callee      = callee;
+		entry->freq        = get_block_execfreq(get_nodes_block(call));
+		entry->callee_size = 0;
+		entry->loop_depth  = get_irn_loop(get_nodes_block(call))->depth;
+		entry->benefice    = 0;
+		entry->priority    = 0;
+		entry->local_adr   = 0;
+		entry->all_const   = 0;
 
 		list_add_tail(&entry->list, &x->calls);
 	}
@@ -779,17 +793,23 @@ static void collect_calls2(ir_node *call, void *ctx)
  * @param new_call  the new call node
  * @param loop_depth_delta
  *                  delta value for the loop depth
+ * @param freq_factor
+ *                  execution frequency of the inlined call site
  */
 static call_entry *duplicate_call_entry(const call_entry *entry,
-                                        ir_node *new_call, int loop_depth_delta)
+                                        ir_node *new_call, int loop_depth_delta,
+                                        double freq_factor)
 {
 	call_entry *nentry = OALLOC(&temp_obst, call_entry);
-	nentry->call       = new_call;
-	nentry->callee     = entry->callee;
-	nentry->benefice   = entry->benefice;
-	nentry->loop_depth = entry->loop_depth + loop_depth_delta;
-	nentry->local_adr  = entry->local_adr;
-	nentry->all_const  = entry->all_const;
+	nentry->call        = new_call;
+	nentry->callee      = entry->callee;
+	nentry->freq        = entry->freq * freq_factor;
+	nentry->callee_size = 0;
+	nentry->benefice    = entry->benefice;
+	nentry->priority    = 0;
+	nentry->loop_depth  = entry->loop_depth + loop_depth_delta;
+	nentry->local_adr   = entry->local_adr;
+	nentry->all_const   = entry->all_const;
 
 	return nentry;
 }
@@ -1084,6 +1104,43 @@ static void maybe_push_call(pqueue_t *pqueue, call_entry *call,
 	pqueue_put(pqueue, call, benefice);
 }
 
+/**
+ * Creates a copy of a recursive graph that can be inlined into itself and
+ * registers it in @p copied_graphs.
+ *
+ * @param callee         the graph to copy
+ * @param copied_graphs  map containing copies of recursive graphs
+ */
+static ir_graph *create_inline_copy(ir_graph *callee, pmap *copied_graphs)
+{
+	ir_graph       *copy = create_irg_copy(callee);
+	inline_irg_env *env  = alloc_inline_irg_env();
+	wenv_t         wenv;
+
+	set_irg_link(copy, env);
+
+	assure_irg_properties(copy, IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO);
+	memset(&wenv, 0, sizeof(wenv));
+	wenv.x              = env;
+	wenv.ignore_callers = 1;
+	irg_walk_graph(copy, NULL, collect_calls2, &wenv);
+
+	/*
+	 * Enter the entity of the original graph. This is needed
+	 * for inline_method(). However, note that ent->irg still points
+	 * to callee, NOT to copy.
+	 */
+	set_irg_entity(copy, get_irg_entity(callee));
+
+	pmap_insert(copied_graphs, callee, copy);
+
+	/* we have only one caller: the original graph */
+	env->n_callers      = 1;
+	env->n_callers_orig = 1;
+	env->entry_freq     = ((inline_irg_env*)get_irg_link(callee))->entry_freq;
+	return copy;
+}
+
 /**
  * Try to inline calls into a graph.
  *
@@ -1100,7 +1157,6 @@ static void inline_into(ir_graph *irg, unsigned maxsize,
 {
 	int            phiproj_computed = 0;
 	inline_irg_env *env = (inline_irg_env*)get_irg_link(irg);
-	wenv_t         wenv;
 	pqueue_t       *pqueue;
 
 	if (env->n_call_nodes == 0)
@@ -1186,36 +1242,15 @@ static void inline_into(ir_graph *irg, unsigned maxsize,
 			 * Note that recursive methods are never leafs, so it is
 			 * sufficient to test this condition here.
 			 */
-			copy = create_irg_copy(callee);
+			copy = create_inline_copy(callee, copied_graphs);
 
 			/* create_irg_copy() destroys the Proj links, recompute them */
 			phiproj_computed = 0;
 
 			ir_reserve_resources(irg, IR_RESOURCE_IRN_LINK|IR_RESOURCE_PHI_LIST);
 
-			/* allocate a new environment */
-			callee_env = alloc_inline_irg_env();
-			set_irg_link(copy, callee_env);
-
-			assure_irg_properties(copy, IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO);
-			memset(&wenv, 0, sizeof(wenv));
-			wenv.x              = callee_env;
-			wenv.ignore_callers = 1;
-			irg_walk_graph(copy, NULL, collect_calls2, &wenv);
-
-			/*
-			 * Enter the entity of the original graph. This is needed
-			 * for inline_method(). However, note that ent->irg still points
-			 * to callee, NOT to copy.
-			 */
-			set_irg_entity(copy, get_irg_entity(callee));
-
-			pmap_insert(copied_graphs, callee, copy);
-			callee = copy;
-
-			/* we have only one caller: the original graph */
-			callee_env->n_callers      = 1;
-			callee_env->n_callers_orig = 1;
+			callee     = copy;
+			callee_env = (inline_irg_env*)get_irg_link(callee);
 		}
 		if (! phiproj_computed) {
 			phiproj_computed = 1;
@@ -1259,7 +1294,8 @@ static void inline_into(ir_graph *irg, unsigned maxsize,
 			}
 			assert(is_Call(new_call));
 
-			new_entry = duplicate_call_entry(centry, new_call, loop_depth);
+			new_entry = duplicate_call_entry(centry, new_call, loop_depth,
+			                                 curr_call->freq);
 			list_add_tail(&new_entry->list, &env->calls);
 			maybe_push_call(pqueue, new_entry, inline_threshold);
 		}
@@ -1272,6 +1308,23 @@ static void inline_into(ir_graph *irg, unsigned maxsize,
 	del_pqueue(pqueue);
 }
 
+/**
+ * Kill the copied graphs: we don't need them anymore.
+ */
+static void free_copied_graphs(pmap *copied_graphs)
+{
+	pmap_entry *pm_entry;
+
+	foreach_pmap(copied_graphs, pm_entry) {
+		ir_graph *copy = (ir_graph*)pm_entry->value;
+
+		/* reset the entity, otherwise it will be deleted in the next step ... */
+		set_irg_entity(copy, NULL);
+		free_ir_graph(copy);
+	}
+	pmap_destroy(copied_graphs);
+}
+
 /*
  * Heuristic inliner. Calculates a benefice value for every call and inlines
  * those calls with a value higher than the threshold.
@@ -1284,7 +1337,6 @@ void inline_functions(unsigned maxsize, int inline_threshold,
 	ir_graph         *rem;
 	wenv_t           wenv;
 	pmap             *copied_graphs;
-	pmap_entry       *pm_entry;
 	ir_graph         **irgs;
 
 	rem = current_ir_graph;
@@ -1335,22 +1387,370 @@ void inline_functions(unsigned maxsize, int inline_threshold,
 		}
 	}
 
-	/* kill the copied graphs: we don't need them anymore */
-	foreach_pmap(copied_graphs, pm_entry) {
-		ir_graph *copy = (ir_graph*)pm_entry->value;
+	free_copied_graphs(copied_graphs);
 
-		/* reset the entity, otherwise it will be deleted in the next step ... */
-		set_irg_entity(copy, NULL);
-		free_ir_graph(copy);
+	free(irgs);
+
+	obstack_free(&temp_obst, NULL);
+	current_ir_graph = rem;
+}
+
+/**
+ * Environment of the global inliner.
+ */
+typedef struct global_inline_env {
+	pqueue_t *pqueue;           /**< Call entries of the whole unit. */
+	pmap     *copied_graphs;    /**< Copies of recursive graphs. */
+	unsigned  maxsize;          /**< Maximum size of a single graph. */
+	int       inline_threshold; /**< Minimum benefice of a call. */
+	unsigned  unit_size;        /**< Current size of the whole unit. */
+	unsigned  unit_budget;      /**< Maximum size of the whole unit. */
+} global_inline_env;
+
+/**
+ * Emits a statistic event describing a decision of the global inliner,
+ * so that the heuristic can be tuned offline.
+ */
+static void log_inline_decision(const global_inline_env *genv,
+                                const call_entry *entry, ir_graph *callee,
+                                const char *decision)
+{
+	ir_graph       *caller     = get_irn_irg(entry->call);
+	inline_irg_env *caller_env = (inline_irg_env*)get_irg_link(caller);
+	inline_irg_env *callee_env = (inline_irg_env*)get_irg_link(callee);
+
+	DB((dbg, LEVEL_2, "%+F: call %+F to %+F (prio %d, size %u+%u): %s\n",
+	    caller, entry->call, callee, entry->priority, caller_env->n_nodes,
+	    callee_env->n_nodes, decision));
+
+	if (!stat_ev_enabled)
+		return;
+
+	stat_ev_ctx_push_str("inline_caller",
+	                     get_entity_ld_name(get_irg_entity(caller)));
+	stat_ev_ctx_push_str("inline_callee",
+	                     get_entity_ld_name(get_irg_entity(callee)));
+	stat_ev_ctx_push_str("inline_decision", decision);
+	stat_ev_int("inline_priority", entry->priority);
+	stat_ev_int("inline_benefice", entry->benefice);
+	stat_ev_int("inline_loop_depth", entry->loop_depth);
+	stat_ev_dbl("inline_freq", caller_env->entry_freq * entry->freq);
+	stat_ev_int("inline_caller_size", caller_env->n_nodes);
+	stat_ev_int("inline_callee_size", callee_env->n_nodes);
+	stat_ev_int("inline_unit_size", genv->unit_size);
+	stat_ev_ctx_pop("inline_decision");
+	stat_ev_ctx_pop("inline_callee");
+	stat_ev_ctx_pop("inline_caller");
+}
+
+/**
+ * Maps a non-negative priority to a queue key. The key grows with the
+ * logarithm of the priority, so small fractional priorities keep their order
+ * instead of being truncated to 0.
+ */
+static int get_priority_key(double prio)
+{
+	double key;
+
+	if (prio <= 0.0)
+		return INT_MIN + 1;
+	key = log2(prio) * (1 << 16);
+	if (key >= INT_MAX - 1)
+		return INT_MAX - 1;
+	if (key <= INT_MIN + 1)
+		return INT_MIN + 1;
+	return (int)key;
+}
+
+/**
+ * Puts a call into the global priority queue. The priority is the margin
+ * of the benefice above the threshold weighted by the execution frequency
+ * of the call site and divided by the code growth caused by inlining.
+ */
+static void global_push_call(global_inline_env *genv, call_entry *entry)
+{
+	ir_graph       *caller     = get_irn_irg(entry->call);
+	ir_graph       *callee     = entry->callee;
+	inline_irg_env *caller_env = (inline_irg_env*)get_irg_link(caller);
+	inline_irg_env *callee_env = (inline_irg_env*)get_irg_link(callee);
+	ir_entity      *ent        = get_irg_entity(callee);
+	ir_graph       *rem        = current_ir_graph;
+
+	/* calc_inline_benefice() inspects the frame of the current graph */
+	current_ir_graph = caller;
+	int benefice = calc_inline_benefice(entry, callee);
+	current_ir_graph = rem;
+
+	entry->callee_size = callee_env->n_nodes;
+
+	mtp_additional_properties props = get_entity_additional_properties(ent);
+	if (props & mtp_property_always_inline) {
+		entry->priority = INT_MAX;
+	} else if (benefice == INT_MIN || benefice < genv->inline_threshold) {
+		entry->priority = INT_MIN;
+		log_inline_decision(genv, entry, callee, "below_threshold");
+		return;
+	} else {
+		double margin = (double)benefice - genv->inline_threshold + 1.0;
+		double weight = caller_env->entry_freq * entry->freq;
+		double growth = callee_env->n_nodes > 0 ? callee_env->n_nodes : 1;
+		double prio   = margin * weight / growth;
+
+		entry->priority = get_priority_key(prio);
 	}
-	pmap_destroy(copied_graphs);
 
+	pqueue_put(genv->pqueue, entry, entry->priority);
+}
+
+/**
+ * Estimates how often each graph is invoked by propagating the call site
+ * frequencies top-down over the call graph. Graphs that may be called from
+ * outside the unit are assumed to be executed once.
+ *
+ * @param irgs    the graphs in callgraph post-order
+ * @param n_irgs  number of graphs
+ */
+static void compute_entry_freqs(ir_graph **irgs, size_t n_irgs)
+{
+	for (size_t i = 0; i < n_irgs; ++i) {
+		ir_graph       *irg = irgs[i];
+		inline_irg_env *env = (inline_irg_env*)get_irg_link(irg);
+
+		if (env->n_callers == 0
+		    || entity_is_externally_visible(get_irg_entity(irg)))
+			env->entry_freq = 1.0;
+	}
+
+	/* walk callers before callees, ignoring recursion */
+	for (size_t i = n_irgs; i-- > 0; ) {
+		ir_graph       *irg = irgs[i];
+		inline_irg_env *env = (inline_irg_env*)get_irg_link(irg);
+
+		list_for_each_entry(call_entry, entry, &env->calls, list) {
+			inline_irg_env *callee_env
+				= (inline_irg_env*)get_irg_link(entry->callee);
+			if (entry->callee == irg)
+				continue;
+			callee_env->entry_freq += env->entry_freq * entry->freq;
+		}
+	}
+}
+
+/**
+ * Inlines the call of a queued entry if the size limits allow it.
+ */
+static void global_inline_call(global_inline_env *genv, call_entry *entry)
+{
+	ir_node        *call       = entry->call;
+	ir_graph       *irg        = get_irn_irg(call);
+	ir_graph       *callee     = entry->callee;
+	inline_irg_env *env        = (inline_irg_env*)get_irg_link(irg);
+	inline_irg_env *callee_env = (inline_irg_env*)get_irg_link(callee);
+	ir_entity      *ent        = get_irg_entity(callee);
+	mtp_additional_properties props = get_entity_additional_properties(ent);
+	bool            always     = (props & mtp_property_always_inline) != 0;
+
+	/* the callee changed since the priority was computed: requeue it */
+	if (entry->callee_size != callee_env->n_nodes) {
+		global_push_call(genv, entry);
+		return;
+	}
+
+	if (!always && env->n_nodes + callee_env->n_nodes > genv->maxsize) {
+		log_inline_decision(genv, entry, callee, "caller_too_big");
+		return;
+	}
+	if (!always && genv->unit_size + callee_env->n_nodes > genv->unit_budget) {
+		log_inline_decision(genv, entry, callee, "unit_budget");
+		return;
+	}
+
+	ir_graph *copy = pmap_get(ir_graph, genv->copied_graphs, callee);
+	if (copy != NULL || callee == irg) {
+		/*
+		 * Reduce the weight for recursive function IFF not all arguments are
+		 * const. inlining recursive functions is rarely good.
+		 */
+		if (!entry->all_const
+		    && entry->benefice - 2000 < genv->inline_threshold) {
+			log_inline_decision(genv, entry, callee, "recursive");
+			return;
+		}
+		if (copy == NULL)
+			copy = create_inline_copy(callee, genv->copied_graphs);
+		callee     = copy;
+		callee_env = (inline_irg_env*)get_irg_link(callee);
+	}
+
+	current_ir_graph = irg;
+	ir_reserve_resources(irg, IR_RESOURCE_IRN_LINK|IR_RESOURCE_PHI_LIST);
+	collect_phiprojs(irg);
+
+	if (!inline_method(call, callee)) {
+		ir_free_resources(irg, IR_RESOURCE_IRN_LINK|IR_RESOURCE_PHI_LIST);
+		log_inline_decision(genv, entry, callee, "not_inlinable");
+		return;
+	}
+	log_inline_decision(genv, entry, callee, "inlined");
+
+	list_del(&entry->list);
+	env->got_inline = 1;
+	--env->n_call_nodes;
+
+	list_for_each_entry(call_entry, centry, &callee_env->calls, list) {
+		inline_irg_env *penv = (inline_irg_env*)get_irg_link(centry->callee);
+		ir_node        *new_call = (ir_node*)get_irn_link(centry->call);
+
+		++penv->n_callers;
+		/* the call was dead and has not been copied */
+		if (get_irn_irg(new_call) != irg)
+			continue;
+		assert(is_Call(new_call));
+
+		call_entry *new_entry = duplicate_call_entry(centry, new_call,
+		                                             entry->loop_depth,
+		                                             entry->freq);
+		list_add_tail(&new_entry->list, &env->calls);
+		global_push_call(genv, new_entry);
+	}
+	ir_free_resources(irg, IR_RESOURCE_IRN_LINK|IR_RESOURCE_PHI_LIST);
+
+	env->n_call_nodes += callee_env->n_call_nodes;
+	env->n_nodes      += callee_env->n_nodes;
+	genv->unit_size   += callee_env->n_nodes;
+	--callee_env->n_callers;
+}
+
+/*
+ * Whole-program inliner driven by a single priority queue for all calls.
+ */
+void inline_functions_global(unsigned maxsize, unsigned max_growth,
+                             int inline_threshold, opt_ptr after_inline_opt)
+{
+	ir_graph          *rem = current_ir_graph;
+	global_inline_env genv;
+	wenv_t            wenv;
+	size_t            n_irgs;
+	ir_graph          **irgs;
+
+	obstack_init(&temp_obst);
+
+	irgs   = create_irg_list();
+	n_irgs = get_irp_n_irgs();
+
+	for (size_t i = 0; i < n_irgs; ++i)
+		set_irg_link(irgs[i], alloc_inline_irg_env());
+
+	/* call sites are weighted by their execution frequency */
+	if (ir_profile_available()) {
+		ir_create_execfreqs_from_profile();
+	} else {
+		for (size_t i = 0; i < n_irgs; ++i)
+			ir_estimate_execfreq(irgs[i]);
+	}
+
+	genv.pqueue           = new_pqueue();
+	genv.copied_graphs    = pmap_create();
+	genv.maxsize          = maxsize;
+	genv.inline_threshold = inline_threshold;
+	genv.unit_size        = 0;
+
+	wenv.ignore_callers = 0;
+	for (size_t i = 0; i < n_irgs; ++i) {
+		ir_graph *irg = irgs[i];
+
+		free_callee_info(irg);
+		/* the frequency estimation activated the out edges, which are not
+		 * kept consistent while nodes are copied out of a callee */
+		edges_deactivate(irg);
+
+		wenv.x = (inline_irg_env*)get_irg_link(irg);
+		assure_loopinfo(irg);
+		current_ir_graph = irg;
+		irg_walk_graph(irg, NULL, collect_calls2, &wenv);
+		genv.unit_size += wenv.x->n_nodes;
+	}
+	genv.unit_budget = genv.unit_size
+	                 + (unsigned)((unsigned long long)genv.unit_size
+	                              * max_growth / 100);
+
+	compute_entry_freqs(irgs, n_irgs);
+
+	for (size_t i = 0; i < n_irgs; ++i) {
+		inline_irg_env *env = (inline_irg_env*)get_irg_link(irgs[i]);
+
+		list_for_each_entry(call_entry, entry, &env->calls, list) {
+			global_push_call(&genv, entry);
+		}
+	}
+
+	/* note that calls are added to the queue during the process */
+	while (!pqueue_empty(genv.pqueue)) {
+		call_entry *entry = (call_entry*)pqueue_pop_front(genv.pqueue);
+		global_inline_call(&genv, entry);
+	}
+
+	DB((dbg, LEVEL_1, "unit size: %u, budget: %u\n", genv.unit_size,
+	    genv.unit_budget));
+	stat_ev_int("inline_unit_size", genv.unit_size);
+	stat_ev_int("inline_unit_budget", genv.unit_budget);
+
+	for (size_t i = 0; i < n_irgs; ++i) {
+		ir_graph       *irg = irgs[i];
+		inline_irg_env *env = (inline_irg_env*)get_irg_link(irg);
+
+		if (env->got_inline && after_inline_opt != NULL)
+			after_inline_opt(irg);
+	}
+
+	free_copied_graphs(genv.copied_graphs);
+	del_pqueue(genv.pqueue);
 	free(irgs);
 
 	obstack_free(&temp_obst, NULL);
 	current_ir_graph = rem;
 }
 
+typedef struct inline_functions_global_pass_t {
+	ir_prog_pass_t pass;
+	unsigned       maxsize;
+	unsigned       max_growth;
+	int            inline_threshold;
+	opt_ptr        after_inline_opt;
+} inline_functions_global_pass_t;
+
+/**
+ * Wrapper to run inline_functions_global() as a ir_prog pass.
+ */
+static int inline_functions_global_wrapper(ir_prog *irp, void *context)
+{
+	inline_functions_global_pass_t *pass
+		= (inline_functions_global_pass_t*)context;
+
+	(void)irp;
+	inline_functions_global(pass->maxsize, pass->max_growth,
+	                        pass->inline_threshold, pass->after_inline_opt);
+	return 0;
+}
+
+/* create a ir_prog pass for inline_functions_global */
+ir_prog_pass_t *inline_functions_global_pass(
+	  const char *name, unsigned maxsize, unsigned max_growth,
+	  int inline_threshold, opt_ptr after_inline_opt)
+{
+	inline_functions_global_pass_t *pass
+		= XMALLOCZ(inline_functions_global_pass_t);
+
+	pass->maxsize          = maxsize;
+	pass->max_growth       = max_growth;
+	pass->inline_threshold = inline_threshold;
+	pass->after_inline_opt = after_inline_opt;
+
+	return def_prog_pass_constructor(
+		&pass->pass, name ? name : "inline_functions_global",
+		inline_functions_global_wrapper);
+}
+
 typedef struct inline_functions_pass_t {
 	ir_prog_pass_t pass;
 	unsigned       maxsize;
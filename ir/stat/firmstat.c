@@ -25,6 +25,8 @@
 #include "util.h"
 #include "ircons.h"
 #include "irtools.h"
+#include "array_t.h"
+#include "compiler.h"
 
 #include "lc_opts.h"
 #include "lc_opts_enum.h"
@@ -61,6 +63,7 @@ static ir_op _op_SelSel;
 static ir_op _op_SelSelSel;
 
 static unsigned stat_options;
+static int      stat_sample_ratio = 16;
 
 /* ---------------------------------------------------------------------------------- */
 
@@ -308,12 +311,66 @@ static graph_entry_t *graph_get_entry(ir_graph *irg, hmap_graph_entry_t *hmap)
 	/* these hash tables are created on demand */
 	elem->block_hash = NULL;
 
+	/* in sampling mode, structural statistics are collected for 1-in-N graphs only */
+	elem->is_sampled = 1;
+	if (irg != NULL && (status->stat_options & FIRMSTAT_SAMPLING)) {
+		elem->is_sampled = status->n_graphs++ % status->sample_ratio == 0;
+		if (elem->is_sampled)
+			++status->n_sampled_graphs;
+	}
+
 	for (i = 0; i != ARRAY_SIZE(elem->opt_hash); ++i)
 		elem->opt_hash[i] = new_pset(opt_cmp, 4);
 
 	return (graph_entry_t*)pset_insert(hmap, elem, hash_ptr(irg));
 }
 
+/**
+ * Returns the flat opcode counter entry for a node (sampling mode).
+ * The array grows on demand as opcodes may be registered late.
+ *
+ * @param node  the IR node
+ */
+static node_entry_t *flat_get_entry(const ir_node *node)
+{
+	unsigned code = get_irn_opcode(node);
+	size_t   len  = ARR_LEN(status->flat_opcodes);
+
+	if (UNLIKELY(code >= len)) {
+		ARR_RESIZE(node_entry_t, status->flat_opcodes, code + 1);
+		memset(&status->flat_opcodes[len], 0, (code + 1 - len) * sizeof(status->flat_opcodes[0]));
+	}
+	return &status->flat_opcodes[code];
+}
+
+/**
+ * Adds the flat opcode counters (sampling mode) to the global opcode
+ * counters and clears them.
+ *
+ * @param global  the global graph entry
+ */
+static void flat_aggregate(graph_entry_t *global)
+{
+	size_t code;
+
+	for (code = 0; code < ARR_LEN(status->flat_opcodes); ++code) {
+		node_entry_t *flat = &status->flat_opcodes[code];
+		node_entry_t *entry;
+		ir_op        *op;
+
+		if (cnt_eq(&flat->new_node, 0) && cnt_eq(&flat->into_Id, 0)
+		    && cnt_eq(&flat->normalized, 0))
+			continue;
+
+		op    = ir_get_opcode((unsigned)code);
+		entry = opcode_get_entry(op, global->opcode_hash);
+		cnt_add(&entry->new_node,   &flat->new_node);
+		cnt_add(&entry->into_Id,    &flat->into_Id);
+		cnt_add(&entry->normalized, &flat->normalized);
+		memset(flat, 0, sizeof(*flat));
+	}
+}
+
 /**
  * Clear all counter in an opt_entry_t.
  */
@@ -1388,6 +1445,12 @@ static void stat_new_node(void *ctx, ir_graph *irg, ir_node *node)
 	if (status->in_dead_node_elim)
 		return;
 
+	/* sampling mode: global flat counter only */
+	if (status->stat_options & FIRMSTAT_SAMPLING) {
+		cnt_inc(&flat_get_entry(node)->new_node);
+		return;
+	}
+
 	STAT_ENTER;
 	{
 		node_entry_t *entry;
@@ -1419,6 +1482,12 @@ static void stat_turn_into_id(void *ctx, ir_node *node)
 	if (! status->stat_options)
 		return;
 
+	/* sampling mode: global flat counter only */
+	if (status->stat_options & FIRMSTAT_SAMPLING) {
+		cnt_inc(&flat_get_entry(node)->into_Id);
+		return;
+	}
+
 	STAT_ENTER;
 	{
 		node_entry_t *entry;
@@ -1450,6 +1519,12 @@ static void stat_normalize(void *ctx, ir_node *node)
 	if (! status->stat_options)
 		return;
 
+	/* sampling mode: global flat counter only */
+	if (status->stat_options & FIRMSTAT_SAMPLING) {
+		cnt_inc(&flat_get_entry(node)->normalized);
+		return;
+	}
+
 	STAT_ENTER;
 	{
 		node_entry_t *entry;
@@ -1522,7 +1597,7 @@ static void stat_free_graph(void *ctx, ir_graph *irg)
 
 		graph->is_deleted = 1;
 
-		if (status->stat_options & FIRMSTAT_COUNT_DELETED) {
+		if ((status->stat_options & FIRMSTAT_COUNT_DELETED) && graph->is_sampled) {
 			/* count the nodes of the graph yet, it will be destroyed later */
 			update_graph_stat(global, graph);
 		}
@@ -2057,12 +2132,16 @@ void stat_dump_snapshot(const char *name, const char *phase)
 				/* special entry for the global count */
 				continue;
 			}
-			if (! entry->is_deleted) {
+			if (! entry->is_deleted && entry->is_sampled) {
 				/* the graph is still alive, count the nodes on it */
 				update_graph_stat(global, entry);
 			}
 		}
 
+		/* sampling mode: fold the flat opcode counters into the global ones */
+		if (status->stat_options & FIRMSTAT_SAMPLING)
+			flat_aggregate(global);
+
 		/* some calculations are dependent, we pushed them on the wait_q */
 		while (! pdeq_empty(status->wait_q)) {
 			graph_entry_t *const entry = (graph_entry_t*)pdeq_getr(status->wait_q);
@@ -2077,6 +2156,11 @@ void stat_dump_snapshot(const char *name, const char *phase)
 				continue;
 			}
 
+			if (! entry->is_sampled) {
+				/* no statistics collected for this graph */
+				continue;
+			}
+
 			if (! entry->is_deleted || status->stat_options & FIRMSTAT_COUNT_DELETED) {
 				stat_dump_graph(entry);
 				stat_dump_registered(entry);
@@ -2191,6 +2275,11 @@ void firm_init_stat(void)
 	/* enable statistics */
 	status->stat_options = stat_options & FIRMSTAT_ENABLED ? stat_options : 0;
 
+	/* sampling mode */
+	status->sample_ratio = stat_sample_ratio > 0 ? (unsigned)stat_sample_ratio : 1;
+	if (stat_options & FIRMSTAT_SAMPLING)
+		status->flat_opcodes = NEW_ARR_FZ(node_entry_t, ir_get_n_opcodes());
+
 	/* register all hooks */
 	HOOK(hook_new_ir_op,                          stat_new_ir_op);
 	HOOK(hook_free_ir_op,                         stat_free_ir_op);
@@ -2324,6 +2413,9 @@ void stat_term(void)
 
 		stat_term_dumper();
 
+		if (status->flat_opcodes)
+			DEL_ARR_F(status->flat_opcodes);
+
 		free(status);
 		status = (stat_info_t *)&status_disable;
 	}
@@ -2349,11 +2441,13 @@ void init_stat(void)
 		{ "count_sels",      FIRMSTAT_COUNT_SELS      },
 		{ "count_consts",    FIRMSTAT_COUNT_CONSTS    },
 		{ "csv_output",      FIRMSTAT_CSV_OUTPUT      },
+		{ "sampling",        FIRMSTAT_SAMPLING        },
 		{ NULL,              0 }
 	};
 	static lc_opt_enum_mask_var_t statmask = { &stat_options, stat_items };
 	static const lc_opt_table_entry_t stat_optionstable[] = {
 		LC_OPT_ENT_ENUM_MASK("statistics", "enable statistics",   &statmask),
+		LC_OPT_ENT_INT("statistics_sample_ratio", "collect structural statistics for 1-in-N graphs in sampling mode", &stat_sample_ratio),
 		LC_OPT_LAST
 	};
 	lc_opt_add_table(be_grp, stat_optionstable);
@@ -51,6 +51,7 @@ enum firmstat_options_t {
 	FIRMSTAT_COUNT_DELETED   = 0x00000010,    /**< if set, count deleted graphs */
 	FIRMSTAT_COUNT_SELS      = 0x00000020,    /**< if set, count Sel(Sel(..)) differently */
 	FIRMSTAT_COUNT_CONSTS    = 0x00000040,    /**< if set, count Const statistics */
+	FIRMSTAT_SAMPLING        = 0x00000080,    /**< if set, use flat opcode counters and sample graphs */
 	FIRMSTAT_CSV_OUTPUT      = 0x10000000     /**< CSV output of some mini-statistic */
 };
 
@@ -283,6 +284,7 @@ typedef struct graph_entry_t {
 	unsigned                   is_chain_call:1;              /**< set, if this irg is a chain call */
 	unsigned                   is_strict:1;                  /**< set, if this irg represents a strict program */
 	unsigned                   is_analyzed:1;                /**< helper: set, if this irg was already analysed */
+	unsigned                   is_sampled:1;                 /**< set, if structural statistics are collected for this irg */
 } graph_entry_t;
 
 /**
@@ -450,6 +452,11 @@ typedef struct statistic_info_t {
 	distrib_tbl_t           *dist_param_cnt;     /**< distribution table for call parameters */
 
 	counter_t               num_opts[FS_OPT_MAX];/**< count optimizations */
+
+	node_entry_t            *flat_opcodes;       /**< sampling mode: flat array of opcode counters, indexed by opcode */
+	unsigned                sample_ratio;        /**< sampling mode: structural statistics for 1-in-sample_ratio graphs */
+	unsigned                n_graphs;            /**< sampling mode: number of graphs seen */
+	unsigned                n_sampled_graphs;    /**< sampling mode: number of sampled graphs */
 } stat_info_t;
 
 /**
@@ -492,6 +492,11 @@ static void simple_dump_graph(dumper_t *dmp, graph_entry_t *entry)
 	} else {
 		fprintf(dmp->f, "\nGlobals counts:\n");
 		fprintf(dmp->f, "--------------\n");
+		if (dmp->status->stat_options & FIRMSTAT_SAMPLING) {
+			fprintf(dmp->f, " sampled graphs            : %u of %u (1 in %u)\n",
+				dmp->status->n_sampled_graphs, dmp->status->n_graphs,
+				dmp->status->sample_ratio);
+		}
 		dump_opts = 0;
 	}
 
@@ -1911,10 +1911,6 @@ SOURCE=..\ir\ir\iredges_t.h
 # End Source File
 # Begin Source File
 
-SOURCE=..\ir\ir\iredgeset.h
-# End Source File
-# Begin Source File
-
 SOURCE=..\ir\ir\irflag.c
 # End Source File
 # Begin Source File